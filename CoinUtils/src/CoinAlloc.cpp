@@ -4,27 +4,70 @@
 // This code is licensed under the terms of the Eclipse Public License (EPL).
 
 #include <cassert>
+#include <cstdio>
 #include <cstdlib>
 #include <new>
 #include "CoinAlloc.hpp"
 
-#if (COINUTILS_MEMPOOL_MAXPOOLED >= 0)
+#if defined(COINUTILS_PTHREADS) && (COINUTILS_PTHREADS == 1)
+#include <pthread.h>
+#define COIN_ALLOC_PTHREADS 1
+#endif
+
+/* Atomic operations on shared pools.  Everything is allocated with
+   malloc (not new) as this may be serving operator new. */
+#ifdef COIN_ALLOC_PTHREADS
+#define COIN_ALLOC_CAS(where,old,value) \
+  __sync_bool_compare_and_swap(where,old,value)
+#define COIN_ALLOC_EXCHANGE(where,value) \
+  __sync_lock_test_and_set(where,value)
+#define COIN_ALLOC_ADD(where,value) \
+  __sync_fetch_and_add(where,value)
+#else
+template <class T> static inline bool
+coinAllocCas(T volatile * where, T old, T value)
+{ if (*where!=old) return false; *where = value; return true; }
+template <class T> static inline T
+coinAllocExchange(T volatile * where, T value)
+{ T old = *where; *where = value; return old; }
+#define COIN_ALLOC_CAS(where,old,value) coinAllocCas(where,old,value)
+#define COIN_ALLOC_EXCHANGE(where,value) coinAllocExchange(where,value)
+#define COIN_ALLOC_ADD(where,value) (*(where) += (value))
+#endif
+
+// Default number of entries moved at a time
+#define COIN_ALLOC_BATCH 64
+
+//#############################################################################
+// Free entry is - next in batch, next batch, number in batch
+//#############################################################################
+
+static inline char *&
+coinNextEntry(char * entry)
+{
+  return reinterpret_cast<char **>(entry)[0];
+}
+
+static inline char *&
+coinNextBatch(char * entry)
+{
+  return reinterpret_cast<char **>(entry)[1];
+}
+
+static inline std::size_t &
+coinBatchCount(char * entry)
+{
+  return reinterpret_cast<std::size_t *>(entry)[2];
+}
 
 //=============================================================================
 
 CoinMempool::CoinMempool(size_t entry) :
-#if (COIN_MEMPOOL_SAVE_BLOCKHEADS==1)
-  block_heads_(NULL),
-  block_num_(0),
-  max_block_num_(0),
-#endif
-  last_block_size_(0),
-  first_free_(NULL),
-  entry_size_(entry)
+  batches_(NULL),
+  entry_size_(entry),
+  mallocs_(0),
+  shared_(0)
 {
-#if defined(COINUTILS_PTHREADS) && (COINUTILS_PTHREAD == 1)
-  pthread_mutex_init(&mutex_, NULL);
-#endif
   assert((entry_size_/COINUTILS_MEMPOOL_ALIGNMENT)*COINUTILS_MEMPOOL_ALIGNMENT
 	 == entry_size_);
 }
@@ -33,87 +76,482 @@ CoinMempool::CoinMempool(size_t entry) :
 
 CoinMempool::~CoinMempool()
 {
-#if (COIN_MEMPOOL_SAVE_BLOCKHEADS==1)
-  for (size_t i = 0; i < block_num_; ++i) {
-    free(block_heads_[i]);
-  }
-#endif
-#if defined(COINUTILS_PTHREADS) && (COINUTILS_PTHREAD == 1)
-  pthread_mutex_destroy(&mutex_);
-#endif
+  trim();
 }
 
 //==============================================================================
 
-char* 
-CoinMempool::alloc()
-{
-  lock_mutex();
-  if (first_free_ == NULL) {
-    unlock_mutex();
-    char* block = allocate_new_block();
-    lock_mutex();
-#if (COIN_MEMPOOL_SAVE_BLOCKHEADS==1)
-    // see if we can record another block head. If not, then resize
-    // block_heads
-    if (max_block_num_ == block_num_) {
-      max_block_num_ = 2 * block_num_ + 10;
-      char** old_block_heads = block_heads_;
-      block_heads_ = (char**)malloc(max_block_num_ * sizeof(char*));
-      CoinMemcpyN( old_block_heads,block_num_,block_heads_);
-      free(old_block_heads);
+// Get a batch of entries
+int
+CoinMempool::takeBatch(char *& first, int number)
+{
+  // take whole stack - no one else can then see first batch
+  char * batch = COIN_ALLOC_EXCHANGE(&batches_,static_cast<char *>(NULL));
+  if (batch) {
+    first = batch;
+    int n = static_cast<int>(coinBatchCount(batch));
+    COIN_ALLOC_ADD(&shared_,static_cast<CoinInt64>(-n));
+    char * rest = coinNextBatch(batch);
+    if (rest) {
+      // put back rest
+      char * last = rest;
+      while (coinNextBatch(last))
+	last = coinNextBatch(last);
+      char * old;
+      do {
+	old = batches_;
+	coinNextBatch(last) = old;
+      } while (!COIN_ALLOC_CAS(&batches_,old,rest));
     }
-    // save the new block
-    block_heads_[block_num_++] = block;
-#endif
-    // link in the new block
-    *(char**)(block+((last_block_size_-1)*entry_size_)) = first_free_;
-    first_free_ = block;
+    return n;
   }
-  char* p = first_free_;
-  first_free_ = *(char**)p;
-  unlock_mutex();
-  return p;
+  // new entries
+  char * previous = NULL;
+  for (int i=0;i<number;i++) {
+    char * entry = static_cast<char *>(std::malloc(entry_size_));
+    if (!entry) {
+      // give back what we have
+      while (previous) {
+	char * next = coinNextEntry(previous);
+	std::free(previous);
+	previous = next;
+      }
+      COIN_ALLOC_ADD(&mallocs_,static_cast<CoinInt64>(-i));
+      throw std::bad_alloc();
+    }
+    coinNextEntry(entry) = previous;
+    previous = entry;
+    COIN_ALLOC_ADD(&mallocs_,static_cast<CoinInt64>(1));
+  }
+  first = previous;
+  return number;
 }
 
 //=============================================================================
 
-char*
-CoinMempool::allocate_new_block()
+// Put batch on stack
+void
+CoinMempool::giveBatch(char * first, char * last, int number)
+{
+  assert (!coinNextEntry(last));
+  coinBatchCount(first) = number;
+  COIN_ALLOC_ADD(&shared_,static_cast<CoinInt64>(number));
+  char * old;
+  do {
+    old = batches_;
+    coinNextBatch(first) = old;
+  } while (!COIN_ALLOC_CAS(&batches_,old,first));
+}
+
+//=============================================================================
+
+// Free shared entries
+int
+CoinMempool::trim()
 {
-  last_block_size_ = static_cast<int>(1.5 * last_block_size_ + 32);
-  char* block = static_cast<char*>(std::malloc(last_block_size_*entry_size_));
-  // link the entries in the new block together
-  for (int i = last_block_size_-2; i >= 0; --i) {
-    *(char**)(block+(i*entry_size_)) = block+((i+1)*entry_size_);
+  char * batch = COIN_ALLOC_EXCHANGE(&batches_,static_cast<char *>(NULL));
+  int n = 0;
+  while (batch) {
+    char * nextBatch = coinNextBatch(batch);
+    int nInBatch = static_cast<int>(coinBatchCount(batch));
+    char * entry = batch;
+    while (entry) {
+      char * next = coinNextEntry(entry);
+      std::free(entry);
+      entry = next;
+    }
+    n += nInBatch;
+    batch = nextBatch;
   }
-  // terminate the linked list with a null pointer
-  *(char**)(block+((last_block_size_-1)*entry_size_)) = NULL;
-  return block;
+  COIN_ALLOC_ADD(&shared_,static_cast<CoinInt64>(-n));
+  COIN_ALLOC_ADD(&mallocs_,static_cast<CoinInt64>(-n));
+  return n;
 }
 
+//#############################################################################
+// Thread caches
 //#############################################################################
 
-CoinAlloc CoinAllocator;
+namespace {
+  struct CoinAllocCacheEntry {
+    char * free;
+    int count;
+    CoinInt64 allocs;
+    CoinInt64 deallocs;
+  };
+  /* Cache of one thread (entry for each pool follows) - also used for
+     counts of threads which have ended */
+  struct CoinAllocCache {
+    CoinAllocData * data;
+    CoinAllocCache * previous;
+    CoinAllocCache * next;
+    CoinAllocCacheEntry * entry;
+  };
+}
+
+class CoinAllocData {
+public:
+  CoinMempool * pool_;
+  int numberPools_;
+  int batchSize_;
+  /// True if made by default constructor (never torn down)
+  bool keep_;
+  /// First cache (registry of all thread caches)
+  CoinAllocCache * first_;
+  /// Counts from threads which have ended
+  CoinAllocCache * retired_;
+#ifdef COIN_ALLOC_PTHREADS
+  pthread_key_t key_;
+  /// Protects registry
+  pthread_mutex_t mutex_;
+#endif
+  inline void lock() {
+#ifdef COIN_ALLOC_PTHREADS
+    pthread_mutex_lock(&mutex_);
+#endif
+  }
+  inline void unlock() {
+#ifdef COIN_ALLOC_PTHREADS
+    pthread_mutex_unlock(&mutex_);
+#endif
+  }
+  /// Cache of calling thread (created if needed)
+  CoinAllocCache * cache();
+  /// New zeroed cache
+  CoinAllocCache * newCache();
+  /// Pass free entries of cache to pools
+  void flush(CoinAllocCache * cache);
+};
+
+CoinAllocCache *
+CoinAllocData::newCache()
+{
+  size_t bytes = sizeof(CoinAllocCache)+numberPools_*sizeof(CoinAllocCacheEntry);
+  CoinAllocCache * cache = static_cast<CoinAllocCache *>(std::malloc(bytes));
+  if (!cache)
+    throw std::bad_alloc();
+  cache->data = this;
+  cache->previous = NULL;
+  cache->next = NULL;
+  cache->entry = reinterpret_cast<CoinAllocCacheEntry *>(cache+1);
+  for (int i=0;i<numberPools_;i++) {
+    cache->entry[i].free = NULL;
+    cache->entry[i].count = 0;
+    cache->entry[i].allocs = 0;
+    cache->entry[i].deallocs = 0;
+  }
+  return cache;
+}
+
+void
+CoinAllocData::flush(CoinAllocCache * cache)
+{
+  for (int i=0;i<numberPools_;i++) {
+    CoinAllocCacheEntry & entry = cache->entry[i];
+    if (entry.count) {
+      char * last = entry.free;
+      while (coinNextEntry(last))
+	last = coinNextEntry(last);
+      pool_[i].giveBatch(entry.free,last,entry.count);
+      entry.free = NULL;
+      entry.count = 0;
+    }
+  }
+}
+
+#ifdef COIN_ALLOC_PTHREADS
+extern "C" {
+  // Thread has ended - pass on entries and keep counts
+  static void coinAllocCacheDelete(void * arg)
+  {
+    CoinAllocCache * cache = static_cast<CoinAllocCache *>(arg);
+    CoinAllocData * data = cache->data;
+    data->flush(cache);
+    data->lock();
+    for (int i=0;i<data->numberPools_;i++) {
+      data->retired_->entry[i].allocs += cache->entry[i].allocs;
+      data->retired_->entry[i].deallocs += cache->entry[i].deallocs;
+    }
+    if (cache->previous)
+      cache->previous->next = cache->next;
+    else
+      data->first_ = cache->next;
+    if (cache->next)
+      cache->next->previous = cache->previous;
+    data->unlock();
+    std::free(cache);
+  }
+}
+#endif
+
+CoinAllocCache *
+CoinAllocData::cache()
+{
+#ifdef COIN_ALLOC_PTHREADS
+  CoinAllocCache * cache =
+    static_cast<CoinAllocCache *>(pthread_getspecific(key_));
+  if (cache)
+    return cache;
+  cache = newCache();
+  pthread_setspecific(key_,cache);
+  lock();
+  cache->next = first_;
+  if (first_)
+    first_->previous = cache;
+  first_ = cache;
+  unlock();
+  return cache;
+#else
+  if (!first_)
+    first_ = newCache();
+  return first_;
+#endif
+}
+
+//#############################################################################
 
 CoinAlloc::CoinAlloc() :
   pool_(NULL),
-  maxpooled_(COINUTILS_MEMPOOL_MAXPOOLED)
+  maxpooled_(COINUTILS_MEMPOOL_MAXPOOLED),
+  data_(NULL)
 {
   const char* maxpooled = std::getenv("COINUTILS_MEMPOOL_MAXPOOLED");
   if (maxpooled) {
     maxpooled_ = std::atoi(maxpooled);
   }
+  gutsOfConstructor();
+  if (data_)
+    data_->keep_ = true;
+}
+
+CoinAlloc::CoinAlloc(int maxPooled) :
+  pool_(NULL),
+  maxpooled_(maxPooled),
+  data_(NULL)
+{
+  gutsOfConstructor();
+}
+
+void
+CoinAlloc::gutsOfConstructor()
+{
+  if (maxpooled_ < 0)
+    maxpooled_ = 0;
   const size_t poolnum = maxpooled_ / COINUTILS_MEMPOOL_ALIGNMENT;
-  maxpooled_ = poolnum * COINUTILS_MEMPOOL_ALIGNMENT;
+  maxpooled_ = static_cast<int>(poolnum * COINUTILS_MEMPOOL_ALIGNMENT);
   if (maxpooled_ > 0) {
     pool_ = (CoinMempool*)malloc(sizeof(CoinMempool)*poolnum);
-    for (int i = poolnum-1; i >= 0; --i) {
+    for (int i = static_cast<int>(poolnum)-1; i >= 0; --i) {
       new (&pool_[i]) CoinMempool(i*COINUTILS_MEMPOOL_ALIGNMENT);
     }
+    data_ = static_cast<CoinAllocData *>(malloc(sizeof(CoinAllocData)));
+    data_->pool_ = pool_;
+    data_->numberPools_ = static_cast<int>(poolnum);
+    data_->batchSize_ = COIN_ALLOC_BATCH;
+    data_->keep_ = false;
+    data_->first_ = NULL;
+    data_->retired_ = data_->newCache();
+#ifdef COIN_ALLOC_PTHREADS
+    pthread_key_create(&data_->key_,coinAllocCacheDelete);
+    pthread_mutex_init(&data_->mutex_,NULL);
+#endif
+  }
+}
+
+CoinAlloc::~CoinAlloc()
+{
+  /* CoinAllocator may still be used by static destructors run later
+     so is left alone */
+  if (!data_ || data_->keep_)
+    return;
+#ifdef COIN_ALLOC_PTHREADS
+  pthread_key_delete(data_->key_);
+  pthread_mutex_destroy(&data_->mutex_);
+#endif
+  while (data_->first_) {
+    CoinAllocCache * cache = data_->first_;
+    data_->flush(cache);
+    data_->first_ = cache->next;
+    std::free(cache);
+  }
+  std::free(data_->retired_);
+  std::free(data_);
+  for (int i = numberPools()-1; i >= 0; --i)
+    pool_[i].~CoinMempool();
+  std::free(pool_);
+}
+
+//=============================================================================
+
+// Get entry from cache of calling thread
+char*
+CoinAlloc::allocPooled(int whichPool)
+{
+  CoinAllocCacheEntry & entry = data_->cache()->entry[whichPool];
+  entry.allocs++;
+  if (!entry.free)
+    entry.count = pool_[whichPool].takeBatch(entry.free,data_->batchSize_);
+  char * p = entry.free;
+  entry.free = coinNextEntry(p);
+  entry.count--;
+  return p;
+}
+
+// Give entry to cache of calling thread
+void
+CoinAlloc::deallocPooled(char* p, int whichPool)
+{
+  CoinAllocCacheEntry & entry = data_->cache()->entry[whichPool];
+  entry.deallocs++;
+  coinNextEntry(p) = entry.free;
+  entry.free = p;
+  entry.count++;
+  const int batchSize = data_->batchSize_;
+  if (entry.count >= 2*batchSize) {
+    // pass on a batch
+    char * first = entry.free;
+    char * last = first;
+    for (int i=1;i<batchSize;i++)
+      last = coinNextEntry(last);
+    entry.free = coinNextEntry(last);
+    coinNextEntry(last) = NULL;
+    entry.count -= batchSize;
+    pool_[whichPool].giveBatch(first,last,batchSize);
+  }
+}
+
+//=============================================================================
+
+void
+CoinAlloc::flushThreadCache()
+{
+  if (data_)
+    data_->flush(data_->cache());
+}
+
+CoinInt64
+CoinAlloc::trim()
+{
+  CoinInt64 bytes = 0;
+  if (data_) {
+    flushThreadCache();
+    for (int i = 0; i < numberPools(); i++)
+      bytes += static_cast<CoinInt64>(pool_[i].trim())*pool_[i].entrySize();
+  }
+  return bytes;
+}
+
+int
+CoinAlloc::batchSize() const
+{
+  return data_ ? data_->batchSize_ : COIN_ALLOC_BATCH;
+}
+
+void
+CoinAlloc::setBatchSize(int value)
+{
+  if (data_)
+    data_->batchSize_ = value>1 ? value : 1;
+}
+
+//=============================================================================
+
+CoinInt64
+CoinAlloc::numberAllocs(int whichPool) const
+{
+  CoinInt64 n = 0;
+  if (data_) {
+    data_->lock();
+    for (int i = 0; i < numberPools(); i++) {
+      if (whichPool<0||i==whichPool) {
+	n += data_->retired_->entry[i].allocs;
+	for (CoinAllocCache * cache = data_->first_;cache;cache=cache->next)
+	  n += cache->entry[i].allocs;
+      }
+    }
+    data_->unlock();
+  }
+  return n;
+}
+
+CoinInt64
+CoinAlloc::numberDeallocs(int whichPool) const
+{
+  CoinInt64 n = 0;
+  if (data_) {
+    data_->lock();
+    for (int i = 0; i < numberPools(); i++) {
+      if (whichPool<0||i==whichPool) {
+	n += data_->retired_->entry[i].deallocs;
+	for (CoinAllocCache * cache = data_->first_;cache;cache=cache->next)
+	  n += cache->entry[i].deallocs;
+      }
+    }
+    data_->unlock();
+  }
+  return n;
+}
+
+CoinInt64
+CoinAlloc::numberMalloced(int whichPool) const
+{
+  CoinInt64 n = 0;
+  for (int i = 0; i < numberPools(); i++) {
+    if (whichPool<0||i==whichPool)
+      n += pool_[i].numberMalloced();
+  }
+  return n;
+}
+
+CoinInt64
+CoinAlloc::numberFree(int whichPool) const
+{
+  CoinInt64 n = 0;
+  if (data_) {
+    data_->lock();
+    for (int i = 0; i < numberPools(); i++) {
+      if (whichPool<0||i==whichPool) {
+	n += pool_[i].numberShared();
+	for (CoinAllocCache * cache = data_->first_;cache;cache=cache->next)
+	  n += cache->entry[i].count;
+      }
+    }
+    data_->unlock();
   }
+  return n;
 }
 
+CoinInt64
+CoinAlloc::bytesFree() const
+{
+  CoinInt64 n = 0;
+  for (int i = 0; i < numberPools(); i++)
+    n += numberFree(i)*pool_[i].entrySize();
+  return n;
+}
+
+void
+CoinAlloc::printStatistics() const
+{
+  printf("CoinAlloc pools up to %d bytes, batches of %d\n",
+	 maxpooled_,batchSize());
+  for (int i = 0; i < numberPools(); i++) {
+    CoinInt64 nAlloc = numberAllocs(i);
+    if (nAlloc||pool_[i].numberMalloced())
+      printf("%6d bytes - %lld allocs, %lld deallocs, %lld malloced, %lld free\n",
+	     poolSize(i),static_cast<long long>(nAlloc),
+	     static_cast<long long>(numberDeallocs(i)),
+	     static_cast<long long>(pool_[i].numberMalloced()),
+	     static_cast<long long>(numberFree(i)));
+  }
+}
+
+//#############################################################################
+
+#if (COINUTILS_MEMPOOL_MAXPOOLED >= 0)
+
+CoinAlloc CoinAllocator;
+
 //#############################################################################
 
 #if defined(COINUTILS_MEMPOOL_OVERRIDE_NEW) && (COINUTILS_MEMPOOL_OVERRIDE_NEW == 1)
@@ -7,14 +7,14 @@
 #define CoinAlloc_hpp
 
 #include "CoinUtilsConfig.h"
+#include "CoinTypes.hpp"
 #include <cstdlib>
+#include <new>
 
 #if !defined(COINUTILS_MEMPOOL_MAXPOOLED)
 #  define COINUTILS_MEMPOOL_MAXPOOLED -1
 #endif
 
-#if (COINUTILS_MEMPOOL_MAXPOOLED >= 0)
-
 #ifndef COINUTILS_MEMPOOL_ALIGNMENT
 #define COINUTILS_MEMPOOL_ALIGNMENT 16
 #endif
@@ -42,61 +42,62 @@ static const std::size_t CoinAllocRoundMask = ~((std::size_t)7);
 
 //#############################################################################
 
-#ifndef COIN_MEMPOOL_SAVE_BLOCKHEADS
-#  define COIN_MEMPOOL_SAVE_BLOCKHEADS 0
-#endif
+/** Shared free entries of one size.
 
-//#############################################################################
+    Free entries are held as batches (chains linked through the first
+    word of each entry).  Batches are kept on a lock-free stack - a batch
+    is pushed with compare and swap and the whole stack is taken with one
+    exchange so there is no ABA problem.  Threads normally work from
+    their own cache (see CoinAlloc) and only come here a batch at a time.
+
+    Entries are obtained from malloc one at a time so trim() can give
+    them back and the memory can then be used for other sizes.
+*/
 
-class CoinMempool 
+class CoinMempool
 {
 private:
-#if (COIN_MEMPOOL_SAVE_BLOCKHEADS == 1)
-   char** block_heads;
-   std::size_t block_num;
-   std::size_t max_block_num;
-#endif
-#if defined(COINUTILS_PTHREADS) && (COINUTILS_PTHREAD == 1)
-  pthread_mutex_t mutex_;
-#endif
-  int last_block_size_;
-  char* first_free_;
+  /// Stack of batches (linked through second word of first entry)
+  char * volatile batches_;
   const std::size_t entry_size_;
+  /// Entries obtained from malloc
+  volatile CoinInt64 mallocs_;
+  /// Entries in batches on stack
+  volatile CoinInt64 shared_;
 
 private:
   CoinMempool(const CoinMempool&);
   CoinMempool& operator=(const CoinMempool&);
 
-private:
-  char* allocate_new_block();
-  inline void lock_mutex() {
-#if defined(COINUTILS_PTHREADS) && (COINUTILS_PTHREAD == 1)
-    pthread_mutex_lock(&mutex_);
-#endif
-  }
-  inline void unlock_mutex() {
-#if defined(COINUTILS_PTHREADS) && (COINUTILS_PTHREAD == 1)
-    pthread_mutex_unlock(&mutex_);
-#endif
-  }
-
 public:
   CoinMempool(std::size_t size = 0);
+  /// Destructor - frees shared entries
   ~CoinMempool();
 
-  char* alloc();
-  inline void dealloc(char *p) 
-  {
-    char** pp = (char**)p;
-    lock_mutex();
-    *pp = first_free_;
-    first_free_ = p;
-    unlock_mutex();
-  }
+  /** Get a chain of number entries (a batch from the stack, or new
+      entries if none).  Returns number in chain which may be more or
+      less than asked for. */
+  int takeBatch(char *& first, int number);
+  /// Put chain of number entries (first to last) on stack
+  void giveBatch(char * first, char * last, int number);
+  /// Free shared entries - returns number freed
+  int trim();
+
+  /// Size of each entry in bytes
+  inline std::size_t entrySize() const
+  { return entry_size_; }
+  /// Number of entries obtained from malloc (and not trimmed)
+  inline CoinInt64 numberMalloced() const
+  { return mallocs_; }
+  /// Number of entries in shared batches
+  inline CoinInt64 numberShared() const
+  { return shared_; }
 };
 
 //#############################################################################
 
+class CoinAllocData;
+
 /** A memory pool allocator.
 
     If a request arrives for allocating \c n bytes then it is first
@@ -107,6 +108,16 @@ public:
     then malloc is used. In either case, the size of the allocated
     chunk is written into the first \c sizeof(void*) bytes and a
     pointer pointing afterwards is returned.
+
+    Each thread has its own cache of free entries for each size, so
+    pooled alloc and dealloc normally need no locking.  Entries move
+    between a thread cache and the shared CoinMempool a batch at a time;
+    a thread with more than twice batchSize() free entries of a size
+    passes a batch on so memory freed in one thread can be reused by
+    another.  The caches of a thread are passed on when it ends.
+
+    Statistics are kept for each size class (pool).  While other threads
+    are running they are approximate.
 */
 
 class CoinAlloc
@@ -114,9 +125,25 @@ class CoinAlloc
 private:
   CoinMempool* pool_;
   int maxpooled_;
+  /// Thread caches etc (hidden so no thread headers needed here)
+  CoinAllocData* data_;
+
+  CoinAlloc(const CoinAlloc&);
+  CoinAlloc& operator=(const CoinAlloc&);
+  /// Set up pools
+  void gutsOfConstructor();
+  /// Get entry from cache of calling thread
+  char* allocPooled(int whichPool);
+  /// Give entry to cache of calling thread
+  void deallocPooled(char* p, int whichPool);
 public:
+  /// Maximum pooled size from COINUTILS_MEMPOOL_MAXPOOLED (or environment)
   CoinAlloc();
-  ~CoinAlloc() {}
+  /// Pool requests of less than maxPooled bytes (<=0 just use malloc)
+  CoinAlloc(int maxPooled);
+  /** Destructor - frees all free entries.  Threads other than the
+      calling one must have finished using the allocator. */
+  ~CoinAlloc();
 
   inline void* alloc(const std::size_t n)
   {
@@ -124,16 +151,21 @@ public:
       return std::malloc(n);
     }
     char *p = NULL;
-    const std::size_t to_alloc =
+    std::size_t to_alloc =
       ((n+COINUTILS_MEMPOOL_ALIGNMENT-1) & CoinAllocRoundMask) +
       COINUTILS_MEMPOOL_ALIGNMENT;
+    // free entries need three words
+    if (to_alloc < 3*sizeof(char*))
+      to_alloc = (3*sizeof(char*)+COINUTILS_MEMPOOL_ALIGNMENT-1) &
+	CoinAllocRoundMask;
     CoinMempool* pool = NULL;
     if (maxpooled_ > 0 && to_alloc >= (size_t)maxpooled_) {
       p = static_cast<char*>(std::malloc(to_alloc));
       if (p == NULL) throw std::bad_alloc();
     } else {
-      pool = pool_ + (to_alloc >> CoinAllocPtrShift);
-      p = pool->alloc();
+      const int which = static_cast<int>(to_alloc >> CoinAllocPtrShift);
+      pool = pool_ + which;
+      p = allocPooled(which);
     }
     *((CoinMempool**)p) = pool;
     return static_cast<void*>(p+COINUTILS_MEMPOOL_ALIGNMENT);
@@ -151,12 +183,51 @@ public:
       if (!pool) {
 	std::free(base);
       } else {
-	pool->dealloc(base);
+	deallocPooled(base, static_cast<int>(pool-pool_));
       }
     }
   }
+
+  /**@name Trimming */
+  //@{
+  /// Pass free entries held by calling thread to shared pools
+  void flushThreadCache();
+  /** Free idle memory - flushes cache of calling thread and frees all
+      shared free entries (returns bytes freed) */
+  CoinInt64 trim();
+  /// Entries moved between thread cache and shared pool at a time
+  int batchSize() const;
+  /// Set batch size
+  void setBatchSize(int value);
+  //@}
+
+  /**@name Statistics (for each pool or all if -1) */
+  //@{
+  /// Largest request pooled (0 if not pooling)
+  inline int maxPooled() const
+  { return maxpooled_; }
+  /// Number of pools
+  inline int numberPools() const
+  { return maxpooled_>0 ? maxpooled_/COINUTILS_MEMPOOL_ALIGNMENT : 0; }
+  /// Bytes in each entry of a pool
+  inline int poolSize(int whichPool) const
+  { return static_cast<int>(pool_[whichPool].entrySize()); }
+  /// Number of pooled allocs
+  CoinInt64 numberAllocs(int whichPool=-1) const;
+  /// Number of pooled deallocs
+  CoinInt64 numberDeallocs(int whichPool=-1) const;
+  /// Number of entries got from malloc
+  CoinInt64 numberMalloced(int whichPool=-1) const;
+  /// Number of free entries (in thread caches and shared)
+  CoinInt64 numberFree(int whichPool=-1) const;
+  /// Bytes held in free entries
+  CoinInt64 bytesFree() const;
+  /// Print statistics for pools which have been used
+  void printStatistics() const;
+  //@}
 };
 
+#if (COINUTILS_MEMPOOL_MAXPOOLED >= 0)
 extern CoinAlloc CoinAllocator;
 
 //#############################################################################
@@ -0,0 +1,181 @@
+/* $Id$ */
+// Copyright (C) 2012, International Business Machines
+// Corporation and others.  All Rights Reserved.
+// This code is licensed under the terms of the Eclipse Public License (EPL).
+
+#include <cassert>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+
+#include "CoinArena.hpp"
+
+//#############################################################################
+
+// Data starts this far into block
+#define COIN_ARENA_HEADER 16
+
+class CoinArenaBlock {
+public:
+  /// Next block (spare if after current)
+  CoinArenaBlock * next;
+  /// Usable bytes
+  size_t size;
+  inline char * data()
+  { return reinterpret_cast<char *>(this)+COIN_ARENA_HEADER; }
+};
+
+// Offset of first byte at or after top aligned on alignment
+static inline size_t
+coinArenaAlign(const char * base, size_t top, size_t alignment)
+{
+  size_t address = reinterpret_cast<size_t>(base+top);
+  return top+((alignment-(address&(alignment-1)))&(alignment-1));
+}
+
+//#############################################################################
+
+CoinArena::CoinArena(size_t blockSize)
+  : first_(NULL),
+    current_(NULL),
+    top_(0),
+    usedBefore_(0),
+    reserved_(0),
+    numberBlocks_(0),
+    blockSize_(blockSize>=1024 ? blockSize : 1024)
+{
+  assert (sizeof(CoinArenaBlock)<=COIN_ARENA_HEADER);
+}
+
+CoinArena::~CoinArena()
+{
+  current_ = NULL;
+  trim();
+}
+
+// Get numberBytes aligned on alignment
+void *
+CoinArena::allocate(size_t numberBytes, size_t alignment)
+{
+  assert (alignment&&!(alignment&(alignment-1)));
+  if (current_) {
+    char * base = current_->data();
+    size_t start = coinArenaAlign(base,top_,alignment);
+    if (start+numberBytes<=current_->size) {
+      top_ = start+numberBytes;
+      return base+start;
+    }
+  }
+  nextBlock(numberBytes,alignment);
+  char * base = current_->data();
+  size_t start = coinArenaAlign(base,0,alignment);
+  top_ = start+numberBytes;
+  return base+start;
+}
+
+// Move to next block with room (or get one)
+void
+CoinArena::nextBlock(size_t numberBytes, size_t alignment)
+{
+  size_t needed = numberBytes+alignment;
+  CoinArenaBlock * next;
+  if (current_) {
+    usedBefore_ += top_;
+    next = current_->next;
+  } else {
+    next = first_;
+  }
+  if (next&&next->size>=needed) {
+    current_ = next;
+  } else {
+    // new block goes in front of spare ones
+    size_t size = needed>blockSize_ ? needed : blockSize_;
+    CoinArenaBlock * block = static_cast<CoinArenaBlock *>
+      (malloc(size+COIN_ARENA_HEADER));
+    if (!block)
+      throw std::bad_alloc();
+    block->next = next;
+    block->size = size;
+    if (current_)
+      current_->next = block;
+    else
+      first_ = block;
+    current_ = block;
+    reserved_ += size;
+    numberBlocks_++;
+  }
+  top_ = 0;
+}
+
+// Get bigger copy of array
+void *
+CoinArena::reallocate(void * array, size_t oldBytes, size_t numberBytes)
+{
+  if (!array)
+    return allocate(numberBytes);
+  char * old = static_cast<char *>(array);
+  if (current_&&old+oldBytes==current_->data()+top_&&
+      old+numberBytes<=current_->data()+current_->size) {
+    // last thing allocated - just extend
+    top_ += numberBytes-oldBytes;
+    return array;
+  }
+  void * newArray = allocate(numberBytes);
+  memcpy(newArray,array,oldBytes<numberBytes ? oldBytes : numberBytes);
+  return newArray;
+}
+
+// Copy of string
+char *
+CoinArena::duplicate(const char * string)
+{
+  size_t n = strlen(string)+1;
+  char * copy = static_cast<char *>(allocate(n,1));
+  memcpy(copy,string,n);
+  return copy;
+}
+
+//#############################################################################
+
+CoinArenaMark
+CoinArena::mark() const
+{
+  CoinArenaMark position;
+  position.block_ = current_;
+  position.top_ = top_;
+  position.usedBefore_ = usedBefore_;
+  return position;
+}
+
+// Give back everything allocated since mark was taken
+void
+CoinArena::release(const CoinArenaMark & mark)
+{
+  current_ = mark.block_;
+  top_ = mark.top_;
+  usedBefore_ = mark.usedBefore_;
+}
+
+void
+CoinArena::reset()
+{
+  release(CoinArenaMark());
+}
+
+// Free blocks not in use
+void
+CoinArena::trim()
+{
+  CoinArenaBlock * block = current_ ? current_->next : first_;
+  if (current_)
+    current_->next = NULL;
+  else
+    first_ = NULL;
+  while (block) {
+    CoinArenaBlock * next = block->next;
+    reserved_ -= block->size;
+    numberBlocks_--;
+    free(block);
+    block = next;
+  }
+}
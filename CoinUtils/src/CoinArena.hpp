@@ -0,0 +1,144 @@
+/* $Id$ */
+// Copyright (C) 2012, International Business Machines
+// Corporation and others.  All Rights Reserved.
+// This code is licensed under the terms of the Eclipse Public License (EPL).
+
+#ifndef CoinArena_H
+#define CoinArena_H
+
+#include <cstddef>
+
+#include "CoinUtilsConfig.h"
+
+class CoinArenaBlock;
+
+/// Position in a CoinArena (from CoinArena::mark())
+class CoinArenaMark {
+public:
+  CoinArenaMark()
+    : block_(NULL), top_(0), usedBefore_(0) {}
+private:
+  friend class CoinArena;
+  /// Block in use (NULL if none)
+  CoinArenaBlock * block_;
+  /// Bytes used in block
+  size_t top_;
+  /// Bytes used in earlier blocks
+  size_t usedBefore_;
+};
+
+/** Bump allocator for temporaries.
+
+    Memory is handed out from large blocks by moving a pointer, and is
+    only given back all at once - by release() to a mark() (usually through
+    a CoinArenaScope) or by reset().  Giving back is O(1); blocks are kept
+    for reuse until trim() or the destructor.  Nothing is constructed or
+    destructed so only use for plain data.
+
+    Code which can draw from an arena (CoinLpIO::readLp, CoinBuild,
+    presolve) is given one by the caller through setArena().  The caller
+    decides when the memory goes, so the arena must outlive every object
+    still holding memory from it.
+*/
+class CoinArena {
+public:
+  /**@name Constructors and destructor */
+  //@{
+  /// Constructor - blocks are at least blockSize bytes
+  CoinArena(size_t blockSize = 65536);
+  /// Destructor - frees all blocks
+  ~CoinArena();
+  //@}
+
+  /**@name Memory */
+  //@{
+  /** Get numberBytes aligned on alignment (a power of 2 no more than
+      blockSize).  Throws std::bad_alloc if no memory. */
+  void * allocate(size_t numberBytes, size_t alignment = 16);
+  /// Get array of number T (not constructed)
+  template <class T> inline T * allocateArray(size_t number)
+  { return static_cast<T *>(allocate(number*sizeof(T))); }
+  /** Get bigger copy of array of oldBytes (old array is left in
+      arena until released) */
+  void * reallocate(void * array, size_t oldBytes, size_t numberBytes);
+  /// Copy of string
+  char * duplicate(const char * string);
+  //@}
+
+  /**@name Giving back */
+  //@{
+  /// Current position
+  CoinArenaMark mark() const;
+  /// Give back everything allocated since mark was taken
+  void release(const CoinArenaMark & mark);
+  /// Give back everything
+  void reset();
+  /// Free blocks not in use
+  void trim();
+  //@}
+
+  /**@name Statistics */
+  //@{
+  /// Bytes handed out (including alignment padding)
+  inline size_t bytesUsed() const
+  { return usedBefore_+top_; }
+  /// Bytes held in blocks
+  inline size_t bytesReserved() const
+  { return reserved_; }
+  /// Number of blocks held
+  inline int numberBlocks() const
+  { return numberBlocks_; }
+  /// Minimum block size
+  inline size_t blockSize() const
+  { return blockSize_; }
+  //@}
+
+private:
+  CoinArena(const CoinArena &);
+  CoinArena & operator=(const CoinArena &);
+  /// Move to next block with room (or get one)
+  void nextBlock(size_t numberBytes, size_t alignment);
+
+  /// First block
+  CoinArenaBlock * first_;
+  /// Block in use (blocks after it are spare)
+  CoinArenaBlock * current_;
+  /// Bytes used in current block
+  size_t top_;
+  /// Bytes used in blocks before current
+  size_t usedBefore_;
+  /// Bytes in all blocks
+  size_t reserved_;
+  int numberBlocks_;
+  size_t blockSize_;
+};
+
+/** Gives back all memory taken from an arena during its lifetime.
+
+    \code
+    {
+      CoinArenaScope scope(arena);
+      double * work = arena.allocateArray<double>(n);
+      ...
+    } // work given back here
+    \endcode
+
+    Memory is given back even if an exception is thrown.
+*/
+class CoinArenaScope {
+public:
+  inline CoinArenaScope(CoinArena & arena)
+    : arena_(&arena), mark_(arena.mark()) {}
+  /// Does nothing if arena is NULL (for optional arenas)
+  inline CoinArenaScope(CoinArena * arena)
+    : arena_(arena), mark_(arena ? arena->mark() : CoinArenaMark()) {}
+  inline ~CoinArenaScope()
+  { if (arena_) arena_->release(mark_); }
+private:
+  CoinArenaScope(const CoinArenaScope &);
+  CoinArenaScope & operator=(const CoinArenaScope &);
+  CoinArena * arena_;
+  CoinArenaMark mark_;
+};
+
+#endif
@@ -13,6 +13,7 @@
 
 
 #include "CoinBuild.hpp"
+#include "CoinArena.hpp"
 
 #include "CoinPragma.hpp"
 #include "CoinHelperFunctions.hpp"
@@ -50,7 +51,8 @@ CoinBuild::CoinBuild ()
     currentItem_(NULL),
     firstItem_(NULL),
     lastItem_(NULL),
-    type_(-1)
+    type_(-1),
+    arena_(NULL)
 {
 }
 //-------------------------------------------------------------------
@@ -63,7 +65,8 @@ CoinBuild::CoinBuild (int type)
     currentItem_(NULL),
     firstItem_(NULL),
     lastItem_(NULL),
-    type_(type)
+    type_(type),
+    arena_(NULL)
 {
   if (type<0||type>1)
     type_=-1; // unset
@@ -76,7 +79,8 @@ CoinBuild::CoinBuild (const CoinBuild & rhs)
   : numberItems_(rhs.numberItems_),
     numberOther_(rhs.numberOther_),
     numberElements_(rhs.numberElements_),
-    type_(rhs.type_)
+    type_(rhs.type_),
+    arena_(NULL)
 {
   if (numberItems_) {
     firstItem_=NULL;
@@ -114,12 +118,7 @@ CoinBuild::CoinBuild (const CoinBuild & rhs)
 //-------------------------------------------------------------------
 CoinBuild::~CoinBuild ()
 {
-  buildFormat * item = reinterpret_cast<buildFormat *> ( firstItem_);
-  for (int iItem=0;iItem<numberItems_;iItem++) {
-    double * array = reinterpret_cast<double *> ( item);
-    item = item->next;
-    delete [] array;
-  }
+  freeItems();
 }
 
 //----------------------------------------------------------------
@@ -129,12 +128,7 @@ CoinBuild &
 CoinBuild::operator=(const CoinBuild& rhs)
 {
   if (this != &rhs) {
-    buildFormat * item = reinterpret_cast<buildFormat *> ( firstItem_);
-    for (int iItem=0;iItem<numberItems_;iItem++) {
-      double * array = reinterpret_cast<double *> ( item);
-      item = item->next;
-      delete [] array;
-    }
+    freeItems();
     numberItems_=rhs.numberItems_;
     numberOther_=rhs.numberOther_;
     numberElements_=rhs.numberElements_;
@@ -149,7 +143,7 @@ CoinBuild::operator=(const CoinBuild& rhs)
         int numberElements = item->numberElements;
         int length = CoinSizeofAsInt(buildFormat)+(numberElements-1)*(CoinSizeofAsInt(double)+CoinSizeofAsInt(int));
         int doubles = (length + CoinSizeofAsInt(double)-1)/CoinSizeofAsInt(double);
-        double * copyOfItem = new double [doubles];
+        double * copyOfItem = allocateItem(doubles);
         memcpy(copyOfItem,item,length);
         if (!firstItem_) {
           firstItem_ = copyOfItem;
@@ -286,7 +280,7 @@ CoinBuild::addItem(int numberInItem, const int * indices,
   buildFormat * lastItem = reinterpret_cast<buildFormat *> ( lastItem_);
   int length = CoinSizeofAsInt(buildFormat)+(numberInItem-1)*(CoinSizeofAsInt(double)+CoinSizeofAsInt(int));
   int doubles = (length + CoinSizeofAsInt(double)-1)/CoinSizeofAsInt(double);
-  double * newItem = new double [doubles];
+  double * newItem = allocateItem(doubles);
   if (!firstItem_) {
     firstItem_ = newItem;
   } else {
@@ -388,3 +382,32 @@ CoinBuild::currentItem() const
   else
     return -1;
 }
+// Take items from arena
+void
+CoinBuild::setArena(CoinArena * arena)
+{
+  assert (!numberItems_);
+  arena_ = arena;
+}
+// Get space for an item
+double *
+CoinBuild::allocateItem(int doubles)
+{
+  if (arena_)
+    return arena_->allocateArray<double>(doubles);
+  else
+    return new double [doubles];
+}
+// Delete items (unless from arena)
+void
+CoinBuild::freeItems()
+{
+  if (arena_)
+    return;
+  buildFormat * item = reinterpret_cast<buildFormat *> ( firstItem_);
+  for (int iItem=0;iItem<numberItems_;iItem++) {
+    double * array = reinterpret_cast<double *> ( item);
+    item = item->next;
+    delete [] array;
+  }
+}
@@ -11,6 +11,7 @@
 #include "CoinTypes.hpp"
 #include "CoinFinite.hpp"
 
+class CoinArena;
 
 /** 
     In many cases it is natural to build a model by adding one row at a time.  In Coin this
@@ -83,6 +84,12 @@ public:
   /// Returns type
   inline int type() const
   { return type_;}
+  /** Take items from arena (NULL for new[]).  Only allowed while empty.
+      The arena must outlive this object. */
+  void setArena(CoinArena * arena);
+  /// Arena items come from (NULL if none)
+  inline CoinArena * arena() const
+  { return arena_;}
    //@}
 
 
@@ -125,6 +132,10 @@ private:
   void setCurrentItem(int whichItem);
   /// Returns current item number
   int currentItem() const;
+  /// Get space for an item
+  double * allocateItem(int doubles);
+  /// Delete items (unless from arena)
+  void freeItems();
    
 private:
   /**@name Data members */
@@ -143,6 +154,8 @@ private:
   double * lastItem_;
   /// Type of build - 0 for row, 1 for column, -1 unset
   int type_;
+  /// Arena items come from (not copied)
+  CoinArena * arena_;
    //@}
 };
 
@@ -22,6 +22,7 @@
 #include "CoinIndexedVector.hpp"
 
 class CoinPackedMatrix;
+class CoinMemoryUsage;
 /** This deals with Factorization and Updates
 
     This class started with a parallel simplex code I was writing in the
@@ -65,12 +66,38 @@ public:
   void almostDestructor();
   /// Debug show object (shows one representation)
   void show_self (  ) const;
-  /// Debug - save on file - 0 if no error
-  int saveFactorization (const char * file  ) const;
-  /** Debug - restore from file - 0 if no error on file.
-      If factor true then factorizes as if called from ClpFactorization
+  /** Save factorization as a checkpoint on file - 0 if no error.
+      The file has a versioned header followed by the packed L, U and R
+      arrays and permutations, each section aligned so that an
+      uncompressed file can be mapped with mapFactorization.
+      compression - 0 none, 1 gzip, 2 bzip2 (if available)
+  */
+  int saveFactorization (const char * file , int compression=0 ) const;
+  /** Restore checkpoint from file (may be compressed) - 0 if no error,
+      1 bad file, 2 not a checkpoint or written with different
+      CoinBigIndex/CoinFactorizationDouble sizes.
+      Factorization can be used for solves immediately.
+      If factor true then refactorizes as if called from ClpFactorization
   */
   int restoreFactorization (const char * file  , bool factor=false) ;
+  /** Restore uncompressed checkpoint by mapping file into memory.
+      Arrays point into a read only mapping so pages are only read when
+      solves touch them.  Return codes as restoreFactorization plus 3 if
+      mapping not supported on this platform or file compressed.
+      Any refactorization (or destructor) unmaps file; updates
+      (updateColumnFT, replaceColumn etc) first copy arrays to memory.
+  */
+  int mapFactorization (const char * file) ;
+  /** Unmap checkpoint.  If keepArrays true then arrays are copied to
+      normal memory first so factorization can still be used */
+  void unmapFactorization(bool keepArrays=true);
+  /// Returns true if arrays come from a mapped checkpoint
+  inline bool mapped() const
+  { return checkpointMap_!=NULL;}
+  /** Add bytes used and allocated for each internal array to \p usage.
+      For U and L areas used is the number of elements so slack shows
+      how well areaFactor fits. */
+  void memoryUsage(CoinMemoryUsage & usage) const;
   /// Debug - sort so can compare
   void sort (  ) const;
   /// = copy
@@ -478,6 +505,24 @@ public:
   /// 1 bit - tolerances etc, 2 more, 4 dummy arrays
   void gutsOfInitialize(int type);
   void gutsOfCopy(const CoinFactorization &other);
+  /** Fills in arrays and counts of items for checkpoint sections.
+      Counts are zero for arrays not allocated unless allocatedOnly
+      false.  Returns number of sections */
+  int checkpointSections(CoinArrayWithLength ** arrays, int * sizes,
+			 CoinBigIndex * counts, bool allocatedOnly=true) const;
+  /** Items of each section actually in use (written to checkpoint) -
+      only first part of U and L areas */
+  void checkpointUsed(int numberSections, const CoinBigIndex * counts,
+		      CoinBigIndex * used) const;
+  /** True if scalars just restored from intValues are consistent and
+      section counts from file fit them or, if loaded, are exactly
+      what would be saved */
+  bool checkpointValid(const CoinInt64 * intValues,
+		       const CoinInt64 * fileCounts, int numberSections,
+		       bool loaded);
+  /// Gets (or sets if save false) scalars for checkpoint
+  void checkpointScalars(CoinInt64 * intValues, double * doubleValues,
+			 bool save);
 
   /// Reset all sparsity etc statistics
   void resetStatistics();
@@ -1443,6 +1488,10 @@ protected:
       2 as 1 but give a bit extra if bigger needed
   */
   int persistenceFlag_;
+  /// Mapped checkpoint (NULL if none)
+  void * checkpointMap_;
+  /// Size of mapped checkpoint in bytes
+  size_t checkpointMapSize_;
   //@}
 };
 // Dense coding
@@ -22,6 +22,8 @@
 CoinFactorization::CoinFactorization (  )
 {
   persistenceFlag_=0;
+  checkpointMap_=NULL;
+  checkpointMapSize_=0;
   gutsOfInitialize(7);
 }
 
@@ -29,6 +31,8 @@ CoinFactorization::CoinFactorization (  )
 CoinFactorization::CoinFactorization ( const CoinFactorization &other)
 {
   persistenceFlag_=0;
+  checkpointMap_=NULL;
+  checkpointMapSize_=0;
   gutsOfInitialize(3);
   persistenceFlag_=other.persistenceFlag_;
   gutsOfCopy(other);
@@ -37,6 +41,8 @@ CoinFactorization::CoinFactorization ( const CoinFactorization &other)
 /// Really really delete if type 2
 void CoinFactorization::gutsOfDestructor(int type)
 {
+  if (checkpointMap_)
+    unmapFactorization(false);
   delete [] denseArea_;
   delete [] densePermute_;
   if (type==2) {
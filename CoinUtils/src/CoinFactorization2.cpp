@@ -17,6 +17,16 @@
 #include "CoinIndexedVector.hpp"
 #include "CoinHelperFunctions.hpp"
 #include "CoinFinite.hpp"
+#include "CoinFileIO.hpp"
+#include "CoinError.hpp"
+#include "CoinMemoryUsage.hpp"
+#ifndef _MSC_VER
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
 #if DENSE_CODE==1
 // using simple lapack interface
 extern "C" 
@@ -747,251 +757,686 @@ CoinFactorization::separateLinks(int count,bool rowsFirst)
       lastCount[firstRow]=lastColumn;
   } 
 }
-// Debug - save on file
-int
-CoinFactorization::saveFactorization (const char * file  ) const
+/* Checkpoint format.  All integers are written in native byte order,
+   endianCheck lets a reader see if that matches.  After the header
+   come intScalars CoinInt64 and doubleScalars doubles, then a table
+   of numberSections entries.  Each section starts on a
+   COIN_CHECKPOINT_ALIGN byte boundary so an uncompressed file can be
+   mapped and used in place.
+*/
+#define COIN_CHECKPOINT_VERSION 1
+#define COIN_CHECKPOINT_ALIGN 64
+#define COIN_CHECKPOINT_INTS 37
+#define COIN_CHECKPOINT_DOUBLES 19
+#define COIN_CHECKPOINT_MAX_SECTIONS 40
+typedef struct {
+  char magic[8];
+  int version;
+  int endianCheck;
+  int sizeofBigIndex;
+  int sizeofFactorizationDouble;
+  int numberIntScalars;
+  int numberDoubleScalars;
+  int numberSections;
+  int spare[9];
+} CoinFactorizationCheckpointHeader;
+typedef struct {
+  CoinInt64 offset;
+  CoinInt64 count;
+  int size;
+  int spare;
+} CoinFactorizationCheckpointSection;
+static const char coinCheckpointMagic[8] = {'C','o','i','n','F','a','c','t'};
+// Sets up header and section table for current factorization
+static CoinInt64 
+coinCheckpointLayout(CoinFactorizationCheckpointHeader & header,
+		     CoinFactorizationCheckpointSection * table,
+		     int numberSections, const int * sizes, 
+		     const CoinBigIndex * counts)
 {
-  FILE * fp = fopen(file,"wb");
-  if (fp) {
-    // Save so we can pick up scalars
-    const char * first = reinterpret_cast<const char *> ( &pivotTolerance_);
-    const char * last = reinterpret_cast<const char *> ( &biasLU_);
-    // increment
-    last += sizeof(int);
-    if (fwrite(first,last-first,1,fp)!=1)
-      return 1;
-    // Now arrays
-    if (CoinToFile(elementU_.array(),lengthAreaU_ , fp ))
-      return 1;
-    if (CoinToFile(indexRowU_.array(),lengthAreaU_ , fp ))
-      return 1;
-    if (CoinToFile(indexColumnU_.array(),lengthAreaU_ , fp ))
-      return 1;
-    if (CoinToFile(convertRowToColumnU_.array(),lengthAreaU_ , fp ))
-      return 1;
-    if (CoinToFile(elementByRowL_.array(),lengthAreaL_ , fp ))
-      return 1;
-    if (CoinToFile(indexColumnL_.array(),lengthAreaL_ , fp ))
-      return 1;
-    if (CoinToFile(startRowL_.array() , numberRows_+1, fp ))
-      return 1;
-    if (CoinToFile(elementL_.array(),lengthAreaL_ , fp ))
-      return 1;
-    if (CoinToFile(indexRowL_.array(),lengthAreaL_ , fp ))
-      return 1;
-    if (CoinToFile(startColumnL_.array(),numberRows_ + 1 , fp ))
-      return 1;
-    if (CoinToFile(markRow_.array(),numberRows_  , fp))
-      return 1;
-    if (CoinToFile(saveColumn_.array(),numberColumns_  , fp))
-      return 1;
-    if (CoinToFile(startColumnR_.array() , maximumPivots_ + 1 , fp ))
-      return 1;
-    if (CoinToFile(startRowU_.array(),maximumRowsExtra_ + 1 , fp ))
-      return 1;
-    if (CoinToFile(numberInRow_.array(),maximumRowsExtra_ + 1 , fp ))
-      return 1;
-    if (CoinToFile(nextRow_.array(),maximumRowsExtra_ + 1 , fp ))
-      return 1;
-    if (CoinToFile(lastRow_.array(),maximumRowsExtra_ + 1 , fp ))
-      return 1;
-    if (CoinToFile(pivotRegion_.array(),maximumRowsExtra_ + 1 , fp ))
-      return 1;
-    if (CoinToFile(permuteBack_.array(),maximumRowsExtra_ + 1 , fp ))
-      return 1;
-    if (CoinToFile(permute_.array(),maximumRowsExtra_ + 1 , fp ))
-      return 1;
-    if (CoinToFile(pivotColumnBack_.array(),maximumRowsExtra_ + 1 , fp ))
-      return 1;
-    if (CoinToFile(startColumnU_.array(),maximumColumnsExtra_ + 1 , fp ))
-      return 1;
-    if (CoinToFile(numberInColumn_.array(),maximumColumnsExtra_ + 1 , fp ))
-      return 1;
-    if (CoinToFile(numberInColumnPlus_.array(),maximumColumnsExtra_ + 1 , fp ))
-      return 1;
-    if (CoinToFile(firstCount_.array(),biggerDimension_ + 2 , fp ))
-      return 1;
-    if (CoinToFile(nextCount_.array(),numberRows_ + numberColumns_ , fp ))
-      return 1;
-    if (CoinToFile(lastCount_.array(),numberRows_ + numberColumns_ , fp ))
-      return 1;
-    if (CoinToFile(pivotRowL_.array(),numberRows_ + 1 , fp ))
-      return 1;
-    if (CoinToFile(pivotColumn_.array(),maximumColumnsExtra_ + 1 , fp ))
-      return 1;
-    if (CoinToFile(nextColumn_.array(),maximumColumnsExtra_ + 1 , fp ))
-      return 1;
-    if (CoinToFile(lastColumn_.array(),maximumColumnsExtra_ + 1 , fp ))
-      return 1;
-    if (CoinToFile(denseArea_ , numberDense_*numberDense_, fp ))
-      return 1;
-    if (CoinToFile(densePermute_ , numberDense_, fp ))
-      return 1;
-    fclose(fp);
+  memset(&header,0,sizeof(header));
+  memcpy(header.magic,coinCheckpointMagic,8);
+  header.version = COIN_CHECKPOINT_VERSION;
+  header.endianCheck = 0x01020304;
+  header.sizeofBigIndex = CoinSizeofAsInt(CoinBigIndex);
+  header.sizeofFactorizationDouble = CoinSizeofAsInt(CoinFactorizationDouble);
+  header.numberIntScalars = COIN_CHECKPOINT_INTS;
+  header.numberDoubleScalars = COIN_CHECKPOINT_DOUBLES;
+  header.numberSections = numberSections;
+  CoinInt64 position = sizeof(header) + 
+    COIN_CHECKPOINT_INTS*sizeof(CoinInt64) +
+    COIN_CHECKPOINT_DOUBLES*sizeof(double) + 
+    numberSections*sizeof(CoinFactorizationCheckpointSection);
+  for (int i=0;i<numberSections;i++) {
+    position = (position+COIN_CHECKPOINT_ALIGN-1) & 
+      ~static_cast<CoinInt64>(COIN_CHECKPOINT_ALIGN-1);
+    table[i].offset = position;
+    table[i].count = counts[i];
+    table[i].size = sizes[i];
+    table[i].spare = 0;
+    position += counts[i]*static_cast<CoinInt64>(sizes[i]);
   }
+  return position;
+}
+// Checks header - 0 okay, 2 not compatible
+static int 
+coinCheckpointCheck(const CoinFactorizationCheckpointHeader & header,
+		    int numberSections)
+{
+  if (memcmp(header.magic,coinCheckpointMagic,8)||
+      header.version>COIN_CHECKPOINT_VERSION||
+      header.endianCheck!=0x01020304||
+      header.sizeofBigIndex!=CoinSizeofAsInt(CoinBigIndex)||
+      header.sizeofFactorizationDouble!=
+      CoinSizeofAsInt(CoinFactorizationDouble)||
+      header.numberIntScalars!=COIN_CHECKPOINT_INTS||
+      header.numberDoubleScalars!=COIN_CHECKPOINT_DOUBLES||
+      header.numberSections!=numberSections)
+    return 2;
   return 0;
 }
-// Debug - restore from file
+// Chunked write as CoinFileOutput works in ints
+static bool
+coinCheckpointWrite(CoinFileOutput * output, const void * data, 
+		    CoinInt64 numberBytes)
+{
+  const char * put = reinterpret_cast<const char *>(data);
+  while (numberBytes>0) {
+    int nThis = static_cast<int>(CoinMin(numberBytes,
+					 static_cast<CoinInt64>(1<<30)));
+    if (output->write(put,nThis)!=nThis)
+      return false;
+    put += nThis;
+    numberBytes -= nThis;
+  }
+  return true;
+}
+// Chunked read
+static bool
+coinCheckpointRead(CoinFileInput * input, void * data, 
+		    CoinInt64 numberBytes)
+{
+  char * put = reinterpret_cast<char *>(data);
+  while (numberBytes>0) {
+    int nThis = static_cast<int>(CoinMin(numberBytes,
+					 static_cast<CoinInt64>(1<<30)));
+    if (input->read(put,nThis)!=nThis)
+      return false;
+    put += nThis;
+    numberBytes -= nThis;
+  }
+  return true;
+}
+template <class T> static inline void 
+coinCheckpointScalar(T & value, CoinInt64 * values, int & n, bool save)
+{
+  if (save)
+    values[n] = static_cast<CoinInt64>(value);
+  else
+    value = static_cast<T>(values[n]);
+  n++;
+}
+template <class T> static inline void 
+coinCheckpointScalar(T & value, double * values, int & n, bool save)
+{
+  if (save)
+    values[n] = static_cast<double>(value);
+  else
+    value = static_cast<T>(values[n]);
+  n++;
+}
+// Gets (or sets if save false) scalars for checkpoint
+void 
+CoinFactorization::checkpointScalars(CoinInt64 * intValues, 
+				     double * doubleValues, bool save)
+{
+  int n=0;
+  coinCheckpointScalar(numberRows_,intValues,n,save);
+  coinCheckpointScalar(numberRowsExtra_,intValues,n,save);
+  coinCheckpointScalar(maximumRowsExtra_,intValues,n,save);
+  coinCheckpointScalar(numberColumns_,intValues,n,save);
+  coinCheckpointScalar(numberColumnsExtra_,intValues,n,save);
+  coinCheckpointScalar(maximumColumnsExtra_,intValues,n,save);
+  coinCheckpointScalar(numberGoodU_,intValues,n,save);
+  coinCheckpointScalar(numberGoodL_,intValues,n,save);
+  coinCheckpointScalar(maximumPivots_,intValues,n,save);
+  coinCheckpointScalar(numberPivots_,intValues,n,save);
+  coinCheckpointScalar(totalElements_,intValues,n,save);
+  coinCheckpointScalar(factorElements_,intValues,n,save);
+  coinCheckpointScalar(status_,intValues,n,save);
+  coinCheckpointScalar(numberTrials_,intValues,n,save);
+  coinCheckpointScalar(messageLevel_,intValues,n,save);
+  coinCheckpointScalar(biggerDimension_,intValues,n,save);
+  coinCheckpointScalar(numberSlacks_,intValues,n,save);
+  coinCheckpointScalar(numberU_,intValues,n,save);
+  coinCheckpointScalar(maximumU_,intValues,n,save);
+  coinCheckpointScalar(lengthU_,intValues,n,save);
+  coinCheckpointScalar(lengthAreaU_,intValues,n,save);
+  coinCheckpointScalar(numberL_,intValues,n,save);
+  coinCheckpointScalar(baseL_,intValues,n,save);
+  coinCheckpointScalar(lengthL_,intValues,n,save);
+  coinCheckpointScalar(lengthAreaL_,intValues,n,save);
+  coinCheckpointScalar(doForrestTomlin_,intValues,n,save);
+  coinCheckpointScalar(numberR_,intValues,n,save);
+  coinCheckpointScalar(lengthR_,intValues,n,save);
+  coinCheckpointScalar(lengthAreaR_,intValues,n,save);
+  coinCheckpointScalar(numberDense_,intValues,n,save);
+  coinCheckpointScalar(denseThreshold_,intValues,n,save);
+  coinCheckpointScalar(numberCompressions_,intValues,n,save);
+  coinCheckpointScalar(sparseThreshold_,intValues,n,save);
+  coinCheckpointScalar(sparseThreshold2_,intValues,n,save);
+  coinCheckpointScalar(biasLU_,intValues,n,save);
+  coinCheckpointScalar(numberFtranCounts_,intValues,n,save);
+  coinCheckpointScalar(numberBtranCounts_,intValues,n,save);
+  assert (n==COIN_CHECKPOINT_INTS);
+  n=0;
+  coinCheckpointScalar(pivotTolerance_,doubleValues,n,save);
+  coinCheckpointScalar(zeroTolerance_,doubleValues,n,save);
+#ifndef COIN_FAST_CODE
+  coinCheckpointScalar(slackValue_,doubleValues,n,save);
+#else
+  if (save)
+    doubleValues[n]=slackValue_;
+  n++;
+#endif
+  coinCheckpointScalar(areaFactor_,doubleValues,n,save);
+  coinCheckpointScalar(relaxCheck_,doubleValues,n,save);
+  coinCheckpointScalar(ftranCountInput_,doubleValues,n,save);
+  coinCheckpointScalar(ftranCountAfterL_,doubleValues,n,save);
+  coinCheckpointScalar(ftranCountAfterR_,doubleValues,n,save);
+  coinCheckpointScalar(ftranCountAfterU_,doubleValues,n,save);
+  coinCheckpointScalar(btranCountInput_,doubleValues,n,save);
+  coinCheckpointScalar(btranCountAfterU_,doubleValues,n,save);
+  coinCheckpointScalar(btranCountAfterR_,doubleValues,n,save);
+  coinCheckpointScalar(btranCountAfterL_,doubleValues,n,save);
+  coinCheckpointScalar(ftranAverageAfterL_,doubleValues,n,save);
+  coinCheckpointScalar(ftranAverageAfterR_,doubleValues,n,save);
+  coinCheckpointScalar(ftranAverageAfterU_,doubleValues,n,save);
+  coinCheckpointScalar(btranAverageAfterU_,doubleValues,n,save);
+  coinCheckpointScalar(btranAverageAfterR_,doubleValues,n,save);
+  coinCheckpointScalar(btranAverageAfterL_,doubleValues,n,save);
+  assert (n==COIN_CHECKPOINT_DOUBLES);
+}
+/* Fills in arrays and counts of items for checkpoint sections.
+   Dense area and permutation are always last two (with NULL arrays) */
+int 
+CoinFactorization::checkpointSections(CoinArrayWithLength ** arrays, 
+				      int * sizes,
+				      CoinBigIndex * counts,
+				      bool allocatedOnly) const
+{
+  CoinFactorization * self = const_cast<CoinFactorization *>(this);
+  int n=0;
+#define COIN_CHECKPOINT_SECTION(member,type,number) \
+  arrays[n]=&self->member; sizes[n]=CoinSizeofAsInt(type); \
+  counts[n]=(member.array()||!allocatedOnly) ? (number) : 0; n++
+  // U
+  COIN_CHECKPOINT_SECTION(elementU_,CoinFactorizationDouble,lengthAreaU_);
+  COIN_CHECKPOINT_SECTION(indexRowU_,int,lengthAreaU_);
+  COIN_CHECKPOINT_SECTION(indexColumnU_,int,lengthAreaU_);
+  COIN_CHECKPOINT_SECTION(convertRowToColumnU_,CoinBigIndex,lengthAreaU_);
+  COIN_CHECKPOINT_SECTION(startColumnU_,CoinBigIndex,maximumColumnsExtra_+1);
+  COIN_CHECKPOINT_SECTION(numberInColumn_,int,maximumColumnsExtra_+1);
+  COIN_CHECKPOINT_SECTION(numberInColumnPlus_,int,maximumColumnsExtra_+1);
+  COIN_CHECKPOINT_SECTION(startRowU_,CoinBigIndex,maximumRowsExtra_+1);
+  COIN_CHECKPOINT_SECTION(numberInRow_,int,maximumRowsExtra_+1);
+  // L (R lives at end of L area)
+  COIN_CHECKPOINT_SECTION(elementL_,CoinFactorizationDouble,lengthAreaL_);
+  COIN_CHECKPOINT_SECTION(indexRowL_,int,lengthAreaL_);
+  COIN_CHECKPOINT_SECTION(startColumnL_,CoinBigIndex,numberRows_+1);
+  COIN_CHECKPOINT_SECTION(elementByRowL_,CoinFactorizationDouble,lengthAreaL_);
+  COIN_CHECKPOINT_SECTION(indexColumnL_,int,lengthAreaL_);
+  COIN_CHECKPOINT_SECTION(startRowL_,CoinBigIndex,numberRows_+1);
+  COIN_CHECKPOINT_SECTION(startColumnR_,CoinBigIndex,maximumPivots_+1+
+			  ((numberInColumnPlus_.array()||!allocatedOnly) ? 
+			   maximumColumnsExtra_+1 : 0));
+  // Permutations etc
+  COIN_CHECKPOINT_SECTION(pivotRegion_,CoinFactorizationDouble,maximumRowsExtra_+1);
+  COIN_CHECKPOINT_SECTION(permute_,int,maximumRowsExtra_+1);
+  COIN_CHECKPOINT_SECTION(permuteBack_,int,maximumRowsExtra_+1);
+  COIN_CHECKPOINT_SECTION(pivotColumnBack_,int,maximumRowsExtra_+1);
+  COIN_CHECKPOINT_SECTION(pivotColumn_,int,maximumColumnsExtra_+1);
+  COIN_CHECKPOINT_SECTION(nextColumn_,int,maximumColumnsExtra_+1);
+  COIN_CHECKPOINT_SECTION(lastColumn_,int,maximumColumnsExtra_+1);
+  COIN_CHECKPOINT_SECTION(nextRow_,int,maximumRowsExtra_+1);
+  COIN_CHECKPOINT_SECTION(lastRow_,int,maximumRowsExtra_+1);
+  // as in getAreas so a restored factorization can be refactorized
+  COIN_CHECKPOINT_SECTION(firstCount_,int,(numberRows_+numberColumns_) ?
+			  CoinMax(biggerDimension_+2,maximumRowsExtra_+1) : 2);
+  COIN_CHECKPOINT_SECTION(nextCount_,int,numberRows_+numberColumns_);
+  COIN_CHECKPOINT_SECTION(lastCount_,int,numberRows_+numberColumns_);
+  COIN_CHECKPOINT_SECTION(markRow_,int,numberRows_);
+  COIN_CHECKPOINT_SECTION(saveColumn_,int,numberColumns_);
+  COIN_CHECKPOINT_SECTION(pivotRowL_,int,numberRows_+1);
+#undef COIN_CHECKPOINT_SECTION
+  // Dense part
+  arrays[n]=NULL; sizes[n]=CoinSizeofAsInt(double);
+  counts[n]=(denseArea_||!allocatedOnly) ? numberDense_*numberDense_ : 0; n++;
+  arrays[n]=NULL; sizes[n]=CoinSizeofAsInt(int);
+  counts[n]=(densePermute_||!allocatedOnly) ? numberDense_ : 0; n++;
+  assert (n<=COIN_CHECKPOINT_MAX_SECTIONS);
+  return n;
+}
+/* Items of each section in use.  U (sections 0-3) goes as far as any
+   column or row of U (or next free position), L area (9-10) holds L then
+   R and row copy of L (12-13) just L.  Rest of those areas is only
+   space for updates so is not saved. */
+void
+CoinFactorization::checkpointUsed(int numberSections,
+				  const CoinBigIndex * counts,
+				  CoinBigIndex * used) const
+{
+  for (int i=0;i<numberSections;i++)
+    used[i] = counts[i];
+  const CoinBigIndex * startColumnU = startColumnU_.array();
+  const int * numberInColumn = numberInColumn_.array();
+  if (counts[0]&&startColumnU&&numberInColumn) {
+    CoinBigIndex last = CoinMax(maximumU_,
+				startColumnU[maximumColumnsExtra_]);
+    int n = CoinMin(numberRowsExtra_,maximumColumnsExtra_+1);
+    for (int i=0;i<n;i++) 
+      last = CoinMax(last,startColumnU[i]+numberInColumn[i]);
+    used[0] = CoinMin(last,counts[0]);
+    used[1] = CoinMin(last,counts[1]);
+  }
+  const CoinBigIndex * startRowU = startRowU_.array();
+  const int * numberInRow = numberInRow_.array();
+  if (counts[2]&&startRowU&&numberInRow) {
+    CoinBigIndex last = startRowU[maximumRowsExtra_];
+    for (int i=0;i<numberRowsExtra_;i++) 
+      last = CoinMax(last,startRowU[i]+numberInRow[i]);
+    used[2] = CoinMin(last,counts[2]);
+    used[3] = CoinMin(last,counts[3]);
+  }
+  for (int i=9;i<11;i++)
+    used[i] = CoinMin(static_cast<CoinBigIndex>(lengthL_+lengthR_),counts[i]);
+  for (int i=12;i<14;i++)
+    used[i] = CoinMin(static_cast<CoinBigIndex>(lengthL_),counts[i]);
+}
+/* Checks a checkpoint being restored.  Before arrays are read
+   (loaded false) that scalars are as saved and consistent and that
+   sections fit arrays; after, that sections are exactly what
+   saveFactorization would write. */
+bool
+CoinFactorization::checkpointValid(const CoinInt64 * intValues,
+				   const CoinInt64 * fileCounts,
+				   int numberSections, bool loaded)
+{
+  CoinArrayWithLength * arrays[COIN_CHECKPOINT_MAX_SECTIONS];
+  int sizes[COIN_CHECKPOINT_MAX_SECTIONS];
+  CoinBigIndex counts[COIN_CHECKPOINT_MAX_SECTIONS];
+  if (loaded) {
+    CoinBigIndex used[COIN_CHECKPOINT_MAX_SECTIONS];
+    checkpointSections(arrays,sizes,counts);
+    checkpointUsed(numberSections,counts,used);
+    for (int i=0;i<numberSections;i++) {
+      if (fileCounts[i]!=used[i])
+	return false;
+    }
+    return true;
+  }
+  // anything which does not fit in an int has been truncated
+  CoinInt64 saved[COIN_CHECKPOINT_INTS];
+  double doubleValues[COIN_CHECKPOINT_DOUBLES];
+  checkpointScalars(saved,doubleValues,true);
+  if (memcmp(saved,intValues,sizeof(saved)))
+    return false;
+  if (numberRows_<0||numberRowsExtra_<numberRows_||
+      maximumRowsExtra_<numberRowsExtra_||
+      numberColumns_<0||numberColumnsExtra_<numberColumns_||
+      maximumColumnsExtra_<numberColumnsExtra_||maximumPivots_<0||
+      lengthL_<0||lengthR_<0||
+      static_cast<CoinInt64>(lengthL_)+lengthR_>lengthAreaL_||
+      maximumU_<0||maximumU_>lengthAreaU_||
+      numberDense_<0||numberDense_>numberRows_)
+    return false;
+  // all arrays as big as they could be
+  checkpointSections(arrays,sizes,counts,false);
+  for (int i=0;i<numberSections;i++) {
+    CoinInt64 capacity = counts[i];
+    if (numberDense_&&i==numberSections-2)
+      capacity = static_cast<CoinInt64>(numberDense_)*numberDense_;
+    if (capacity<0||capacity*sizes[i]>COIN_INT_MAX||
+	fileCounts[i]<0||fileCounts[i]>capacity)
+      return false;
+  }
+  return true;
+}
+// Adds memory usage to report
+void
+CoinFactorization::memoryUsage(CoinMemoryUsage & usage) const
+{
+  // Same order as checkpointSections
+  static const char * names[] = {
+    "elementU","indexRowU","indexColumnU","convertRowToColumnU",
+    "startColumnU","numberInColumn","numberInColumnPlus","startRowU",
+    "numberInRow","elementL","indexRowL","startColumnL","elementByRowL",
+    "indexColumnL","startRowL","startColumnR","pivotRegion","permute",
+    "permuteBack","pivotColumnBack","pivotColumn","nextColumn","lastColumn",
+    "nextRow","lastRow","firstCount","nextCount","lastCount","markRow",
+    "saveColumn","pivotRowL","denseArea","densePermute"};
+  CoinArrayWithLength * arrays[COIN_CHECKPOINT_MAX_SECTIONS];
+  int sizes[COIN_CHECKPOINT_MAX_SECTIONS];
+  CoinBigIndex counts[COIN_CHECKPOINT_MAX_SECTIONS];
+  int numberSections = checkpointSections(arrays,sizes,counts);
+  assert (numberSections==CoinSizeofAsInt(names)/CoinSizeofAsInt(names[0]));
+  for (int i=0;i<numberSections;i++) {
+    CoinBigIndex used = counts[i];
+    if (used) {
+      if (i<4)
+	used = lengthU_; // U area
+      else if (i==9||i==10)
+	used = lengthL_+lengthR_; // L area with R at end
+      else if (i==12||i==13)
+	used = lengthL_;
+    }
+    usage.addArray(names[i],used,counts[i],sizes[i]);
+  }
+  // persistent work arrays
+  if (workArea_.switchedOn())
+    usage.add("workArea",workArea_.capacity(),workArea_.capacity());
+  if (workArea2_.switchedOn())
+    usage.add("workArea2",workArea2_.capacity(),workArea2_.capacity());
+  if (sparse_.switchedOn())
+    usage.add("sparse",sparse_.capacity(),sparse_.capacity());
+}
+// Save checkpoint on file
+int
+CoinFactorization::saveFactorization (const char * file, int compression ) const
+{
+  CoinFileOutput::Compression compress = CoinFileOutput::COMPRESS_NONE;
+  if (compression==1)
+    compress = CoinFileOutput::COMPRESS_GZIP;
+  else if (compression==2)
+    compress = CoinFileOutput::COMPRESS_BZIP2;
+  if (!CoinFileOutput::compressionSupported(compress))
+    return 1;
+  CoinFileOutput * output = NULL;
+  try {
+    output = CoinFileOutput::create(file,compress);
+  }
+  catch (CoinError & ) {
+    return 1;
+  }
+  CoinArrayWithLength * arrays[COIN_CHECKPOINT_MAX_SECTIONS];
+  int sizes[COIN_CHECKPOINT_MAX_SECTIONS];
+  CoinBigIndex counts[COIN_CHECKPOINT_MAX_SECTIONS];
+  int numberSections = checkpointSections(arrays,sizes,counts);
+  // only write what is in use
+  CoinBigIndex used[COIN_CHECKPOINT_MAX_SECTIONS];
+  checkpointUsed(numberSections,counts,used);
+  CoinFactorizationCheckpointHeader header;
+  CoinFactorizationCheckpointSection table[COIN_CHECKPOINT_MAX_SECTIONS];
+  coinCheckpointLayout(header,table,numberSections,sizes,used);
+  CoinInt64 intValues[COIN_CHECKPOINT_INTS];
+  double doubleValues[COIN_CHECKPOINT_DOUBLES];
+  const_cast<CoinFactorization *>(this)->checkpointScalars(intValues,
+							   doubleValues,true);
+  bool ok = coinCheckpointWrite(output,&header,sizeof(header)) &&
+    coinCheckpointWrite(output,intValues,sizeof(intValues)) &&
+    coinCheckpointWrite(output,doubleValues,sizeof(doubleValues)) &&
+    coinCheckpointWrite(output,table,
+			numberSections*sizeof(CoinFactorizationCheckpointSection));
+  CoinInt64 position = sizeof(header) + sizeof(intValues) + 
+    sizeof(doubleValues) + 
+    numberSections*sizeof(CoinFactorizationCheckpointSection);
+  char padding[COIN_CHECKPOINT_ALIGN];
+  memset(padding,0,COIN_CHECKPOINT_ALIGN);
+  for (int i=0;i<numberSections&&ok;i++) {
+    ok = coinCheckpointWrite(output,padding,table[i].offset-position);
+    const void * data;
+    if (arrays[i])
+      data = arrays[i]->array();
+    else if (i==numberSections-2)
+      data = denseArea_;
+    else
+      data = densePermute_;
+    CoinInt64 numberBytes = table[i].count*table[i].size;
+    if (ok && numberBytes)
+      ok = coinCheckpointWrite(output,data,numberBytes);
+    position = table[i].offset+numberBytes;
+  }
+  delete output;
+  return ok ? 0 : 1;
+}
+// Sets up what is needed for solves after restoring checkpoint
+static void 
+coinCheckpointSparse(CoinIntArrayWithLength & sparse, int maximumRowsExtra)
+{
+  // allow for stack, list, next and char map of mark
+  int nRowIndex = (maximumRowsExtra+CoinSizeofAsInt(int)-1)/
+    CoinSizeofAsInt(char);
+  int nInBig = static_cast<int>(sizeof(CoinBigIndex)/sizeof(int));
+  sparse.conditionalNew( (2+nInBig)*maximumRowsExtra + nRowIndex );
+  // zero out mark
+  memset(sparse.array()+(2+nInBig)*maximumRowsExtra,
+         0,maximumRowsExtra*sizeof(char));
+}
+// Restore checkpoint from file
 int 
 CoinFactorization::restoreFactorization (const char * file , bool factorIt ) 
 {
-  FILE * fp = fopen(file,"rb");
-  if (fp) {
-    // Get rid of current
+  CoinFileInput * input = NULL;
+  try {
+    input = CoinFileInput::create(file);
+  }
+  catch (CoinError & ) {
+    return 1;
+  }
+  // Get rid of current
+  gutsOfDestructor();
+  CoinFactorizationCheckpointHeader header;
+  CoinInt64 intValues[COIN_CHECKPOINT_INTS];
+  double doubleValues[COIN_CHECKPOINT_DOUBLES];
+  CoinArrayWithLength * arrays[COIN_CHECKPOINT_MAX_SECTIONS];
+  int sizes[COIN_CHECKPOINT_MAX_SECTIONS];
+  CoinBigIndex counts[COIN_CHECKPOINT_MAX_SECTIONS];
+  int numberSections = checkpointSections(arrays,sizes,counts);
+  if (!coinCheckpointRead(input,&header,sizeof(header))) {
+    delete input;
+    return 1;
+  }
+  if (coinCheckpointCheck(header,numberSections)) {
+    delete input;
+    return 2;
+  }
+  CoinFactorizationCheckpointSection table[COIN_CHECKPOINT_MAX_SECTIONS];
+  CoinInt64 fileCounts[COIN_CHECKPOINT_MAX_SECTIONS];
+  bool ok = coinCheckpointRead(input,intValues,sizeof(intValues)) &&
+    coinCheckpointRead(input,doubleValues,sizeof(doubleValues)) &&
+    coinCheckpointRead(input,table,
+			numberSections*sizeof(CoinFactorizationCheckpointSection));
+  if (ok) {
+    checkpointScalars(intValues,doubleValues,false);
+    for (int i=0;i<numberSections;i++)
+      fileCounts[i] = table[i].count;
+    ok = checkpointValid(intValues,fileCounts,numberSections,false);
+    // space for updates as well as what was saved
+    if (ok)
+      checkpointSections(arrays,sizes,counts,false);
+  }
+  CoinInt64 position = sizeof(header) + sizeof(intValues) + 
+    sizeof(doubleValues) + 
+    numberSections*sizeof(CoinFactorizationCheckpointSection);
+  char padding[COIN_CHECKPOINT_ALIGN];
+  for (int i=0;i<numberSections&&ok;i++) {
+    if (table[i].size!=sizes[i]||table[i].offset<position||
+	table[i].offset-position>=COIN_CHECKPOINT_ALIGN) {
+      ok=false;
+      break;
+    }
+    ok = coinCheckpointRead(input,padding,table[i].offset-position);
+    CoinInt64 numberBytes = table[i].count*table[i].size;
+    if (ok && numberBytes) {
+      void * data;
+      if (arrays[i]) {
+	CoinInt64 capacity = static_cast<CoinInt64>(counts[i])*sizes[i];
+	data = arrays[i]->conditionalNew(static_cast<long>(capacity));
+      } else if (i==numberSections-2) {
+	denseArea_ = new double [table[i].count];
+	data = denseArea_;
+      } else {
+	densePermute_ = new int [table[i].count];
+	data = densePermute_;
+      }
+      ok = coinCheckpointRead(input,data,numberBytes);
+    }
+    position = table[i].offset+numberBytes;
+  }
+  delete input;
+  if (ok)
+    ok = checkpointValid(intValues,fileCounts,numberSections,true);
+  if (!ok) {
     gutsOfDestructor();
-    CoinBigIndex newSize=0; // for checking - should be same
-    // Restore so we can pick up scalars
-    char * first = reinterpret_cast<char *> ( &pivotTolerance_);
-    char * last = reinterpret_cast<char *> ( &biasLU_);
-    // increment
-    last += sizeof(int);
-    if (fread(first,last-first,1,fp)!=1)
-      return 1;
-    CoinBigIndex space = lengthAreaL_ - lengthL_;
-    // Now arrays
-    CoinFactorizationDouble *elementU = elementU_.array();
-    if (CoinFromFile(elementU,lengthAreaU_ , fp, newSize )==1)
-      return 1;
-    assert (newSize==lengthAreaU_);
-    int * indexRowU = indexRowU_.array();
-    if (CoinFromFile(indexRowU,lengthAreaU_ , fp, newSize )==1)
-      return 1;
-    assert (newSize==lengthAreaU_);
-    int * indexColumnU = indexColumnU_.array();
-    if (CoinFromFile(indexColumnU,lengthAreaU_ , fp, newSize )==1)
-      return 1;
-    assert (newSize==lengthAreaU_);
-    CoinBigIndex *convertRowToColumnU = convertRowToColumnU_.array();
-    if (CoinFromFile(convertRowToColumnU,lengthAreaU_ , fp, newSize )==1)
-      return 1;
-    assert (newSize==lengthAreaU_||(newSize==0&&!convertRowToColumnU_.array()));
-    CoinFactorizationDouble * elementByRowL = elementByRowL_.array();
-    if (CoinFromFile(elementByRowL,lengthAreaL_ , fp, newSize )==1)
-      return 1;
-    assert (newSize==lengthAreaL_||(newSize==0&&!elementByRowL_.array()));
-    int * indexColumnL = indexColumnL_.array();
-    if (CoinFromFile(indexColumnL,lengthAreaL_ , fp, newSize )==1)
-      return 1;
-    assert (newSize==lengthAreaL_||(newSize==0&&!indexColumnL_.array()));
-    CoinBigIndex * startRowL = startRowL_.array();
-    if (CoinFromFile(startRowL , numberRows_+1, fp, newSize )==1)
-      return 1;
-    assert (newSize==numberRows_+1||(newSize==0&&!startRowL_.array()));
-    CoinFactorizationDouble * elementL = elementL_.array();
-    if (CoinFromFile(elementL,lengthAreaL_ , fp, newSize )==1)
-      return 1;
-    assert (newSize==lengthAreaL_);
-    int * indexRowL = indexRowL_.array();
-    if (CoinFromFile(indexRowL,lengthAreaL_ , fp, newSize )==1)
-      return 1;
-    assert (newSize==lengthAreaL_);
-    CoinBigIndex * startColumnL = startColumnL_.array();
-    if (CoinFromFile(startColumnL,numberRows_ + 1 , fp, newSize )==1)
-      return 1;
-    assert (newSize==numberRows_+1);
-    int * markRow = markRow_.array();
-    if (CoinFromFile(markRow,numberRows_  , fp, newSize )==1)
-      return 1;
-    assert (newSize==numberRows_);
-    int * saveColumn = saveColumn_.array();
-    if (CoinFromFile(saveColumn,numberColumns_  , fp, newSize )==1)
-      return 1;
-    assert (newSize==numberColumns_);
-    CoinBigIndex * startColumnR = startColumnR_.array();
-    if (CoinFromFile(startColumnR , maximumPivots_ + 1 , fp, newSize )==1)
-      return 1;
-    assert (newSize==maximumPivots_+1||(newSize==0&&!startColumnR_.array()));
-    CoinBigIndex * startRowU = startRowU_.array();
-    if (CoinFromFile(startRowU,maximumRowsExtra_ + 1 , fp, newSize )==1)
-      return 1;
-    assert (newSize==maximumRowsExtra_+1||(newSize==0&&!startRowU_.array()));
-    int * numberInRow = numberInRow_.array();
-    if (CoinFromFile(numberInRow,maximumRowsExtra_ + 1 , fp, newSize )==1)
-      return 1;
-    assert (newSize==maximumRowsExtra_+1);
-    int * nextRow = nextRow_.array();
-    if (CoinFromFile(nextRow,maximumRowsExtra_ + 1 , fp, newSize )==1)
-      return 1;
-    assert (newSize==maximumRowsExtra_+1);
-    int * lastRow = lastRow_.array();
-    if (CoinFromFile(lastRow,maximumRowsExtra_ + 1 , fp, newSize )==1)
-      return 1;
-    assert (newSize==maximumRowsExtra_+1);
-    CoinFactorizationDouble * pivotRegion = pivotRegion_.array();
-    if (CoinFromFile(pivotRegion,maximumRowsExtra_ + 1 , fp, newSize )==1)
-      return 1;
-    assert (newSize==maximumRowsExtra_+1);
-    int * permuteBack = permuteBack_.array();
-    if (CoinFromFile(permuteBack,maximumRowsExtra_ + 1 , fp, newSize )==1)
-      return 1;
-    assert (newSize==maximumRowsExtra_+1||(newSize==0&&!permuteBack_.array()));
-    int * permute = permute_.array();
-    if (CoinFromFile(permute,maximumRowsExtra_ + 1 , fp, newSize )==1)
-      return 1;
-    assert (newSize==maximumRowsExtra_+1||(newSize==0&&!permute_.array()));
-    int * pivotColumnBack = pivotColumnBack_.array();
-    if (CoinFromFile(pivotColumnBack,maximumRowsExtra_ + 1 , fp, newSize )==1)
-      return 1;
-    assert (newSize==maximumRowsExtra_+1||(newSize==0&&!pivotColumnBack_.array()));
-    CoinBigIndex * startColumnU = startColumnU_.array();
-    if (CoinFromFile(startColumnU,maximumColumnsExtra_ + 1 , fp, newSize )==1)
-      return 1;
-    assert (newSize==maximumColumnsExtra_+1);
-    int * numberInColumn = numberInColumn_.array();
-    if (CoinFromFile(numberInColumn,maximumColumnsExtra_ + 1 , fp, newSize )==1)
-      return 1;
-    assert (newSize==maximumColumnsExtra_+1);
-    int * numberInColumnPlus = numberInColumnPlus_.array();
-    if (CoinFromFile(numberInColumnPlus,maximumColumnsExtra_ + 1 , fp, newSize )==1)
-      return 1;
-    assert (newSize==maximumColumnsExtra_+1);
-    int *firstCount = firstCount_.array();
-    if (CoinFromFile(firstCount,biggerDimension_ + 2 , fp, newSize )==1)
-      return 1;
-    assert (newSize==biggerDimension_+2);
-    int *nextCount = nextCount_.array();
-    if (CoinFromFile(nextCount,numberRows_ + numberColumns_ , fp, newSize )==1)
-      return 1;
-    assert (newSize==numberRows_+numberColumns_);
-    int *lastCount = lastCount_.array();
-    if (CoinFromFile(lastCount,numberRows_ + numberColumns_ , fp, newSize )==1)
-      return 1;
-    assert (newSize==numberRows_+numberColumns_);
-    int * pivotRowL = pivotRowL_.array();
-    if (CoinFromFile(pivotRowL,numberRows_ + 1 , fp, newSize )==1)
-      return 1;
-    assert (newSize==numberRows_+1);
-    int * pivotColumn = pivotColumn_.array(); 
-    if (CoinFromFile(pivotColumn,maximumColumnsExtra_ + 1 , fp, newSize )==1)
-      return 1;
-    assert (newSize==maximumColumnsExtra_+1);
-    int * nextColumn = nextColumn_.array();
-    if (CoinFromFile(nextColumn,maximumColumnsExtra_ + 1 , fp, newSize )==1)
-      return 1;
-    assert (newSize==maximumColumnsExtra_+1);
-    int * lastColumn = lastColumn_.array();
-    if (CoinFromFile(lastColumn,maximumColumnsExtra_ + 1 , fp, newSize )==1)
-      return 1;
-    assert (newSize==maximumColumnsExtra_+1);
-    if (CoinFromFile(denseArea_ , numberDense_*numberDense_, fp, newSize )==1)
-      return 1;
-    assert (newSize==numberDense_*numberDense_);
-    if (CoinFromFile(densePermute_ , numberDense_, fp, newSize )==1)
-      return 1;
-    assert (newSize==numberDense_);
-    lengthAreaR_ = space;
-    elementR_ = elementL_.array() + lengthL_;
-    indexRowR_ = indexRowL_.array() + lengthL_;
-    fclose(fp);
-    if (factorIt) {
-      if (biasLU_>=3||numberRows_!=numberColumns_)
-        preProcess ( 2 );
-      else
-        preProcess ( 3 ); // no row copy
-      factor (  );
+    return 1;
+  }
+  elementR_ = elementL_.array() + lengthL_;
+  indexRowR_ = indexRowL_.array() + lengthL_;
+  if (sparseThreshold_)
+    coinCheckpointSparse(sparse_,maximumRowsExtra_);
+  if (factorIt) {
+    if (biasLU_>=3||numberRows_!=numberColumns_)
+      preProcess ( 2 );
+    else
+      preProcess ( 3 ); // no row copy
+    factor (  );
+  }
+  return 0;
+}
+// Restore uncompressed checkpoint by mapping file
+int 
+CoinFactorization::mapFactorization (const char * file) 
+{
+#ifndef _MSC_VER
+  int fd = open(file,O_RDONLY);
+  if (fd<0)
+    return 1;
+  struct stat fileStat;
+  if (fstat(fd,&fileStat)||
+      fileStat.st_size<static_cast<off_t>(sizeof(CoinFactorizationCheckpointHeader))) {
+    close(fd);
+    return 1;
+  }
+  size_t fileSize = static_cast<size_t>(fileStat.st_size);
+  // read only - anything which modifies factorization copies first
+  void * map = mmap(NULL,fileSize,PROT_READ,MAP_PRIVATE,fd,0);
+  close(fd);
+  if (map==MAP_FAILED)
+    return 1;
+  char * base = reinterpret_cast<char *>(map);
+  CoinArrayWithLength * arrays[COIN_CHECKPOINT_MAX_SECTIONS];
+  int sizes[COIN_CHECKPOINT_MAX_SECTIONS];
+  CoinBigIndex counts[COIN_CHECKPOINT_MAX_SECTIONS];
+  int numberSections = checkpointSections(arrays,sizes,counts);
+  const CoinFactorizationCheckpointHeader * header =
+    reinterpret_cast<const CoinFactorizationCheckpointHeader *>(base);
+  if (memcmp(header->magic,coinCheckpointMagic,8)) {
+    munmap(map,fileSize);
+    // may be compressed
+    return 3;
+  }
+  if (coinCheckpointCheck(*header,numberSections)) {
+    munmap(map,fileSize);
+    return 2;
+  }
+  size_t position = sizeof(CoinFactorizationCheckpointHeader);
+  CoinInt64 * intValues = reinterpret_cast<CoinInt64 *>(base+position);
+  position += COIN_CHECKPOINT_INTS*sizeof(CoinInt64);
+  double * doubleValues = reinterpret_cast<double *>(base+position);
+  position += COIN_CHECKPOINT_DOUBLES*sizeof(double);
+  const CoinFactorizationCheckpointSection * table =
+    reinterpret_cast<const CoinFactorizationCheckpointSection *>(base+position);
+  position += numberSections*sizeof(CoinFactorizationCheckpointSection);
+  bool ok = position<=fileSize;
+  CoinInt64 fileCounts[COIN_CHECKPOINT_MAX_SECTIONS];
+  for (int i=0;i<numberSections&&ok;i++) {
+    fileCounts[i] = table[i].count;
+    if (table[i].size!=sizes[i]||table[i].offset<0||table[i].count<0||
+	(table[i].offset&(COIN_CHECKPOINT_ALIGN-1))||
+	table[i].count>static_cast<CoinInt64>(fileSize)||
+	static_cast<size_t>(table[i].offset+table[i].count*table[i].size)
+	>fileSize)
+      ok=false;
+  }
+  if (!ok) {
+    munmap(map,fileSize);
+    return 1;
+  }
+  // Get rid of current
+  gutsOfDestructor();
+  checkpointScalars(intValues,doubleValues,false);
+  if (!checkpointValid(intValues,fileCounts,numberSections,false)) {
+    munmap(map,fileSize);
+    gutsOfDestructor();
+    return 1;
+  }
+  for (int i=0;i<numberSections;i++) {
+    if (!table[i].count)
+      continue;
+    char * data = base+table[i].offset;
+    CoinInt64 numberBytes = table[i].count*table[i].size;
+    if (arrays[i]) {
+      arrays[i]->borrowArray(data,static_cast<int>(numberBytes));
+    } else if (i==numberSections-2) {
+      // dense part is small so just copy
+      denseArea_ = CoinCopyOfArray(reinterpret_cast<double *>(data),
+				   static_cast<int>(table[i].count));
+    } else {
+      densePermute_ = CoinCopyOfArray(reinterpret_cast<int *>(data),
+				      static_cast<int>(table[i].count));
     }
   }
+  checkpointMap_ = map;
+  checkpointMapSize_ = fileSize;
+  if (!checkpointValid(intValues,fileCounts,numberSections,true)) {
+    // drops mapping
+    gutsOfDestructor();
+    return 1;
+  }
+  elementR_ = elementL_.array() + lengthL_;
+  indexRowR_ = indexRowL_.array() + lengthL_;
+  if (sparseThreshold_)
+    coinCheckpointSparse(sparse_,maximumRowsExtra_);
   return 0;
+#else
+  return 3;
+#endif
+}
+// Unmap checkpoint
+void 
+CoinFactorization::unmapFactorization(bool keepArrays)
+{
+  if (!checkpointMap_)
+    return;
+  CoinArrayWithLength * arrays[COIN_CHECKPOINT_MAX_SECTIONS];
+  int sizes[COIN_CHECKPOINT_MAX_SECTIONS];
+  CoinBigIndex counts[COIN_CHECKPOINT_MAX_SECTIONS];
+  int numberSections = checkpointSections(arrays,sizes,counts);
+  // only used part is in file - rest is space for updates
+  CoinBigIndex used[COIN_CHECKPOINT_MAX_SECTIONS];
+  checkpointUsed(numberSections,counts,used);
+  for (int i=0;i<numberSections;i++) {
+    if (arrays[i]&&arrays[i]->borrowed()) {
+      const char * data = arrays[i]->array();
+      CoinInt64 numberBytes = static_cast<CoinInt64>(used[i])*sizes[i];
+      CoinInt64 capacity = static_cast<CoinInt64>(counts[i])*sizes[i];
+      arrays[i]->returnArray();
+      if (keepArrays&&data&&numberBytes) {
+	char * newData = 
+	  arrays[i]->conditionalNew(static_cast<long>(capacity));
+	CoinMemcpyN(data,static_cast<int>(numberBytes),newData);
+      }
+    }
+  }
+  if (keepArrays) {
+    elementR_ = elementL_.array() + lengthL_;
+    indexRowR_ = indexRowL_.array() + lengthL_;
+  }
+#ifndef _MSC_VER
+  munmap(checkpointMap_,checkpointMapSize_);
+#endif
+  checkpointMap_ = NULL;
+  checkpointMapSize_ = 0;
 }
 //  factorSparse.  Does sparse phase of factorization
 //return code is <0 error, 0= finished
@@ -540,6 +540,9 @@ CoinFactorization::updateTwoColumnsFT ( CoinIndexedVector * regionSparse1,
 					CoinIndexedVector * regionSparse3,
 					bool noPermuteRegion3)
 {
+  // mapped checkpoint is read only
+  if (checkpointMap_)
+    unmapFactorization(true);
 #if 1
   //#ifdef NDEBUG
   //#undef NDEBUG
@@ -2021,6 +2024,9 @@ CoinFactorization::updateColumnRFT ( CoinIndexedVector * regionSparse,
 int CoinFactorization::updateColumnFT ( CoinIndexedVector * regionSparse,
 					CoinIndexedVector * regionSparse2)
 {
+  // mapped checkpoint is read only
+  if (checkpointMap_)
+    unmapFactorization(true);
   //permute and move indices into index array
   int * COIN_RESTRICT regionIndex = regionSparse->getIndices (  );
   int numberNonZero = regionSparse2->getNumElements();
@@ -235,6 +235,9 @@ CoinFactorization::replaceColumn ( CoinIndexedVector * regionSparse,
 				   bool checkBeforeModifying,
 				   double )
 {
+  // mapped checkpoint is read only
+  if (checkpointMap_)
+    unmapFactorization(true);
   assert (numberU_<=numberRowsExtra_);
   CoinBigIndex * COIN_RESTRICT startColumnU = startColumnU_.array();
   CoinBigIndex * COIN_RESTRICT startColumn;
@@ -2037,6 +2040,9 @@ CoinFactorization::replaceRow ( int whichRow, int iNumberInRow,
 {
   if (!iNumberInRow)
     return 0;
+  // mapped checkpoint is read only
+  if (checkpointMap_)
+    unmapFactorization(true);
   int next = nextRow_.array()[whichRow];
   int * numberInRow = numberInRow_.array();
 #ifndef NDEBUG
@@ -2326,6 +2332,9 @@ CoinFactorization::replaceColumnPFI ( CoinIndexedVector * regionSparse,
 				      int pivotRow,
 				      double alpha)
 {
+  // mapped checkpoint is read only
+  if (checkpointMap_)
+    unmapFactorization(true);
   CoinBigIndex *startColumn=startColumnU_.array()+numberRows_;
   int *indexRow=indexRowU_.array();
   CoinFactorizationDouble *element=elementU_.array();
@@ -0,0 +1,411 @@
+/* $Id$ */
+// Copyright (C) 2012, International Business Machines
+// Corporation and others.  All Rights Reserved.
+// This code is licensed under the terms of the Eclipse Public License (EPL).
+
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+
+#include "CoinFingerprint.hpp"
+#include "CoinPackedMatrix.hpp"
+#include "CoinMpsIO.hpp"
+#include "CoinModel.hpp"
+#include "CoinHelperFunctions.hpp"
+#include "CoinFinite.hpp"
+#include "CoinThreadPool.hpp"
+
+// Fewest items worth using threads for
+#define COIN_FINGERPRINT_PARALLEL 100000
+
+// Starting value of each of the four words
+static const unsigned int coinFingerprintSeed[4] =
+  {0x9e3779b9u, 0x7f4a7c15u, 0x85ebca6bu, 0xc2b2ae35u};
+
+// Adds k into hash h (a MurmurHash3 step)
+static inline unsigned int
+coinHashMix(unsigned int h, unsigned int k)
+{
+  k *= 0xcc9e2d51u;
+  k = (k << 15) | (k >> 17);
+  k *= 0x1b873593u;
+  h ^= k;
+  h = (h << 13) | (h >> 19);
+  return h * 5 + 0xe6546b64u;
+}
+
+// Mixes all bits of h (MurmurHash3 finalizer)
+static inline unsigned int
+coinHashFinal(unsigned int h)
+{
+  h ^= h >> 16;
+  h *= 0x85ebca6bu;
+  h ^= h >> 13;
+  h *= 0xc2b2ae35u;
+  h ^= h >> 16;
+  return h;
+}
+
+//#############################################################################
+// Bits of a value rounded to a number of significant bits
+
+class CoinFingerprintValue {
+public:
+  CoinFingerprintValue(int valueBits)
+    : splitter_(valueBits < 53 ? ldexp(1.0, 53 - valueBits) + 1.0 : 0.0)
+  {
+    // which word has sign and exponent
+    const double one = 1.0;
+    unsigned int word[2];
+    memcpy(word, &one, sizeof(word));
+    high_ = word[0] ? 0 : 1;
+  }
+  /// Low and high words of value (-0.0 as 0.0, all NaNs the same)
+  inline void split(double value, unsigned int & low,
+		    unsigned int & high) const
+  {
+    if (value != value) {
+      low = 0;
+      high = 0x7ff80000u;
+      return;
+    }
+    if (!value) {
+      value = 0.0;
+    } else if (splitter_ && fabs(value) < 1.0e300) {
+      // Veltkamp split leaves value rounded to valueBits bits
+      const double big = value * splitter_;
+      value = big - (big - value);
+    }
+    unsigned int word[2];
+    memcpy(word, &value, sizeof(word));
+    low = word[1 - high_];
+    high = word[high_];
+  }
+private:
+  double splitter_;
+  int high_;
+};
+
+//#############################################################################
+// Adds up hashes of a share of the items
+
+class CoinFingerprintTask : public CoinThreadTask {
+public:
+  /// 0 matrix, 1 CoinModel triples, 2 array
+  int mode_;
+  int numberPieces_;
+  /// Major vectors, triples or array items
+  CoinBigIndex number_;
+  const CoinPackedMatrix * matrix_;
+  const CoinModelTriple * triples_;
+  const double * array_;
+  const int * integer_;
+  const char * marks_;
+  /// Which array
+  unsigned int kind_;
+  const CoinFingerprintValue * value_;
+  /// Four words for structure and four for values for each piece
+  unsigned int * sums_;
+  virtual void run(int which)
+  {
+    const CoinBigIndex first = static_cast<CoinBigIndex>
+      ((static_cast<CoinInt64>(number_) * which) / numberPieces_);
+    const CoinBigIndex last = static_cast<CoinBigIndex>
+      ((static_cast<CoinInt64>(number_) * (which + 1)) / numberPieces_);
+    unsigned int sum[8];
+    CoinZeroN(sum, 8);
+    unsigned int low;
+    unsigned int high;
+    switch (mode_) {
+    case 0:
+      {
+	const CoinBigIndex * start = matrix_->getVectorStarts();
+	const CoinInt64 * wideStart = matrix_->getWideVectorStarts();
+	const int * length = matrix_->getVectorLengths();
+	const int * index = matrix_->getIndices();
+	const double * element = matrix_->getElements();
+	const bool colOrdered = matrix_->isColOrdered();
+	for (CoinBigIndex i = first; i < last; ++i) {
+	  const CoinInt64 begin = wideStart ? wideStart[i] : start[i];
+	  const CoinInt64 end = begin + length[i];
+	  for (CoinInt64 j = begin; j < end; ++j) {
+	    value_->split(element[j], low, high);
+	    if (colOrdered)
+	      addElement(index[j], static_cast<int>(i), low, high, sum);
+	    else
+	      addElement(static_cast<int>(i), index[j], low, high, sum);
+	  }
+	}
+      }
+      break;
+    case 1:
+      for (CoinBigIndex i = first; i < last; ++i) {
+	const CoinModelTriple & triple = triples_[i];
+	if (triple.column < 0)
+	  continue;
+	if (stringInTriple(triple)) {
+	  // string number in a pattern no value has
+	  low = static_cast<unsigned int>(triple.value);
+	  high = 0xfff80001u;
+	} else {
+	  value_->split(triple.value, low, high);
+	}
+	addElement(rowInTriple(triple), triple.column, low, high, sum);
+      }
+      break;
+    case 2:
+      for (CoinBigIndex i = first; i < last; ++i) {
+	double value;
+	if (array_) {
+	  value = array_[i];
+	  if (value >= 1.0e30)
+	    value = COIN_DBL_MAX;
+	  else if (value <= -1.0e30)
+	    value = -COIN_DBL_MAX;
+	} else {
+	  if (integer_ ? !integer_[i] : !marks_[i])
+	    continue;
+	  value = 1.0;
+	}
+	value_->split(value, low, high);
+	for (int k = 0; k < 4; ++k) {
+	  unsigned int h = coinHashMix(coinFingerprintSeed[k], kind_);
+	  h = coinHashMix(h, static_cast<unsigned int>(i));
+	  h = coinHashMix(h, low);
+	  h = coinHashMix(h, high);
+	  sum[k] += coinHashFinal(h ^ 16u);
+	}
+      }
+      break;
+    }
+    CoinMemcpyN(sum, 8, sums_ + 8 * which);
+  }
+private:
+  /// Adds hashes of position and of position and value
+  static inline void addElement(int row, int column, unsigned int low,
+				unsigned int high, unsigned int * sum)
+  {
+    for (int k = 0; k < 4; ++k) {
+      unsigned int h = coinHashMix(coinFingerprintSeed[k],
+				   static_cast<unsigned int>(row));
+      h = coinHashMix(h, static_cast<unsigned int>(column));
+      sum[k] += coinHashFinal(h ^ 8u);
+      h = coinHashMix(h, low);
+      h = coinHashMix(h, high);
+      sum[4+k] += coinHashFinal(h ^ 16u);
+    }
+  }
+};
+
+// Runs task (in pieces on threads if worth it) and adds into sum
+static void
+coinFingerprintRun(CoinFingerprintTask & task, CoinBigIndex numberItems,
+		   unsigned int * sum)
+{
+  CoinThreadPool * pool =
+    CoinThreadPool::defaultPoolFor(numberItems, COIN_FINGERPRINT_PARALLEL);
+  const bool parallel = pool != NULL;
+  // a few pieces for each thread (adding up does not depend on pieces)
+  task.numberPieces_ = parallel ?
+    static_cast<int>(CoinMin(static_cast<CoinBigIndex>(4 * pool->numberThreads()),
+			     task.number_ + 1)) : 1;
+  task.sums_ = new unsigned int [8 * task.numberPieces_];
+  if (parallel)
+    pool->run(task, task.numberPieces_);
+  else
+    task.run(0);
+  for (int i = 0; i < task.numberPieces_; ++i) {
+    for (int k = 0; k < 8; ++k)
+      sum[k] += task.sums_[8 * i + k];
+  }
+  delete [] task.sums_;
+  task.sums_ = NULL;
+}
+
+//#############################################################################
+
+CoinFingerprint::CoinFingerprint()
+  : valueBits_(53)
+{
+  memset(sum_, 0, sizeof(sum_));
+  memset(value_, 0, sizeof(value_));
+}
+
+CoinFingerprint::CoinFingerprint(const CoinPackedMatrix & matrix,
+				 int valueBits)
+  : valueBits_(CoinMax(1, CoinMin(53, valueBits)))
+{
+  memset(sum_, 0, sizeof(sum_));
+  addMatrix(matrix);
+  finish(matrix.getNumRows(), matrix.getNumCols(), false);
+}
+
+CoinFingerprint::CoinFingerprint(const CoinMpsIO & model, int valueBits)
+  : valueBits_(CoinMax(1, CoinMin(53, valueBits)))
+{
+  memset(sum_, 0, sizeof(sum_));
+  const int numberRows = model.getNumRows();
+  const int numberColumns = model.getNumCols();
+  const CoinPackedMatrix * matrix = model.getMatrixByCol();
+  if (matrix)
+    addMatrix(*matrix);
+  addArray(columnData, 0, numberColumns, model.getColLower());
+  addArray(columnData, 1, numberColumns, model.getColUpper());
+  addArray(columnData, 2, numberColumns, model.getObjCoefficients());
+  addArray(columnData, 3, numberColumns, NULL, NULL, model.integerColumns());
+  const double offset = model.objectiveOffset();
+  addArray(columnData, 4, 1, &offset);
+  addArray(rowData, 0, numberRows, model.getRowLower());
+  addArray(rowData, 1, numberRows, model.getRowUpper());
+  finish(numberRows, numberColumns, true);
+}
+
+CoinFingerprint::CoinFingerprint(const CoinModel & model, int valueBits)
+  : valueBits_(CoinMax(1, CoinMin(53, valueBits)))
+{
+  memset(sum_, 0, sizeof(sum_));
+  const int numberRows = model.numberRows();
+  const int numberColumns = model.numberColumns();
+  addModel(model);
+  addArray(columnData, 0, numberColumns, model.columnLowerArray());
+  addArray(columnData, 1, numberColumns, model.columnUpperArray());
+  addArray(columnData, 2, numberColumns, model.objectiveArray());
+  addArray(columnData, 3, numberColumns, NULL, model.integerTypeArray());
+  const double offset = model.objectiveOffset();
+  addArray(columnData, 4, 1, &offset);
+  addArray(rowData, 0, numberRows, model.rowLowerArray());
+  addArray(rowData, 1, numberRows, model.rowUpperArray());
+  finish(numberRows, numberColumns, true);
+}
+
+//#############################################################################
+
+void
+CoinFingerprint::addMatrix(const CoinPackedMatrix & matrix)
+{
+  const CoinFingerprintValue value(valueBits_);
+  CoinFingerprintTask task;
+  task.mode_ = 0;
+  task.number_ = matrix.getMajorDim();
+  task.matrix_ = &matrix;
+  task.value_ = &value;
+  unsigned int sum[8];
+  CoinZeroN(sum, 8);
+  coinFingerprintRun(task, matrix.getNumElements(), sum);
+  for (int k = 0; k < 4; ++k) {
+    sum_[matrixStructure][k] += sum[k];
+    sum_[matrixValues][k] += sum[4+k];
+  }
+}
+
+void
+CoinFingerprint::addModel(const CoinModel & model)
+{
+  if (model.packedMatrix()) {
+    addMatrix(*model.packedMatrix());
+    return;
+  }
+  const CoinFingerprintValue value(valueBits_);
+  CoinFingerprintTask task;
+  task.mode_ = 1;
+  task.number_ = model.numberElements();
+  task.triples_ = model.elements();
+  task.value_ = &value;
+  if (!task.triples_)
+    return;
+  unsigned int sum[8];
+  CoinZeroN(sum, 8);
+  coinFingerprintRun(task, task.number_, sum);
+  for (int k = 0; k < 4; ++k) {
+    sum_[matrixStructure][k] += sum[k];
+    sum_[matrixValues][k] += sum[4+k];
+  }
+}
+
+void
+CoinFingerprint::addArray(Part part, int kind, int number,
+			  const double * array, const int * integer,
+			  const char * marks)
+{
+  if (number <= 0 || (!array && !integer && !marks))
+    return;
+  const CoinFingerprintValue value(valueBits_);
+  CoinFingerprintTask task;
+  task.mode_ = 2;
+  task.number_ = number;
+  task.array_ = array;
+  task.integer_ = integer;
+  task.marks_ = marks;
+  task.kind_ = 0x80000000u | static_cast<unsigned int>(kind);
+  task.value_ = &value;
+  unsigned int sum[8];
+  CoinZeroN(sum, 8);
+  coinFingerprintRun(task, number, sum);
+  for (int k = 0; k < 4; ++k)
+    sum_[part][k] += sum[k];
+}
+
+void
+CoinFingerprint::finish(int numberRows, int numberColumns, bool problem)
+{
+  for (int part = 0; part < numberParts; ++part) {
+    for (int k = 0; k < 4; ++k) {
+      if (!problem && part >= columnData) {
+	value_[part][k] = 0;
+	continue;
+      }
+      unsigned int h = coinHashMix(coinFingerprintSeed[k], sum_[part][k]);
+      if (part != columnData)
+	h = coinHashMix(h, static_cast<unsigned int>(numberRows));
+      if (part != rowData)
+	h = coinHashMix(h, static_cast<unsigned int>(numberColumns));
+      value_[part][k] = coinHashFinal(h ^ static_cast<unsigned int>(part));
+    }
+  }
+  for (int k = 0; k < 4; ++k) {
+    unsigned int h = coinFingerprintSeed[k];
+    for (int part = 0; part < numberParts; ++part)
+      h = coinHashMix(h, value_[part][k]);
+    value_[numberParts][k] = coinHashFinal(h ^ 4u * numberParts);
+  }
+}
+
+//#############################################################################
+
+std::string
+CoinFingerprint::toString(int part) const
+{
+  char buffer[40];
+  sprintf(buffer, "%08x%08x%08x%08x", value_[part][3], value_[part][2],
+	  value_[part][1], value_[part][0]);
+  return std::string(buffer);
+}
+
+int
+CoinFingerprint::differences(const CoinFingerprint & rhs) const
+{
+  int mask = 0;
+  for (int part = 0; part < numberParts; ++part) {
+    if (memcmp(value_[part], rhs.value_[part], sizeof(value_[part])))
+      mask |= 1 << part;
+  }
+  return mask;
+}
+
+bool
+CoinFingerprint::operator==(const CoinFingerprint & rhs) const
+{
+  return !memcmp(value_, rhs.value_, sizeof(value_));
+}
+
+bool
+CoinFingerprint::operator<(const CoinFingerprint & rhs) const
+{
+  for (int part = numberParts; part >= 0; --part) {
+    for (int k = 3; k >= 0; --k) {
+      if (value_[part][k] != rhs.value_[part][k])
+	return value_[part][k] < rhs.value_[part][k];
+    }
+  }
+  return false;
+}
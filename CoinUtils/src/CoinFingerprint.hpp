@@ -0,0 +1,115 @@
+/* $Id$ */
+// Copyright (C) 2012, International Business Machines
+// Corporation and others.  All Rights Reserved.
+// This code is licensed under the terms of the Eclipse Public License (EPL).
+
+#ifndef CoinFingerprint_H
+#define CoinFingerprint_H
+
+#include <string>
+
+#include "CoinUtilsConfig.h"
+#include "CoinTypes.hpp"
+
+class CoinPackedMatrix;
+class CoinMpsIO;
+class CoinModel;
+
+/** 128 bit fingerprint of a CoinPackedMatrix or of a whole problem.
+
+    Meant as a key for caching work done on a problem (presolve, scaling,
+    factorizations) and for spotting problems seen before without keeping
+    them.  A fingerprint has parts so a near repeat (e.g. the same matrix
+    with new bounds) can be recognized:
+    - matrixStructure - dimensions and positions of elements
+    - matrixValues - dimensions, positions and values of elements
+    - columnData - column bounds, objective (with offset) and which
+      columns are integer
+    - rowData - row bounds
+
+    Each part adds up a hash of every item with its indices, so the order
+    of elements in the matrix, gaps and whether the matrix is row or
+    column ordered do not matter, the same problem held in a CoinMpsIO or
+    a CoinModel has the same fingerprint and the work can be shared
+    between threads (CoinThreadPool::defaultPool() is used for large
+    problems) without changing the answer.  Values may be rounded to
+    fewer significant bits first so tiny differences (e.g. from writing
+    and reading an MPS file) are ignored.  -0.0 is the same as 0.0 and
+    bounds of 1.0e30 or more are infinite.  Names are not included.
+
+    Fingerprints are not cryptographic - different problems have the
+    same fingerprint with a probability of about 2^-128 unless made to
+    collide on purpose.  They are the same on all platforms with 32 bit
+    unsigned int.
+*/
+class CoinFingerprint {
+public:
+  /// Parts of a fingerprint
+  enum Part {
+    matrixStructure = 0,
+    matrixValues,
+    columnData,
+    rowData,
+    /// Number of parts (also means whole fingerprint)
+    numberParts
+  };
+
+  /**@name Constructors */
+  //@{
+  /// All zero fingerprint
+  CoinFingerprint();
+  /** Fingerprint of matrix (columnData and rowData parts are zero).
+      Values are rounded to valueBits significant bits (1 to 53). */
+  explicit CoinFingerprint(const CoinPackedMatrix & matrix,
+			   int valueBits = 53);
+  /// Fingerprint of problem in CoinMpsIO
+  explicit CoinFingerprint(const CoinMpsIO & model, int valueBits = 53);
+  /** Fingerprint of problem in CoinModel.  Elements given as strings
+      are included by string number. */
+  explicit CoinFingerprint(const CoinModel & model, int valueBits = 53);
+  //@}
+
+  /**@name Queries */
+  //@{
+  /** 32 bit word (0 least significant to 3) of a part (numberParts for
+      whole fingerprint) */
+  inline unsigned int word(int which, int part = numberParts) const
+  { return value_[part][which]; }
+  /// Significant bits values were rounded to
+  inline int valueBits() const
+  { return valueBits_; }
+  /// Part (numberParts for whole fingerprint) as 32 hex digits
+  std::string toString(int part = numberParts) const;
+  /** Bit mask with bit (1<<part) set for each part which differs
+      (0 if fingerprints are the same) */
+  int differences(const CoinFingerprint & rhs) const;
+  /// True if all parts same
+  bool operator==(const CoinFingerprint & rhs) const;
+  inline bool operator!=(const CoinFingerprint & rhs) const
+  { return !(*this == rhs); }
+  /// Some order (e.g. for std::map keys)
+  bool operator<(const CoinFingerprint & rhs) const;
+  //@}
+
+private:
+  /// Adds in elements of matrix
+  void addMatrix(const CoinPackedMatrix & matrix);
+  /// Adds in elements of CoinModel (or of its packed matrix)
+  void addModel(const CoinModel & model);
+  /** Adds in items of column or row data (kind says which array).  If
+      array is NULL items are 1.0 for columns marked in integer or
+      marks. */
+  void addArray(Part part, int kind, int number, const double * array,
+		const int * integer = NULL, const char * marks = NULL);
+  /// Finishes parts and whole fingerprint from sums
+  void finish(int numberRows, int numberColumns, bool problem);
+
+  /// Significant bits of values
+  int valueBits_;
+  /// Sums of item hashes for each part
+  unsigned int sum_[numberParts][4];
+  /// Finished parts and then whole fingerprint
+  unsigned int value_[numberParts+1][4];
+};
+
+#endif
@@ -10,14 +10,25 @@
   
 #include <cassert>
 #include <cstdio>
+#include <utility>
 
 #include "CoinTypes.hpp"
 #include "CoinFloatEqual.hpp"
 #include "CoinHelperFunctions.hpp"
 #include "CoinIndexedVector.hpp"
+#include "CoinMemoryUsage.hpp"
+#include "CoinThreadPool.hpp"
+#include "CoinWorkPool.hpp"
+#include "CoinMemoryPolicy.hpp"
 #include "CoinTypes.hpp"
 //#############################################################################
 #define WARN_USELESS 0
+// With automatic representation go to bitmap above capacity/16 nonzeros
+#define COIN_INDEXED_BITMAP_SHIFT 4
+// and to dense above capacity/4
+#define COIN_INDEXED_DENSE_SHIFT 2
+// but not for short vectors
+#define COIN_INDEXED_HYBRID_MINIMUM 256
 void
 CoinIndexedVector::clear()
 {
@@ -37,7 +48,34 @@ CoinIndexedVector::clear()
     printf("Vector said it had %d nonzeros - but is already empty\n",
 	   nElements_);
 #endif
-  if (!packedMode_) {
+  int number = nElements_;
+  if (representation_==nonzeroBitmap) {
+    // zero by walking touched words
+    const unsigned int * bits = bitmap_;
+    const unsigned int * touched = bitmap_+2*bitmapWords_;
+    for (int k=0;k<numberTouched_;k++) {
+      int iWord = touched[k];
+      unsigned int word = bits[iWord];
+      double * elements = elements_+(iWord<<5);
+      for (int iBit=0;word;iBit++,word>>=1) {
+	if ((word&1)!=0)
+	  elements[iBit]=0.0;
+      }
+    }
+    // new generation makes all words invalid
+    startBitmap();
+    representation_=indexList;
+  } else if (representation_==pureDense) {
+    // count as well so density known
+    number=0;
+    for (int i=0;i<capacity_;i++) {
+      if (elements_[i]) {
+	elements_[i]=0.0;
+	number++;
+      }
+    }
+    representation_=indexList;
+  } else if (!packedMode_) {
     if (3*nElements_<capacity_) {
       int i=0;
       if ((nElements_&1)!=0) {
@@ -56,6 +94,16 @@ CoinIndexedVector::clear()
   } else {
     CoinZeroN(elements_,nElements_);
   }
+  if (autoRepresentation_) {
+    // guess for next time
+    if (number>(capacity_>>COIN_INDEXED_DENSE_SHIFT))
+      predicted_=pureDense;
+    else if (number>(capacity_>>COIN_INDEXED_BITMAP_SHIFT))
+      predicted_=nonzeroBitmap;
+    else
+      predicted_=indexList;
+    setSwitchAt();
+  }
   nElements_ = 0;
   packedMode_=false;
   //checkClear();
@@ -66,14 +114,239 @@ CoinIndexedVector::clear()
 void
 CoinIndexedVector::empty()
 {
-  delete [] indices_;
+  freeArrays();
   indices_=NULL;
-  if (elements_)
-    delete [] (elements_-offset_);
   elements_=NULL;
+  offset_=0;
   nElements_ = 0;
   capacity_=0;
   packedMode_=false;
+  delete [] bitmap_;
+  bitmap_=NULL;
+  bitmapWords_=0;
+  numberTouched_=0;
+  representation_=indexList;
+  setSwitchAt();
+}
+
+//#############################################################################
+
+// Deletes arrays or gives them back to work pool
+void
+CoinIndexedVector::freeArrays()
+{
+  if (offset_>=0) {
+    delete [] indices_;
+    if (elements_)
+      delete [] (elements_-offset_);
+  } else if (elements_) {
+    // came from pool - give back with elements zero
+    clear();
+    checkClear();
+    CoinWorkPool::release(reinterpret_cast<char *>(indices_),
+			  capacity_*CoinSizeofAsInt(int));
+    CoinWorkPool::release(reinterpret_cast<char *>(elements_),0);
+  }
+}
+
+//#############################################################################
+
+// Sets bit for index (bitmap is bits, stamps, touched words)
+static inline void
+coinMarkBitmap(unsigned int * bitmap, int numberWords, int & numberTouched,
+	       unsigned int generation, int index)
+{
+  int iWord = index>>5;
+  unsigned int * stamps = bitmap+numberWords;
+  if (stamps[iWord]!=generation) {
+    stamps[iWord]=generation;
+    bitmap[iWord]=0;
+    bitmap[2*numberWords+numberTouched++]=iWord;
+  }
+  bitmap[iWord] |= 1u<<(index&31);
+}
+
+void
+CoinIndexedVector::setRepresentation(int value)
+{
+  assert (!packedMode_||value==indexList);
+  if (value==representation_)
+    return;
+  // dense does not need list
+  if (representation_)
+    makeIndexList(value!=pureDense);
+  if (value==nonzeroBitmap) {
+    startBitmap();
+    for (int i=0;i<nElements_;i++) 
+      coinMarkBitmap(bitmap_,bitmapWords_,numberTouched_,generation_,
+		     indices_[i]);
+  }
+  representation_=value;
+  setSwitchAt();
+}
+
+void
+CoinIndexedVector::makeIndexList(bool rebuild)
+{
+  if (rebuild) {
+    if (representation_==nonzeroBitmap) {
+      // sort touched words so indices come out in order
+      const unsigned int * bits = bitmap_;
+      unsigned int * touched = bitmap_+2*bitmapWords_;
+      std::sort(touched,touched+numberTouched_);
+      int number=0;
+      for (int k=0;k<numberTouched_;k++) {
+	int iWord = touched[k];
+	unsigned int word = bits[iWord];
+	int base = iWord<<5;
+	for (int iBit=0;word;iBit++,word>>=1) {
+	  if ((word&1)!=0)
+	    indices_[number++]=base+iBit;
+	}
+      }
+      assert (number==nElements_);
+      nElements_=number;
+      // invalidate bitmap
+      if (++generation_==0) {
+	CoinZeroN(bitmap_+bitmapWords_,bitmapWords_);
+	generation_=1;
+      }
+      numberTouched_=0;
+    } else if (representation_==pureDense) {
+      int number=0;
+      for (int i=0;i<capacity_;i++) {
+	if (elements_[i])
+	  indices_[number++]=i;
+      }
+      nElements_=number;
+    }
+  } else if (representation_==nonzeroBitmap) {
+    // caller set up list - just invalidate bitmap
+    if (++generation_==0) {
+      CoinZeroN(bitmap_+bitmapWords_,bitmapWords_);
+      generation_=1;
+    }
+    numberTouched_=0;
+  }
+  representation_=indexList;
+  setSwitchAt();
+}
+
+void
+CoinIndexedVector::setAutoRepresentation(bool yesNo)
+{
+  autoRepresentation_=yesNo;
+  predicted_=indexList;
+  setSwitchAt();
+}
+
+void
+CoinIndexedVector::markNonZero(int index)
+{
+  if (representation_==nonzeroBitmap) {
+    coinMarkBitmap(bitmap_,bitmapWords_,numberTouched_,generation_,index);
+    nElements_++;
+    assert (nElements_<=capacity_);
+    if (nElements_>switchAt_)
+      switchRepresentation();
+  }
+}
+
+void
+CoinIndexedVector::switchRepresentation()
+{
+  if (packedMode_) {
+    switchAt_=COIN_INT_MAX;
+    return;
+  }
+  if (representation_==indexList)
+    setRepresentation(nonzeroBitmap);
+  else if (representation_==nonzeroBitmap)
+    setRepresentation(pureDense);
+}
+
+void
+CoinIndexedVector::setSwitchAt()
+{
+  if (!autoRepresentation_||representation_==pureDense||
+      capacity_<COIN_INDEXED_HYBRID_MINIMUM) {
+    switchAt_=COIN_INT_MAX;
+  } else if (representation_==indexList) {
+    // go straight on if last time was dense
+    switchAt_ = (predicted_==indexList) ? 
+      capacity_>>COIN_INDEXED_BITMAP_SHIFT : 0;
+  } else {
+    switchAt_ = (predicted_!=pureDense) ? 
+      capacity_>>COIN_INDEXED_DENSE_SHIFT : 0;
+  }
+}
+
+const int *
+CoinIndexedVector::listOfIndices(int & number, int *& work) const
+{
+  work=NULL;
+  if (representation_==indexList) {
+    number=nElements_;
+    return indices_;
+  }
+  work = new int [CoinMax(capacity_,1)];
+  number=0;
+  if (representation_==nonzeroBitmap) {
+    // valid words in order so indices come out sorted
+    const unsigned int * stamps = bitmap_+bitmapWords_;
+    for (int iWord=0;iWord<bitmapWords_;iWord++) {
+      if (stamps[iWord]==generation_) {
+	unsigned int word = bitmap_[iWord];
+	int base = iWord<<5;
+	for (int iBit=0;word;iBit++,word>>=1) {
+	  if ((word&1)!=0)
+	    work[number++]=base+iBit;
+	}
+      }
+    }
+  } else {
+    for (int i=0;i<capacity_;i++) {
+      if (elements_[i])
+	work[number++]=i;
+    }
+  }
+  return work;
+}
+
+int
+CoinIndexedVector::countNonZero() const
+{
+  int number=0;
+  for (int i=0;i<capacity_;i++) {
+    if (elements_[i])
+      number++;
+  }
+  return number;
+}
+
+void
+CoinIndexedVector::notIndexList(const char * method) const
+{
+  throw CoinError("not held as list of indices - use makeIndexList()",
+		  method,"CoinIndexedVector");
+}
+
+void
+CoinIndexedVector::startBitmap()
+{
+  int numberWords = (capacity_+31)>>5;
+  if (numberWords>bitmapWords_) {
+    delete [] bitmap_;
+    bitmapWords_=numberWords;
+    bitmap_ = new unsigned int [3*bitmapWords_];
+    CoinZeroN(bitmap_+bitmapWords_,bitmapWords_);
+    generation_=0;
+  }
+  if (++generation_==0) {
+    CoinZeroN(bitmap_+bitmapWords_,bitmapWords_);
+    generation_=1;
+  }
+  numberTouched_=0;
 }
 
 //#############################################################################
@@ -82,17 +355,49 @@ CoinIndexedVector &
 CoinIndexedVector::operator=(const CoinIndexedVector & rhs)
 {
   if (this != &rhs) {
+    int number;
+    int * work;
+    const int * indices = rhs.listOfIndices(number,work);
     clear();
     packedMode_=rhs.packedMode_;
     if (!packedMode_)
-      gutsOfSetVector(rhs.capacity_,rhs.nElements_, 
-		      rhs.indices_, rhs.elements_);
+      gutsOfSetVector(rhs.capacity_,number, 
+		      indices, rhs.elements_);
     else
-      gutsOfSetPackedVector(rhs.capacity_,rhs.nElements_, 
-		      rhs.indices_, rhs.elements_);
+      gutsOfSetPackedVector(rhs.capacity_,number, 
+		      indices, rhs.elements_);
+    delete [] work;
   }
   return *this;
 }
+#if __cplusplus >= 201103L
+CoinIndexedVector &
+CoinIndexedVector::operator=(CoinIndexedVector && rhs)
+{
+  if (this != &rhs)
+    gutsOfMove(rhs);
+  return *this;
+}
+#endif
+// Exchanges arrays and state with rhs
+void
+CoinIndexedVector::gutsOfMove(CoinIndexedVector & rhs)
+{
+  std::swap(indices_,rhs.indices_);
+  std::swap(elements_,rhs.elements_);
+  std::swap(nElements_,rhs.nElements_);
+  std::swap(capacity_,rhs.capacity_);
+  std::swap(offset_,rhs.offset_);
+  std::swap(packedMode_,rhs.packedMode_);
+  std::swap(autoRepresentation_,rhs.autoRepresentation_);
+  std::swap(representation_,rhs.representation_);
+  std::swap(predicted_,rhs.predicted_);
+  std::swap(switchAt_,rhs.switchAt_);
+  std::swap(bitmapWords_,rhs.bitmapWords_);
+  std::swap(numberTouched_,rhs.numberTouched_);
+  std::swap(generation_,rhs.generation_);
+  std::swap(bitmap_,rhs.bitmap_);
+}
 /* Copy the contents of one vector into another.  If multiplier is 1
    It is the equivalent of = but if vectors are same size does
    not re-allocate memory just clears and copies */
@@ -101,12 +406,15 @@ CoinIndexedVector::copy(const CoinIndexedVector & rhs, double multiplier)
 {
   if (capacity_==rhs.capacity_) {
     // can do fast
+    int number;
+    int * work;
+    const int * indices = rhs.listOfIndices(number,work);
     clear();
     packedMode_=rhs.packedMode_;
     nElements_=0;
     if (!packedMode_) {
-      for (int i=0;i<rhs.nElements_;i++) {
-        int index = rhs.indices_[i];
+      for (int i=0;i<number;i++) {
+        int index = indices[i];
         double value = rhs.elements_[index]*multiplier;
         if (fabs(value)<COIN_INDEXED_TINY_ELEMENT) 
           value = COIN_INDEXED_REALLY_TINY_ELEMENT;
@@ -114,8 +422,8 @@ CoinIndexedVector::copy(const CoinIndexedVector & rhs, double multiplier)
         indices_[nElements_++]=index;
       }
     } else {
-      for (int i=0;i<rhs.nElements_;i++) {
-        int index = rhs.indices_[i];
+      for (int i=0;i<number;i++) {
+        int index = indices[i];
         double value = rhs.elements_[i]*multiplier;
         if (fabs(value)<COIN_INDEXED_TINY_ELEMENT) 
           value = COIN_INDEXED_REALLY_TINY_ELEMENT;
@@ -123,6 +431,7 @@ CoinIndexedVector::copy(const CoinIndexedVector & rhs, double multiplier)
         indices_[nElements_++]=index;
       }
     }
+    delete [] work;
   } else {
     // do as two operations
     *this = rhs;
@@ -161,6 +470,7 @@ CoinIndexedVector::borrowVector(int size, int numberIndices, int* inds, double*
 void
 CoinIndexedVector::returnVector()
 {
+  representation_=indexList;
   indices_=NULL;
   elements_=NULL;
   nElements_ = 0;
@@ -240,6 +550,7 @@ CoinIndexedVector::operator[](int index) const
 void
 CoinIndexedVector::setElement(int index, double element)
 {
+  checkIndexed();
 #ifndef COIN_FAST_CODE
   if ( index >= nElements_ ) 
     throw CoinError("index >= size()", "setElement", "CoinIndexedVector");
@@ -264,7 +575,13 @@ CoinIndexedVector::insert( int index, double element )
   if (elements_[index])
     throw CoinError("Index already exists", "insert", "CoinIndexedVector");
 #endif
-  indices_[nElements_++] = index;
+  if (!representation_) {
+    indices_[nElements_++] = index;
+    if (nElements_>switchAt_)
+      switchRepresentation();
+  } else {
+    markNonZero(index);
+  }
   elements_[index] = element;
 }
 
@@ -287,10 +604,16 @@ CoinIndexedVector::add( int index, double element )
       elements_[index] = COIN_INDEXED_REALLY_TINY_ELEMENT;
     }
   } else if (fabs(element)>= COIN_INDEXED_TINY_ELEMENT) {
-    indices_[nElements_++] = index;
-    assert (nElements_<=capacity_);
+    if (!representation_) {
+      indices_[nElements_++] = index;
+      assert (nElements_<=capacity_);
+      if (nElements_>switchAt_)
+	switchRepresentation();
+    } else {
+      markNonZero(index);
+    }
     elements_[index] = element;
-   }
+  }
 }
 
 //#############################################################################
@@ -298,6 +621,7 @@ CoinIndexedVector::add( int index, double element )
 int
 CoinIndexedVector::clean( double tolerance )
 {
+  checkIndexed();
   int number = nElements_;
   int i;
   nElements_=0;
@@ -317,6 +641,7 @@ CoinIndexedVector::clean( double tolerance )
 // For debug check vector is clear i.e. no elements
 void CoinIndexedVector::checkClear()
 {
+  checkIndexed();
 #ifndef NDEBUG
   //printf("checkClear %p\n",this);
   assert(!nElements_);
@@ -358,6 +683,7 @@ void CoinIndexedVector::checkClear()
 // For debug check vector is clean i.e. elements match indices
 void CoinIndexedVector::checkClean()
 {
+  checkIndexed();
   //printf("checkClean %p\n",this);
   int i;
   if (packedMode_) {
@@ -391,6 +717,7 @@ void CoinIndexedVector::checkClean()
 void
 CoinIndexedVector::append(const CoinPackedVectorBase & caboose) 
 {
+  checkIndexed();
   const int cs = caboose.getNumElements();
   
   const int * cind = caboose.getIndices();
@@ -444,6 +771,7 @@ CoinIndexedVector::append(const CoinPackedVectorBase & caboose)
 void
 CoinIndexedVector::swap(int i, int j) 
 {
+  checkIndexed();
   if ( i >= nElements_ ) 
     throw CoinError("index i >= size()","swap","CoinIndexedVector");
   if ( i < 0 ) 
@@ -466,6 +794,7 @@ CoinIndexedVector::swap(int i, int j)
 void
 CoinIndexedVector::truncate( int n ) 
 {
+  checkIndexed();
   reserve(n);
 }
 
@@ -474,6 +803,7 @@ CoinIndexedVector::truncate( int n )
 void
 CoinIndexedVector::operator+=(double value) 
 {
+  checkIndexed();
   assert (!packedMode_);
   int i,indexValue;
   for (i=0;i<nElements_;i++) {
@@ -491,6 +821,7 @@ CoinIndexedVector::operator+=(double value)
 void
 CoinIndexedVector::operator-=(double value) 
 {
+  checkIndexed();
   assert (!packedMode_);
   int i,indexValue;
   for (i=0;i<nElements_;i++) {
@@ -508,6 +839,7 @@ CoinIndexedVector::operator-=(double value)
 void
 CoinIndexedVector::operator*=(double value) 
 {
+  checkIndexed();
   assert (!packedMode_);
   int i,indexValue;
   for (i=0;i<nElements_;i++) {
@@ -525,6 +857,7 @@ CoinIndexedVector::operator*=(double value)
 void
 CoinIndexedVector::operator/=(double value) 
 {
+  checkIndexed();
   assert (!packedMode_);
   int i,indexValue;
   for (i=0;i<nElements_;i++) {
@@ -538,9 +871,30 @@ CoinIndexedVector::operator/=(double value)
 }
 //#############################################################################
 
+void
+CoinIndexedVector::memoryUsage(CoinMemoryUsage & usage) const
+{
+  int nPlus = 0;
+  if (capacity_) {
+    // as in reserve
+    if (sizeof(int)==4*sizeof(char))
+      nPlus=(capacity_+3)>>2;
+    else
+      nPlus=(capacity_+7)>>4;
+  }
+  usage.addArray("indices",nElements_,capacity_+nPlus,
+		 static_cast<int>(sizeof(int)));
+  usage.addArray("elements",nElements_,capacity_ ? capacity_+9 : 0,
+		 static_cast<int>(sizeof(double)));
+  if (bitmap_)
+    usage.addArray("bitmap",3*numberTouched_,3*bitmapWords_,
+		   static_cast<int>(sizeof(unsigned int)));
+}
+
 void
 CoinIndexedVector::reserve(int n) 
 {
+  checkIndexed();
   int i;
   // don't make allocated space smaller but do take off values
   if ( n < capacity_ ) {
@@ -564,6 +918,7 @@ CoinIndexedVector::reserve(int n)
     int * tempIndices = indices_;
     double * tempElements = elements_;
     double * delTemp = elements_-offset_;
+    int tempOffset = offset_;
     
     // allocate new space
     int nPlus;
@@ -571,32 +926,50 @@ CoinIndexedVector::reserve(int n)
       nPlus=(n+3)>>2;
     else
       nPlus=(n+7)>>4;
-    indices_ = new int [n+nPlus];
-    CoinZeroN(indices_+n,nPlus);
-    // align on 64 byte boundary
-    double * temp = new double [n+9];
-    offset_ = 0;
-    CoinInt64 xx = reinterpret_cast<CoinInt64>(temp);
-    int iBottom = static_cast<int>(xx & 63);
-    //if (iBottom)
+    if (CoinWorkPool::active()) {
+      // zeroed (apart from start of indices) and aligned
+      CoinWorkPool * pool = CoinWorkPool::threadPool();
+      indices_ = reinterpret_cast<int *>
+	(pool->checkOut((n+nPlus)*CoinSizeofAsInt(int),n*CoinSizeofAsInt(int)));
+      elements_ = reinterpret_cast<double *>
+	(pool->checkOut(n*CoinSizeofAsInt(double)));
+      offset_ = -1;
+    } else {
+      indices_ = new int [n+nPlus];
+      CoinZeroN(indices_+n,nPlus);
+      // align on 64 byte boundary
+      double * temp = new double [n+9];
+      offset_ = 0;
+      CoinInt64 xx = reinterpret_cast<CoinInt64>(temp);
+      int iBottom = static_cast<int>(xx & 63);
+      //if (iBottom)
       offset_ = (64-iBottom)>>3;
-    elements_ = temp + offset_;;
+      elements_ = temp + offset_;;
+      if (nElements_ <= 0) 
+	CoinZeroN(elements_,n);
+      else
+	CoinZeroN(elements_+capacity_,n-capacity_);
+    }
     
     // copy data to new space
-    // and zero out part of array
     if (nElements_ > 0) {
       CoinMemcpyN(tempIndices, nElements_, indices_);
       CoinMemcpyN(tempElements, capacity_, elements_);
-      CoinZeroN(elements_+capacity_,n-capacity_);
-    } else {
-      CoinZeroN(elements_,n);
     }
-    capacity_ = n;
     
     // free old data
-    if (tempElements)
-      delete [] delTemp;
-    delete [] tempIndices;
+    if (tempOffset>=0) {
+      if (tempElements)
+	delete [] delTemp;
+      delete [] tempIndices;
+    } else if (tempElements) {
+      CoinWorkPool::release(reinterpret_cast<char *>(tempIndices),
+			    capacity_*CoinSizeofAsInt(int));
+      CoinWorkPool::release(reinterpret_cast<char *>(tempElements),
+			    capacity_*CoinSizeofAsInt(double));
+    }
+    capacity_ = n;
+    setSwitchAt();
   }
 }
 
@@ -608,7 +981,15 @@ elements_(NULL),
 nElements_(0),
 capacity_(0),
 offset_(0),
-packedMode_(false)
+packedMode_(false),
+autoRepresentation_(false),
+representation_(indexList),
+predicted_(indexList),
+switchAt_(COIN_INT_MAX),
+bitmapWords_(0),
+numberTouched_(0),
+generation_(0),
+bitmap_(NULL)
 {
 }
 
@@ -619,7 +1000,15 @@ elements_(NULL),
 nElements_(0),
 capacity_(0),
 offset_(0),
-packedMode_(false)
+packedMode_(false),
+autoRepresentation_(false),
+representation_(indexList),
+predicted_(indexList),
+switchAt_(COIN_INT_MAX),
+bitmapWords_(0),
+numberTouched_(0),
+generation_(0),
+bitmap_(NULL)
 {
   // Get space
   reserve(size);
@@ -634,7 +1023,15 @@ CoinIndexedVector::CoinIndexedVector(int size,
   nElements_(0),
   capacity_(0),
   offset_(0),
-  packedMode_(false)
+  packedMode_(false),
+  autoRepresentation_(false),
+  representation_(indexList),
+  predicted_(indexList),
+  switchAt_(COIN_INT_MAX),
+  bitmapWords_(0),
+  numberTouched_(0),
+  generation_(0),
+  bitmap_(NULL)
 {
   gutsOfSetVector(size, inds, elems);
 }
@@ -648,7 +1045,15 @@ elements_(NULL),
 nElements_(0),
 capacity_(0),
 offset_(0),
-packedMode_(false)
+packedMode_(false),
+autoRepresentation_(false),
+representation_(indexList),
+predicted_(indexList),
+switchAt_(COIN_INT_MAX),
+bitmapWords_(0),
+numberTouched_(0),
+generation_(0),
+bitmap_(NULL)
 {
 gutsOfSetConstant(size, inds, value);
 }
@@ -661,7 +1066,15 @@ elements_(NULL),
 nElements_(0),
 capacity_(0),
 offset_(0),
-packedMode_(false)
+packedMode_(false),
+autoRepresentation_(false),
+representation_(indexList),
+predicted_(indexList),
+switchAt_(COIN_INT_MAX),
+bitmapWords_(0),
+numberTouched_(0),
+generation_(0),
+bitmap_(NULL)
 {
   setFull(size, element);
 }
@@ -674,7 +1087,15 @@ elements_(NULL),
 nElements_(0),
 capacity_(0),
 offset_(0),
-packedMode_(false)
+packedMode_(false),
+autoRepresentation_(false),
+representation_(indexList),
+predicted_(indexList),
+switchAt_(COIN_INT_MAX),
+bitmapWords_(0),
+numberTouched_(0),
+generation_(0),
+bitmap_(NULL)
 {  
   gutsOfSetVector(rhs.getNumElements(), 
 			    rhs.getIndices(), rhs.getElements());
@@ -688,37 +1109,70 @@ elements_(NULL),
 nElements_(0),
 capacity_(0),
 offset_(0),
-packedMode_(false)
-{
+packedMode_(false),
+autoRepresentation_(false),
+representation_(indexList),
+predicted_(indexList),
+switchAt_(COIN_INT_MAX),
+bitmapWords_(0),
+numberTouched_(0),
+generation_(0),
+bitmap_(NULL)
+{
+  int number;
+  int * work;
+  const int * indices = rhs.listOfIndices(number,work);
   if (!rhs.packedMode_)
-    gutsOfSetVector(rhs.capacity_,rhs.nElements_, rhs.indices_, rhs.elements_);
+    gutsOfSetVector(rhs.capacity_,number, indices, rhs.elements_);
   else
-    gutsOfSetPackedVector(rhs.capacity_,rhs.nElements_, rhs.indices_, rhs.elements_);
+    gutsOfSetPackedVector(rhs.capacity_,number, indices, rhs.elements_);
+  delete [] work;
 }
 
 //-----------------------------------------------------------------------------
 
+#if __cplusplus >= 201103L
+CoinIndexedVector::CoinIndexedVector(CoinIndexedVector && rhs) noexcept :
+  CoinIndexedVector()
+{
+  gutsOfMove(rhs);
+}
+#endif
+
+//-----------------------------------------------------------------------------
+
 CoinIndexedVector::CoinIndexedVector(const CoinIndexedVector * rhs) :
 indices_(NULL),
 elements_(NULL),
 nElements_(0),
 capacity_(0),
 offset_(0),
-packedMode_(false)
+packedMode_(false),
+autoRepresentation_(false),
+representation_(indexList),
+predicted_(indexList),
+switchAt_(COIN_INT_MAX),
+bitmapWords_(0),
+numberTouched_(0),
+generation_(0),
+bitmap_(NULL)
 {  
+  int number;
+  int * work;
+  const int * indices = rhs->listOfIndices(number,work);
   if (!rhs->packedMode_)
-    gutsOfSetVector(rhs->capacity_,rhs->nElements_, rhs->indices_, rhs->elements_);
+    gutsOfSetVector(rhs->capacity_,number, indices, rhs->elements_);
   else
-    gutsOfSetPackedVector(rhs->capacity_,rhs->nElements_, rhs->indices_, rhs->elements_);
+    gutsOfSetPackedVector(rhs->capacity_,number, indices, rhs->elements_);
+  delete [] work;
 }
 
 //-----------------------------------------------------------------------------
 
 CoinIndexedVector::~CoinIndexedVector ()
 {
-  delete [] indices_;
-  if (elements_)
-    delete [] (elements_-offset_);
+  freeArrays();
+  delete [] bitmap_;
 }
 //#############################################################################
 //#############################################################################
@@ -728,6 +1182,10 @@ CoinIndexedVector
 CoinIndexedVector::operator+(
                             const CoinIndexedVector& op2)
 {
+  checkIndexed();
+  int numberOp2;
+  int * work;
+  const int * indicesOp2 = op2.listOfIndices(numberOp2,work);
   assert (!packedMode_);
   int i;
   int nElements=nElements_;
@@ -736,8 +1194,8 @@ CoinIndexedVector::operator+(
   newOne.reserve(capacity);
   bool needClean=false;
   // new one now can hold everything so just modify old and add new
-  for (i=0;i<op2.nElements_;i++) {
-    int indexValue=op2.indices_[i];
+  for (i=0;i<numberOp2;i++) {
+    int indexValue=indicesOp2[i];
     double value=op2.elements_[indexValue];
     double oldValue=elements_[indexValue];
     if (!oldValue) {
@@ -767,6 +1225,7 @@ CoinIndexedVector::operator+(
       }
     }
   }
+  delete [] work;
   return newOne;
 }
 
@@ -775,6 +1234,10 @@ CoinIndexedVector
 CoinIndexedVector::operator-(
                             const CoinIndexedVector& op2)
 {
+  checkIndexed();
+  int numberOp2;
+  int * work;
+  const int * indicesOp2 = op2.listOfIndices(numberOp2,work);
   assert (!packedMode_);
   int i;
   int nElements=nElements_;
@@ -783,8 +1246,8 @@ CoinIndexedVector::operator-(
   newOne.reserve(capacity);
   bool needClean=false;
   // new one now can hold everything so just modify old and add new
-  for (i=0;i<op2.nElements_;i++) {
-    int indexValue=op2.indices_[i];
+  for (i=0;i<numberOp2;i++) {
+    int indexValue=indicesOp2[i];
     double value=op2.elements_[indexValue];
     double oldValue=elements_[indexValue];
     if (!oldValue) {
@@ -814,6 +1277,7 @@ CoinIndexedVector::operator-(
       }
     }
   }
+  delete [] work;
   return newOne;
 }
 
@@ -822,6 +1286,10 @@ CoinIndexedVector
 CoinIndexedVector::operator*(
                             const CoinIndexedVector& op2)
 {
+  checkIndexed();
+  int numberOp2;
+  int * work;
+  const int * indicesOp2 = op2.listOfIndices(numberOp2,work);
   assert (!packedMode_);
   int i;
   int nElements=nElements_;
@@ -830,8 +1298,8 @@ CoinIndexedVector::operator*(
   newOne.reserve(capacity);
   bool needClean=false;
   // new one now can hold everything so just modify old and add new
-  for (i=0;i<op2.nElements_;i++) {
-    int indexValue=op2.indices_[i];
+  for (i=0;i<numberOp2;i++) {
+    int indexValue=indicesOp2[i];
     double value=op2.elements_[indexValue];
     double oldValue=elements_[indexValue];
     if (oldValue) {
@@ -858,6 +1326,7 @@ CoinIndexedVector::operator*(
       }
     }
   }
+  delete [] work;
   return newOne;
 }
 
@@ -865,6 +1334,10 @@ CoinIndexedVector::operator*(
 CoinIndexedVector 
 CoinIndexedVector::operator/ (const CoinIndexedVector& op2) 
 {
+  checkIndexed();
+  int numberOp2;
+  int * work;
+  const int * indicesOp2 = op2.listOfIndices(numberOp2,work);
   assert (!packedMode_);
   // I am treating 0.0/0.0 as 0.0
   int i;
@@ -874,8 +1347,8 @@ CoinIndexedVector::operator/ (const CoinIndexedVector& op2)
   newOne.reserve(capacity);
   bool needClean=false;
   // new one now can hold everything so just modify old and add new
-  for (i=0;i<op2.nElements_;i++) {
-    int indexValue=op2.indices_[i];
+  for (i=0;i<numberOp2;i++) {
+    int indexValue=indicesOp2[i];
     double value=op2.elements_[indexValue];
     double oldValue=elements_[indexValue];
     if (oldValue) {
@@ -904,6 +1377,7 @@ CoinIndexedVector::operator/ (const CoinIndexedVector& op2)
       }
     }
   }
+  delete [] work;
   return newOne;
 }
 // The sum of two indexed vectors
@@ -941,6 +1415,7 @@ CoinIndexedVector::operator/=(const CoinIndexedVector& op2)
 void 
 CoinIndexedVector::sortDecrIndex()
 { 
+  checkIndexed();
   // Should replace with std sort
   double * elements = new double [nElements_];
   CoinZeroN (elements,nElements_);
@@ -959,6 +1434,7 @@ CoinIndexedVector::sortPacked()
 void 
 CoinIndexedVector::sortIncrElement()
 { 
+  checkIndexed();
   double * elements = new double [nElements_];
   int i;
   for (i=0;i<nElements_;i++) 
@@ -971,6 +1447,7 @@ CoinIndexedVector::sortIncrElement()
 void 
 CoinIndexedVector::sortDecrElement()
 { 
+  checkIndexed();
   double * elements = new double [nElements_];
   int i;
   for (i=0;i<nElements_;i++) 
@@ -1204,9 +1681,10 @@ CoinIndexedVector::gutsOfSetConstant(int size,
 void 
 CoinIndexedVector::append(const CoinIndexedVector & caboose)
 {
-  const int cs = caboose.getNumElements();
-  
-  const int * cind = caboose.getIndices();
+  checkIndexed();
+  int cs;
+  int * work;
+  const int * cind = caboose.listOfIndices(cs,work);
   const double * celem = caboose.denseVector();
   int maxIndex=-1;
   int i;
@@ -1250,6 +1728,7 @@ CoinIndexedVector::append(const CoinIndexedVector & caboose)
       }
     }
   }
+  delete [] work;
   if (numberDuplicates)
     throw CoinError("duplicate index", "append", "CoinIndexedVector");
 }
@@ -1257,6 +1736,8 @@ CoinIndexedVector::append(const CoinIndexedVector & caboose)
 void 
 CoinIndexedVector::append(CoinIndexedVector & other,int adjustIndex, bool zapElements/*,double multiplier*/)
 {
+  checkIndexed();
+  other.checkIndexed();
   const int cs = other.nElements_;
   const int * cind = other.indices_;
   double * celem = other.elements_;
@@ -1340,7 +1821,7 @@ CoinIndexedVector::operator==(const CoinPackedVectorBase & rhs) const
   
   const int * cind = rhs.getIndices();
   const double * celem = rhs.getElements();
-  if (nElements_!=cs)
+  if (getNumElements()!=cs)
     return false;
   int i;
   bool okay=true;
@@ -1361,7 +1842,7 @@ CoinIndexedVector::operator!=(const CoinPackedVectorBase & rhs) const
   
   const int * cind = rhs.getIndices();
   const double * celem = rhs.getElements();
-  if (nElements_!=cs)
+  if (getNumElements()!=cs)
     return true;
   int i;
   bool okay=false;
@@ -1466,12 +1947,14 @@ CoinIndexedVector::isApproximatelyEqual(const CoinIndexedVector & rhs, double to
 bool 
 CoinIndexedVector::operator==(const CoinIndexedVector & rhs) const
 {
-  const int cs = rhs.nElements_;
-  
-  const int * cind = rhs.indices_;
+  int cs;
+  int * work;
+  const int * cind = rhs.listOfIndices(cs,work);
   const double * celem = rhs.elements_;
-  if (nElements_!=cs)
+  if (getNumElements()!=cs) {
+    delete [] work;
     return false;
+  }
   bool okay=true;
   CoinRelFltEq eq(1.0e-8);
   if (!packedMode_&&!rhs.packedMode_) {
@@ -1510,18 +1993,21 @@ CoinIndexedVector::operator==(const CoinIndexedVector & rhs) const
       }
     }
   }
+  delete [] work;
   return okay;
 }
 /// Not equal
 bool 
 CoinIndexedVector::operator!=(const CoinIndexedVector & rhs) const
 {
-  const int cs = rhs.nElements_;
-  
-  const int * cind = rhs.indices_;
+  int cs;
+  int * work;
+  const int * cind = rhs.listOfIndices(cs,work);
   const double * celem = rhs.elements_;
-  if (nElements_!=cs)
+  if (getNumElements()!=cs) {
+    delete [] work;
     return true;
+  }
   int i;
   bool okay=false;
   for (i=0;i<cs;i++) {
@@ -1531,32 +2017,347 @@ CoinIndexedVector::operator!=(const CoinIndexedVector & rhs) const
       break;
     }
   }
+  delete [] work;
   return okay;
 }
 // Get value of maximum index
 int 
 CoinIndexedVector::getMaxIndex() const
 {
+  int number;
+  int * work;
+  const int * indices = listOfIndices(number,work);
   int maxIndex = -COIN_INT_MAX;
   int i;
-  for (i=0;i<nElements_;i++)
-    maxIndex = CoinMax(maxIndex,indices_[i]);
+  for (i=0;i<number;i++)
+    maxIndex = CoinMax(maxIndex,indices[i]);
+  delete [] work;
   return maxIndex;
 }
 // Get value of minimum index
 int 
 CoinIndexedVector::getMinIndex() const
 {
+  int number;
+  int * work;
+  const int * indices = listOfIndices(number,work);
   int minIndex = COIN_INT_MAX;
   int i;
-  for (i=0;i<nElements_;i++)
-    minIndex = CoinMin(minIndex,indices_[i]);
+  for (i=0;i<number;i++)
+    minIndex = CoinMin(minIndex,indices[i]);
+  delete [] work;
   return minIndex;
 }
+//#############################################################################
+// Scanning dense region
+//#############################################################################
+/* scan and scanAndPack (and CoinPartitionedVector::scan) spend their time
+   comparing elements with zero or a tolerance and compressing the ones
+   kept.  Where the compiler allows, AVX2 and AVX-512 versions are compiled
+   as well as the plain loops and the best the processor supports is used.
+   Define COIN_INDEXED_NO_SIMD to get just the plain loops. */
+#ifndef COIN_INDEXED_NO_SIMD
+#if (defined(__x86_64__) || defined(__i386__)) && \
+  ((defined(__clang__) && __clang_major__ >= 4) || \
+   (!defined(__clang__) && defined(__GNUC__) && \
+    (__GNUC__ > 4 || (__GNUC__ == 4 && __GNUC_MINOR__ >= 9))))
+#define COIN_INDEXED_SIMD 1
+#include <immintrin.h>
+#endif
+#endif
+// Which elements are kept
+// value nonzero
+#define COIN_SCAN_NONZERO 0
+// value nonzero and fabs(value)>=tolerance
+#define COIN_SCAN_GE 1
+// fabs(value)>=tolerance (even if zero)
+#define COIN_SCAN_GE_ANY 2
+// value nonzero and fabs(value)>tolerance
+#define COIN_SCAN_GT 3
+namespace {
+  // -1 for best processor supports, otherwise set by setScanInstructionSet
+  int coinScanLevel = -1;
+}
+template <int type> static inline bool
+coinScanKeep(double value, double tolerance)
+{
+  switch (type) {
+  case COIN_SCAN_NONZERO:
+    return value!=0.0;
+  case COIN_SCAN_GE:
+    return value!=0.0&&fabs(value)>=tolerance;
+  case COIN_SCAN_GE_ANY:
+    return fabs(value)>=tolerance;
+  default:
+    return value!=0.0&&fabs(value)>tolerance;
+  }
+}
+/* Plain loop.  Looks at elements[first..last-1].  Index of element i is
+   i+shift.  If pack then elements are zeroed and ones kept moved down to
+   start of elements, otherwise ones not kept are zeroed.  Counting starts
+   at number (so vectorized versions can do the tail).
+   Returns number kept. */
+template <int type> static int
+coinScanPlain(double * COIN_RESTRICT elements, int * COIN_RESTRICT indices,
+	      int first, int last, int shift, double tolerance, bool pack,
+	      int number=0)
+{
+  int n=number;
+  if (!pack) {
+    for (int i=first;i<last;i++) {
+      double value = elements[i];
+      if (value) {
+	if (coinScanKeep<type>(value,tolerance))
+	  indices[n++]=i+shift;
+	else
+	  elements[i]=0.0;
+      }
+    }
+  } else {
+    for (int i=first;i<last;i++) {
+      double value = elements[i];
+      elements[i]=0.0;
+      if (coinScanKeep<type>(value,tolerance)) {
+	elements[n]=value;
+	indices[n++]=i+shift;
+      }
+    }
+  }
+  return n;
+}
+#if COIN_INDEXED_SIMD
+// For each 4 bit mask - lanes kept followed by a lane not kept
+static const int coinScanLanes[16][4] = {
+  {0,0,0,0},
+  {0,1,1,1},
+  {1,0,0,0},
+  {0,1,2,2},
+  {2,0,0,0},
+  {0,2,1,1},
+  {1,2,0,0},
+  {0,1,2,3},
+  {3,0,0,0},
+  {0,3,1,1},
+  {1,3,0,0},
+  {0,1,3,2},
+  {2,3,0,0},
+  {0,2,3,1},
+  {1,2,3,0},
+  {0,1,2,3}
+};
+// Same as permutation of 32 bit halves of doubles
+static const int coinScanPermute[16][8] = {
+  {0,1,0,1,0,1,0,1},
+  {0,1,2,3,2,3,2,3},
+  {2,3,0,1,0,1,0,1},
+  {0,1,2,3,4,5,4,5},
+  {4,5,0,1,0,1,0,1},
+  {0,1,4,5,2,3,2,3},
+  {2,3,4,5,0,1,0,1},
+  {0,1,2,3,4,5,6,7},
+  {6,7,0,1,0,1,0,1},
+  {0,1,6,7,2,3,2,3},
+  {2,3,6,7,0,1,0,1},
+  {0,1,2,3,6,7,4,5},
+  {4,5,6,7,0,1,0,1},
+  {0,1,4,5,6,7,2,3},
+  {2,3,4,5,6,7,0,1},
+  {0,1,2,3,4,5,6,7}
+};
+/* AVX2 - compare four at a time, turn result into a bit mask and use
+   tables to compress.  Stores are four wide so room is number of
+   indices which may be written (elements are always below i+4). */
+template <int type> __attribute__((target("avx2"))) static int
+coinScanAvx2(double * COIN_RESTRICT elements, int * COIN_RESTRICT indices,
+	     int first, int last, int shift, double tolerance, bool pack,
+	     int room)
+{
+  const __m256d zero = _mm256_setzero_pd();
+  const __m256d absMask =
+    _mm256_castsi256_pd(_mm256_set1_epi64x(0x7fffffffffffffffLL));
+  const __m256d tol = _mm256_set1_pd(tolerance);
+  int n=0;
+  int i=first;
+  for (;i+4<=last&&n+4<=room;i+=4) {
+    __m256d value = _mm256_loadu_pd(elements+i);
+    __m256d nonzero = _mm256_cmp_pd(value,zero,_CMP_NEQ_UQ);
+    __m256d keep;
+    if (type==COIN_SCAN_NONZERO) {
+      keep = nonzero;
+    } else {
+      __m256d absValue = _mm256_and_pd(value,absMask);
+      if (type==COIN_SCAN_GE_ANY)
+	keep = _mm256_cmp_pd(absValue,tol,_CMP_GE_OQ);
+      else if (type==COIN_SCAN_GE)
+	keep = _mm256_and_pd(nonzero,_mm256_cmp_pd(absValue,tol,_CMP_GE_OQ));
+      else
+	keep = _mm256_and_pd(nonzero,_mm256_cmp_pd(absValue,tol,_CMP_GT_OQ));
+    }
+    int mask = _mm256_movemask_pd(keep);
+    if (!pack) {
+      if (type!=COIN_SCAN_NONZERO&&(_mm256_movemask_pd(nonzero)&~mask))
+	_mm256_storeu_pd(elements+i,_mm256_and_pd(value,keep));
+      if (mask) {
+	__m128i index =
+	  _mm_add_epi32(_mm_set1_epi32(i+shift),
+			_mm_loadu_si128(reinterpret_cast<const __m128i *>
+					(coinScanLanes[mask])));
+	_mm_storeu_si128(reinterpret_cast<__m128i *>(indices+n),index);
+	n += __builtin_popcount(mask);
+      }
+    } else if (mask|_mm256_movemask_pd(nonzero)) {
+      _mm256_storeu_pd(elements+i,zero);
+      if (mask) {
+	// ones not kept are zero so tail of store is zero
+	__m256i permute =
+	  _mm256_loadu_si256(reinterpret_cast<const __m256i *>
+			     (coinScanPermute[mask]));
+	__m256d packed = _mm256_castps_pd
+	  (_mm256_permutevar8x32_ps(_mm256_castpd_ps(_mm256_and_pd(value,keep)),
+				    permute));
+	_mm256_storeu_pd(elements+n,packed);
+	__m128i index =
+	  _mm_add_epi32(_mm_set1_epi32(i+shift),
+			_mm_loadu_si128(reinterpret_cast<const __m128i *>
+					(coinScanLanes[mask])));
+	_mm_storeu_si128(reinterpret_cast<__m128i *>(indices+n),index);
+	n += __builtin_popcount(mask);
+      }
+    }
+  }
+  return coinScanPlain<type>(elements,indices,i,last,shift,tolerance,pack,n);
+}
+/* AVX-512 - compare eight at a time into a mask register and use
+   compress stores which only write the ones kept. */
+template <int type> __attribute__((target("avx512f,avx512vl"))) static int
+coinScanAvx512(double * COIN_RESTRICT elements, int * COIN_RESTRICT indices,
+	       int first, int last, int shift, double tolerance, bool pack)
+{
+  const __m512d zero = _mm512_setzero_pd();
+  const __m512d tol = _mm512_set1_pd(tolerance);
+  const __m256i lanes = _mm256_setr_epi32(0,1,2,3,4,5,6,7);
+  int n=0;
+  int i=first;
+  for (;i+8<=last;i+=8) {
+    __m512d value = _mm512_loadu_pd(elements+i);
+    __mmask8 nonzero = _mm512_cmp_pd_mask(value,zero,_CMP_NEQ_UQ);
+    __mmask8 keep;
+    if (type==COIN_SCAN_NONZERO) {
+      keep = nonzero;
+    } else {
+      __m512d absValue = _mm512_abs_pd(value);
+      if (type==COIN_SCAN_GE_ANY)
+	keep = _mm512_cmp_pd_mask(absValue,tol,_CMP_GE_OQ);
+      else if (type==COIN_SCAN_GE)
+	keep = _mm512_mask_cmp_pd_mask(nonzero,absValue,tol,_CMP_GE_OQ);
+      else
+	keep = _mm512_mask_cmp_pd_mask(nonzero,absValue,tol,_CMP_GT_OQ);
+    }
+    if (!pack) {
+      if (type!=COIN_SCAN_NONZERO&&(nonzero&~keep))
+	_mm512_storeu_pd(elements+i,_mm512_maskz_mov_pd(keep,value));
+      if (keep) {
+	__m256i index = _mm256_add_epi32(_mm256_set1_epi32(i+shift),lanes);
+	_mm256_mask_compressstoreu_epi32(indices+n,keep,index);
+	n += __builtin_popcount(keep);
+      }
+    } else if (keep|nonzero) {
+      _mm512_storeu_pd(elements+i,zero);
+      if (keep) {
+	_mm512_mask_compressstoreu_pd(elements+n,keep,value);
+	__m256i index = _mm256_add_epi32(_mm256_set1_epi32(i+shift),lanes);
+	_mm256_mask_compressstoreu_epi32(indices+n,keep,index);
+	n += __builtin_popcount(keep);
+      }
+    }
+  }
+  return coinScanPlain<type>(elements,indices,i,last,shift,tolerance,pack,n);
+}
+#endif
+// Instruction set processor supports
+static int
+coinScanDetect()
+{
+#if COIN_INDEXED_SIMD
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("avx512f")&&__builtin_cpu_supports("avx512vl"))
+    return 2;
+  if (__builtin_cpu_supports("avx2"))
+    return 1;
+#endif
+  return 0;
+}
+/* Best instruction set processor supports.  Found once - a local static
+   is initialized safely even if first use is from several threads. */
+static int
+coinScanBest()
+{
+  static const int best = coinScanDetect();
+  return best;
+}
+// Instruction set to use (nothing written on the way)
+static inline int
+coinScanUse()
+{
+  int level = coinScanLevel;
+  return level<0 ? coinScanBest() : level;
+}
+template <int type> static int
+coinScanDispatch(double * elements, int * indices, int first, int last,
+		 int shift, double tolerance, bool pack, int room)
+{
+#if COIN_INDEXED_SIMD
+  int level = coinScanUse();
+  if (level==2)
+    return coinScanAvx512<type>(elements,indices,first,last,shift,
+				tolerance,pack);
+  else if (level==1)
+    return coinScanAvx2<type>(elements,indices,first,last,shift,
+			      tolerance,pack,room);
+#endif
+  return coinScanPlain<type>(elements,indices,first,last,shift,
+			     tolerance,pack);
+}
+/* Scan elements[first..last-1] - see coinScanPlain.  room is number
+   of entries in indices which may be used. */
+static int
+coinScan(double * elements, int * indices, int first, int last, int shift,
+	 int type, double tolerance, bool pack, int room)
+{
+  switch (type) {
+  case COIN_SCAN_NONZERO:
+    return coinScanDispatch<COIN_SCAN_NONZERO>(elements,indices,first,last,
+					       shift,tolerance,pack,room);
+  case COIN_SCAN_GE:
+    return coinScanDispatch<COIN_SCAN_GE>(elements,indices,first,last,
+					  shift,tolerance,pack,room);
+  case COIN_SCAN_GE_ANY:
+    return coinScanDispatch<COIN_SCAN_GE_ANY>(elements,indices,first,last,
+					      shift,tolerance,pack,room);
+  default:
+    return coinScanDispatch<COIN_SCAN_GT>(elements,indices,first,last,
+					  shift,tolerance,pack,room);
+  }
+}
+// Instruction set used by scans
+int
+CoinIndexedVector::scanInstructionSet()
+{
+  return coinScanUse();
+}
+// Set instruction set used by scans
+void
+CoinIndexedVector::setScanInstructionSet(int value)
+{
+  coinScanLevel = CoinMax(0,CoinMin(value,coinScanBest()));
+}
 // Scan dense region and set up indices
 int
 CoinIndexedVector::scan()
 {
+  // whole region so no need to build list
+  if (representation_)
+    makeIndexList(false);
   nElements_=0;
   return scan(0,capacity_);
 }
@@ -1564,15 +2365,12 @@ CoinIndexedVector::scan()
 int
 CoinIndexedVector::scan(int start, int end)
 {
+  checkIndexed();
   assert(!packedMode_);
   end = CoinMin(end,capacity_);
   start = CoinMax(start,0);
-  int i;
-  int number = 0;
-  int * indices = indices_+nElements_;
-  for (i=start;i<end;i++) 
-    if (elements_[i])
-      indices[number++] = i;
+  int number = coinScan(elements_,indices_+nElements_,start,end,0,
+			COIN_SCAN_NONZERO,0.0,false,capacity_-nElements_);
   nElements_ += number;
   return number;
 }
@@ -1580,6 +2378,9 @@ CoinIndexedVector::scan(int start, int end)
 int
 CoinIndexedVector::scan(double tolerance)
 {
+  // whole region so no need to build list
+  if (representation_)
+    makeIndexList(false);
   nElements_=0;
   return scan(0,capacity_,tolerance);
 }
@@ -1587,21 +2388,12 @@ CoinIndexedVector::scan(double tolerance)
 int
 CoinIndexedVector::scan(int start, int end, double tolerance)
 {
+  checkIndexed();
   assert(!packedMode_);
   end = CoinMin(end,capacity_);
   start = CoinMax(start,0);
-  int i;
-  int number = 0;
-  int * indices = indices_+nElements_;
-  for (i=start;i<end;i++) {
-    double value = elements_[i];
-    if (value) {
-      if (fabs(value)>=tolerance) 
-	indices[number++] = i;
-      else
-	elements_[i]=0.0;
-    }
-  }
+  int number = coinScan(elements_,indices_+nElements_,start,end,0,
+			COIN_SCAN_GE,tolerance,false,capacity_-nElements_);
   nElements_ += number;
   return number;
 }
@@ -1609,6 +2401,7 @@ CoinIndexedVector::scan(int start, int end, double tolerance)
 int
 CoinIndexedVector::cleanAndPack( double tolerance )
 {
+  checkIndexed();
   if (!packedMode_) {
     int number = nElements_;
     int i;
@@ -1630,6 +2423,7 @@ CoinIndexedVector::cleanAndPack( double tolerance )
 int
 CoinIndexedVector::cleanAndPackSafe( double tolerance )
 {
+  checkIndexed();
   int number = nElements_;
   if (number) {
     int i;
@@ -1675,6 +2469,9 @@ CoinIndexedVector::cleanAndPackSafe( double tolerance )
 int
 CoinIndexedVector::scanAndPack()
 {
+  // whole region so no need to build list
+  if (representation_)
+    makeIndexList(false);
   nElements_=0;
   return scanAndPack(0,capacity_);
 }
@@ -1682,20 +2479,12 @@ CoinIndexedVector::scanAndPack()
 int
 CoinIndexedVector::scanAndPack(int start, int end)
 {
+  checkIndexed();
   assert(!packedMode_);
   end = CoinMin(end,capacity_);
   start = CoinMax(start,0);
-  int i;
-  int number = 0;
-  int * indices = indices_+nElements_;
-  for (i=start;i<end;i++) {
-    double value = elements_[i];
-    elements_[i]=0.0;
-    if (value) {
-      elements_[number]=value;
-      indices[number++] = i;
-    }
-  }
+  int number = coinScan(elements_,indices_+nElements_,start,end,0,
+			COIN_SCAN_NONZERO,0.0,true,capacity_-nElements_);
   nElements_ += number;
   packedMode_=true;
   return number;
@@ -1704,6 +2493,9 @@ CoinIndexedVector::scanAndPack(int start, int end)
 int
 CoinIndexedVector::scanAndPack(double tolerance)
 {
+  // whole region so no need to build list
+  if (representation_)
+    makeIndexList(false);
   nElements_=0;
   return scanAndPack(0,capacity_,tolerance);
 }
@@ -1711,20 +2503,12 @@ CoinIndexedVector::scanAndPack(double tolerance)
 int
 CoinIndexedVector::scanAndPack(int start, int end, double tolerance)
 {
+  checkIndexed();
   assert(!packedMode_);
   end = CoinMin(end,capacity_);
   start = CoinMax(start,0);
-  int i;
-  int number = 0;
-  int * indices = indices_+nElements_;
-  for (i=start;i<end;i++) {
-    double value = elements_[i];
-    elements_[i]=0.0;
-    if (fabs(value)>=tolerance) {
-      elements_[number]=value;
-	indices[number++] = i;
-    }
-  }
+  int number = coinScan(elements_,indices_+nElements_,start,end,0,
+			COIN_SCAN_GE_ANY,tolerance,true,capacity_-nElements_);
   nElements_ += number;
   packedMode_=true;
   return number;
@@ -1733,6 +2517,7 @@ CoinIndexedVector::scanAndPack(int start, int end, double tolerance)
 void 
 CoinIndexedVector::expand()
 {
+  checkIndexed();
   if (nElements_&&packedMode_) {
     double * temp = new double[capacity_];
     int i;
@@ -1752,6 +2537,7 @@ void
 CoinIndexedVector::createPacked(int number, const int * indices, 
 		    const double * elements)
 {
+  checkIndexed();
   nElements_=number;
   packedMode_=true;
   CoinMemcpyN(indices,number,indices_);
@@ -1762,6 +2548,7 @@ void
 CoinIndexedVector::createUnpacked(int number, const int * indices, 
 		    const double * elements)
 {
+  checkIndexed();
   nElements_=number;
   packedMode_=false;
   for (int i=0;i<nElements_;i++) {
@@ -1774,6 +2561,7 @@ CoinIndexedVector::createUnpacked(int number, const int * indices,
 void 
 CoinIndexedVector::createOneUnpackedElement(int index, double element)
 {
+  checkIndexed();
   nElements_=1;
   packedMode_=false;
   indices_[0]=index;
@@ -1783,15 +2571,19 @@ CoinIndexedVector::createOneUnpackedElement(int index, double element)
 void 
 CoinIndexedVector::print() const
 {
-  printf("Vector has %d elements (%spacked mode)\n",nElements_,packedMode_ ? "" : "un");
-  for (int i=0;i<nElements_;i++) {
+  int number;
+  int * work;
+  const int * indices = listOfIndices(number,work);
+  printf("Vector has %d elements (%spacked mode)\n",number,packedMode_ ? "" : "un");
+  for (int i=0;i<number;i++) {
     if (i&&(i%5==0))
       printf("\n");
-    int index = indices_[i];
+    int index = indices[i];
     double value = packedMode_ ? elements_[i] : elements_[index];
     printf(" (%d,%g)",index,value);
   }
   printf("\n");
+  delete [] work;
 }
 
 // Zero out array
@@ -1805,7 +2597,22 @@ CoinArrayWithLength::clear()
 void 
 CoinArrayWithLength::getArray(int size)
 {
-  if (size>0) {
+  int policy = (memoryPolicy_>=0) ? memoryPolicy_ :
+    CoinMemoryPolicy::defaultPolicy();
+  if (policy&&alignment_<=6&&size>0&&
+      static_cast<size_t>(size)>=CoinMemoryPolicy::threshold()) {
+    // policy arrays are aligned on 64 bytes
+    array_ = static_cast<char *>(CoinMemoryPolicy::allocate(size,policy));
+    offset_ = -3;
+    if (size_!=-1)
+      size_=size;
+  } else if (size>0&&alignment_<=6&&CoinWorkPool::active()) {
+    // pool regions are aligned on 64 bytes
+    array_ = CoinWorkPool::threadPool()->checkOut(size,size);
+    offset_ = -2;
+    if (size_!=-1)
+      size_=size;
+  } else if (size>0) {
     if(alignment_>2) {
       offset_ = 1<<alignment_;
     } else {
@@ -1836,10 +2643,9 @@ void
 CoinArrayWithLength::conditionalDelete()
 {
   if (size_==-1) {
-    char * charArray = reinterpret_cast<char *> (array_);
-    if (charArray)
-      delete [] (charArray-offset_);
+    freeArray();
     array_=NULL;
+    offset_=0;
   } else if (size_>=0) {
     size_ = -size_-2;
   }
@@ -1848,11 +2654,10 @@ CoinArrayWithLength::conditionalDelete()
 void 
 CoinArrayWithLength::reallyFreeArray()
 {
-  char * charArray = reinterpret_cast<char *> (array_);
-  if (charArray)
-    delete [] (charArray-offset_);
+  freeArray();
   array_=NULL;
   size_=-1;
+  offset_=0;
 }
 // Get enough space
 void 
@@ -1875,6 +2680,7 @@ CoinArrayWithLength::getCapacity(int numberBytes,int numberNeeded)
    If abs(mode) >2 then align on that as power of 2
 */
 CoinArrayWithLength::CoinArrayWithLength(int size, int mode)
+  : memoryPolicy_(-1)
 {
   alignment_=abs(mode);
   getArray(size);
@@ -1884,8 +2690,20 @@ CoinArrayWithLength::CoinArrayWithLength(int size, int mode)
 }
 CoinArrayWithLength::~CoinArrayWithLength ()
 { 
-  if (array_)
-    delete [] (array_-offset_); 
+  freeArray();
+}
+// Deletes array or gives it back to work pool (borrowed left alone)
+void
+CoinArrayWithLength::freeArray()
+{
+  if (array_) {
+    if (offset_>=0)
+      delete [] (array_-offset_);
+    else if (offset_==-2)
+      CoinWorkPool::release(array_,CoinWorkPool::used(array_));
+    else if (offset_==-3)
+      CoinMemoryPolicy::release(array_);
+  }
 }
 // Conditionally gets new array
 char * 
@@ -1903,6 +2721,7 @@ CoinArrayWithLength::conditionalNew(long sizeWanted)
 }
 /* Copy constructor. */
 CoinArrayWithLength::CoinArrayWithLength(const CoinArrayWithLength & rhs)
+  : memoryPolicy_(rhs.memoryPolicy_)
 {
   assert (capacity()>=0);
   getArray(rhs.capacity());
@@ -1912,6 +2731,7 @@ CoinArrayWithLength::CoinArrayWithLength(const CoinArrayWithLength & rhs)
 
 /* Copy constructor.2 */
 CoinArrayWithLength::CoinArrayWithLength(const CoinArrayWithLength * rhs)
+  : memoryPolicy_(rhs->memoryPolicy_)
 {
   assert (rhs->capacity()>=0);
   size_=rhs->size_;
@@ -1962,8 +2782,9 @@ CoinArrayWithLength::allocate(const CoinArrayWithLength & rhs, int numberBytes)
   } else {
     assert (numberBytes>=0);
     if (size_==-1) {
-      delete [] array_;
+      freeArray();
       array_=NULL;
+      offset_=0;
     } else {
       size_=-1;
     } 
@@ -2020,30 +2841,61 @@ CoinArrayWithLength::extend(int newSize)
   assert (size_>=0); // not much point otherwise
   if (newSize>size_) {
     char * temp = array_;
+    int tempOffset = offset_;
+    int oldSize = size_;
     getArray(newSize);
     if (temp) {
-      CoinMemcpyN(array_,size_,temp);
-      delete [] (temp-offset_);
+      CoinMemcpyN(temp,oldSize,array_);
+      if (tempOffset>=0)
+	delete [] (temp-tempOffset);
+      else if (tempOffset==-2)
+	CoinWorkPool::release(temp,CoinWorkPool::used(temp));
+      else if (tempOffset==-3)
+	CoinMemoryPolicy::release(temp);
     }
     size_=newSize;
   }
 }
+// Use memory owned by someone else as array
+void 
+CoinArrayWithLength::borrowArray(char * array, int numberBytes)
+{
+  freeArray();
+  array_ = array;
+  offset_ = -1;
+  if (size_!=-1)
+    size_ = numberBytes;
+}
+// Stop using borrowed memory
+void 
+CoinArrayWithLength::returnArray()
+{
+  if (offset_==-1) {
+    array_ = NULL;
+    offset_ = 0;
+    if (size_!=-1)
+      size_ = -2;
+  }
+}
 
 /* Default constructor */
 CoinPartitionedVector::CoinPartitionedVector()
-  : CoinIndexedVector()
+  : CoinIndexedVector(),
+    threadPool_(NULL)
 {
   memset(startPartition_,0,((&numberPartitions_-startPartition_)+1)*sizeof(int));
 }
 /* Copy constructor. */
 CoinPartitionedVector::CoinPartitionedVector(const CoinPartitionedVector & rhs)
-  : CoinIndexedVector(rhs)
+  : CoinIndexedVector(rhs),
+    threadPool_(rhs.threadPool_)
 {
   memcpy(startPartition_,rhs.startPartition_,((&numberPartitions_-startPartition_)+1)*sizeof(int));
 }
 /* Copy constructor.2 */
 CoinPartitionedVector::CoinPartitionedVector(const CoinPartitionedVector * rhs)
-  : CoinIndexedVector(rhs)
+  : CoinIndexedVector(rhs),
+    threadPool_(rhs->threadPool_)
 {
   memcpy(startPartition_,rhs->startPartition_,((&numberPartitions_-startPartition_)+1)*sizeof(int));
 }
@@ -2053,6 +2905,7 @@ CoinPartitionedVector & CoinPartitionedVector::operator=(const CoinPartitionedVe
   if (this != &rhs) {
     CoinIndexedVector::operator=(rhs);
     memcpy(startPartition_,rhs.startPartition_,((&numberPartitions_-startPartition_)+1)*sizeof(int));
+    threadPool_ = rhs.threadPool_;
   }
   return *this;
 }
@@ -2060,6 +2913,57 @@ CoinPartitionedVector & CoinPartitionedVector::operator=(const CoinPartitionedVe
 CoinPartitionedVector::~CoinPartitionedVector ()
 {
 }
+// Below this much work partitions are done in order
+#define COIN_PARTITION_PARALLEL_MINIMUM 8192
+// Does one operation on each partition
+class CoinPartitionedVectorTask : public CoinThreadTask {
+public:
+  enum Type {
+    scan=0,
+    clear,
+    move
+  };
+  CoinPartitionedVectorTask(CoinPartitionedVector * vector, Type type,
+			    double tolerance, const int * to)
+    : vector_(vector), type_(type), tolerance_(tolerance), to_(to) {}
+  virtual void run(int partition);
+private:
+  CoinPartitionedVector * vector_;
+  Type type_;
+  double tolerance_;
+  /// Where each partition moves to (for move)
+  const int * to_;
+};
+void
+CoinPartitionedVectorTask::run(int partition)
+{
+  switch (type_) {
+  case scan:
+    vector_->scan(partition,tolerance_);
+    break;
+  case clear:
+    vector_->clearPartition(partition);
+    break;
+  case move:
+    {
+      int nThis = vector_->numberElementsPartition_[partition];
+      int start = vector_->startPartition_[partition];
+      int to = to_[partition];
+      vector_->numberElementsPartition_[partition]=0;
+      if (to!=start) {
+	memmove(vector_->indices_+to,vector_->indices_+start,nThis*sizeof(int));
+	memmove(vector_->elements_+to,vector_->elements_+start,
+		nThis*sizeof(double));
+	// zero what is left behind
+	int first = CoinMax(to+nThis,start);
+	if (first<start+nThis)
+	  memset(vector_->elements_+first,0,
+		 (start+nThis-first)*sizeof(double));
+      }
+    }
+    break;
+  }
+}
 // Add up number of elements in partitions
 void 
 CoinPartitionedVector::computeNumberElements()
@@ -2076,6 +2980,37 @@ CoinPartitionedVector::computeNumberElements()
 void 
 CoinPartitionedVector::compact()
 {
+  if (numberPartitions_>1) {
+    int to[COIN_PARTITIONS];
+    int n=0;
+    for (int i=0;i<numberPartitions_;i++) {
+      to[i]=n;
+      n += numberElementsPartition_[i];
+    }
+    if (useThreads(n)) {
+      // can only move at same time if no partition moves onto another
+      bool overlap=false;
+      for (int i=1;i<numberPartitions_&&!overlap;i++) {
+	int end=to[i]+numberElementsPartition_[i];
+	for (int j=0;j<numberPartitions_;j++) {
+	  int start=startPartition_[j];
+	  if (j!=i&&to[i]<start+numberElementsPartition_[j]&&start<end) {
+	    overlap=true;
+	    break;
+	  }
+	}
+      }
+      if (!overlap) {
+	CoinPartitionedVectorTask task(this,CoinPartitionedVectorTask::move,
+				       0.0,to);
+	threadPool_->run(task,numberPartitions_);
+	nElements_=n;
+	packedMode_=true;
+	numberPartitions_=0;
+	return;
+      }
+    }
+  }
   if (numberPartitions_) {
     int n=numberElementsPartition_[0];
     numberElementsPartition_[0]=0;
@@ -2137,17 +3072,43 @@ CoinPartitionedVector::setPartitions(int number,const int * starts)
     clearAndReset();
   }
 }
+// Setup partitions with about same weight in each
+void 
+CoinPartitionedVector::setBalancedPartitions(int number, int size,
+					     const int * weight)
+{
+  assert (number>0&&number<=COIN_PARTITIONS&&size<=capacity_);
+  int starts[COIN_PARTITIONS+1];
+  starts[0]=0;
+  CoinInt64 total=0;
+  if (weight) {
+    for (int j=0;j<size;j++)
+      total += weight[j];
+  }
+  if (!total) {
+    for (int i=1;i<number;i++)
+      starts[i]=static_cast<int>((static_cast<CoinInt64>(size)*i)/number);
+  } else {
+    CoinInt64 sum=0;
+    int j=0;
+    for (int i=1;i<number;i++) {
+      // end partition when its share of total reached
+      CoinInt64 target=(total*i)/number;
+      while (j<size&&sum+weight[j]<=target)
+	sum += weight[j++];
+      starts[i]=j;
+    }
+  }
+  starts[number]=size;
+  setPartitions(number,starts);
+}
 // Reset the vector (as if were just created an empty vector). Gets rid of partitions
 void 
 CoinPartitionedVector::clearAndReset()
 {
   if (numberPartitions_) {
     assert (packedMode_||!nElements_);
-    for (int i=0;i<numberPartitions_;i++) {
-      int n=numberElementsPartition_[i];
-      memset(elements_+startPartition_[i],0,n*sizeof(double));
-      numberElementsPartition_[i]=0;
-    }
+    clearPartitions();
   } else {
     memset(elements_,0,nElements_*sizeof(double));
   }
@@ -2161,13 +3122,28 @@ void
 CoinPartitionedVector::clearAndKeep()
 {
   assert (packedMode_);
-  for (int i=0;i<numberPartitions_;i++) {
-    int n=numberElementsPartition_[i];
-    memset(elements_+startPartition_[i],0,n*sizeof(double));
-    numberElementsPartition_[i]=0;
-  }
+  clearPartitions();
   nElements_=0;
 }
+// Clear all partitions
+void 
+CoinPartitionedVector::clearPartitions()
+{
+  int n=0;
+  for (int i=0;i<numberPartitions_;i++)
+    n += numberElementsPartition_[i];
+  if (useThreads(n)) {
+    CoinPartitionedVectorTask task(this,CoinPartitionedVectorTask::clear,
+				   0.0,NULL);
+    threadPool_->run(task,numberPartitions_);
+  } else {
+    for (int i=0;i<numberPartitions_;i++) {
+      int n=numberElementsPartition_[i];
+      memset(elements_+startPartition_[i],0,n*sizeof(double));
+      numberElementsPartition_[i]=0;
+    }
+  }
+}
 // Clear a partition.
 void 
 CoinPartitionedVector::clearPartition(int partition)
@@ -2242,35 +3218,37 @@ CoinPartitionedVector::scan(int partition, double tolerance)
 {
   assert (packedMode_);
   assert (partition<COIN_PARTITIONS);
-  int n=0;
   int start=startPartition_[partition];
-  double * COIN_RESTRICT elements=elements_+start;
-  int * COIN_RESTRICT indices=indices_+start;
   int sizePartition=startPartition_[partition+1]-start;
-  if (!tolerance) {
-    for (int i=0;i<sizePartition;i++) {
-      double value = elements[i];
-      if (value) {
-	elements[i]=0.0;
-	elements[n]=value;
-	indices[n++]=i+start;
-      }
-    }
-  } else {
-    for (int i=0;i<sizePartition;i++) {
-      double value = elements[i];
-      if (value) {
-	elements[i]=0.0;
-	if (fabs(value)>tolerance) {
-	  elements[n]=value;
-	  indices[n++]=i+start;
-	}
-      }
-    }
-  }
+  int n = coinScan(elements_+start,indices_+start,0,sizePartition,start,
+		   tolerance ? COIN_SCAN_GT : COIN_SCAN_NONZERO,tolerance,
+		   true,sizePartition);
   numberElementsPartition_[partition]=n;
   return n;
 }
+// Scan all partitions and compute number of elements
+int 
+CoinPartitionedVector::scanPartitions(double tolerance)
+{
+  assert (numberPartitions_);
+  if (useThreads(startPartition_[numberPartitions_])) {
+    CoinPartitionedVectorTask task(this,CoinPartitionedVectorTask::scan,
+				   tolerance,NULL);
+    threadPool_->run(task,numberPartitions_);
+  } else {
+    for (int i=0;i<numberPartitions_;i++)
+      scan(i,tolerance);
+  }
+  computeNumberElements();
+  return nElements_;
+}
+// True if worth doing partitions in parallel
+bool
+CoinPartitionedVector::useThreads(int work) const
+{
+  return threadPool_&&numberPartitions_>1&&
+    threadPool_->numberThreads()>1&&work>=COIN_PARTITION_PARALLEL_MINIMUM;
+}
 //  Print out
 void 
 CoinPartitionedVector::print() const
@@ -20,6 +20,9 @@
 #include "CoinHelperFunctions.hpp"
 #include <cassert>
 
+class CoinMemoryUsage;
+class CoinThreadPool;
+
 #ifndef COIN_FLOAT
 #define COIN_INDEXED_TINY_ELEMENT 1.0e-50
 #define COIN_INDEXED_REALLY_TINY_ELEMENT 1.0e-100
@@ -35,6 +38,17 @@ It is designed to be lightweight in normal use.
 
 It now has a "packed" mode when it is even more like CoinPackedVector
 
+Between calls to its own methods the nonzeros need not be held as a list
+of indices.  They can be held as a bitmap of nonzeros (with generation
+counters so clearing stays proportional to the number of nonzeros) or not
+tracked at all (pure dense).  With setAutoRepresentation(true) the vector
+moves between these as density grows when elements are added by insert,
+add, quickInsert, quickAdd and quickAddNonZero.  Non-const access to
+indices or count returns it to the list so existing code sees no
+difference.  Const methods never change the representation, so several
+threads may read a shared vector; getIndices() through a const reference
+throws unless the vector is held as a list (call makeIndexList() first).
+
 Indices array has capacity_ extra chars which are zeroed and can
 be used for any purpose - but must be re-zeroed
 
@@ -107,14 +121,19 @@ class CoinIndexedVector {
 public:
    /**@name Get methods. */
    //@{
-   /// Get the size
-   inline int getNumElements() const { return nElements_; }
-   /// Get indices of elements
-   inline const int * getIndices() const { return indices_; }
+   /// Get the size (counted without changing representation if pure dense)
+   inline int getNumElements() const 
+   { return (representation_!=pureDense) ? nElements_ : countNonZero(); }
+   /// Get the size (going to list of indices if pure dense)
+   inline int getNumElements() 
+   { if (representation_==pureDense) makeIndexList(); return nElements_; }
+   /// Get indices of elements (throws if not held as list)
+   inline const int * getIndices() const 
+   { if (representation_) notIndexList("getIndices"); return indices_; }
    /// Get element values
    // ** No longer supported virtual const double * getElements() const ;
    /// Get indices of elements
-   inline int * getIndices() { return indices_; }
+   inline int * getIndices() { checkIndexed(); return indices_; }
    /** Get the vector as a dense vector. This is normal storage method.
        The user should not not delete [] this.
    */
@@ -138,13 +157,18 @@ public:
    //@{
    /// Set the size
    inline void setNumElements(int value) { nElements_ = value;
-   if (!nElements_) packedMode_=false;}
+   if (!nElements_) packedMode_=false;
+   if (representation_) makeIndexList(false);}
    /// Reset the vector (as if were just created an empty vector).  This leaves arrays!
    void clear();
    /// Reset the vector (as if were just created an empty vector)
    void empty();
    /** Assignment operator. */
    CoinIndexedVector & operator=(const CoinIndexedVector &);
+#if __cplusplus >= 201103L
+   /** Move assignment - exchanges arrays and state with rhs */
+   CoinIndexedVector & operator=(CoinIndexedVector &&);
+#endif
 #ifndef CLP_NO_VECTOR
    /** Assignment operator from a CoinPackedVectorBase. <br>
    <strong>NOTE</strong>: This assumes no duplicates */
@@ -193,8 +217,14 @@ public:
    inline void quickInsert(int index, double element)
                {
 		 assert (!elements_[index]);
-		 indices_[nElements_++] = index;
-		 assert (nElements_<=capacity_);
+		 if (!representation_) {
+		   indices_[nElements_++] = index;
+		   assert (nElements_<=capacity_);
+		   if (nElements_>switchAt_)
+		     switchRepresentation();
+		 } else {
+		   markNonZero(index);
+		 }
 		 elements_[index] = element;
 	       }
    /** Insert or if exists add an element into the vector
@@ -213,8 +243,14 @@ public:
 		     elements_[index] = 1.0e-100;
 		   }
 		 } else if ((element > 0 ? element : -element) >= COIN_INDEXED_TINY_ELEMENT) {
-		   indices_[nElements_++] = index;
-		   assert (nElements_<=capacity_);
+		   if (!representation_) {
+		     indices_[nElements_++] = index;
+		     assert (nElements_<=capacity_);
+		     if (nElements_>switchAt_)
+		       switchRepresentation();
+		   } else {
+		     markNonZero(index);
+		   }
 		   elements_[index] = element;
 		 }
 	       }
@@ -233,8 +269,14 @@ public:
 		     elements_[index] = COIN_DBL_MIN;
 		   }
 		 } else {
-		   indices_[nElements_++] = index;
-		   assert (nElements_<=capacity_);
+		   if (!representation_) {
+		     indices_[nElements_++] = index;
+		     assert (nElements_<=capacity_);
+		     if (nElements_>switchAt_)
+		       switchRepresentation();
+		   } else {
+		     markNonZero(index);
+		   }
 		   elements_[index] = element;
 		 }
 	       }
@@ -282,6 +324,13 @@ public:
    int scanAndPack(int start, int end);
    int scanAndPack(double tolerance);
    int scanAndPack(int start, int end, double tolerance);
+   /** Instruction set used by scans (0 plain, 1 AVX2, 2 AVX-512).
+       Best one processor supports is chosen on first use. */
+   static int scanInstructionSet();
+   /** Set instruction set used by scans - mainly for testing and timing.
+       Reduced to what processor and build support.  Not to be called
+       while other threads are scanning. */
+   static void setScanInstructionSet(int value);
    /// Create packed array
    void createPacked(int number, const int * indices, 
 		    const double * elements);
@@ -352,10 +401,10 @@ public:
    //@{ 
    /** Sort the indexed storage vector (increasing indices). */
    void sort()
-   { std::sort(indices_,indices_+nElements_); }
+   { checkIndexed(); std::sort(indices_,indices_+nElements_); }
 
    void sortIncrIndex()
-   { std::sort(indices_,indices_+nElements_); }
+   { checkIndexed(); std::sort(indices_,indices_+nElements_); }
 
    void sortDecrIndex();
   
@@ -418,6 +467,9 @@ void operator/=(const CoinIndexedVector& op2);
        having to reallocate storage.
    */
    int capacity() const { return capacity_; }
+   /** Add bytes used (current nonzeros) and allocated for indices
+       (including mark area) and elements to \p usage */
+   void memoryUsage(CoinMemoryUsage & usage) const;
    /// Sets packed mode
    inline void setPackedMode(bool yesNo)
    { packedMode_=yesNo;}
@@ -426,6 +478,35 @@ void operator/=(const CoinIndexedVector& op2);
    { return packedMode_;}
    //@}
 
+   /**@name Representation */
+   //@{
+   /// How nonzeros are held between calls
+   enum Representation {
+     /// List of indices (normal)
+     indexList = 0,
+     /// Bitmap of nonzeros, count kept
+     nonzeroBitmap = 1,
+     /// Not tracked - found by scanning when needed
+     pureDense = 2
+   };
+   /// Current representation
+   inline int representation() const
+   { return representation_;}
+   /** Set representation.  Vector must not be in packed mode.
+       Changing to indexList is same as makeIndexList(). */
+   void setRepresentation(int value);
+   /** Return to list of indices.  If \p rebuild is false the list is
+       assumed to have been set up by the caller. */
+   void makeIndexList(bool rebuild=true);
+   /** Switch automatically between list, bitmap and dense as density
+       grows.  The density seen at clear() is used as a guide for the
+       next use. */
+   void setAutoRepresentation(bool yesNo);
+   /// Whether switching automatically
+   inline bool autoRepresentation() const
+   { return autoRepresentation_;}
+   //@}
+
    /**@name Constructors and destructors */
    //@{
    /** Default constructor */
@@ -443,6 +524,12 @@ void operator/=(const CoinIndexedVector& op2);
    CoinIndexedVector(const CoinIndexedVector &);
    /** Copy constructor.2 */
    CoinIndexedVector(const CoinIndexedVector *);
+#if __cplusplus >= 201103L
+   /** Move constructor - takes arrays of rhs which is left empty.
+       Does not throw so std::vector moves rather than copies when it
+       grows. */
+   CoinIndexedVector(CoinIndexedVector &&) noexcept;
+#endif
 #ifndef CLP_NO_VECTOR
    /** Copy constructor <em>from a PackedVectorBase</em>. */
    CoinIndexedVector(const CoinPackedVectorBase & rhs);
@@ -464,6 +551,29 @@ private:
    ///
    void gutsOfSetConstant(int size,
 			  const int * inds, double value);
+   /// Goes to list if not already
+   inline void checkIndexed()
+   { if (representation_) makeIndexList();}
+   /** Indices of nonzeros without changing representation.  Returns
+       indices_ if held as list, otherwise work (new array which caller
+       must delete) */
+   const int * listOfIndices(int & number, int *& work) const;
+   /// Number of nonzeros found by scanning dense vector
+   int countNonZero() const;
+   /// Throws as const method needs list of indices
+   void notIndexList(const char * method) const;
+   /// Records a new nonzero when not in list representation
+   void markNonZero(int index);
+   /// Moves to next representation when too dense
+   void switchRepresentation();
+   /// Deletes arrays or gives them back to work pool
+   void freeArrays();
+   /// Exchanges arrays and state with rhs
+   void gutsOfMove(CoinIndexedVector & rhs);
+   /// Sets switchAt_ from representation and density seen
+   void setSwitchAt();
+   /// Starts a new bitmap generation (allocating if needed)
+   void startBitmap();
    //@}
 
 protected:
@@ -477,10 +587,27 @@ protected:
    int nElements_;
    /// Amount of memory allocated for indices_, and elements_.
    int capacity_;
-   ///  Offset to get where new allocated array
+   ///  Offset to get where new allocated array (-1 if from CoinWorkPool)
    int offset_;
    /// If true then is operating in packed mode
    bool packedMode_;
+   /// If true then representation switches with density
+   bool autoRepresentation_;
+   /// Representation (see Representation)
+   int representation_;
+   /// Representation density at last clear() suggests
+   int predicted_;
+   /// Number of nonzeros above which to switch representation
+   int switchAt_;
+   /// Number of words in each part of bitmap_
+   int bitmapWords_;
+   /// Number of bitmap words touched in this generation
+   int numberTouched_;
+   /// Current generation - a bitmap word is valid only if stamped with this
+   unsigned int generation_;
+   /** Bitmap of nonzeros as bitmapWords_ words of bits, then stamps
+       (generations) and then list of touched words */
+   unsigned int * bitmap_;
    //@}
 };
 
@@ -552,6 +679,26 @@ public:
   void swap(CoinArrayWithLength & other);
   /// Extend a persistent array keeping data (size in bytes)
   void extend(int newSize);
+  /** Use memory owned by someone else (e.g. a mapped file) as array.
+      The array is never deleted by this object - if more space is needed
+      a new array is allocated in the normal way.  The caller must
+      call returnArray before the memory goes away.
+  */
+  void borrowArray(char * array, int numberBytes);
+  /// Stop using borrowed memory (does nothing if array owned)
+  void returnArray();
+  /// See if array is borrowed
+  inline bool borrowed() const 
+  { return offset_==-1; }
+  /** Set CoinMemoryPolicy for arrays obtained from now on (-1, the
+      default, means use CoinMemoryPolicy::defaultPolicy()).  Only arrays
+      of at least CoinMemoryPolicy::threshold() bytes and with alignment
+      no more than 64 bytes are affected. */
+  inline void setMemoryPolicy(int policy)
+  { memoryPolicy_ = policy; }
+  /// CoinMemoryPolicy for arrays (-1 if default)
+  inline int memoryPolicy() const
+  { return memoryPolicy_; }
   //@}
   
   /**@name Condition methods */
@@ -566,11 +713,11 @@ public:
   //@{
   /** Default constructor - NULL*/
   inline CoinArrayWithLength()
-    : array_(NULL),size_(-1),offset_(0),alignment_(0)
+    : array_(NULL),size_(-1),offset_(0),alignment_(0),memoryPolicy_(-1)
   { }
   /** Alternate Constructor - length in bytes - size_ -1 */
   inline CoinArrayWithLength(int size)
-    : size_(-1),offset_(0),alignment_(0)
+    : size_(-1),offset_(0),alignment_(0),memoryPolicy_(-1)
   { array_=new char [size];}
   /** Alternate Constructor - length in bytes 
       mode -  0 size_ set to size
@@ -598,6 +745,10 @@ public:
   /// Get enough space (if more needed then do at least needed)
   void getCapacity(int numberBytes,int numberIfNeeded=-1);
   //@}
+
+private:
+  /// Deletes array or gives it back to work pool (leaves pointers)
+  void freeArray();
   
 protected:
   /**@name Private member data */
@@ -606,10 +757,13 @@ protected:
   char * array_;
   /// Size of array in bytes
   CoinBigIndex size_;
-  /// Offset of array
+  /** Offset of array (-1 if array borrowed and must not be deleted,
+      -2 if from CoinWorkPool, -3 if from CoinMemoryPolicy) */
   int offset_;
   /// Alignment wanted (power of 2)
   int alignment_;
+  /// CoinMemoryPolicy for new arrays (-1 default)
+  int memoryPolicy_;
   //@}
 };
 /// double * version
@@ -1096,6 +1250,10 @@ public:
    void reserve(int n);
   /// Setup partitions (needs end as well)
   void setPartitions(int number,const int * starts);
+  /** Setup partitions over 0..size-1 so each has about the same total
+      of weight (e.g. expected nonzeros of each index).  If weight is NULL
+      partitions have the same number of indices. */
+  void setBalancedPartitions(int number, int size, const int * weight);
    /// Reset the vector (as if were just created an empty vector). Gets rid of partitions
    void clearAndReset();
    /// Reset the vector (as if were just created an empty vector). Keeps partitions
@@ -1113,12 +1271,24 @@ public:
 #endif
    /// Scan dense region and set up indices (returns number found)
   int scan(int partition, double tolerance=0.0);
-   /** Scan dense region from start to < end and set up indices
-       returns number found
-   */
+  /** Scan all partitions and compute number of elements
+      (returns number found) */
+  int scanPartitions(double tolerance=0.0);
    ///  Print out
    void print() const;
    //@}
+
+  /**@name Threads */
+  //@{
+  /** Use threads in pool (not owned) for scanPartitions, compact,
+      clearAndReset and clearAndKeep.  Partitions are then done at same
+      time if there is enough work.  NULL to do them in order. */
+  inline void setThreadPool(CoinThreadPool * pool)
+  { threadPool_ = pool; }
+  /// Thread pool (may be NULL)
+  inline CoinThreadPool * threadPool() const
+  { return threadPool_; }
+  //@}
  
    /**@name Sorting */
    //@{ 
@@ -1157,6 +1327,14 @@ protected:
    int numberElementsPartition_[COIN_PARTITIONS];
   /// Number of partitions (0 means off)
   int numberPartitions_;
+  /// Thread pool for partitions (not owned)
+  CoinThreadPool * threadPool_;
    //@}
+private:
+  /// Clear all partitions
+  void clearPartitions();
+  /// True if work is enough to do partitions in parallel
+  bool useThreads(int work) const;
+  friend class CoinPartitionedVectorTask;
 };
 #endif
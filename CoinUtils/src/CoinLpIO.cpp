@@ -24,6 +24,7 @@
 #include "CoinHelperFunctions.hpp"
 #include "CoinPackedMatrix.hpp"
 #include "CoinLpIO.hpp"
+#include "CoinArena.hpp"
 #include "CoinFinite.hpp"
 
 using namespace std;
@@ -55,7 +56,8 @@ CoinLpIO::CoinLpIO() :
   numberAcross_(10),
   epsilon_(1e-5),
   decimals_(5),
-  objName_(NULL)
+  objName_(NULL),
+  arena_(NULL)
 {
   card_previous_names_[0] = 0;
   card_previous_names_[1] = 0;
@@ -100,7 +102,8 @@ CoinLpIO::CoinLpIO(const CoinLpIO& rhs)
     infinity_(COIN_DBL_MAX),
     numberAcross_(10),
     epsilon_(1e-5),
-    objName_(NULL)
+    objName_(NULL),
+    arena_(NULL)
 {
     card_previous_names_[0] = 0;
     card_previous_names_[1] = 0;
@@ -1418,7 +1421,7 @@ CoinLpIO::read_monom_obj(FILE *fp, double *coeff, char **name, int *cnt,
     printf("CoinLpIO: read_monom_obj(): obj_name: %s\n", buff);
 #endif
 
-    *obj_name = CoinStrdup(buff);
+    *obj_name = lpStrdup(buff);
     return(0);
   }
 
@@ -1484,7 +1487,7 @@ CoinLpIO::read_monom_obj(FILE *fp, double *coeff, char **name, int *cnt,
   }
 
   coeff[*cnt] *= mult;
-  name[*cnt] = CoinStrdup(loc_name);
+  name[*cnt] = lpStrdup(loc_name);
 
 #ifdef LPIO_DEBUG
   printf("read_monom_obj: (%f)  (%s)\n", coeff[*cnt], name[*cnt]);
@@ -1547,11 +1550,11 @@ CoinLpIO::read_monom_row(FILE *fp, char *start_str,
   coeff[cnt_coeff] *= mult;
 #ifdef KILL_ZERO_READLP
   if (fabs(coeff[cnt_coeff])>epsilon_)
-    name[cnt_coeff] = CoinStrdup(loc_name);
+    name[cnt_coeff] = lpStrdup(loc_name);
   else
     read_sense=-2; // effectively zero
 #else
-  name[cnt_coeff] = CoinStrdup(loc_name);
+  name[cnt_coeff] = lpStrdup(loc_name);
 #endif
 
 #ifdef LPIO_DEBUG
@@ -1561,15 +1564,56 @@ CoinLpIO::read_monom_row(FILE *fp, char *start_str,
   return(read_sense);
 } /* read_monom_row */
 
+/*************************************************************************/
+void *
+CoinLpIO::lpMalloc(size_t numberBytes) const {
+
+  if(arena_) {
+    return(arena_->allocate(numberBytes));
+  }
+  return(malloc(numberBytes));
+} /* lpMalloc */
+
+/*************************************************************************/
+void *
+CoinLpIO::lpRealloc(void * array, size_t oldBytes, 
+		    size_t numberBytes) const {
+
+  if(arena_) {
+    return(arena_->reallocate(array, oldBytes, numberBytes));
+  }
+  return(realloc(array, numberBytes));
+} /* lpRealloc */
+
+/*************************************************************************/
+void
+CoinLpIO::lpFree(void * array) const {
+
+  if(!arena_) {
+    free(array);
+  }
+} /* lpFree */
+
+/*************************************************************************/
+char *
+CoinLpIO::lpStrdup(const char * name) const {
+
+  if(arena_) {
+    return(arena_->duplicate(name));
+  }
+  return(CoinStrdup(name));
+} /* lpStrdup */
+
 /*************************************************************************/
 void
 CoinLpIO::realloc_coeff(double **coeff, char ***colNames, 
 			int *maxcoeff) const {
   
+  size_t oldSize = *maxcoeff+1;
   *maxcoeff *= 5;
 
-  *colNames = reinterpret_cast<char **> (realloc ((*colNames), (*maxcoeff+1) * sizeof(char *)));
-  *coeff = reinterpret_cast<double *> (realloc ((*coeff), (*maxcoeff+1) * sizeof(double)));
+  *colNames = reinterpret_cast<char **> (lpRealloc ((*colNames), oldSize * sizeof(char *), (*maxcoeff+1) * sizeof(char *)));
+  *coeff = reinterpret_cast<double *> (lpRealloc ((*coeff), oldSize * sizeof(double), (*maxcoeff+1) * sizeof(double)));
 
 } /* realloc_coeff */
 
@@ -1578,12 +1622,13 @@ void
 CoinLpIO::realloc_row(char ***rowNames, int **start, double **rhs, 
 		      double **rowlow, double **rowup, int *maxrow) const {
 
+  size_t oldSize = *maxrow+1;
   *maxrow *= 5;
-  *rowNames = reinterpret_cast<char **> (realloc ((*rowNames), (*maxrow+1) * sizeof(char *)));
-  *start = reinterpret_cast<int *> (realloc ((*start), (*maxrow+1) * sizeof(int)));
-  *rhs = reinterpret_cast<double *> (realloc ((*rhs), (*maxrow+1) * sizeof(double)));
-  *rowlow = reinterpret_cast<double *> (realloc ((*rowlow), (*maxrow+1) * sizeof(double)));
-  *rowup = reinterpret_cast<double *> (realloc ((*rowup), (*maxrow+1) * sizeof(double)));
+  *rowNames = reinterpret_cast<char **> (lpRealloc ((*rowNames), oldSize * sizeof(char *), (*maxrow+1) * sizeof(char *)));
+  *start = reinterpret_cast<int *> (lpRealloc ((*start), oldSize * sizeof(int), (*maxrow+1) * sizeof(int)));
+  *rhs = reinterpret_cast<double *> (lpRealloc ((*rhs), oldSize * sizeof(double), (*maxrow+1) * sizeof(double)));
+  *rowlow = reinterpret_cast<double *> (lpRealloc ((*rowlow), oldSize * sizeof(double), (*maxrow+1) * sizeof(double)));
+  *rowup = reinterpret_cast<double *> (lpRealloc ((*rowup), oldSize * sizeof(double), (*maxrow+1) * sizeof(double)));
 
 } /* realloc_row */
 
@@ -1592,10 +1637,11 @@ void
 CoinLpIO::realloc_col(double **collow, double **colup, char **is_int,
 		      int *maxcol) const {
   
+  size_t oldSize = *maxcol+1;
   *maxcol += 100;
-  *collow = reinterpret_cast<double *> (realloc ((*collow), (*maxcol+1) * sizeof(double)));
-  *colup = reinterpret_cast<double *> (realloc ((*colup), (*maxcol+1) * sizeof(double)));
-  *is_int = reinterpret_cast<char *> (realloc ((*is_int), (*maxcol+1) * sizeof(char)));
+  *collow = reinterpret_cast<double *> (lpRealloc ((*collow), oldSize * sizeof(double), (*maxcol+1) * sizeof(double)));
+  *colup = reinterpret_cast<double *> (lpRealloc ((*colup), oldSize * sizeof(double), (*maxcol+1) * sizeof(double)));
+  *is_int = reinterpret_cast<char *> (lpRealloc ((*is_int), oldSize * sizeof(char), (*maxcol+1) * sizeof(char)));
 
 } /* realloc_col */
 
@@ -1729,14 +1775,17 @@ CoinLpIO::readLp(FILE* fp)
   int objsense, cnt_coeff = 0, cnt_row = 0, cnt_obj = 0;
   char *objName = NULL;
 
-  char **colNames = reinterpret_cast<char **> (malloc ((maxcoeff+1) * sizeof(char *)));
-  double *coeff = reinterpret_cast<double *> (malloc ((maxcoeff+1) * sizeof(double)));
+  // arena memory goes at end (or if an error is thrown)
+  CoinArenaScope arenaScope(arena_);
+
+  char **colNames = reinterpret_cast<char **> (lpMalloc ((maxcoeff+1) * sizeof(char *)));
+  double *coeff = reinterpret_cast<double *> (lpMalloc ((maxcoeff+1) * sizeof(double)));
 
-  char **rowNames = reinterpret_cast<char **> (malloc ((maxrow+1) * sizeof(char *)));
-  int *start = reinterpret_cast<int *> (malloc ((maxrow+1) * sizeof(int)));
-  double *rhs = reinterpret_cast<double *> (malloc ((maxrow+1) * sizeof(double)));
-  double *rowlow = reinterpret_cast<double *> (malloc ((maxrow+1) * sizeof(double)));
-  double *rowup = reinterpret_cast<double *> (malloc ((maxrow+1) * sizeof(double)));
+  char **rowNames = reinterpret_cast<char **> (lpMalloc ((maxrow+1) * sizeof(char *)));
+  int *start = reinterpret_cast<int *> (lpMalloc ((maxrow+1) * sizeof(int)));
+  double *rhs = reinterpret_cast<double *> (lpMalloc ((maxrow+1) * sizeof(double)));
+  double *rowlow = reinterpret_cast<double *> (lpMalloc ((maxrow+1) * sizeof(double)));
+  double *rowup = reinterpret_cast<double *> (lpMalloc ((maxrow+1) * sizeof(double)));
 
   int i;
 
@@ -1777,13 +1826,13 @@ CoinLpIO::readLp(FILE* fp)
       printf("CoinLpIO::readLp(): rowName[%d]: %s\n", cnt_row, buff);
 #endif
 
-      rowNames[cnt_row] = CoinStrdup(buff);
+      rowNames[cnt_row] = lpStrdup(buff);
       scan_next(buff, fp);
     }
     else {
       char rname[15];
       sprintf(rname, "cons%d", cnt_row); 
-      rowNames[cnt_row] = CoinStrdup(rname);
+      rowNames[cnt_row] = lpStrdup(rname);
     }
     read_row(fp, buff, 
 	     &coeff, &colNames, &cnt_coeff, &maxcoeff, rhs, rowlow, rowup, 
@@ -1808,9 +1857,9 @@ CoinLpIO::readLp(FILE* fp)
 
   int maxcol = numberHash_[1] + 100;
 
-  double *collow = reinterpret_cast<double *> (malloc ((maxcol+1) * sizeof(double)));
-  double *colup = reinterpret_cast<double *> (malloc ((maxcol+1) * sizeof(double)));
-  char *is_int = reinterpret_cast<char *> (malloc ((maxcol+1) * sizeof(char)));
+  double *collow = reinterpret_cast<double *> (lpMalloc ((maxcol+1) * sizeof(double)));
+  double *colup = reinterpret_cast<double *> (lpMalloc ((maxcol+1) * sizeof(double)));
+  char *is_int = reinterpret_cast<char *> (lpMalloc ((maxcol+1) * sizeof(char)));
   int has_int = 0;
 
   for (i=0; i<maxcol; i++) {
@@ -2060,7 +2109,7 @@ CoinLpIO::readLp(FILE* fp)
   printf("CoinLpIO::readLp(): Done with reading the Lp file\n");
 #endif
 
-  int *ind = reinterpret_cast<int *> (malloc ((maxcoeff+1) * sizeof(int)));
+  int *ind = reinterpret_cast<int *> (lpMalloc ((maxcoeff+1) * sizeof(int)));
 
   for(i=0; i<cnt_coeff; i++) {
     ind[i] = findHash(colNames[i], 1);
@@ -2080,7 +2129,7 @@ CoinLpIO::readLp(FILE* fp)
   numberColumns_ = numberHash_[1];
   numberElements_ = cnt_coeff - start[0];
 
-  double *obj = reinterpret_cast<double *> (malloc (numberColumns_ * sizeof(double)));
+  double *obj = reinterpret_cast<double *> (lpMalloc (numberColumns_ * sizeof(double)));
   memset(obj, 0, numberColumns_ * sizeof(double));
 
   for(i=0; i<cnt_obj; i++) {
@@ -2119,10 +2168,10 @@ CoinLpIO::readLp(FILE* fp)
 
 
   if(objName == NULL) {
-    rowNames[cnt_row] = CoinStrdup("obj");
+    rowNames[cnt_row] = lpStrdup("obj");
   }
   else {
-    rowNames[cnt_row] = CoinStrdup(objName);
+    rowNames[cnt_row] = lpStrdup(objName);
   }
 
   // Hash tables for column names are already set up
@@ -2136,32 +2185,32 @@ CoinLpIO::readLp(FILE* fp)
   } 
   
   for(i=0; i<cnt_coeff; i++) {
-    free(colNames[i]);
+    lpFree(colNames[i]);
   }
-  free(colNames);
+  lpFree(colNames);
 
   for(i=0; i<cnt_row+1; i++) {
-    free(rowNames[i]);
+    lpFree(rowNames[i]);
   }
-  free(rowNames);
+  lpFree(rowNames);
 
-  free(objName);
+  lpFree(objName);
 
 #ifdef LPIO_DEBUG
   writeLp("readlp.xxx");
   printf("CoinLpIO::readLp(): read Lp file written in file readlp.xxx\n");
 #endif
 
-  free(coeff);
-  free(start);
-  free(ind);
-  free(colup);
-  free(collow);
-  free(rhs);
-  free(rowlow);
-  free(rowup);
-  free(is_int);
-  free(obj);
+  lpFree(coeff);
+  lpFree(start);
+  lpFree(ind);
+  lpFree(colup);
+  lpFree(collow);
+  lpFree(rhs);
+  lpFree(rowlow);
+  lpFree(rowup);
+  lpFree(is_int);
+  lpFree(obj);
   delete matrix;
 
 } /* readLp */
@@ -20,6 +20,8 @@
 #include "CoinPackedMatrix.hpp"
 #include "CoinMessage.hpp"
 
+class CoinArena;
+
 typedef int COINColumnIndex;
 
   /** Class to read and write Lp files 
@@ -458,6 +460,14 @@ public:
   /// flipped to get a minimization problem.  
   void readLp(FILE *fp);
 
+  /** Take temporary arrays and names used while reading from arena
+      (NULL for malloc).  They are all given back to the arena at the end
+      of readLp instead of being freed one by one. */
+  inline void setArena(CoinArena * arena) {arena_ = arena;}
+
+  /// Arena used while reading (NULL if none)
+  inline CoinArena * arena() const {return arena_;}
+
   /// Dump the data. Low level method for debugging.
   void print() const;
   //@}
@@ -566,6 +576,9 @@ protected:
   /// Objective function name
   char *objName_;
 
+  /// Arena for temporaries in readLp (not owned)
+  CoinArena *arena_;
+
   /** Row names (including objective function name) 
       and column names when stopHash() for the corresponding 
       section was last called or for initial names (deemed invalid) 
@@ -699,6 +712,18 @@ protected:
   int read_monom_row(FILE *fp, char *start_str, double *coeff, char **name, 
 		     int cnt_coeff) const;
 
+  /// Get temporary memory (from arena_ if set).
+  void * lpMalloc(size_t numberBytes) const;
+
+  /// Reallocate temporary memory.
+  void * lpRealloc(void * array, size_t oldBytes, size_t numberBytes) const;
+
+  /// Free temporary memory (nothing if from arena_).
+  void lpFree(void * array) const;
+
+  /// Copy of name as temporary memory.
+  char * lpStrdup(const char * name) const;
+
   /// Reallocate vectors related to number of coefficients.
   void realloc_coeff(double **coeff, char ***colNames, int *maxcoeff) const;
 
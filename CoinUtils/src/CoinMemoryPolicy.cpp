@@ -0,0 +1,252 @@
+/* $Id$ */
+// Copyright (C) 2012, International Business Machines
+// Corporation and others.  All Rights Reserved.
+// This code is licensed under the terms of the Eclipse Public License (EPL).
+
+#include <cassert>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+
+#include "CoinMemoryPolicy.hpp"
+#include "CoinTypes.hpp"
+
+#if defined(__linux__)
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#define COIN_MEMORY_POLICY_MMAP 1
+#endif
+
+//#############################################################################
+
+namespace {
+  int policyDefault = CoinMemoryPolicy::standard;
+  // 2Mb - below that huge pages make no sense
+  size_t policyThreshold = 2*1024*1024;
+}
+
+// Arrays start 64 bytes after header
+#define COIN_POLICY_HEADER 64
+#define COIN_POLICY_MAGIC 0x436f696e
+#define COIN_HUGE_PAGE (2*1024*1024)
+
+namespace {
+  struct CoinPolicyHeader {
+    /// What to free or unmap
+    char * base;
+    /// Bytes mapped (0 if from malloc)
+    size_t mapped;
+    int policy;
+    int magic;
+  };
+  inline CoinPolicyHeader * coinPolicyHeader(const void * array)
+  {
+    return reinterpret_cast<CoinPolicyHeader *>
+      (static_cast<char *>(const_cast<void *>(array))-sizeof(CoinPolicyHeader));
+  }
+}
+
+#ifdef COIN_MEMORY_POLICY_MMAP
+// Node mask of online NUMA nodes - returns number of bits to pass (0 if none)
+static int
+coinOnlineNodes(unsigned long * mask, int numberWords)
+{
+  FILE * fp = fopen("/sys/devices/system/node/online","r");
+  if (!fp)
+    return 0;
+  const int bitsPerWord = 8*static_cast<int>(sizeof(unsigned long));
+  const int maxBits = numberWords*bitsPerWord-1;
+  int highest = -1;
+  int first, last;
+  char separator;
+  for (int i=0;i<numberWords;i++)
+    mask[i] = 0;
+  while (fscanf(fp,"%d",&first)==1) {
+    last = first;
+    separator = static_cast<char>(fgetc(fp));
+    if (separator=='-') {
+      if (fscanf(fp,"%d",&last)!=1)
+	break;
+      separator = static_cast<char>(fgetc(fp));
+    }
+    for (int j=first;j<=last&&j<maxBits;j++) {
+      mask[j/bitsPerWord] |= 1UL<<(j%bitsPerWord);
+      highest = j;
+    }
+    if (separator!=',')
+      break;
+  }
+  fclose(fp);
+  return highest+2;
+}
+
+// Map memory following policy (NULL if mmap fails)
+static char *
+coinPolicyMap(size_t numberBytes, int policy, size_t & mapped, int & used)
+{
+  char * base = NULL;
+  used = CoinMemoryPolicy::firstTouch;
+#ifdef MAP_HUGETLB
+  if ((policy&CoinMemoryPolicy::explicitHugePages)!=0) {
+    mapped = ((numberBytes+COIN_HUGE_PAGE-1)/COIN_HUGE_PAGE)*COIN_HUGE_PAGE;
+    void * address = mmap(NULL,mapped,PROT_READ|PROT_WRITE,
+			  MAP_PRIVATE|MAP_ANONYMOUS|MAP_HUGETLB,-1,0);
+    if (address!=MAP_FAILED) {
+      base = static_cast<char *>(address);
+      used |= CoinMemoryPolicy::explicitHugePages;
+    }
+  }
+#endif
+  if (!base) {
+    long pageSize = sysconf(_SC_PAGESIZE);
+    if (pageSize<=0)
+      pageSize = 4096;
+    mapped = ((numberBytes+pageSize-1)/pageSize)*pageSize;
+    if ((policy&(CoinMemoryPolicy::hugePages|
+		 CoinMemoryPolicy::explicitHugePages))!=0) {
+      // map extra and trim so start is on huge page boundary
+      size_t extra = mapped+COIN_HUGE_PAGE;
+      void * address = mmap(NULL,extra,PROT_READ|PROT_WRITE,
+			    MAP_PRIVATE|MAP_ANONYMOUS,-1,0);
+      if (address==MAP_FAILED)
+	return NULL;
+      char * start = static_cast<char *>(address);
+      size_t offset = reinterpret_cast<size_t>(start)&(COIN_HUGE_PAGE-1);
+      size_t head = offset ? COIN_HUGE_PAGE-offset : 0;
+      if (head)
+	munmap(start,head);
+      base = start+head;
+      if (extra-head>mapped)
+	munmap(base+mapped,extra-head-mapped);
+#ifdef MADV_HUGEPAGE
+      if (!madvise(base,mapped,MADV_HUGEPAGE))
+	used |= CoinMemoryPolicy::hugePages;
+#endif
+    } else {
+      void * address = mmap(NULL,mapped,PROT_READ|PROT_WRITE,
+			    MAP_PRIVATE|MAP_ANONYMOUS,-1,0);
+      if (address==MAP_FAILED)
+	return NULL;
+      base = static_cast<char *>(address);
+    }
+  }
+#ifdef SYS_mbind
+  if ((policy&CoinMemoryPolicy::interleave)!=0) {
+    unsigned long mask[16];
+    int maxNode = coinOnlineNodes(mask,16);
+    // MPOL_INTERLEAVE is 3
+    if (maxNode>2&&!syscall(SYS_mbind,base,mapped,3,mask,maxNode,0))
+      used |= CoinMemoryPolicy::interleave;
+  }
+#endif
+  return base;
+}
+#endif
+
+//#############################################################################
+
+void *
+CoinMemoryPolicy::allocate(size_t numberBytes, int policy)
+{
+  if (policy<0)
+    policy = policyDefault;
+  size_t total = numberBytes+2*COIN_POLICY_HEADER;
+  char * base = NULL;
+  size_t mapped = 0;
+  int used = standard;
+#ifdef COIN_MEMORY_POLICY_MMAP
+  if (policy&&numberBytes>=policyThreshold) {
+    base = coinPolicyMap(total,policy,mapped,used);
+    if (!base) {
+      mapped = 0;
+      used = standard;
+    }
+  }
+#endif
+  if (!base) {
+    base = static_cast<char *>(malloc(total));
+    if (!base)
+      throw std::bad_alloc();
+  }
+  // align array on 64 bytes with header in front
+  CoinInt64 xx = reinterpret_cast<CoinInt64>(base+COIN_POLICY_HEADER);
+  int iBottom = static_cast<int>(xx & (COIN_POLICY_HEADER-1));
+  char * array = base+COIN_POLICY_HEADER;
+  if (iBottom)
+    array += COIN_POLICY_HEADER-iBottom;
+  CoinPolicyHeader * header = coinPolicyHeader(array);
+  header->base = base;
+  header->mapped = mapped;
+  header->policy = used;
+  header->magic = COIN_POLICY_MAGIC;
+  return array;
+}
+
+void
+CoinMemoryPolicy::release(void * array)
+{
+  if (array) {
+    CoinPolicyHeader * header = coinPolicyHeader(array);
+    assert (header->magic==COIN_POLICY_MAGIC);
+    header->magic = 0;
+#ifdef COIN_MEMORY_POLICY_MMAP
+    if (header->mapped) {
+      munmap(header->base,header->mapped);
+      return;
+    }
+#endif
+    free(header->base);
+  }
+}
+
+int
+CoinMemoryPolicy::policyUsed(const void * array)
+{
+  return array ? coinPolicyHeader(array)->policy : standard;
+}
+
+int
+CoinMemoryPolicy::defaultPolicy()
+{
+  return policyDefault;
+}
+
+void
+CoinMemoryPolicy::setDefaultPolicy(int policy)
+{
+  policyDefault = policy;
+}
+
+size_t
+CoinMemoryPolicy::threshold()
+{
+  return policyThreshold;
+}
+
+void
+CoinMemoryPolicy::setThreshold(size_t numberBytes)
+{
+  policyThreshold = numberBytes;
+}
+
+int
+CoinMemoryPolicy::available()
+{
+  int value = standard;
+#ifdef COIN_MEMORY_POLICY_MMAP
+  value |= firstTouch;
+#ifdef MADV_HUGEPAGE
+  value |= hugePages;
+#endif
+#ifdef MAP_HUGETLB
+  value |= explicitHugePages;
+#endif
+#ifdef SYS_mbind
+  unsigned long mask[16];
+  if (coinOnlineNodes(mask,16)>2)
+    value |= interleave;
+#endif
+#endif
+  return value;
+}
@@ -0,0 +1,70 @@
+/* $Id$ */
+// Copyright (C) 2012, International Business Machines
+// Corporation and others.  All Rights Reserved.
+// This code is licensed under the terms of the Eclipse Public License (EPL).
+
+#ifndef CoinMemoryPolicy_H
+#define CoinMemoryPolicy_H
+
+#include <cstddef>
+
+#include "CoinUtilsConfig.h"
+
+/** Placement of large arrays.
+
+    Large arrays (CoinPackedMatrix elements and indices, CoinArrayWithLength
+    work arrays) can be given a policy which says how their memory should
+    be obtained:
+    - hugePages - ask for transparent huge pages (madvise)
+    - explicitHugePages - map from the huge page pool (MAP_HUGETLB), using
+      transparent huge pages if none are reserved
+    - interleave - spread pages over all NUMA nodes
+    - firstTouch - pages are not touched when obtained, so each lands on
+      the node of the thread which first writes it.
+
+    Policies apply to arrays of at least threshold() bytes and only where
+    the operating system supports them (Linux mmap, madvise and mbind);
+    anything else is allocated normally.  An array obtained through
+    allocate() must be given back through release().
+
+    Objects created with policy -1 use defaultPolicy() (initially
+    standard).
+*/
+class CoinMemoryPolicy {
+public:
+  /// Policies (may be or'ed together)
+  enum Policy {
+    standard = 0,
+    hugePages = 1,
+    explicitHugePages = 2,
+    interleave = 4,
+    firstTouch = 8
+  };
+
+  /**@name Arrays */
+  //@{
+  /** Get array of numberBytes aligned on 64 bytes.  If policy is -1
+      the default policy is used */
+  static void * allocate(size_t numberBytes, int policy = -1);
+  /// Give back array from allocate (NULL allowed)
+  static void release(void * array);
+  /// Policy which array actually got (may be less than asked for)
+  static int policyUsed(const void * array);
+  //@}
+
+  /**@name Settings */
+  //@{
+  /// Default policy
+  static int defaultPolicy();
+  /// Set default policy
+  static void setDefaultPolicy(int policy);
+  /// Arrays smaller than this (bytes) are allocated normally
+  static size_t threshold();
+  /// Set threshold in bytes
+  static void setThreshold(size_t numberBytes);
+  /// Policies which can be honoured here
+  static int available();
+  //@}
+};
+
+#endif
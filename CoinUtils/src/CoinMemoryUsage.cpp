@@ -0,0 +1,248 @@
+/* $Id$ */
+// Copyright (C) 2012, International Business Machines
+// Corporation and others.  All Rights Reserved.
+// This code is licensed under the terms of the Eclipse Public License (EPL).
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+
+#include "CoinMemoryUsage.hpp"
+
+CoinMemoryUsage::CoinMemoryUsage()
+{
+}
+
+CoinMemoryUsage::~CoinMemoryUsage()
+{
+}
+
+void
+CoinMemoryUsage::add(const char * name, CoinInt64 used, CoinInt64 reserved)
+{
+  int i = find(name);
+  if (i<0) {
+    names_.push_back(std::string(name));
+    used_.push_back(used);
+    reserved_.push_back(reserved);
+  } else {
+    used_[i] += used;
+    reserved_[i] += reserved;
+  }
+}
+
+void
+CoinMemoryUsage::add(const CoinMemoryUsage & other, const char * prefix)
+{
+  int n = other.numberEntries();
+  for (int i=0;i<n;i++) {
+    if (prefix) {
+      std::string full(prefix);
+      full += ".";
+      full += other.names_[i];
+      add(full.c_str(),other.used_[i],other.reserved_[i]);
+    } else {
+      add(other.names_[i].c_str(),other.used_[i],other.reserved_[i]);
+    }
+  }
+}
+
+void
+CoinMemoryUsage::clear()
+{
+  names_.clear();
+  used_.clear();
+  reserved_.clear();
+}
+
+int
+CoinMemoryUsage::find(const char * name) const
+{
+  int n = numberEntries();
+  for (int i=0;i<n;i++) {
+    if (names_[i]==name)
+      return i;
+  }
+  return -1;
+}
+
+CoinInt64
+CoinMemoryUsage::totalUsed() const
+{
+  CoinInt64 total = 0;
+  for (size_t i=0;i<used_.size();i++)
+    total += used_[i];
+  return total;
+}
+
+CoinInt64
+CoinMemoryUsage::totalReserved() const
+{
+  CoinInt64 total = 0;
+  for (size_t i=0;i<reserved_.size();i++)
+    total += reserved_[i];
+  return total;
+}
+
+void
+CoinMemoryUsage::print() const
+{
+  int n = numberEntries();
+  for (int i=0;i<n;i++) {
+    printf("%-24s %12.0f used %12.0f reserved\n",names_[i].c_str(),
+	   static_cast<double>(used_[i]),static_cast<double>(reserved_[i]));
+  }
+  printf("%-24s %12.0f used %12.0f reserved\n","Total",
+	 static_cast<double>(totalUsed()),static_cast<double>(totalReserved()));
+}
+
+//#############################################################################
+// Allocation tracking
+//#############################################################################
+
+#if defined(COINUTILS_MEMORY_TRACKING) && (COINUTILS_MEMORY_TRACKING == 1)
+
+#if defined(COINUTILS_MEMPOOL_OVERRIDE_NEW) && (COINUTILS_MEMPOOL_OVERRIDE_NEW == 1)
+#error "COINUTILS_MEMORY_TRACKING cannot be used with COINUTILS_MEMPOOL_OVERRIDE_NEW"
+#endif
+
+namespace {
+  CoinInt64 trackCurrent = 0;
+  CoinInt64 trackHighWater = 0;
+  CoinInt64 trackAllocations = 0;
+  CoinInt64 trackLimit = 0;
+  CoinMemoryTracker::highWaterHook trackHook = NULL;
+}
+
+// Size is kept in front of block; keep this a multiple of malloc alignment
+#define COIN_TRACK_HEADER 16
+
+#ifdef __GNUC__
+#define COIN_TRACK_ADD(x,y) __sync_add_and_fetch(&(x),(y))
+#else
+#define COIN_TRACK_ADD(x,y) ((x) += (y))
+#endif
+
+static void *
+coinTrackedAlloc(std::size_t sz)
+{
+  CoinInt64 size = static_cast<CoinInt64>(sz);
+  if (trackLimit && trackCurrent+size>trackLimit)
+    return NULL;
+  char * p = static_cast<char *>(malloc(sz+COIN_TRACK_HEADER));
+  if (!p)
+    return NULL;
+  *reinterpret_cast<CoinInt64 *>(p) = size;
+  CoinInt64 now = COIN_TRACK_ADD(trackCurrent,size);
+  COIN_TRACK_ADD(trackAllocations,1);
+  if (now>trackHighWater) {
+    // not exact under threads but good enough for a debug counter
+    trackHighWater = now;
+    if (trackHook)
+      trackHook(now);
+  }
+  return p+COIN_TRACK_HEADER;
+}
+
+static void
+coinTrackedFree(void * p)
+{
+  if (p) {
+    char * block = static_cast<char *>(p)-COIN_TRACK_HEADER;
+    COIN_TRACK_ADD(trackCurrent,-*reinterpret_cast<CoinInt64 *>(block));
+    free(block);
+  }
+}
+
+#if __cplusplus >= 201103L
+#define COIN_TRACK_THROW
+#define COIN_TRACK_NOTHROW noexcept
+#else
+#define COIN_TRACK_THROW throw (std::bad_alloc)
+#define COIN_TRACK_NOTHROW throw()
+#endif
+
+void* operator new(std::size_t sz) COIN_TRACK_THROW
+{
+  void * p = coinTrackedAlloc(sz);
+  if (!p)
+    throw std::bad_alloc();
+  return p;
+}
+
+void* operator new[](std::size_t sz) COIN_TRACK_THROW
+{
+  void * p = coinTrackedAlloc(sz);
+  if (!p)
+    throw std::bad_alloc();
+  return p;
+}
+
+void operator delete(void* p) COIN_TRACK_NOTHROW
+{
+  coinTrackedFree(p);
+}
+
+void operator delete[](void* p) COIN_TRACK_NOTHROW
+{
+  coinTrackedFree(p);
+}
+
+void* operator new(std::size_t sz, const std::nothrow_t&) COIN_TRACK_NOTHROW
+{
+  return coinTrackedAlloc(sz);
+}
+
+void* operator new[](std::size_t sz, const std::nothrow_t&) COIN_TRACK_NOTHROW
+{
+  return coinTrackedAlloc(sz);
+}
+
+void operator delete(void* p, const std::nothrow_t&) COIN_TRACK_NOTHROW
+{
+  coinTrackedFree(p);
+}
+
+void operator delete[](void* p, const std::nothrow_t&) COIN_TRACK_NOTHROW
+{
+  coinTrackedFree(p);
+}
+
+bool CoinMemoryTracker::active()
+{ return true; }
+CoinInt64 CoinMemoryTracker::current()
+{ return trackCurrent; }
+CoinInt64 CoinMemoryTracker::highWater()
+{ return trackHighWater; }
+void CoinMemoryTracker::resetHighWater()
+{ trackHighWater = trackCurrent; }
+CoinInt64 CoinMemoryTracker::numberAllocations()
+{ return trackAllocations; }
+void CoinMemoryTracker::setLimit(CoinInt64 limit)
+{ trackLimit = limit; }
+CoinInt64 CoinMemoryTracker::limit()
+{ return trackLimit; }
+void CoinMemoryTracker::setHighWaterHook(highWaterHook hook)
+{ trackHook = hook; }
+
+#else
+
+bool CoinMemoryTracker::active()
+{ return false; }
+CoinInt64 CoinMemoryTracker::current()
+{ return 0; }
+CoinInt64 CoinMemoryTracker::highWater()
+{ return 0; }
+void CoinMemoryTracker::resetHighWater()
+{ }
+CoinInt64 CoinMemoryTracker::numberAllocations()
+{ return 0; }
+void CoinMemoryTracker::setLimit(CoinInt64 )
+{ }
+CoinInt64 CoinMemoryTracker::limit()
+{ return 0; }
+void CoinMemoryTracker::setHighWaterHook(highWaterHook )
+{ }
+
+#endif
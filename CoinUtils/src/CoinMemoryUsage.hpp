@@ -0,0 +1,122 @@
+/* $Id$ */
+// Copyright (C) 2012, International Business Machines
+// Corporation and others.  All Rights Reserved.
+// This code is licensed under the terms of the Eclipse Public License (EPL).
+
+#ifndef CoinMemoryUsage_H
+#define CoinMemoryUsage_H
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+#include "CoinUtilsConfig.h"
+#include "CoinTypes.hpp"
+
+/** Memory footprint of an object.
+
+    Filled in by the memoryUsage() methods of the larger CoinUtils classes
+    (CoinPackedMatrix, CoinIndexedVector, CoinFactorization, CoinModel,
+    CoinMpsIO, CoinPresolveMatrix).  One entry is kept for each internal
+    array, giving the bytes actually in use and the bytes allocated, so
+    slack left by extra gaps, area factors or growth can be seen.  Reports
+    are additive, so a caller can collect several objects into one.
+*/
+class CoinMemoryUsage {
+public:
+  /**@name Constructors and destructor */
+  //@{
+  /// Default constructor - empty report
+  CoinMemoryUsage();
+  /// Destructor
+  ~CoinMemoryUsage();
+  //@}
+
+  /**@name Adding entries */
+  //@{
+  /** Add an entry. \p used and \p reserved are in bytes.
+      An entry with the same name has the counts added to it. */
+  void add(const char * name, CoinInt64 used, CoinInt64 reserved);
+  /// Add an array entry given as number of elements of size \p elementSize
+  inline void addArray(const char * name, CoinInt64 numberUsed,
+		       CoinInt64 numberReserved, int elementSize)
+  { add(name, numberUsed*elementSize, numberReserved*elementSize); }
+  /** Add all entries of another report.  If \p prefix is not NULL each
+      name becomes prefix.name */
+  void add(const CoinMemoryUsage & other, const char * prefix = NULL);
+  /// Remove all entries
+  void clear();
+  //@}
+
+  /**@name Queries */
+  //@{
+  /// Number of entries
+  inline int numberEntries() const
+  { return static_cast<int>(names_.size()); }
+  /// Name of entry \p i
+  inline const char * name(int i) const
+  { return names_[i].c_str(); }
+  /// Bytes in use for entry \p i
+  inline CoinInt64 used(int i) const
+  { return used_[i]; }
+  /// Bytes allocated for entry \p i
+  inline CoinInt64 reserved(int i) const
+  { return reserved_[i]; }
+  /// Entry number of \p name or -1 if not there
+  int find(const char * name) const;
+  /// Total bytes in use
+  CoinInt64 totalUsed() const;
+  /// Total bytes allocated
+  CoinInt64 totalReserved() const;
+  /// Print one line per entry and totals to stdout
+  void print() const;
+  //@}
+
+private:
+  /// Names of entries
+  std::vector<std::string> names_;
+  /// Bytes in use
+  std::vector<CoinInt64> used_;
+  /// Bytes allocated
+  std::vector<CoinInt64> reserved_;
+};
+
+/** Debug allocation tracking.
+
+    If CoinUtils is compiled with COINUTILS_MEMORY_TRACKING defined to 1
+    (e.g. by adding -DCOINUTILS_MEMORY_TRACKING=1 to CXXFLAGS), global
+    operator new and delete are replaced so that the bytes currently
+    allocated and the high-water mark are recorded.  A limit may then be set
+    above which allocation throws std::bad_alloc, and a hook can be called
+    on every new high-water mark.  It cannot be combined with
+    COINUTILS_MEMPOOL_OVERRIDE_NEW.
+
+    Without tracking all queries return 0 and setting a limit or hook does
+    nothing, so callers need not test the macro.
+*/
+class CoinMemoryTracker {
+public:
+  /** Hook called when the high-water mark rises. Argument is the new
+      high-water mark in bytes.  It must not allocate memory. */
+  typedef void (*highWaterHook)(CoinInt64 highWater);
+
+  /// True if library was built with allocation tracking
+  static bool active();
+  /// Bytes currently allocated through operator new
+  static CoinInt64 current();
+  /// Largest value of current() since start or last reset
+  static CoinInt64 highWater();
+  /// Set high-water mark back to current()
+  static void resetHighWater();
+  /// Number of calls to operator new
+  static CoinInt64 numberAllocations();
+  /** Set limit in bytes (0 for none).  An allocation which would take
+      current() above this throws std::bad_alloc */
+  static void setLimit(CoinInt64 limit);
+  /// Current limit (0 for none)
+  static CoinInt64 limit();
+  /// Set high-water hook (NULL for none)
+  static void setHighWaterHook(highWaterHook hook);
+};
+
+#endif
@@ -9,6 +9,7 @@
 #include "CoinSort.hpp"
 #include "CoinMpsIO.hpp"
 #include "CoinFloatEqual.hpp"
+#include "CoinMemoryUsage.hpp"
 
 //#############################################################################
 // Constructors / Destructor / Assignment
@@ -695,6 +696,77 @@ CoinModel::operator=(const CoinModel& rhs)
   }
   return *this;
 }
+#if __cplusplus >= 201103L
+CoinModel::CoinModel (CoinModel && rhs) noexcept
+  : CoinModel()
+{
+  swap(rhs);
+}
+CoinModel &
+CoinModel::operator=(CoinModel && rhs) noexcept
+{
+  if (this != &rhs)
+    swap(rhs);
+  return *this;
+}
+#endif
+// Exchanges everything with other (no copying)
+void
+CoinModel::swap(CoinModel & other)
+{
+  std::swap(numberRows_,other.numberRows_);
+  std::swap(numberColumns_,other.numberColumns_);
+  std::swap(optimizationDirection_,other.optimizationDirection_);
+  std::swap(objectiveOffset_,other.objectiveOffset_);
+  std::swap(logLevel_,other.logLevel_);
+  problemName_.swap(other.problemName_);
+  rowBlockName_.swap(other.rowBlockName_);
+  columnBlockName_.swap(other.columnBlockName_);
+  rowName_.swap(other.rowName_);
+  columnName_.swap(other.columnName_);
+  string_.swap(other.string_);
+  hashElements_.swap(other.hashElements_);
+  rowList_.swap(other.rowList_);
+  columnList_.swap(other.columnList_);
+  hashQuadraticElements_.swap(other.hashQuadraticElements_);
+  quadraticRowList_.swap(other.quadraticRowList_);
+  quadraticColumnList_.swap(other.quadraticColumnList_);
+  std::swap(maximumRows_,other.maximumRows_);
+  std::swap(maximumColumns_,other.maximumColumns_);
+  std::swap(numberElements_,other.numberElements_);
+  std::swap(maximumElements_,other.maximumElements_);
+  std::swap(numberQuadraticElements_,other.numberQuadraticElements_);
+  std::swap(maximumQuadraticElements_,other.maximumQuadraticElements_);
+  std::swap(rowLower_,other.rowLower_);
+  std::swap(rowUpper_,other.rowUpper_);
+  std::swap(rowType_,other.rowType_);
+  std::swap(objective_,other.objective_);
+  std::swap(columnLower_,other.columnLower_);
+  std::swap(columnUpper_,other.columnUpper_);
+  std::swap(integerType_,other.integerType_);
+  std::swap(columnType_,other.columnType_);
+  std::swap(start_,other.start_);
+  std::swap(elements_,other.elements_);
+  std::swap(packedMatrix_,other.packedMatrix_);
+  std::swap(quadraticElements_,other.quadraticElements_);
+  std::swap(sortIndices_,other.sortIndices_);
+  std::swap(sortElements_,other.sortElements_);
+  std::swap(sortSize_,other.sortSize_);
+  std::swap(sizeAssociated_,other.sizeAssociated_);
+  std::swap(associated_,other.associated_);
+  std::swap(numberSOS_,other.numberSOS_);
+  std::swap(startSOS_,other.startSOS_);
+  std::swap(memberSOS_,other.memberSOS_);
+  std::swap(typeSOS_,other.typeSOS_);
+  std::swap(prioritySOS_,other.prioritySOS_);
+  std::swap(referenceSOS_,other.referenceSOS_);
+  std::swap(priority_,other.priority_);
+  std::swap(cut_,other.cut_);
+  std::swap(moreInfo_,other.moreInfo_);
+  std::swap(type_,other.type_);
+  std::swap(noNames_,other.noNames_);
+  std::swap(links_,other.links_);
+}
 /* add a row -  numberInRow may be zero */
 void 
 CoinModel::addRow(int numberInRow, const int * columns,
@@ -2975,6 +3047,80 @@ CoinModel::resize(int maximumRows, int maximumColumns, int maximumElements)
     }
   }
 }
+// Adds memory usage to report
+void
+CoinModel::memoryUsage(CoinMemoryUsage & usage) const
+{
+  const int sizeDouble = static_cast<int>(sizeof(double));
+  const int sizeInt = static_cast<int>(sizeof(int));
+  int maximumRows = rowLower_ ? maximumRows_ : 0;
+  int maximumColumns = objective_ ? maximumColumns_ : 0;
+  usage.addArray("rowLower",numberRows_,maximumRows,sizeDouble);
+  usage.addArray("rowUpper",numberRows_,maximumRows,sizeDouble);
+  usage.addArray("rowType",numberRows_,maximumRows,sizeInt);
+  usage.addArray("objective",numberColumns_,maximumColumns,sizeDouble);
+  usage.addArray("columnLower",numberColumns_,maximumColumns,sizeDouble);
+  usage.addArray("columnUpper",numberColumns_,maximumColumns,sizeDouble);
+  usage.addArray("integerType",numberColumns_,maximumColumns,sizeInt);
+  usage.addArray("columnType",numberColumns_,maximumColumns,sizeInt);
+  if (start_) {
+    if (type_==0)
+      usage.addArray("start",numberRows_+1,maximumRows_+1,sizeInt);
+    else
+      usage.addArray("start",numberColumns_+1,maximumColumns_+1,sizeInt);
+  }
+  if (elements_)
+    usage.addArray("elements",numberElements_,maximumElements_,
+		   static_cast<int>(sizeof(CoinModelTriple)));
+  if (quadraticElements_)
+    usage.addArray("quadraticElements",numberQuadraticElements_,
+		   maximumQuadraticElements_,
+		   static_cast<int>(sizeof(CoinModelTriple)));
+  CoinMemoryUsage part;
+  rowName_.memoryUsage(part);
+  usage.add(part,"rowName");
+  part.clear();
+  columnName_.memoryUsage(part);
+  usage.add(part,"columnName");
+  part.clear();
+  string_.memoryUsage(part);
+  usage.add(part,"string");
+  part.clear();
+  hashElements_.memoryUsage(part);
+  usage.add(part,"hashElements");
+  part.clear();
+  rowList_.memoryUsage(part);
+  usage.add(part,"rowList");
+  part.clear();
+  columnList_.memoryUsage(part);
+  usage.add(part,"columnList");
+  part.clear();
+  hashQuadraticElements_.memoryUsage(part);
+  quadraticRowList_.memoryUsage(part);
+  quadraticColumnList_.memoryUsage(part);
+  usage.add(part,"quadratic");
+  if (packedMatrix_) {
+    part.clear();
+    packedMatrix_->memoryUsage(part);
+    usage.add(part,"packedMatrix");
+  }
+  if (sortIndices_) {
+    usage.addArray("sortIndices",sortSize_,sortSize_,sizeInt);
+    usage.addArray("sortElements",sortSize_,sortSize_,sizeDouble);
+  }
+  if (associated_)
+    usage.addArray("associated",sizeAssociated_,sizeAssociated_,sizeDouble);
+  if (numberSOS_) {
+    int numberMembers = startSOS_[numberSOS_];
+    usage.addArray("SOS",3*numberSOS_+1+numberMembers,
+		   3*numberSOS_+1+numberMembers,sizeInt);
+    usage.addArray("SOSreference",numberMembers,numberMembers,sizeDouble);
+  }
+  if (priority_)
+    usage.addArray("priority",numberColumns_,maximumColumns_,sizeInt);
+  if (cut_)
+    usage.addArray("cut",numberRows_,maximumRows_,sizeInt);
+}
 void
 CoinModel::fillRows(int whichRow, bool forceCreation,bool fromAddRow)
 {
@@ -2987,8 +3133,8 @@ CoinModel::fillRows(int whichRow, bool forceCreation,bool fromAddRow)
       type_=2;
     }
     if (!rowLower_) {
-      // need to set all
-      whichRow = numberRows_-1;
+      // need to set all (and whichRow)
+      whichRow = CoinMax(whichRow,numberRows_-1);
       numberRows_=0;
       if (type_!=3)
 	resize(CoinMax(100,whichRow+1),0,0);
@@ -3035,8 +3181,8 @@ CoinModel::fillColumns(int whichColumn,bool forceCreation,bool fromAddColumn)
       type_=2;
     }
     if (!objective_) {
-      // need to set all
-      whichColumn = numberColumns_-1;
+      // need to set all (and whichColumn)
+      whichColumn = CoinMax(whichColumn,numberColumns_-1);
       numberColumns_=0;
       if (type_!=3)
 	resize(0,CoinMax(100,whichColumn+1),0);
@@ -3773,8 +3919,25 @@ void
 CoinModel::passInMatrix(const CoinPackedMatrix & matrix)
 {
   type_=3;
+  delete packedMatrix_;
   packedMatrix_ = new CoinPackedMatrix(matrix);
 }
+#if __cplusplus >= 201103L
+void 
+CoinModel::passInMatrix(CoinPackedMatrix && matrix)
+{
+  takeMatrix(matrix);
+}
+#endif
+// Passes in matrix by taking its arrays
+void 
+CoinModel::takeMatrix(CoinPackedMatrix & matrix)
+{
+  type_=3;
+  delete packedMatrix_;
+  packedMatrix_ = new CoinPackedMatrix();
+  packedMatrix_->swap(matrix);
+}
 // Convert elements to CoinPackedMatrix (and switch off element updates)
 int 
 CoinModel::convertMatrix()
@@ -3789,8 +3952,7 @@ CoinModel::convertMatrix()
     }
     CoinPackedMatrix matrix;
     createPackedMatrix(matrix,associated_);
-    packedMatrix_ = new CoinPackedMatrix(matrix);
-    type_=3;
+    takeMatrix(matrix);
   }
   return numberErrors;
 }
@@ -3876,14 +4038,45 @@ CoinModel::loadBlock(const CoinPackedMatrix& matrix,
 				   const double* obj,
 				   const double* rowlb, const double* rowub)
 {
+  loadBlockBounds(matrix.getNumRows(), matrix.getNumCols(),
+		  collb, colub, obj, rowlb, rowub);
   passInMatrix(matrix);
-  int numberRows=matrix.getNumRows();
-  int numberColumns=matrix.getNumCols();
-  setObjective(numberColumns,obj);
-  setRowLower(numberRows,rowlb);
-  setRowUpper(numberRows,rowub);
-  setColumnLower(numberColumns,collb);
-  setColumnUpper(numberColumns,colub);
+}
+
+//-----------------------------------------------------------------------------
+// Sets bounds and objective for loadBlock (any may be NULL).
+// Done before matrix is passed in as arrays can not grow in block mode
+
+void
+CoinModel::loadBlockBounds(int numberRows, int numberColumns,
+			   const double* collb, const double* colub,   
+			   const double* obj,
+			   const double* rowlb, const double* rowub)
+{
+  for (int i = 0; i < numberColumns; i++) {
+    setColumnBounds(i, collb ? collb[i] : 0.0,
+		    colub ? colub[i] : COIN_DBL_MAX);
+    setColumnObjective(i, obj ? obj[i] : 0.0);
+  }
+  for (int i = 0; i < numberRows; i++) 
+    setRowBounds(i, rowlb ? rowlb[i] : -COIN_DBL_MAX,
+		 rowub ? rowub[i] : COIN_DBL_MAX);
+}
+
+//-----------------------------------------------------------------------------
+// Converts sense/rhs/range (any may be NULL) to row bounds
+
+void
+CoinModel::convertSense(int numberRows, const char* rowsen,
+			const double* rowrhs, const double* rowrng,
+			double* rowlb, double* rowub) const
+{
+  for (int i = 0; i < numberRows; i++) {
+    convertSenseToBound(rowsen ? rowsen[i] : 'G',
+			rowrhs ? rowrhs[i] : 0.0,
+			rowrng ? rowrng[i] : 0.0,
+			rowlb[i],rowub[i]);
+  }
 }
 
 //-----------------------------------------------------------------------------
@@ -3895,40 +4088,10 @@ CoinModel::loadBlock(const CoinPackedMatrix& matrix,
 				   const char* rowsen, const double* rowrhs,   
 				   const double* rowrng)
 {
-  // If any of Rhs NULLs then create arrays
   int numrows = matrix.getNumRows();
-  const char * rowsenUse = rowsen;
-  if (!rowsen) {
-    char * rowsen = new char [numrows];
-    for (int i=0;i<numrows;i++)
-      rowsen[i]='G';
-    rowsenUse = rowsen;
-  } 
-  const double * rowrhsUse = rowrhs;
-  if (!rowrhs) {
-    double * rowrhs = new double [numrows];
-    for (int i=0;i<numrows;i++)
-      rowrhs[i]=0.0;
-    rowrhsUse = rowrhs;
-  }
-  const double * rowrngUse = rowrng;
-  if (!rowrng) {
-    double * rowrng = new double [numrows];
-    for (int i=0;i<numrows;i++)
-      rowrng[i]=0.0;
-    rowrngUse = rowrng;
-  }
   double * rowlb = new double[numrows];
   double * rowub = new double[numrows];
-  for (int i = numrows-1; i >= 0; --i) {   
-    convertSenseToBound(rowsenUse[i],rowrhsUse[i],rowrngUse[i],rowlb[i],rowub[i]);
-  }
-  if (rowsen!=rowsenUse)
-    delete [] rowsenUse;
-  if (rowrhs!=rowrhsUse)
-    delete [] rowrhsUse;
-  if (rowrng!=rowrngUse)
-    delete [] rowrngUse;
+  convertSense(numrows, rowsen, rowrhs, rowrng, rowlb, rowub);
   loadBlock(matrix, collb, colub, obj, rowlb, rowub);
   delete [] rowlb;
   delete [] rowub;
@@ -3936,6 +4099,41 @@ CoinModel::loadBlock(const CoinPackedMatrix& matrix,
 
 //-----------------------------------------------------------------------------
 
+#if __cplusplus >= 201103L
+void
+CoinModel::loadBlock(CoinPackedMatrix&& matrix,
+		     const double* collb, const double* colub,   
+		     const double* obj,
+		     const double* rowlb, const double* rowub)
+{
+  loadBlockBounds(matrix.getNumRows(), matrix.getNumCols(),
+		  collb, colub, obj, rowlb, rowub);
+  takeMatrix(matrix);
+}
+
+//-----------------------------------------------------------------------------
+
+void
+CoinModel::loadBlock(CoinPackedMatrix&& matrix,
+		     const double* collb, const double* colub,
+		     const double* obj,
+		     const char* rowsen, const double* rowrhs,   
+		     const double* rowrng)
+{
+  int numrows = matrix.getNumRows();
+  double * rowlb = new double[numrows];
+  double * rowub = new double[numrows];
+  convertSense(numrows, rowsen, rowrhs, rowrng, rowlb, rowub);
+  loadBlockBounds(matrix.getNumRows(), matrix.getNumCols(),
+		  collb, colub, obj, rowlb, rowub);
+  takeMatrix(matrix);
+  delete [] rowlb;
+  delete [] rowub;
+}
+#endif
+
+//-----------------------------------------------------------------------------
+
 void
 CoinModel::loadBlock(const int numcols, const int numrows,
 		     const CoinBigIndex * start, const int* index,
@@ -3950,7 +4148,9 @@ CoinModel::loadBlock(const int numcols, const int numrows,
     length[i]=start[i+1]-start[i];
   CoinPackedMatrix matrix(true,numrows,numcols,numberElements,value,
 			  index,start,length,0.0,0.0);
-  loadBlock(matrix, collb, colub, obj, rowlb, rowub);
+  loadBlockBounds(matrix.getNumRows(), matrix.getNumCols(),
+		  collb, colub, obj, rowlb, rowub);
+  takeMatrix(matrix);
   delete [] length;
 }
 //-----------------------------------------------------------------------------
@@ -4003,7 +4203,9 @@ CoinModel::loadBlock(const int numcols, const int numrows,
     length[i]=start[i+1]-start[i];
   CoinPackedMatrix matrix(true,numrows,numcols,numberElements,value,
 			  index,start,length,0.0,0.0);
-  loadBlock(matrix, collb, colub, obj, rowlb, rowub);
+  loadBlockBounds(matrix.getNumRows(), matrix.getNumCols(),
+		  collb, colub, obj, rowlb, rowub);
+  takeMatrix(matrix);
   delete [] length;
   delete[] rowlb;
   delete[] rowub;
@@ -416,6 +416,10 @@ public:
    //@{
   /// Pass in CoinPackedMatrix (and switch off element updates)
   void passInMatrix(const CoinPackedMatrix & matrix);
+#if __cplusplus >= 201103L
+  /// As passInMatrix but takes arrays of matrix (which is left empty)
+  void passInMatrix(CoinPackedMatrix && matrix);
+#endif
   /** Convert elements to CoinPackedMatrix (and switch off element updates).
       Returns number of errors */
   int convertMatrix();
@@ -439,6 +443,10 @@ public:
    /// Return  elements as triples
   inline const CoinModelTriple * elements() const
   { return elements_;}
+  /** Adds bytes used and allocated for each internal array to \p usage.
+      Row arrays are allocated for maximumRows, column arrays for
+      maximumColumns and elements for maximumElements. */
+  void memoryUsage(CoinMemoryUsage & usage) const;
   /// Returns value for row i and column j
   inline double operator() (int i,int j) const
   { return getElement(i,j);}
@@ -770,6 +778,21 @@ public:
 		  const double* obj,
 		  const char* rowsen, const double* rowrhs,   
 		  const double* rowrng) ;
+#if __cplusplus >= 201103L
+  /** As loadBlock with rowlb and rowub but takes arrays of matrix
+      (which is left empty) rather than copying them */
+  void loadBlock (CoinPackedMatrix&& matrix,
+		  const double* collb, const double* colub,   
+		  const double* obj,
+		  const double* rowlb, const double* rowub) ;
+  /** As loadBlock with rowsen, rowrhs and rowrng but takes arrays of
+      matrix (which is left empty) rather than copying them */
+  void loadBlock (CoinPackedMatrix&& matrix,
+		  const double* collb, const double* colub,
+		  const double* obj,
+		  const char* rowsen, const double* rowrhs,   
+		  const double* rowrng) ;
+#endif
   
   /*! \brief Load in a problem by copying the arguments. The constraint
     matrix is is specified with standard column-major
@@ -844,6 +867,15 @@ public:
    CoinModel(const CoinModel&);
   /// =
    CoinModel& operator=(const CoinModel&);
+#if __cplusplus >= 201103L
+   /** Move constructor - takes everything from rhs which is left empty.
+       An empty CoinModel allocates nothing so this cannot throw. */
+   CoinModel(CoinModel&& rhs) noexcept;
+   /// Move assignment - exchanges everything with rhs
+   CoinModel& operator=(CoinModel&& rhs) noexcept;
+#endif
+  /// Exchanges everything with other (no copying)
+  void swap(CoinModel & other);
    //@}
 
    /**@name For debug */
@@ -921,6 +953,17 @@ private:
   int decodeBit(char * phrase, char * & nextPhrase, double & coefficient, bool ifFirst) const;
   /// Aborts with message about packedMatrix
   void badType() const;
+  /// Passes in matrix by taking its arrays (matrix is left empty)
+  void takeMatrix(CoinPackedMatrix & matrix);
+  /// Sets bounds and objective for loadBlock before matrix is passed in
+  void loadBlockBounds(int numberRows, int numberColumns,
+		       const double* collb, const double* colub,
+		       const double* obj,
+		       const double* rowlb, const double* rowub);
+  /// Converts sense/rhs/range (any may be NULL) to row bounds
+  void convertSense(int numberRows, const char* rowsen,
+		    const double* rowrhs, const double* rowrng,
+		    double* rowlb, double* rowub) const;
   /**@name Data members */
    //@{
   /// Maximum number of rows
@@ -12,10 +12,12 @@
 #include <string>
 #include <cstdio>
 #include <iostream>
+#include <algorithm>
 
 #include "CoinHelperFunctions.hpp"
 
 #include "CoinModelUseful.hpp"
+#include "CoinMemoryUsage.hpp"
 
 
 //#############################################################################
@@ -158,6 +160,16 @@ CoinModelHash::operator=(const CoinModelHash& rhs)
   }
   return *this;
 }
+// Exchanges contents with other (no copying)
+void
+CoinModelHash::swap(CoinModelHash & other)
+{
+  std::swap(names_,other.names_);
+  std::swap(hash_,other.hash_);
+  std::swap(numberItems_,other.numberItems_);
+  std::swap(maximumItems_,other.maximumItems_);
+  std::swap(lastSlot_,other.lastSlot_);
+}
 // Set number of items
 void 
 CoinModelHash::setNumberItems(int number)
@@ -165,6 +177,21 @@ CoinModelHash::setNumberItems(int number)
   assert (number>=0&&number<=numberItems_);
   numberItems_=number;
 }
+// Adds memory usage to report
+void 
+CoinModelHash::memoryUsage(CoinMemoryUsage & usage) const
+{
+  CoinInt64 nameBytes=0;
+  for (int i=0;i<numberItems_;i++) {
+    if (names_[i])
+      nameBytes += strlen(names_[i])+1;
+  }
+  usage.addArray("names",numberItems_,maximumItems_,
+                 static_cast<int>(sizeof(char *)));
+  usage.add("nameStrings",nameBytes,nameBytes);
+  usage.addArray("hash",numberItems_,hash_ ? 4*maximumItems_ : 0,
+                 static_cast<int>(sizeof(CoinModelHashLink)));
+}
 // Resize hash (also re-hashs)
 void 
 CoinModelHash::resize(int maxItems,bool forceReHash)
@@ -490,6 +517,15 @@ CoinModelHash2::operator=(const CoinModelHash2& rhs)
   }
   return *this;
 }
+// Exchanges contents with other (no copying)
+void
+CoinModelHash2::swap(CoinModelHash2 & other)
+{
+  std::swap(hash_,other.hash_);
+  std::swap(numberItems_,other.numberItems_);
+  std::swap(maximumItems_,other.maximumItems_);
+  std::swap(lastSlot_,other.lastSlot_);
+}
 // Set number of items
 void 
 CoinModelHash2::setNumberItems(int number)
@@ -497,6 +533,13 @@ CoinModelHash2::setNumberItems(int number)
   assert (number>=0&&(number<=numberItems_||!numberItems_));
   numberItems_=number;
 }
+// Adds memory usage to report
+void 
+CoinModelHash2::memoryUsage(CoinMemoryUsage & usage) const
+{
+  usage.addArray("hash",numberItems_,hash_ ? 4*maximumItems_ : 0,
+                 static_cast<int>(sizeof(CoinModelHashLink)));
+}
 // Resize hash (also re-hashs)
 void 
 CoinModelHash2::resize(int maxItems, const CoinModelTriple * triples,bool forceReHash)
@@ -838,6 +881,31 @@ CoinModelLinkedList::operator=(const CoinModelLinkedList& rhs)
   }
   return *this;
 }
+// Exchanges contents with other (no copying)
+void
+CoinModelLinkedList::swap(CoinModelLinkedList & other)
+{
+  std::swap(previous_,other.previous_);
+  std::swap(next_,other.next_);
+  std::swap(first_,other.first_);
+  std::swap(last_,other.last_);
+  std::swap(numberMajor_,other.numberMajor_);
+  std::swap(maximumMajor_,other.maximumMajor_);
+  std::swap(numberElements_,other.numberElements_);
+  std::swap(maximumElements_,other.maximumElements_);
+  std::swap(type_,other.type_);
+}
+// Adds memory usage to report
+void 
+CoinModelLinkedList::memoryUsage(CoinMemoryUsage & usage) const
+{
+  if (!first_)
+    return;
+  usage.addArray("firstLast",2*(numberMajor_+1),2*(maximumMajor_+1),
+                 static_cast<int>(sizeof(int)));
+  usage.addArray("nextPrevious",2*numberElements_,2*maximumElements_,
+                 static_cast<int>(sizeof(int)));
+}
 // Resize list - for row list maxMajor is maximum rows
 void 
 CoinModelLinkedList::resize(int maxMajor,int maxElements)
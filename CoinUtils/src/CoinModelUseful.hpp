@@ -18,6 +18,8 @@
 
 #include "CoinPragma.hpp"
 
+class CoinMemoryUsage;
+
 /**
    This is for various structures/classes needed by CoinModel.
 
@@ -194,6 +196,8 @@ public:
   CoinModelHash(const CoinModelHash&);
   /// =
   CoinModelHash& operator=(const CoinModelHash&);
+  /// Exchanges contents with other (no copying)
+  void swap(CoinModelHash & other);
   //@}
 
   /**@name sizing (just increases) */
@@ -211,6 +215,8 @@ public:
   /// Names
   inline const char *const * names() const
   { return names_;}
+  /// Adds bytes used and allocated for names and hash to \p usage
+  void memoryUsage(CoinMemoryUsage & usage) const;
   //@}
 
   /**@name hashing */
@@ -267,6 +273,8 @@ public:
   CoinModelHash2(const CoinModelHash2&);
   /// =
   CoinModelHash2& operator=(const CoinModelHash2&);
+  /// Exchanges contents with other (no copying)
+  void swap(CoinModelHash2 & other);
   //@}
 
   /**@name sizing (just increases) */
@@ -281,6 +289,8 @@ public:
   /// Maximum number of items
   inline int maximumItems() const
   { return maximumItems_;}
+  /// Adds bytes used and allocated for hash to \p usage
+  void memoryUsage(CoinMemoryUsage & usage) const;
   //@}
 
   /**@name hashing */
@@ -326,6 +336,8 @@ public:
   CoinModelLinkedList(const CoinModelLinkedList&);
   /// =
   CoinModelLinkedList& operator=(const CoinModelLinkedList&);
+  /// Exchanges contents with other (no copying)
+  void swap(CoinModelLinkedList & other);
   //@}
 
   /**@name sizing (just increases) */
@@ -370,6 +382,8 @@ public:
   /// Previous array
   inline const int * previous() const
   { return previous_;}
+  /// Adds bytes used and allocated for links to \p usage
+  void memoryUsage(CoinMemoryUsage & usage) const;
   //@}
 
   /**@name does work */
@@ -17,12 +17,15 @@
 #include <string>
 #include <cstdio>
 #include <iostream>
+#include <utility>
 
 #include "CoinMpsIO.hpp"
 #include "CoinMessage.hpp"
 #include "CoinHelperFunctions.hpp"
 #include "CoinModel.hpp"
 #include "CoinSort.hpp"
+#include "CoinMemoryUsage.hpp"
+#include "CoinPlusMinusOneMatrix.hpp"
 
 //#############################################################################
 // type - 0 normal, 1 INTEL IEEE, 2 other IEEE
@@ -2751,6 +2754,7 @@ int CoinMpsIO::readMps(int & numberSets,CoinSet ** &sets)
   free ( row );
   free ( start );
   free ( element );
+  checkPlusMinusOne();
 
   handler_->message(COIN_MPS_STATS,messages_)<<problemName_
 					    <<numberRows_
@@ -2895,6 +2899,7 @@ CoinMpsIO::readGMPL(const char * modelName, const char * dataName,
   delete [] element;
   delete [] start;
   delete [] index;
+  checkPlusMinusOne();
   // Now do columns
   collower_ = reinterpret_cast<double *> (malloc ( numberColumns_ * sizeof ( double )));
   colupper_ = reinterpret_cast<double *> (malloc ( numberColumns_ * sizeof ( double )));
@@ -3511,6 +3516,7 @@ int CoinMpsIO::readGms(int & /*numberSets*/,CoinSet ** &/*sets*/)
   matrixByColumn_->reverseOrderedCopyOf(matrixByRow);
   if (!convertObjective_)
     assert (matrixByColumn_->getVectorLengths()[iObjCol]==1);
+  checkPlusMinusOne();
   
   handler_->message(COIN_MPS_STATS,messages_)<<problemName_
 					    <<numberRows_
@@ -4897,6 +4903,27 @@ const CoinPackedMatrix * CoinMpsIO::getMatrixByCol() const
   return matrixByColumn_;
 }
 
+//------------------------------------------------------------------
+// +-1 copy of the matrix (if it is one) ...
+//------------------------------------------------------------------
+const CoinPlusMinusOneMatrix * CoinMpsIO::getPlusMinusOneMatrix() const
+{
+  if (plusMinusOne_ || !foundPlusMinusOne_)
+    return plusMinusOne_;
+  // only built when asked for as column copy is kept as well
+  plusMinusOne_ = new CoinPlusMinusOneMatrix(*matrixByColumn_);
+  return plusMinusOne_;
+}
+
+// Sees if every element of matrix is +1 or -1 (drops any old copy)
+void CoinMpsIO::checkPlusMinusOne()
+{
+  delete plusMinusOne_;
+  plusMinusOne_ = NULL;
+  foundPlusMinusOne_ = matrixByColumn_ && matrixByColumn_->getNumElements() &&
+    CoinPlusMinusOneMatrix::isPlusMinusOne(*matrixByColumn_);
+}
+
 //------------------------------------------------------------------
 // Save the data ...
 //------------------------------------------------------------------
@@ -4907,16 +4934,49 @@ CoinMpsIO::setMpsDataWithoutRowAndColNames(
                                   const double* obj, const char* integrality,
                                   const double* rowlb, const double* rowub)
 {
-  freeAll();
+  CoinPackedMatrix * matrix;
+  if (m.isColOrdered()) {
+    matrix = new CoinPackedMatrix(m);
+  } else {
+    matrix = new CoinPackedMatrix;
+    matrix->reverseOrderedCopyOf(m);
+  }
+  gutsOfSetMpsData(matrix,infinity,collb,colub,obj,integrality,rowlb,rowub);
+}
+
+#if __cplusplus >= 201103L
+void
+CoinMpsIO::setMpsDataWithoutRowAndColNames(
+                                  CoinPackedMatrix&& m, const double infinity,
+                                  const double* collb, const double* colub,
+                                  const double* obj, const char* integrality,
+                                  const double* rowlb, const double* rowub)
+{
+  CoinPackedMatrix * matrix;
   if (m.isColOrdered()) {
-    matrixByColumn_ = new CoinPackedMatrix(m);
+    matrix = new CoinPackedMatrix(std::move(m));
   } else {
-    matrixByColumn_ = new CoinPackedMatrix;
-    matrixByColumn_->reverseOrderedCopyOf(m);
+    matrix = new CoinPackedMatrix;
+    matrix->reverseOrderedCopyOf(m);
   }
+  gutsOfSetMpsData(matrix,infinity,collb,colub,obj,integrality,rowlb,rowub);
+}
+#endif
+
+// Sets problem data given column ordered matrix (which is taken over)
+void
+CoinMpsIO::gutsOfSetMpsData(
+                                  CoinPackedMatrix * matrix, const double infinity,
+                                  const double* collb, const double* colub,
+                                  const double* obj, const char* integrality,
+                                  const double* rowlb, const double* rowub)
+{
+  freeAll();
+  matrixByColumn_ = matrix;
   numberColumns_ = matrixByColumn_->getNumCols();
   numberRows_ = matrixByColumn_->getNumRows();
   numberElements_ = matrixByColumn_->getNumElements();
+  checkPlusMinusOne();
   defaultBound_ = 1;
   infinity_ = infinity;
   objectiveOffset_ = 0;
@@ -5109,6 +5169,78 @@ CoinMpsIO::setMpsData(const CoinPackedMatrix& m, const double infinity,
    delete [] rub;
 }
 
+#if __cplusplus >= 201103L
+void
+CoinMpsIO::setMpsData(CoinPackedMatrix&& m, const double infinity,
+                      const double* collb, const double* colub,
+                      const double* obj, const char* integrality,
+                      const double* rowlb, const double* rowub,
+                      char const * const * const colnames,
+                      char const * const * const rownames)
+{
+  setMpsDataWithoutRowAndColNames(std::move(m),infinity,collb,colub,obj,integrality,rowlb,rowub);
+  setMpsDataColAndRowNames(colnames,rownames);
+}
+
+void
+CoinMpsIO::setMpsData(CoinPackedMatrix&& m, const double infinity,
+                      const double* collb, const double* colub,
+                      const double* obj, const char* integrality,
+                      const double* rowlb, const double* rowub,
+                      const std::vector<std::string> & colnames,
+                      const std::vector<std::string> & rownames)
+{
+  setMpsDataWithoutRowAndColNames(std::move(m),infinity,collb,colub,obj,integrality,rowlb,rowub);
+  setMpsDataColAndRowNames(colnames,rownames);
+}
+
+void
+CoinMpsIO::setMpsData(CoinPackedMatrix&& m, const double infinity,
+		      const double* collb, const double* colub,
+		      const double* obj, const char* integrality,
+		      const char* rowsen, const double* rowrhs,
+		      const double* rowrng,
+		      char const * const * const colnames,
+		      char const * const * const rownames)
+{
+   const int numrows = m.getNumRows();
+
+   double * rlb = numrows ? new double[numrows] : 0;
+   double * rub = numrows ? new double[numrows] : 0;
+
+   for (int i = 0; i < numrows; ++i) {
+      convertSenseToBound(rowsen[i], rowrhs[i], rowrng[i], rlb[i], rub[i]);
+   }
+   setMpsData(std::move(m), infinity, collb, colub, obj, integrality, rlb, rub,
+	      colnames, rownames);
+   delete [] rlb;
+   delete [] rub;
+}
+
+void
+CoinMpsIO::setMpsData(CoinPackedMatrix&& m, const double infinity,
+		      const double* collb, const double* colub,
+		      const double* obj, const char* integrality,
+		      const char* rowsen, const double* rowrhs,
+		      const double* rowrng,
+		      const std::vector<std::string> & colnames,
+		      const std::vector<std::string> & rownames)
+{
+   const int numrows = m.getNumRows();
+
+   double * rlb = numrows ? new double[numrows] : 0;
+   double * rub = numrows ? new double[numrows] : 0;
+
+   for (int i = 0; i < numrows; ++i) {
+      convertSenseToBound(rowsen[i], rowrhs[i], rowrng[i], rlb[i], rub[i]);
+   }
+   setMpsData(std::move(m), infinity, collb, colub, obj, integrality, rlb, rub,
+	      colnames, rownames);
+   delete [] rlb;
+   delete [] rub;
+}
+#endif
+
 void
 CoinMpsIO::setProblemName (const char *name)
 { free(problemName_) ;
@@ -5256,6 +5388,73 @@ void CoinMpsIO::releaseMatrixInformation()
   releaseRedundantInformation();
   delete matrixByColumn_;
   matrixByColumn_=NULL;
+  delete plusMinusOne_;
+  plusMinusOne_=NULL;
+  foundPlusMinusOne_=false;
+}
+// Adds memory usage to report
+void CoinMpsIO::memoryUsage(CoinMemoryUsage & usage) const
+{
+  const int sizeDouble = static_cast<int>(sizeof(double));
+  int numberRows = rowlower_ ? numberRows_ : 0;
+  int numberColumns = collower_ ? numberColumns_ : 0;
+  usage.addArray("rowLower",numberRows,numberRows,sizeDouble);
+  usage.addArray("rowUpper",numberRows,numberRows,sizeDouble);
+  usage.addArray("columnLower",numberColumns,numberColumns,sizeDouble);
+  usage.addArray("columnUpper",numberColumns,numberColumns,sizeDouble);
+  if (objective_)
+    usage.addArray("objective",numberColumns_,numberColumns_,sizeDouble);
+  if (integerType_)
+    usage.add("integerType",numberColumns_,numberColumns_);
+  if (rowsense_)
+    usage.add("rowSense",numberRows_,numberRows_);
+  if (rhs_)
+    usage.addArray("rhs",numberRows_,numberRows_,sizeDouble);
+  if (rowrange_)
+    usage.addArray("rowRange",numberRows_,numberRows_,sizeDouble);
+  CoinMemoryUsage part;
+  if (matrixByColumn_) {
+    matrixByColumn_->memoryUsage(part);
+    usage.add(part,"matrixByColumn");
+  }
+  if (matrixByRow_) {
+    part.clear();
+    matrixByRow_->memoryUsage(part);
+    usage.add(part,"matrixByRow");
+  }
+  if (plusMinusOne_) {
+    int numberColumns = plusMinusOne_->getNumCols();
+    usage.addArray("plusMinusOne",plusMinusOne_->getNumElements(),
+		   plusMinusOne_->getNumElements(),
+		   static_cast<int>(sizeof(int)));
+    usage.addArray("plusMinusOneStarts",2*numberColumns+1,2*numberColumns+1,
+		   static_cast<int>(sizeof(CoinBigIndex)));
+  }
+  static const char * nameName[] = {"rowNames","columnNames"};
+  static const char * hashName[] = {"rowHash","columnHash"};
+  for (int section=0;section<2;section++) {
+    int number = section ? numberColumns_ : numberRows_;
+    if (names_[section]) {
+      CoinInt64 bytes = number*static_cast<CoinInt64>(sizeof(char *));
+      for (int i=0;i<number;i++) {
+	if (names_[section][i])
+	  bytes += strlen(names_[section][i])+1;
+      }
+      usage.add(nameName[section],bytes,bytes);
+    }
+    if (hash_[section])
+      usage.addArray(hashName[section],numberHash_[section],
+		     4*numberHash_[section],
+		     static_cast<int>(sizeof(CoinHashLink)));
+  }
+  if (stringElements_) {
+    CoinInt64 bytes = 0;
+    for (int i=0;i<numberStringElements_;i++)
+      bytes += strlen(stringElements_[i])+1;
+    usage.add("stringElements",
+	      bytes+numberStringElements_*static_cast<CoinInt64>(sizeof(char *)),
+	      bytes+maximumStringElements_*static_cast<CoinInt64>(sizeof(char *)));
+  }
 }
   
 
@@ -5278,6 +5477,7 @@ rhs_(NULL),
 rowrange_(NULL),
 matrixByRow_(NULL),
 matrixByColumn_(NULL),
+plusMinusOne_(NULL),
 rowlower_(NULL),
 rowupper_(NULL),
 collower_(NULL),
@@ -5293,6 +5493,7 @@ defaultHandler_(true),
 cardReader_(NULL),
 convertObjective_(false),
 allowStringElements_(0),
+foundPlusMinusOne_(false),
 maximumStringElements_(0),
 numberStringElements_(0),
 stringElements_(NULL)
@@ -5325,6 +5526,7 @@ rhs_(NULL),
 rowrange_(NULL),
 matrixByRow_(NULL),
 matrixByColumn_(NULL),
+plusMinusOne_(NULL),
 rowlower_(NULL),
 rowupper_(NULL),
 collower_(NULL),
@@ -5339,6 +5541,7 @@ smallElement_(1.0e-14),
 defaultHandler_(true),
 cardReader_(NULL),
 allowStringElements_(rhs.allowStringElements_),
+foundPlusMinusOne_(false),
 maximumStringElements_(rhs.maximumStringElements_),
 numberStringElements_(rhs.numberStringElements_),
 stringElements_(NULL)
@@ -5368,6 +5571,9 @@ void CoinMpsIO::gutsOfCopy(const CoinMpsIO & rhs)
   defaultHandler_ = rhs.defaultHandler_;
   if (rhs.matrixByColumn_)
     matrixByColumn_=new CoinPackedMatrix(*(rhs.matrixByColumn_));
+  if (rhs.plusMinusOne_)
+    plusMinusOne_=new CoinPlusMinusOneMatrix(*(rhs.plusMinusOne_));
+  foundPlusMinusOne_=rhs.foundPlusMinusOne_;
   numberElements_=rhs.numberElements_;
   numberRows_=rhs.numberRows_;
   numberColumns_=rhs.numberColumns_;
@@ -5462,6 +5668,119 @@ CoinMpsIO::operator=(const CoinMpsIO& rhs)
   return *this;
 }
 
+#if __cplusplus >= 201103L
+//-------------------------------------------------------------------
+// Move constructor and assignment
+//-------------------------------------------------------------------
+/* Nothing is allocated - rhs is left without names, message handler or
+   messages (so may only be destroyed or assigned to). */
+CoinMpsIO::CoinMpsIO(CoinMpsIO && rhs) noexcept
+:
+problemName_(NULL),
+objectiveName_(NULL),
+rhsName_(NULL),
+rangeName_(NULL),
+boundName_(NULL),
+numberRows_(0),
+numberColumns_(0),
+numberElements_(0),
+rowsense_(NULL),
+rhs_(NULL),
+rowrange_(NULL),
+matrixByRow_(NULL),
+matrixByColumn_(NULL),
+plusMinusOne_(NULL),
+rowlower_(NULL),
+rowupper_(NULL),
+collower_(NULL),
+colupper_(NULL),
+objective_(NULL),
+objectiveOffset_(0.0),
+integerType_(NULL),
+fileName_(NULL),
+defaultBound_(1),
+infinity_(COIN_DBL_MAX),
+smallElement_(1.0e-14),
+handler_(NULL),
+defaultHandler_(true),
+cardReader_(NULL),
+convertObjective_(false),
+allowStringElements_(0),
+foundPlusMinusOne_(false),
+maximumStringElements_(0),
+numberStringElements_(0),
+stringElements_(NULL)
+{
+  numberHash_[0]=0;
+  hash_[0]=NULL;
+  names_[0]=NULL;
+  numberHash_[1]=0;
+  hash_[1]=NULL;
+  names_[1]=NULL;
+  swap(rhs);
+  // messages by hand as CoinMessages has no swap
+  std::swap(messages_.numberMessages_,rhs.messages_.numberMessages_);
+  std::swap(messages_.language_,rhs.messages_.language_);
+  for (int i=0;i<5;i++)
+    std::swap(messages_.source_[i],rhs.messages_.source_[i]);
+  std::swap(messages_.class_,rhs.messages_.class_);
+  std::swap(messages_.lengthMessages_,rhs.messages_.lengthMessages_);
+  std::swap(messages_.message_,rhs.messages_.message_);
+}
+
+CoinMpsIO &
+CoinMpsIO::operator=(CoinMpsIO && rhs) noexcept
+{
+  if (this != &rhs)
+    swap(rhs);
+  return *this;
+}
+#endif
+
+// Exchanges everything except card reader and messages with other
+void
+CoinMpsIO::swap(CoinMpsIO & other)
+{
+  std::swap(problemName_,other.problemName_);
+  std::swap(objectiveName_,other.objectiveName_);
+  std::swap(rhsName_,other.rhsName_);
+  std::swap(rangeName_,other.rangeName_);
+  std::swap(boundName_,other.boundName_);
+  std::swap(numberRows_,other.numberRows_);
+  std::swap(numberColumns_,other.numberColumns_);
+  std::swap(numberElements_,other.numberElements_);
+  std::swap(rowsense_,other.rowsense_);
+  std::swap(rhs_,other.rhs_);
+  std::swap(rowrange_,other.rowrange_);
+  std::swap(matrixByRow_,other.matrixByRow_);
+  std::swap(matrixByColumn_,other.matrixByColumn_);
+  std::swap(plusMinusOne_,other.plusMinusOne_);
+  std::swap(rowlower_,other.rowlower_);
+  std::swap(rowupper_,other.rowupper_);
+  std::swap(collower_,other.collower_);
+  std::swap(colupper_,other.colupper_);
+  std::swap(objective_,other.objective_);
+  std::swap(objectiveOffset_,other.objectiveOffset_);
+  std::swap(integerType_,other.integerType_);
+  std::swap(fileName_,other.fileName_);
+  std::swap(defaultBound_,other.defaultBound_);
+  std::swap(infinity_,other.infinity_);
+  std::swap(smallElement_,other.smallElement_);
+  std::swap(handler_,other.handler_);
+  std::swap(defaultHandler_,other.defaultHandler_);
+  std::swap(convertObjective_,other.convertObjective_);
+  std::swap(allowStringElements_,other.allowStringElements_);
+  std::swap(foundPlusMinusOne_,other.foundPlusMinusOne_);
+  std::swap(maximumStringElements_,other.maximumStringElements_);
+  std::swap(numberStringElements_,other.numberStringElements_);
+  std::swap(stringElements_,other.stringElements_);
+  for (int section=0;section<2;section++) {
+    std::swap(names_[section],other.names_[section]);
+    std::swap(numberHash_[section],other.numberHash_[section]);
+    std::swap(hash_[section],other.hash_[section]);
+  }
+}
+
 //-------------------------------------------------------------------
 void CoinMpsIO::gutsOfDestructor()
 {  
@@ -5482,8 +5801,11 @@ void CoinMpsIO::freeAll()
   releaseColumnNames();
   delete matrixByRow_;
   delete matrixByColumn_;
+  delete plusMinusOne_;
   matrixByRow_=NULL;
   matrixByColumn_=NULL;
+  plusMinusOne_=NULL;
+  foundPlusMinusOne_=false;
   free(rowlower_);
   free(rowupper_);
   free(collower_);
@@ -19,6 +19,8 @@
 #include "CoinMessageHandler.hpp"
 #include "CoinFileIO.hpp"
 class CoinModel;
+class CoinMemoryUsage;
+class CoinPlusMinusOneMatrix;
 
 /// The following lengths are in decreasing order (for 64 bit etc)
 /// Large enough to contain element index
@@ -411,6 +413,16 @@ public:
     /// Get pointer to column-wise copy of the coefficient matrix
     const CoinPackedMatrix * getMatrixByCol() const;
 
+    /** True if every coefficient of the problem read or set is +1 or -1
+	(checked each time) */
+    inline bool isPlusMinusOne() const
+    { return foundPlusMinusOne_;}
+
+    /** Get pointer to column-wise +-1 copy of the coefficient matrix if
+	isPlusMinusOne(), otherwise NULL.  The copy is built on the first
+	call, as the column copy is kept as well. */
+    const CoinPlusMinusOneMatrix * getPlusMinusOneMatrix() const;
+
     /// Return true if column is a continuous variable
     bool isContinuous(int colNumber) const;
 
@@ -519,6 +531,36 @@ public:
 		     const double* rowrng,
 		     const std::vector<std::string> & colnames,
 		     const std::vector<std::string> & rownames);
+#if __cplusplus >= 201103L
+    /** As above but take the arrays of a column ordered m (which is left
+	empty) rather than copying them */
+    void setMpsData(CoinPackedMatrix&& m, const double infinity,
+		     const double* collb, const double* colub,
+		     const double* obj, const char* integrality,
+		     const double* rowlb, const double* rowub,
+		     char const * const * const colnames,
+		     char const * const * const rownames);
+    void setMpsData(CoinPackedMatrix&& m, const double infinity,
+		     const double* collb, const double* colub,
+		     const double* obj, const char* integrality,
+		     const double* rowlb, const double* rowub,
+		     const std::vector<std::string> & colnames,
+		     const std::vector<std::string> & rownames);
+    void setMpsData(CoinPackedMatrix&& m, const double infinity,
+		     const double* collb, const double* colub,
+		     const double* obj, const char* integrality,
+		     const char* rowsen, const double* rowrhs,
+		     const double* rowrng,
+		     char const * const * const colnames,
+		     char const * const * const rownames);
+    void setMpsData(CoinPackedMatrix&& m, const double infinity,
+		     const double* collb, const double* colub,
+		     const double* obj, const char* integrality,
+		     const char* rowsen, const double* rowrhs,
+		     const double* rowrng,
+		     const std::vector<std::string> & colnames,
+		     const std::vector<std::string> & rownames);
+#endif
 
     /** Pass in an array[getNumCols()] specifying if a variable is integer.
 
@@ -763,6 +805,17 @@ public:
   
     /// Assignment operator 
     CoinMpsIO & operator=(const CoinMpsIO& rhs);
+#if __cplusplus >= 201103L
+    /** Move constructor - takes everything (including message handler)
+	from rhs.  Allocates nothing, so rhs is left without names or
+	handler and may only be destroyed or assigned to. */
+    CoinMpsIO (CoinMpsIO && rhs) noexcept;
+    /// Move assignment - exchanges everything with rhs
+    CoinMpsIO & operator=(CoinMpsIO&& rhs) noexcept;
+#endif
+    /** Exchanges problem, names and message handler with other (no
+	copying).  A card reader in use stays where it is. */
+    void swap(CoinMpsIO & other);
   
     /// Destructor 
     ~CoinMpsIO ();
@@ -823,6 +876,10 @@ public:
 
     /// Release matrix information
     void releaseMatrixInformation();
+
+    /** Add bytes used and allocated for each internal array to \p usage.
+	Useful to decide what to release. */
+    void memoryUsage(CoinMemoryUsage & usage) const;
   //@}
 
 protected:
@@ -837,6 +894,21 @@ protected:
 		      const double* collb, const double* colub,
 		      const double* obj, const char* integrality,
 		      const double* rowlb, const double* rowub);
+#if __cplusplus >= 201103L
+    void
+    setMpsDataWithoutRowAndColNames(
+		      CoinPackedMatrix&& m, const double infinity,
+		      const double* collb, const double* colub,
+		      const double* obj, const char* integrality,
+		      const double* rowlb, const double* rowub);
+#endif
+    /// Sets problem data given column ordered matrix (which is taken over)
+    void
+    gutsOfSetMpsData(
+		      CoinPackedMatrix * matrix, const double infinity,
+		      const double* collb, const double* colub,
+		      const double* obj, const char* integrality,
+		      const double* rowlb, const double* rowub);
     void
     setMpsDataColAndRowNames(
 		      const std::vector<std::string> & colnames,
@@ -856,6 +928,9 @@ protected:
     /// Clears problem data from the CoinMpsIO object.
     void freeAll();
 
+    /// Sees if all coefficients are +1 or -1 (and drops any +-1 copy)
+    void checkPlusMinusOne();
+
 
     /** A quick inlined function to convert from lb/ub style constraint
 	definition to sense/rhs/range style */
@@ -953,6 +1028,9 @@ protected:
       /// Pointer to column-wise copy of problem matrix coefficients.
       CoinPackedMatrix *matrixByColumn_;  
 
+      /// Pointer to +-1 copy of matrix (built when first asked for)
+      mutable CoinPlusMinusOneMatrix *plusMinusOne_;
+
       /// Pointer to dense vector of row lower bounds
       double * rowlower_;
 
@@ -1021,6 +1099,8 @@ protected:
       bool convertObjective_;
       /// Whether to allow string elements
       int allowStringElements_;
+      /// Whether all coefficients are +1 or -1
+      bool foundPlusMinusOne_;
       /// Maximum number of string elements
       int maximumStringElements_;
       /// Number of string elements
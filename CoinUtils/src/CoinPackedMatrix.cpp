@@ -10,7 +10,10 @@
 #include <cassert>
 #include <cstdio>
 #include <cmath>
+#include <cstring>
+#include <limits>
 #include <iostream>
+#include <vector>
 
 #include "CoinPragma.hpp"
 #include "CoinSort.hpp"
@@ -20,11 +23,19 @@
 #endif
 #include "CoinFloatEqual.hpp"
 #include "CoinPackedMatrix.hpp"
+#include "CoinMemoryUsage.hpp"
+#include "CoinMemoryPolicy.hpp"
+#include "CoinThreadPool.hpp"
+#include "CoinSellMatrix.hpp"
+#include "CoinIndexedVector.hpp"
 
 #if !defined(COIN_COINUTILS_CHECKLEVEL)
 #define COIN_COINUTILS_CHECKLEVEL 0
 #endif
 
+// sellCacheAfter for new matrices (0 never keep a CoinSellMatrix)
+static int coinSellCacheAfter = 0;
+
 //#############################################################################
 // T must be an integral type (int, CoinBigIndex, etc.)
 template <typename T>
@@ -34,6 +45,567 @@ CoinLengthWithExtra(T len, double extraGap)
   return static_cast<T>(ceil(len * (1 + extraGap)));
 }
 
+//#############################################################################
+// Element and index arrays come from new[] unless matrix has a memory policy
+
+template <class T>
+static inline T *
+coinNewMatrixArray(int policy, CoinInt64 n)
+{
+  if (!policy)
+    return new T [n];
+  return static_cast<T *>
+    (CoinMemoryPolicy::allocate(static_cast<size_t>(n)*sizeof(T),policy));
+}
+
+template <class T>
+static inline void
+coinDeleteMatrixArray(int policy, T * array)
+{
+  if (!policy)
+    delete [] array;
+  else
+    CoinMemoryPolicy::release(array);
+}
+
+/* Start array of a matrix left empty by the move constructor, so that
+   moving allocates nothing.  It only holds start_[0] (always 0) and is
+   never freed. */
+static CoinBigIndex coinEmptyStart[1] = {0};
+
+static inline void
+coinDeleteStart(CoinBigIndex * start)
+{
+  if (start != coinEmptyStart)
+    delete [] start;
+}
+
+template <class T>
+static inline T *
+coinCopyMatrixArray(int policy, const T * array, CoinInt64 n)
+{
+  if (!array)
+    return NULL;
+  T * copy = coinNewMatrixArray<T>(policy,n);
+  memcpy(copy,array,static_cast<size_t>(n)*sizeof(T));
+  return copy;
+}
+
+//#############################################################################
+// Serial products for any type of starts (used with wide starts)
+
+template <class S>
+static void
+coinTimesMajor(const S * start, const int * length, const int * index,
+	       const double * element, int majorDim, int minorDim,
+	       const double * x, double * y)
+{
+  CoinZeroN(y,minorDim);
+  for (int i=0;i<majorDim;i++) {
+    const double value = x[i];
+    if (value) {
+      const S last = start[i]+length[i];
+      for (S j=start[i];j<last;j++)
+	y[index[j]] += value*element[j];
+    }
+  }
+}
+
+template <class S>
+static void
+coinTimesMinor(const S * start, const int * length, const int * index,
+	       const double * element, int majorDim,
+	       const double * x, double * y)
+{
+  for (int i=0;i<majorDim;i++) {
+    double sum = 0.0;
+    const S last = start[i]+length[i];
+    for (S j=start[i];j<last;j++)
+      sum += x[index[j]]*element[j];
+    y[i] = sum;
+  }
+}
+
+//#############################################################################
+// Work is done in parallel if CoinThreadPool::defaultPool() is set
+
+// Fewest elements worth using threads for
+#define COIN_PACKED_MATRIX_PARALLEL 100000
+
+// Pool to use for matrix with size elements (NULL if serial)
+static inline CoinThreadPool *
+coinMatrixPool(CoinBigIndex size)
+{
+  return CoinThreadPool::defaultPoolFor(size,COIN_PACKED_MATRIX_PARALLEL);
+}
+
+// y[i] = major vector i . x for a range of major vectors
+class CoinTimesMinorTask : public CoinThreadRangeTask {
+public:
+  const CoinBigIndex * start_;
+  const int * length_;
+  const int * index_;
+  const double * element_;
+  const double * x_;
+  double * y_;
+  virtual void run(int begin, int end)
+  {
+    for (int i = begin; i < end; ++i) {
+      double y_i = 0;
+      const CoinBigIndex last = start_[i] + length_[i];
+      for (CoinBigIndex j = start_[i]; j < last; ++j)
+	y_i += x_[index_[j]] * element_[j];
+      y_[i] = y_i;
+    }
+  }
+};
+
+/* Moves a range of major vectors to new positions (unless in place) and
+   puts new minor vectors' entries after them */
+class CoinAppendMinorTask : public CoinThreadRangeTask {
+public:
+  const CoinBigIndex * start_;
+  const int * index_;
+  const double * element_;
+  const CoinBigIndex * newStart_;
+  int * newIndex_;
+  double * newElement_;
+  int * length_;
+  /// Entries to add for each major vector (in order)
+  const CoinBigIndex * addStart_;
+  const int * addIndex_;
+  const double * addElement_;
+  virtual void run(int begin, int end)
+  {
+    const bool move = newIndex_ != index_;
+    for (int i = begin; i < end; ++i) {
+      CoinBigIndex put = newStart_[i];
+      const int length = length_[i];
+      if (move) {
+	CoinMemcpyN(index_ + start_[i], length, newIndex_ + put);
+	CoinMemcpyN(element_ + start_[i], length, newElement_ + put);
+      }
+      put += length;
+      const int n = static_cast<int>(addStart_[i+1] - addStart_[i]);
+      CoinMemcpyN(addIndex_ + addStart_[i], n, newIndex_ + put);
+      CoinMemcpyN(addElement_ + addStart_[i], n, newElement_ + put);
+      length_[i] = length + n;
+    }
+  }
+};
+
+// Counts minor indices in one share of the major vectors
+class CoinCountOrthoTask : public CoinThreadTask {
+public:
+  const CoinBigIndex * start_;
+  const int * length_;
+  const int * index_;
+  int majorDim_;
+  int minorDim_;
+  int numberPieces_;
+  /// minorDim_ counts for each piece
+  CoinBigIndex * counts_;
+  virtual void run(int which)
+  {
+    CoinBigIndex * count = counts_ + static_cast<CoinBigIndex>(which) * minorDim_;
+    CoinZeroN(count, minorDim_);
+    const int first = static_cast<int>
+      ((static_cast<CoinInt64>(majorDim_) * which) / numberPieces_);
+    const int last = static_cast<int>
+      ((static_cast<CoinInt64>(majorDim_) * (which + 1)) / numberPieces_);
+    for (int i = first; i < last; ++i) {
+      const CoinBigIndex end = start_[i] + length_[i];
+      for (CoinBigIndex j = start_[i]; j < end; ++j)
+	++count[index_[j]];
+    }
+  }
+};
+
+// Adds counts of pieces for a range of minor indices
+class CoinAddCountsTask : public CoinThreadRangeTask {
+public:
+  const CoinBigIndex * counts_;
+  int minorDim_;
+  int numberPieces_;
+  int * orthoLength_;
+  virtual void run(int begin, int end)
+  {
+    for (int i = begin; i < end; ++i) {
+      CoinBigIndex n = 0;
+      for (int k = 0; k < numberPieces_; ++k)
+	n += counts_[static_cast<CoinBigIndex>(k) * minorDim_ + i];
+      orthoLength_[i] = static_cast<int>(n);
+    }
+  }
+};
+
+// Replaces counts of pieces by where each piece starts putting entries
+class CoinOrthoOffsetsTask : public CoinThreadRangeTask {
+public:
+  CoinBigIndex * counts_;
+  const CoinBigIndex * start_;
+  int minorDim_;
+  int numberPieces_;
+  virtual void run(int begin, int end)
+  {
+    for (int i = begin; i < end; ++i) {
+      CoinBigIndex put = start_[i];
+      for (int k = 0; k < numberPieces_; ++k) {
+	CoinBigIndex & count = counts_[static_cast<CoinBigIndex>(k) * minorDim_ + i];
+	const CoinBigIndex n = count;
+	count = put;
+	put += n;
+      }
+    }
+  }
+};
+
+/* Puts entries of one share of the major vectors in reversed matrix.
+   Shares are in order so minor indices of result stay sorted. */
+class CoinScatterOrthoTask : public CoinThreadTask {
+public:
+  const CoinBigIndex * start_;
+  const int * length_;
+  const int * index_;
+  const double * element_;
+  int majorDim_;
+  int minorDim_;
+  int numberPieces_;
+  /// Where each piece puts next entry of each minor vector
+  CoinBigIndex * offsets_;
+  int * newIndex_;
+  double * newElement_;
+  virtual void run(int which)
+  {
+    CoinBigIndex * put = offsets_ + static_cast<CoinBigIndex>(which) * minorDim_;
+    const int first = static_cast<int>
+      ((static_cast<CoinInt64>(majorDim_) * which) / numberPieces_);
+    const int last = static_cast<int>
+      ((static_cast<CoinInt64>(majorDim_) * (which + 1)) / numberPieces_);
+    for (int i = first; i < last; ++i) {
+      const CoinBigIndex end = start_[i] + length_[i];
+      for (CoinBigIndex j = start_[i]; j < end; ++j) {
+	const CoinBigIndex k = put[index_[j]]++;
+	newElement_[k] = element_[j];
+	newIndex_[k] = i;
+      }
+    }
+  }
+};
+
+/* Cleans a share of the major vectors in place.  Mode 0 moves small
+   elements to after end of vector, 1 also merges duplicates (into first)
+   and 2 also sorts.  Minor dimension work space is got once for each
+   thread (by runOnThread) and freed by the destructor. */
+class CoinCleanVectorsTask : public CoinThreadTask {
+public:
+  const CoinBigIndex * start_;
+  int * length_;
+  int * index_;
+  double * element_;
+  int majorDim_;
+  int minorDim_;
+  int numberPieces_;
+  int mode_;
+  double threshold_;
+  /// Counts for each piece
+  CoinBigIndex * numberDuplicates_;
+  CoinBigIndex * numberSmall_;
+  /// Work space for each thread (NULL until thread needs it)
+  int numberThreads_;
+  CoinBigIndex ** mark_;
+  int ** smallIndex_;
+  double ** smallElement_;
+  CoinCleanVectorsTask(int numberThreads)
+    : numberThreads_(numberThreads)
+  {
+    mark_ = new CoinBigIndex * [numberThreads];
+    smallIndex_ = new int * [numberThreads];
+    smallElement_ = new double * [numberThreads];
+    for (int i = 0; i < numberThreads; ++i) {
+      mark_[i] = NULL;
+      smallIndex_[i] = NULL;
+      smallElement_[i] = NULL;
+    }
+  }
+  ~CoinCleanVectorsTask()
+  {
+    for (int i = 0; i < numberThreads_; ++i) {
+      delete [] mark_[i];
+      delete [] smallIndex_[i];
+      delete [] smallElement_[i];
+    }
+    delete [] mark_;
+    delete [] smallIndex_;
+    delete [] smallElement_;
+  }
+  virtual void run(int which)
+  { runOnThread(which, 0); }
+  virtual void runOnThread(int which, int thread)
+  {
+    const int first = static_cast<int>
+      ((static_cast<CoinInt64>(majorDim_) * which) / numberPieces_);
+    const int last = static_cast<int>
+      ((static_cast<CoinInt64>(majorDim_) * (which + 1)) / numberPieces_);
+    CoinBigIndex numberDuplicates = 0;
+    CoinBigIndex numberSmall = 0;
+    if (!mode_) {
+      if (!smallIndex_[thread]) {
+	smallIndex_[thread] = new int[minorDim_];
+	smallElement_[thread] = new double[minorDim_];
+      }
+      int * smallIndex = smallIndex_[thread];
+      double * smallElement = smallElement_[thread];
+      for (int i = first; i < last; ++i) {
+	const CoinBigIndex end = start_[i] + length_[i];
+	CoinBigIndex k = start_[i];
+	int nSmall = 0;
+	for (CoinBigIndex j = start_[i]; j < end; ++j) {
+	  if (fabs(element_[j]) >= threshold_) {
+	    element_[k] = element_[j];
+	    index_[k++] = index_[j];
+	  } else {
+	    smallElement[nSmall] = element_[j];
+	    smallIndex[nSmall++] = index_[j];
+	  }
+	}
+	if (nSmall) {
+	  numberSmall += nSmall;
+	  length_[i] -= nSmall;
+	  CoinMemcpyN(smallIndex, nSmall, index_ + k);
+	  CoinMemcpyN(smallElement, nSmall, element_ + k);
+	}
+      }
+    } else {
+      // all -1 between vectors
+      if (!mark_[thread]) {
+	mark_[thread] = new CoinBigIndex[minorDim_];
+	CoinFillN(mark_[thread], minorDim_, static_cast<CoinBigIndex>(-1));
+      }
+      CoinBigIndex * mark = mark_[thread];
+      for (int i = first; i < last; ++i) {
+	const CoinBigIndex end = start_[i] + length_[i];
+	CoinBigIndex j;
+	for (j = start_[i]; j < end; ++j) {
+	  const int iIndex = index_[j];
+	  if (mark[iIndex] < 0) {
+	    mark[iIndex] = j;
+	  } else {
+	    // duplicate
+	    element_[mark[iIndex]] += element_[j];
+	    index_[j] = -1;
+	    ++numberDuplicates;
+	  }
+	}
+	CoinBigIndex k = start_[i];
+	for (j = start_[i]; j < end; ++j) {
+	  const int iIndex = index_[j];
+	  if (iIndex < 0)
+	    continue;
+	  mark[iIndex] = -1;
+	  if (fabs(element_[j]) >= threshold_) {
+	    element_[k] = element_[j];
+	    index_[k++] = iIndex;
+	  } else {
+	    ++numberSmall;
+	  }
+	}
+	length_[i] = static_cast<int>(k - start_[i]);
+	if (mode_ == 2)
+	  CoinSort_2(index_ + start_[i], index_ + k, element_ + start_[i]);
+      }
+    }
+    numberDuplicates_[which] = numberDuplicates;
+    numberSmall_[which] = numberSmall;
+  }
+private:
+  CoinCleanVectorsTask(const CoinCleanVectorsTask &);
+  CoinCleanVectorsTask & operator=(const CoinCleanVectorsTask &);
+};
+
+// Copies a range of major vectors to new positions
+class CoinCopyVectorsTask : public CoinThreadRangeTask {
+public:
+  const CoinBigIndex * start_;
+  const int * length_;
+  const int * index_;
+  const double * element_;
+  const CoinBigIndex * newStart_;
+  int * newIndex_;
+  double * newElement_;
+  virtual void run(int begin, int end)
+  {
+    for (int i = begin; i < end; ++i) {
+      CoinMemcpyN(index_ + start_[i], length_[i], newIndex_ + newStart_[i]);
+      CoinMemcpyN(element_ + start_[i], length_[i],
+		  newElement_ + newStart_[i]);
+    }
+  }
+};
+
+// Counts minor indices for each share of major vectors, then totals
+static void
+coinCountOrthoPieces(CoinThreadPool * pool, int numberPieces,
+		     const CoinPackedMatrix & matrix,
+		     CoinBigIndex * counts, int * orthoLength)
+{
+  const int minorDim = matrix.getMinorDim();
+  CoinCountOrthoTask count;
+  count.start_ = matrix.getVectorStarts();
+  count.length_ = matrix.getVectorLengths();
+  count.index_ = matrix.getIndices();
+  count.majorDim_ = matrix.getMajorDim();
+  count.minorDim_ = minorDim;
+  count.numberPieces_ = numberPieces;
+  count.counts_ = counts;
+  pool->run(count, numberPieces);
+  CoinAddCountsTask add;
+  add.counts_ = counts;
+  add.minorDim_ = minorDim;
+  add.numberPieces_ = numberPieces;
+  add.orthoLength_ = orthoLength;
+  pool->parallelFor(add, 0, minorDim);
+}
+
+//#############################################################################
+/* Changes made to a dual ordered matrix since its reverse ordered copy
+   was brought up to date.  Each entry is in terms of rows and columns
+   and has number vectors (indices and elements from first element). */
+
+class CoinOrthoDelta {
+public:
+  enum Type {
+    appendCols, appendRows, deleteCols, deleteRows, modify, dimensions
+  };
+  CoinOrthoDelta() : work_(0), minorAppend_(appendRows), passCost_(0),
+		     deleteCost_(0) {}
+  /// Adds number vectors with starts relative to index and element
+  void addVectors(Type type, int number, const CoinBigIndex * starts,
+		  const int * index, const double * element)
+  {
+    newEntry(type, number);
+    const CoinBigIndex offset = starts[0];
+    for (int i = 0; i < number; ++i)
+      starts_.push_back(starts[i+1] - offset);
+    index_.insert(index_.end(), index + offset, index + starts[number]);
+    element_.insert(element_.end(), element + offset,
+		    element + starts[number]);
+    work_ += number + starts[number] - offset;
+  }
+#ifndef CLP_NO_VECTOR
+  void addVectors(Type type, int number,
+		  const CoinPackedVectorBase * const * vecs)
+  {
+    newEntry(type, number);
+    CoinBigIndex n = 0;
+    for (int i = 0; i < number; ++i) {
+      const int size = vecs[i]->getNumElements();
+      index_.insert(index_.end(), vecs[i]->getIndices(),
+		    vecs[i]->getIndices() + size);
+      element_.insert(element_.end(), vecs[i]->getElements(),
+		      vecs[i]->getElements() + size);
+      n += size;
+      starts_.push_back(n);
+    }
+    work_ += number + n;
+  }
+#endif
+  /// Adds one vector (no elements if element NULL)
+  void addVector(Type type, int size, const int * index,
+		 const double * element)
+  {
+    newEntry(type, 1);
+    index_.insert(index_.end(), index, index + size);
+    if (element)
+      element_.insert(element_.end(), element, element + size);
+    else
+      element_.resize(element_.size() + size, 0.0);
+    starts_.push_back(size);
+    work_ += 1 + size;
+  }
+  /// Adds element change (value zero and keepZero false deletes)
+  void addModify(int row, int column, double value, bool keepZero)
+  {
+    const int index[2] = {row, column};
+    const double element[2] = {value, keepZero ? 1.0 : 0.0};
+    addVector(modify, 2, index, element);
+  }
+  /// Makes entry with first of number+1 starts
+  void newEntry(Type type, int number)
+  {
+    if (type == minorAppend_)
+      work_ += passCost_;
+    else if (type == deleteCols || type == deleteRows)
+      work_ += deleteCost_;
+    type_.push_back(type);
+    number_.push_back(number);
+    first_.push_back(static_cast<CoinBigIndex>(starts_.size()));
+    firstElement_.push_back(static_cast<CoinBigIndex>(index_.size()));
+    starts_.push_back(0);
+  }
+  inline int numberEntries() const
+  { return static_cast<int>(type_.size()); }
+  inline const CoinBigIndex * starts(int i) const
+  { return &starts_[first_[i]]; }
+  inline const int * index(int i) const
+  { return index_.empty() ? NULL : &index_[0] + firstElement_[i]; }
+  inline const double * element(int i) const
+  { return element_.empty() ? NULL : &element_[0] + firstElement_[i]; }
+
+  std::vector<int> type_;
+  std::vector<int> number_;
+  std::vector<CoinBigIndex> first_;
+  std::vector<CoinBigIndex> firstElement_;
+  std::vector<CoinBigIndex> starts_;
+  std::vector<int> index_;
+  std::vector<double> element_;
+  /// Rough cost of making changes to copy
+  CoinBigIndex work_;
+  /// Appends which are minor for copy (these go over all of it)
+  Type minorAppend_;
+  /// Cost of going over major vectors of copy
+  CoinBigIndex passCost_;
+  /// Cost of deleting from copy
+  CoinBigIndex deleteCost_;
+};
+
+/* Keeps the reverse ordered copy of a dual ordered matrix while a
+   logged change is made (changes made by that one do not drop it).
+   If the change does not finish the copy is dropped. */
+class CoinOrthoChange {
+public:
+  CoinOrthoChange(const CoinPackedMatrix & matrix, bool & busy, bool keep)
+    : matrix_(matrix), busy_(busy), keep_(keep)
+  { if (keep_) busy_ = true; }
+  ~CoinOrthoChange()
+  { done(false); }
+  inline bool kept() const { return keep_; }
+  /// Change made (if ok false the copy is dropped)
+  void done(bool ok = true)
+  {
+    if (keep_ && busy_) {
+      busy_ = false;
+      if (!ok)
+	matrix_.clearCaches();
+    }
+  }
+private:
+  const CoinPackedMatrix & matrix_;
+  bool & busy_;
+  bool keep_;
+};
+
+// Orders changes by minor index and then position in list
+class CoinModifyOrder {
+public:
+  CoinModifyOrder(const int * minorIndex) : minorIndex_(minorIndex) {}
+  inline bool operator()(int a, int b) const
+  { return minorIndex_[a] < minorIndex_[b] ||
+      (minorIndex_[a] == minorIndex_[b] && a < b); }
+private:
+  const int * minorIndex_;
+};
+
 //#############################################################################
 
 static inline void
@@ -74,6 +646,8 @@ void
 CoinPackedMatrix::reserve(const int newMaxMajorDim, const CoinBigIndex newMaxSize,
 			  bool create)
 {
+   checkNarrow("reserve");
+   clearCaches();
    if (newMaxMajorDim > maxMajorDim_) {
       maxMajorDim_ = newMaxMajorDim;
       int * oldlength = length_;
@@ -92,20 +666,20 @@ CoinPackedMatrix::reserve(const int newMaxMajorDim, const CoinBigIndex newMaxSiz
 	majorDim_=maxMajorDim_;
       }
       delete[] oldlength;
-      delete[] oldstart;
+      coinDeleteStart(oldstart);
    }
    if (newMaxSize > maxSize_) {
       maxSize_ = newMaxSize;
       int * oldind = index_;
       double * oldelem = element_;
-      index_ = new int[newMaxSize];
-      element_ = new double[newMaxSize];
+      index_ = coinNewMatrixArray<int>(memoryPolicy_,newMaxSize);
+      element_ = coinNewMatrixArray<double>(memoryPolicy_,newMaxSize);
       for (int i = majorDim_ - 1; i >= 0; --i) {
 	 CoinMemcpyN(oldind+start_[i], length_[i], index_+start_[i]);
 	 CoinMemcpyN(oldelem+start_[i], length_[i], element_+start_[i]);
       }
-      delete[] oldind;
-      delete[] oldelem;
+      coinDeleteMatrixArray(memoryPolicy_,oldind);
+      coinDeleteMatrixArray(memoryPolicy_,oldelem);
    }
 }
 
@@ -114,6 +688,8 @@ CoinPackedMatrix::reserve(const int newMaxMajorDim, const CoinBigIndex newMaxSiz
 void
 CoinPackedMatrix::clear()
 {
+   removeWide();
+   clearCaches();
    majorDim_ = 0;
    minorDim_ = 0;
    size_ = 0;
@@ -125,6 +701,13 @@ CoinPackedMatrix::clear()
 void
 CoinPackedMatrix::setDimensions(int newnumrows, int newnumcols)
 {
+   checkNarrow("setDimensions");
+  const bool sorted = sortedIndices_;
+  CoinOrthoChange change(*this, orthoBusy_, keepOrthoCache());
+  if (change.kept()) {
+    const int dimensions[2] = {newnumrows, newnumcols};
+    orthoDelta_->addVector(CoinOrthoDelta::dimensions, 2, dimensions, NULL);
+  }
   const int numrows = getNumRows();
   if (newnumrows < 0)
     newnumrows = numrows;
@@ -154,7 +737,8 @@ CoinPackedMatrix::setDimensions(int newnumrows, int newnumcols)
     delete[] lengths;
     majorDim_ += numplus; //forgot to change majorDim_
   }
-
+  sortedIndices_ = sorted;
+  change.done();
 }
 
 //-----------------------------------------------------------------------------
@@ -179,15 +763,40 @@ CoinPackedMatrix::setExtraMajor(const double newMajor)
    extraMajor_ = newMajor;
 }
 
+//#############################################################################
+
+void
+CoinPackedMatrix::setMemoryPolicy(int policy)
+{
+   if (policy < 0)
+      policy = CoinMemoryPolicy::defaultPolicy();
+   if (policy == memoryPolicy_)
+      return;
+   // copy whole allocation
+   const CoinInt64 n = wideStart_ ? wideStart_[majorDim_] : maxSize_;
+   double * newElem = coinCopyMatrixArray(policy, element_, n);
+   int * newIndex = coinCopyMatrixArray(policy, index_, n);
+   coinDeleteMatrixArray(memoryPolicy_, element_);
+   coinDeleteMatrixArray(memoryPolicy_, index_);
+   element_ = newElem;
+   index_ = newIndex;
+   memoryPolicy_ = policy;
+}
+
 //#############################################################################
 #ifndef CLP_NO_VECTOR
 void
 CoinPackedMatrix::appendCol(const CoinPackedVectorBase& vec)
 {
+   CoinOrthoChange change(*this, orthoBusy_, keepOrthoCache());
+   if (change.kept())
+      orthoDelta_->addVector(CoinOrthoDelta::appendCols, vec.getNumElements(),
+			      vec.getIndices(), vec.getElements());
    if (colOrdered_)
       appendMajorVector(vec);
    else
       appendMinorVector(vec);
+   change.done();
 }
 #endif
 //-----------------------------------------------------------------------------
@@ -197,10 +806,14 @@ CoinPackedMatrix::appendCol(const int vecsize,
 			   const int *vecind,
 			   const double *vecelem)
 {
+   CoinOrthoChange change(*this, orthoBusy_, keepOrthoCache());
+   if (change.kept())
+      orthoDelta_->addVector(CoinOrthoDelta::appendCols, vecsize, vecind, vecelem);
    if (colOrdered_)
       appendMajorVector(vecsize, vecind, vecelem);
    else
       appendMinorVector(vecsize, vecind, vecelem);
+   change.done();
 }
 
 //-----------------------------------------------------------------------------
@@ -209,10 +822,14 @@ void
 CoinPackedMatrix::appendCols(const int numcols,
 			    const CoinPackedVectorBase * const * cols)
 {
+   CoinOrthoChange change(*this, orthoBusy_, keepOrthoCache());
+   if (change.kept())
+      orthoDelta_->addVectors(CoinOrthoDelta::appendCols, numcols, cols);
    if (colOrdered_)
       appendMajorVectors(numcols, cols);
    else
       appendMinorVectors(numcols, cols);
+   change.done();
 }
 #endif
 //-----------------------------------------------------------------------------
@@ -222,12 +839,18 @@ CoinPackedMatrix::appendCols(const int numcols,
                              const CoinBigIndex * columnStarts, const int * row,
                              const double * element, int numberRows)
 {
+   CoinOrthoChange change(*this, orthoBusy_, keepOrthoCache());
+   if (change.kept())
+      orthoDelta_->addVectors(CoinOrthoDelta::appendCols, numcols, columnStarts,
+			       row, element);
   int numberErrors;
   if (colOrdered_) {
     numberErrors=appendMajor(numcols, columnStarts, row, element, numberRows);
   } else {
     numberErrors=appendMinor(numcols, columnStarts, row, element, numberRows);
   }
+  // if any errors copy may not match
+  change.done(numberErrors == 0);
   return numberErrors;
 }
 //-----------------------------------------------------------------------------
@@ -235,10 +858,15 @@ CoinPackedMatrix::appendCols(const int numcols,
 void
 CoinPackedMatrix::appendRow(const CoinPackedVectorBase& vec)
 {
+   CoinOrthoChange change(*this, orthoBusy_, keepOrthoCache());
+   if (change.kept())
+      orthoDelta_->addVector(CoinOrthoDelta::appendRows, vec.getNumElements(),
+			      vec.getIndices(), vec.getElements());
    if (colOrdered_)
       appendMinorVector(vec);
    else
       appendMajorVector(vec);
+   change.done();
 }
 #endif
 //-----------------------------------------------------------------------------
@@ -248,10 +876,14 @@ CoinPackedMatrix::appendRow(const int vecsize,
 			   const int *vecind,
 			   const double *vecelem)
 {
+   CoinOrthoChange change(*this, orthoBusy_, keepOrthoCache());
+   if (change.kept())
+      orthoDelta_->addVector(CoinOrthoDelta::appendRows, vecsize, vecind, vecelem);
    if (colOrdered_)
       appendMinorVector(vecsize, vecind, vecelem);
    else
       appendMajorVector(vecsize, vecind, vecelem);
+   change.done();
 }
 
 //-----------------------------------------------------------------------------
@@ -260,11 +892,13 @@ void
 CoinPackedMatrix::appendRows(const int numrows,
 			    const CoinPackedVectorBase * const * rows)
 {
+  if (numrows == 0)
+    return;
+  CoinOrthoChange change(*this, orthoBusy_, keepOrthoCache());
+  if (change.kept())
+    orthoDelta_->addVectors(CoinOrthoDelta::appendRows, numrows, rows);
   if (colOrdered_) {
     // make sure enough columns
-    if (numrows == 0)
-      return;
-
     int i;
     int maxDim=-1;
     for (i = numrows - 1; i >= 0; --i) {
@@ -286,6 +920,7 @@ CoinPackedMatrix::appendRows(const int numrows,
   } else {
     appendMajorVectors(numrows, rows);
   }
+  change.done();
 }
 #endif
 //-----------------------------------------------------------------------------
@@ -295,12 +930,18 @@ CoinPackedMatrix::appendRows(const int numrows,
                              const CoinBigIndex * rowStarts, const int * column,
                              const double * element, int numberColumns)
 {
+   CoinOrthoChange change(*this, orthoBusy_, keepOrthoCache());
+   if (change.kept())
+      orthoDelta_->addVectors(CoinOrthoDelta::appendRows, numrows, rowStarts,
+			       column, element);
   int numberErrors;
   if (colOrdered_) {
     numberErrors=appendMinor(numrows, rowStarts, column, element, numberColumns);
   } else {
     numberErrors=appendMajor(numrows, rowStarts, column, element, numberColumns);
   }
+  // if any errors copy may not match
+  change.done(numberErrors == 0);
   return numberErrors;
 }
 
@@ -309,6 +950,7 @@ CoinPackedMatrix::appendRows(const int numrows,
 void
 CoinPackedMatrix::rightAppendPackedMatrix(const CoinPackedMatrix& matrix)
 {
+   clearCaches();
    if (colOrdered_) {
       if (matrix.colOrdered_) {
 	 majorAppendSameOrdered(matrix);
@@ -329,6 +971,7 @@ CoinPackedMatrix::rightAppendPackedMatrix(const CoinPackedMatrix& matrix)
 void
 CoinPackedMatrix::bottomAppendPackedMatrix(const CoinPackedMatrix& matrix)
 {
+   clearCaches();
    if (colOrdered_) {
       if (matrix.colOrdered_) {
 	 minorAppendSameOrdered(matrix);
@@ -350,10 +993,14 @@ void
 CoinPackedMatrix::deleteCols(const int numDel, const int * indDel)
 {
   if (numDel) {
+    CoinOrthoChange change(*this, orthoBusy_, keepOrthoCache());
+    if (change.kept())
+      orthoDelta_->addVector(CoinOrthoDelta::deleteCols, numDel, indDel, NULL);
     if (colOrdered_)
       deleteMajorVectors(numDel, indDel);
     else
       deleteMinorVectors(numDel, indDel);
+    change.done();
   }
 }
 
@@ -363,10 +1010,14 @@ void
 CoinPackedMatrix::deleteRows(const int numDel, const int * indDel)
 {
   if (numDel) {
+    CoinOrthoChange change(*this, orthoBusy_, keepOrthoCache());
+    if (change.kept())
+      orthoDelta_->addVector(CoinOrthoDelta::deleteRows, numDel, indDel, NULL);
     if (colOrdered_)
       deleteMinorVectors(numDel, indDel);
     else
       deleteMajorVectors(numDel, indDel);
+    change.done();
   }
 }
 
@@ -379,9 +1030,20 @@ CoinPackedMatrix::replaceVector(const int index,
 			       const int numReplace, 
 			       const double * newElements)
 {
+   checkNarrow("replaceVector");
   if (index >= 0 && index < majorDim_) {
     int length = (length_[index] < numReplace) ? length_[index] : numReplace;
+    const bool sorted = sortedIndices_;
+    if (keepOrthoCache()) {
+      for (int i = 0; i < length; i++) {
+	const int other = index_[start_[index]+i];
+	orthoDelta_->addModify(colOrdered_ ? other : index,
+			       colOrdered_ ? index : other,
+			       newElements[i], true);
+      }
+    }
     CoinMemcpyN(newElements, length, element_ + start_[index]);
+    sortedIndices_ = sorted;
   } else {
 #ifdef COIN_DEBUG
     throw CoinError("bad index", "replaceVector", "CoinPackedMatrix");
@@ -395,6 +1057,7 @@ void
 CoinPackedMatrix::modifyCoefficient(int row, int column, double newElement,
 				    bool keepZero)
 {
+   checkNarrow("modifyCoefficient");
   int minorIndex,majorIndex;
   if (colOrdered_) {
     majorIndex=column;
@@ -403,29 +1066,35 @@ CoinPackedMatrix::modifyCoefficient(int row, int column, double newElement,
     minorIndex=column;
     majorIndex=row;
   }
+  // order is kept (if indices are sorted new element goes in place)
+  const bool sorted = sortedIndices_;
+  CoinOrthoChange change(*this, orthoBusy_, keepOrthoCache());
+  if (change.kept() && majorIndex >= 0 && majorIndex < majorDim_ &&
+      minorIndex >= 0 && minorIndex < minorDim_)
+    orthoDelta_->addModify(row, column, newElement, keepZero);
   if (majorIndex >= 0 && majorIndex < majorDim_) {
     if (minorIndex >= 0 && minorIndex < minorDim_) {
-      CoinBigIndex j;
+      CoinBigIndex j = findMinor(majorIndex, minorIndex);
       CoinBigIndex end=start_[majorIndex]+length_[majorIndex];;
-      for (j=start_[majorIndex];j<end;j++) {
-	if (minorIndex==index_[j]) {
-	  // replacement
-	  if (newElement||keepZero) {
-	    element_[j]=newElement;
-	  } else {
-	    // pack down and return
-	    length_[majorIndex]--;
-	    end--;
-	    size_--;
-	    for (;j<end;j++) {
-	      element_[j]=element_[j+1];
-	      index_[j]=index_[j+1];
-	    }
+      if (j>=0) {
+	// replacement
+	if (newElement||keepZero) {
+	  element_[j]=newElement;
+	} else {
+	  // pack down and return
+	  length_[majorIndex]--;
+	  end--;
+	  size_--;
+	  for (;j<end;j++) {
+	    element_[j]=element_[j+1];
+	    index_[j]=index_[j+1];
 	  }
-	  return;
 	}
+	sortedIndices_ = sorted;
+	change.done();
+	return;
       }
-      if (j==end&&(newElement||keepZero)) {
+      if (newElement||keepZero) {
 	// we need to insert - keep in minor order if possible
 	if (end>=start_[majorIndex+1]) {
 	   int * addedEntries = new int[majorDim_];
@@ -463,13 +1132,213 @@ CoinPackedMatrix::modifyCoefficient(int row, int column, double newElement,
 		    "CoinPackedMatrix");
 #endif
   }
+  sortedIndices_ = sorted;
+  change.done();
+}
+
+//-----------------------------------------------------------------------------
+
+void
+CoinPackedMatrix::modifyCoefficients(int number, const int * rows,
+				     const int * columns, const double * values,
+				     bool keepZero)
+{
+  checkNarrow("modifyCoefficients");
+  if (number <= 0)
+    return;
+  const int * majorIndex = colOrdered_ ? columns : rows;
+  const int * minorIndex = colOrdered_ ? rows : columns;
+  // order is kept (if indices are sorted new elements go in place)
+  const bool sorted = sortedIndices_;
+  CoinOrthoChange change(*this, orthoBusy_, keepOrthoCache());
+  // bucket changes by major vector (stable so last of duplicates wins)
+  int * first = new int[majorDim_ + 1];
+  CoinZeroN(first, majorDim_ + 1);
+  for (int k = 0; k < number; ++k) {
+    const int iMajor = majorIndex[k];
+    const int iMinor = minorIndex[k];
+    if (iMajor >= 0 && iMajor < majorDim_ &&
+	iMinor >= 0 && iMinor < minorDim_) {
+      ++first[iMajor];
+      if (change.kept())
+	orthoDelta_->addModify(rows[k], columns[k], values[k], keepZero);
+    } else {
+#ifdef COIN_DEBUG
+      delete [] first;
+      throw CoinError("bad index", "modifyCoefficients", "CoinPackedMatrix");
+#endif
+    }
+  }
+  for (int i = 0; i < majorDim_; ++i)
+    first[i+1] += first[i];
+  int * which = new int[first[majorDim_]];
+  for (int k = number - 1; k >= 0; --k) {
+    const int iMajor = majorIndex[k];
+    const int iMinor = minorIndex[k];
+    if (iMajor >= 0 && iMajor < majorDim_ &&
+	iMinor >= 0 && iMinor < minorDim_)
+      which[--first[iMajor]] = k;
+  }
+  /* First pass - replace and delete existing elements and leave new ones
+     (in increasing minor order) at start of each bucket */
+  int * added = new int[majorDim_];
+  CoinZeroN(added, majorDim_);
+  CoinBigIndex * mark = NULL;
+  bool resize = false;
+  CoinBigIndex numberAdded = 0;
+  const CoinModifyOrder order(minorIndex);
+  for (int i = 0; i < majorDim_; ++i) {
+    int * bucket = which + first[i];
+    int n = first[i+1] - first[i];
+    if (!n)
+      continue;
+    if (n > 1) {
+      std::sort(bucket, bucket + n, order);
+      // keep last of each minor index
+      int nUnique = 0;
+      for (int k = 0; k < n; ++k) {
+	if (k + 1 < n && minorIndex[bucket[k]] == minorIndex[bucket[k+1]])
+	  continue;
+	bucket[nUnique++] = bucket[k];
+      }
+      n = nUnique;
+    }
+    const CoinBigIndex start = start_[i];
+    const CoinBigIndex end = start + length_[i];
+    if (!sorted && n > 4 && !mark) {
+      mark = new CoinBigIndex[minorDim_];
+      CoinFillN(mark, minorDim_, static_cast<CoinBigIndex>(-1));
+    }
+    const bool useMark = !sorted && n > 4;
+    if (useMark) {
+      for (CoinBigIndex j = start; j < end; ++j)
+	mark[index_[j]] = j;
+    }
+    int nAdd = 0;
+    int nDelete = 0;
+    CoinBigIndex from = start;
+    for (int k = 0; k < n; ++k) {
+      const int iChange = bucket[k];
+      const int iMinor = minorIndex[iChange];
+      const double value = values[iChange];
+      CoinBigIndex j;
+      if (useMark) {
+	j = mark[iMinor];
+      } else if (sorted) {
+	// changes are in increasing order so search rest of vector
+	from = std::lower_bound(index_ + from, index_ + end, iMinor) - index_;
+	j = (from < end && index_[from] == iMinor) ? from : -1;
+      } else {
+	j = findMinor(i, iMinor);
+      }
+      if (j >= 0) {
+	if (value || keepZero) {
+	  element_[j] = value;
+	} else {
+	  index_[j] = -1;
+	  if (useMark)
+	    mark[iMinor] = -1;
+	  ++nDelete;
+	}
+      } else if (value || keepZero) {
+	bucket[nAdd++] = iChange;
+      }
+    }
+    if (useMark) {
+      for (CoinBigIndex j = start; j < end; ++j) {
+	if (index_[j] >= 0)
+	  mark[index_[j]] = -1;
+      }
+    }
+    if (nDelete) {
+      CoinBigIndex put = start;
+      for (CoinBigIndex j = start; j < end; ++j) {
+	if (index_[j] >= 0) {
+	  index_[put] = index_[j];
+	  element_[put++] = element_[j];
+	}
+      }
+      length_[i] -= nDelete;
+      size_ -= nDelete;
+    }
+    added[i] = nAdd;
+    numberAdded += nAdd;
+    if (start + length_[i] + nAdd > start_[i+1])
+      resize = true;
+  }
+  delete [] mark;
+  // grow storage once for all new elements
+  if (resize)
+    resizeForAddingMinorVectors(added);
+  // second pass - put in new elements
+  if (numberAdded) {
+    for (int i = 0; i < majorDim_; ++i) {
+      const int nAdd = added[i];
+      if (!nAdd)
+	continue;
+      const int * bucket = which + first[i];
+      const CoinBigIndex start = start_[i];
+      CoinBigIndex j = start + length_[i] - 1;
+      CoinBigIndex put = j + nAdd;
+      if (sorted) {
+	// merge from end
+	for (int k = nAdd - 1; k >= 0; --k) {
+	  const int iChange = bucket[k];
+	  const int iMinor = minorIndex[iChange];
+	  while (j >= start && index_[j] > iMinor) {
+	    index_[put] = index_[j];
+	    element_[put--] = element_[j--];
+	  }
+	  index_[put] = iMinor;
+	  element_[put--] = values[iChange];
+	}
+      } else {
+	for (int k = 0; k < nAdd; ++k) {
+	  const int iChange = bucket[k];
+	  index_[++j] = minorIndex[iChange];
+	  element_[j] = values[iChange];
+	}
+      }
+      length_[i] += nAdd;
+    }
+    size_ += numberAdded;
+  }
+  delete [] first;
+  delete [] which;
+  delete [] added;
+  sortedIndices_ = sorted;
+  change.done();
 }
+
+//-----------------------------------------------------------------------------
+// Position of minor index in major vector (-1 if not there)
+
+CoinBigIndex
+CoinPackedMatrix::findMinor(int majorIndex, int minorIndex) const
+{
+  const CoinBigIndex start = start_[majorIndex];
+  const CoinBigIndex end = start + length_[majorIndex];
+  if (sortedIndices_) {
+    const int * position =
+      std::lower_bound(index_ + start, index_ + end, minorIndex);
+    if (position != index_ + end && *position == minorIndex)
+      return position - index_;
+  } else {
+    for (CoinBigIndex j = start; j < end; ++j) {
+      if (index_[j] == minorIndex)
+	return j;
+    }
+  }
+  return -1;
+}
+
 /* Return one element of packed matrix.
    This works for either ordering
    If it is not present will return 0.0 */
 double 
 CoinPackedMatrix::getCoefficient(int row, int column) const
 {
+   checkNarrow("getCoefficient");
   int minorIndex,majorIndex;
   if (colOrdered_) {
     majorIndex=column;
@@ -481,14 +1350,9 @@ CoinPackedMatrix::getCoefficient(int row, int column) const
   double value=0.0;
   if (majorIndex >= 0 && majorIndex < majorDim_) {
     if (minorIndex >= 0 && minorIndex < minorDim_) {
-      CoinBigIndex j;
-      CoinBigIndex end=start_[majorIndex]+length_[majorIndex];;
-      for (j=start_[majorIndex];j<end;j++) {
-	if (minorIndex==index_[j]) {
-          value = element_[j];
-          break;
-	}
-      }
+      const CoinBigIndex j = findMinor(majorIndex, minorIndex);
+      if (j >= 0)
+	value = element_[j];
     } else {
 #ifdef COIN_DEBUG
       throw CoinError("bad minor index", "modifyCoefficient",
@@ -510,39 +1374,15 @@ CoinPackedMatrix::getCoefficient(int row, int column) const
    The column starts are not affected.  Returns number of elements
    eliminated.  Elements eliminated are at end of each vector
 */
-int 
+int
 CoinPackedMatrix::compress(double threshold)
 {
-  CoinBigIndex numberEliminated =0;
-  // space for eliminated
-  int * eliminatedIndex = new int[minorDim_];
-  double * eliminatedElement = new double[minorDim_];
-  int i;
-  for (i=0;i<majorDim_;i++) {
-    int length = length_[i];
-    CoinBigIndex k=start_[i];
-    int kbad=0;
-    CoinBigIndex j;
-    for (j=start_[i];j<start_[i]+length;j++) {
-      if (fabs(element_[j])>=threshold) {
-	element_[k]=element_[j];
-	index_[k++]=index_[j];
-      } else {
-	eliminatedElement[kbad]=element_[j];
-	eliminatedIndex[kbad++]=index_[j];
-      }
-    }
-    if (kbad) {
-      numberEliminated += kbad;
-      length_[i] = k-start_[i];
-      memcpy(index_+k,eliminatedIndex,kbad*sizeof(int));
-      memcpy(element_+k,eliminatedElement,kbad*sizeof(double));
-    }
-  }
-  size_ -= numberEliminated;
-  delete [] eliminatedIndex;
-  delete [] eliminatedElement;
-  return numberEliminated;
+   checkNarrow("compress");
+   clearCaches();
+   CoinBigIndex numberDuplicates;
+   CoinBigIndex numberSmall;
+   gutsOfClean(0, threshold, numberDuplicates, numberSmall);
+   return numberSmall;
 }
 //#############################################################################
 /* Eliminate all elements in matrix whose 
@@ -550,50 +1390,85 @@ CoinPackedMatrix::compress(double threshold)
    The column starts are not affected.  Returns number of elements
    eliminated. 
 */
-int 
+int
 CoinPackedMatrix::eliminateDuplicates(double threshold)
 {
-  CoinBigIndex numberEliminated =0;
-  // space for eliminated
-  int * mark = new int [minorDim_];
-  int i;
-  for (i=0;i<minorDim_;i++)
-    mark[i]=-1;
-  for (i=0;i<majorDim_;i++) {
-    CoinBigIndex k=start_[i];
-    CoinBigIndex end = k+length_[i];
-    CoinBigIndex j;
-    for (j=k;j<end;j++) {
-      int index = index_[j];
-      if (mark[index]==-1) {
-	mark[index]=j;
-      } else {
-	// duplicate
-	int jj = mark[index];
-	element_[jj] += element_[j];
-	element_[j]=0.0;
-      }
-    }
-    for (j=k;j<end;j++) {
-      int index = index_[j];
-      mark[index]=-1;
-      if (fabs(element_[j])>=threshold) {
-	element_[k]=element_[j];
-	index_[k++]=index_[j];
-      }
-    }
-    numberEliminated += end-k;
-    length_[i] = k-start_[i];
-  }
-  size_ -= numberEliminated;
-  delete [] mark;
-  return numberEliminated;
+   return eliminateDuplicates(threshold, NULL, NULL);
+}
+
+//-----------------------------------------------------------------------------
+
+int
+CoinPackedMatrix::eliminateDuplicates(double threshold,
+				      CoinBigIndex * numberDuplicates,
+				      CoinBigIndex * numberSmall)
+{
+   checkNarrow("eliminateDuplicates");
+   // order of what is left is kept
+   const bool sorted = sortedIndices_;
+   clearCaches();
+   CoinBigIndex nDuplicates;
+   CoinBigIndex nSmall;
+   gutsOfClean(1, threshold, nDuplicates, nSmall);
+   sortedIndices_ = sorted;
+   if (numberDuplicates)
+      *numberDuplicates = nDuplicates;
+   if (numberSmall)
+      *numberSmall = nSmall;
+   return nDuplicates + nSmall;
+}
+
+//-----------------------------------------------------------------------------
+// Merges duplicates and removes small elements of each major vector in place
+
+void
+CoinPackedMatrix::gutsOfClean(int mode, double threshold,
+			      CoinBigIndex & numberDuplicates,
+			      CoinBigIndex & numberSmall)
+{
+   CoinThreadPool * pool = coinMatrixPool(size_);
+   // a few pieces for each thread (work space is for each thread)
+   const int numberThreads = pool ? pool->numberThreads() : 1;
+   const int numberPieces = pool ?
+      CoinMin(4 * numberThreads, majorDim_ + 1) : 1;
+   CoinBigIndex * counts = new CoinBigIndex[2 * numberPieces];
+   CoinCleanVectorsTask task(numberThreads);
+   task.start_ = start_;
+   task.length_ = length_;
+   task.index_ = index_;
+   task.element_ = element_;
+   task.majorDim_ = majorDim_;
+   task.minorDim_ = minorDim_;
+   task.numberPieces_ = numberPieces;
+   task.mode_ = mode;
+   task.threshold_ = threshold;
+   task.numberDuplicates_ = counts;
+   task.numberSmall_ = counts + numberPieces;
+   if (pool)
+      pool->run(task, numberPieces);
+   else
+      task.run(0);
+   numberDuplicates = 0;
+   numberSmall = 0;
+   for (int i = 0; i < numberPieces; ++i) {
+      numberDuplicates += counts[i];
+      numberSmall += counts[numberPieces + i];
+   }
+   delete [] counts;
+   size_ -= numberDuplicates + numberSmall;
 }
 //#############################################################################
 
 void
 CoinPackedMatrix::removeGaps(double removeValue)
 {
+   if (wideStart_) {
+      // never has gaps
+      if (removeValue<0.0)
+	 return;
+      checkNarrow("removeGaps");
+   }
+   clearCaches();
   if (removeValue<0.0) {
     if (size_<start_[majorDim_]) {
 #if 1
@@ -671,73 +1546,64 @@ CoinPackedMatrix::removeGaps(double removeValue)
    d) orders elements
    returns number of elements eliminated
 */
-int 
+int
 CoinPackedMatrix::cleanMatrix(double threshold)
 {
-  if (!majorDim_) {
-    extraGap_=0.0;
-    extraMajor_=0.0;
-    return 0;
-  }
-  CoinBigIndex numberEliminated =0;
-  // space for eliminated
-  int * mark = new int [minorDim_];
-  int i;
-  for (i=0;i<minorDim_;i++)
-    mark[i]=-1;
-  CoinBigIndex n = 0;
-  for (i=0;i<majorDim_;i++) {
-    CoinBigIndex k=start_[i];
-    start_[i]=n;
-    CoinBigIndex end = k+length_[i];
-    CoinBigIndex j;
-    for (j=k;j<end;j++) {
-      int index = index_[j];
-      if (mark[index]==-1) {
-	mark[index]=j;
-      } else {
-	// duplicate
-	int jj = mark[index];
-	element_[jj] += element_[j];
-	element_[j]=0.0;
-      }
-    }
-    for (j=k;j<end;j++) {
-      int index = index_[j];
-      mark[index]=-1;
-      if (fabs(element_[j])>=threshold) {
-	element_[n]=element_[j];
-	index_[n++]=index_[j];
-	k++;
-      }
-    }
-    numberEliminated += end-k;
-    length_[i] = n-start_[i];
-    // sort
-    CoinSort_2(index_+start_[i],index_+n,element_+start_[i]);
-  }
-  start_[majorDim_]=n;
-  size_ -= numberEliminated;
-  assert (n==size_);
-  delete [] mark;
-  extraGap_=0.0;
-  extraMajor_=0.0;
-  maxMajorDim_=majorDim_;
-  maxSize_=size_;
-  // Now reallocate - do smallest ones first
-  int * temp = CoinCopyOfArray(length_,majorDim_);
-  delete [] length_;
-  length_ = temp;
-  CoinBigIndex * temp2 = CoinCopyOfArray(start_,majorDim_+1);
-  delete [] start_;
-  start_ = temp2;
-  temp = CoinCopyOfArray(index_,size_);
-  delete [] index_;
-  index_ = temp;
-  double * temp3 = CoinCopyOfArray(element_,size_);
-  delete [] element_;
-  element_ = temp3;
-  return numberEliminated;
+   return cleanMatrix(threshold, NULL, NULL);
+}
+
+//-----------------------------------------------------------------------------
+
+int
+CoinPackedMatrix::cleanMatrix(double threshold,
+			      CoinBigIndex * numberDuplicates,
+			      CoinBigIndex * numberSmall)
+{
+   checkNarrow("cleanMatrix");
+   clearCaches();
+   CoinBigIndex nDuplicates = 0;
+   CoinBigIndex nSmall = 0;
+   if (majorDim_) {
+      gutsOfClean(2, threshold, nDuplicates, nSmall);
+      // copy to arrays of exact size without gaps
+      CoinBigIndex * newStart = new CoinBigIndex[majorDim_ + 1];
+      newStart[0] = 0;
+      for (int i = 0; i < majorDim_; ++i)
+	 newStart[i+1] = newStart[i] + length_[i];
+      assert (newStart[majorDim_] == size_);
+      CoinCopyVectorsTask copy;
+      copy.start_ = start_;
+      copy.length_ = length_;
+      copy.index_ = index_;
+      copy.element_ = element_;
+      copy.newStart_ = newStart;
+      copy.newIndex_ = coinNewMatrixArray<int>(memoryPolicy_, size_);
+      copy.newElement_ = coinNewMatrixArray<double>(memoryPolicy_, size_);
+      CoinThreadPool * pool = coinMatrixPool(size_);
+      if (pool)
+	 pool->parallelFor(copy, 0, majorDim_);
+      else
+	 copy.run(0, majorDim_);
+      int * newLength = CoinCopyOfArray(length_, majorDim_);
+      coinDeleteStart(start_);
+      delete [] length_;
+      coinDeleteMatrixArray(memoryPolicy_, index_);
+      coinDeleteMatrixArray(memoryPolicy_, element_);
+      start_ = newStart;
+      length_ = newLength;
+      index_ = copy.newIndex_;
+      element_ = copy.newElement_;
+      maxMajorDim_ = majorDim_;
+      maxSize_ = size_;
+   }
+   extraGap_ = 0.0;
+   extraMajor_ = 0.0;
+   sortedIndices_ = true;
+   if (numberDuplicates)
+      *numberDuplicates = nDuplicates;
+   if (numberSmall)
+      *numberSmall = nSmall;
+   return nDuplicates + nSmall;
 }
 
 //#############################################################################
@@ -746,6 +1612,9 @@ void
 CoinPackedMatrix::submatrixOf(const CoinPackedMatrix& matrix,
 			     const int numMajor, const int * indMajor)
 {
+   matrix.checkNarrow("submatrixOf");
+   removeWide();
+   clearCaches();
    int i;
    int* sortedIndPtr = CoinTestIndexSet(numMajor, indMajor, matrix.majorDim_,
 				       "submatrixOf");
@@ -766,8 +1635,8 @@ CoinPackedMatrix::submatrixOf(const CoinPackedMatrix& matrix,
    length_ = new int[maxMajorDim_];
    start_ = new CoinBigIndex[maxMajorDim_+1];
    start_[0]=0;
-   index_ = new int[maxSize_];
-   element_ = new double[maxSize_];
+   index_ = coinNewMatrixArray<int>(memoryPolicy_,maxSize_);
+   element_ = coinNewMatrixArray<double>(memoryPolicy_,maxSize_);
    majorDim_ = 0;
    minorDim_ = matrix.minorDim_;
    size_ = 0;
@@ -793,6 +1662,9 @@ void
 CoinPackedMatrix::submatrixOfWithDuplicates(const CoinPackedMatrix& matrix,
 			     const int numMajor, const int * indMajor)
 {
+   checkNarrow("submatrixOfWithDuplicates");
+   matrix.checkNarrow("submatrixOfWithDuplicates");
+   clearCaches();
   int i;
   // we allow duplicates - can be useful
 #ifndef NDEBUG
@@ -821,8 +1693,8 @@ CoinPackedMatrix::submatrixOfWithDuplicates(const CoinPackedMatrix& matrix,
   }
   start_[maxMajorDim_]=nzcnt;
   maxSize_ = nzcnt ;
-  index_ = new int[maxSize_];
-  element_ = new double[maxSize_];
+  index_ = coinNewMatrixArray<int>(memoryPolicy_,maxSize_);
+  element_ = coinNewMatrixArray<double>(memoryPolicy_,maxSize_);
   majorDim_ = maxMajorDim_;
   minorDim_ = matrix.minorDim_;
   size_ = 0;
@@ -847,8 +1719,15 @@ CoinPackedMatrix::submatrixOfWithDuplicates(const CoinPackedMatrix& matrix,
 void
 CoinPackedMatrix::copyOf(const CoinPackedMatrix& rhs)
 {
+   clearCaches();
    if (this != &rhs) {
       gutsOfDestructor();
+      if (rhs.wideStart_) {
+	 extraGap_ = rhs.extraGap_;
+	 extraMajor_ = rhs.extraMajor_;
+	 gutsOfCopyWide(rhs);
+	 return;
+      }
       gutsOfCopyOf(rhs.colOrdered_,
 		   rhs.minorDim_, rhs.majorDim_, rhs.size_,
 		   rhs.element_, rhs.index_, rhs.start_, rhs.length_,
@@ -866,6 +1745,8 @@ CoinPackedMatrix::copyOf(const bool colordered,
 			const CoinBigIndex * start, const int * len,
 			const double extraMajor, const double extraGap)
 {
+   removeWide();
+   clearCaches();
    gutsOfDestructor();
    gutsOfCopyOf(colordered, minor, major, numels, elem, ind, start, len,
 		extraMajor, extraGap);
@@ -877,6 +1758,9 @@ CoinPackedMatrix::copyOf(const bool colordered,
 void 
 CoinPackedMatrix::copyReuseArrays(const CoinPackedMatrix& rhs)
 {
+   rhs.checkNarrow("copyReuseArrays");
+   removeWide();
+   clearCaches();
   assert (colOrdered_==rhs.colOrdered_);
   if (maxMajorDim_>=rhs.majorDim_&&maxSize_>=rhs.size_) {
     majorDim_ = rhs.majorDim_;
@@ -911,10 +1795,44 @@ CoinPackedMatrix::copyReuseArrays(const CoinPackedMatrix& rhs)
 void
 CoinPackedMatrix::reverseOrderedCopyOf(const CoinPackedMatrix& rhs)
 {
+   clearCaches();
    if (this == &rhs) {
       reverseOrdering();
       return;
    }
+   removeWide();
+   if (rhs.wideStart_) {
+      // wide result (without gaps)
+      gutsOfDestructor();
+      colOrdered_ = !rhs.colOrdered_;
+      majorDim_ = rhs.minorDim_;
+      minorDim_ = rhs.majorDim_;
+      size_ = rhs.size_;
+      maxMajorDim_ = majorDim_;
+      maxSize_ = size_;
+      const CoinInt64 numberElements = rhs.wideStart_[rhs.majorDim_];
+      length_ = new int[majorDim_];
+      rhs.countOrthoLength(length_);
+      wideStart_ = new CoinInt64[majorDim_ + 1];
+      wideStart_[0] = 0;
+      for (int i = 0; i < majorDim_; ++i)
+	 wideStart_[i+1] = wideStart_[i] + length_[i];
+      index_ = coinNewMatrixArray<int>(memoryPolicy_, numberElements);
+      element_ = coinNewMatrixArray<double>(memoryPolicy_, numberElements);
+      const CoinInt64 * start = rhs.wideStart_;
+      for (int i = 0; i < minorDim_; ++i) {
+	 for (CoinInt64 j = start[i]; j < start[i+1]; ++j) {
+	    const int ind = rhs.index_[j];
+	    CoinInt64 put = wideStart_[ind]++;
+	    element_[put] = rhs.element_[j];
+	    index_[put] = i;
+	 }
+      }
+      for (int i = 0; i < majorDim_; ++i)
+	 wideStart_[i] -= length_[i];
+      sortedIndices_ = true;
+      return;
+   }
 
    int i;
    colOrdered_ = !rhs.colOrdered_;
@@ -925,10 +1843,10 @@ CoinPackedMatrix::reverseOrderedCopyOf(const CoinPackedMatrix& rhs)
    if (size_ == 0) {
      // we still need to allocate starts and lengths
      maxMajorDim_=majorDim_;
-     delete[] start_;
+     coinDeleteStart(start_);
      delete[] length_;
-     delete[] index_;
-     delete[] element_;
+     coinDeleteMatrixArray(memoryPolicy_,index_);
+     coinDeleteMatrixArray(memoryPolicy_,element_);
      start_ = new CoinBigIndex[maxMajorDim_ + 1];
      length_ = new int[maxMajorDim_];
      for (i = 0; i < majorDim_; ++i) {
@@ -936,8 +1854,9 @@ CoinPackedMatrix::reverseOrderedCopyOf(const CoinPackedMatrix& rhs)
        length_[i]=0;
      }
      start_[majorDim_]=0;
-     index_ = new int[maxSize_];
-     element_ = new double[maxSize_];
+     index_ = coinNewMatrixArray<int>(memoryPolicy_,maxSize_);
+     element_ = coinNewMatrixArray<double>(memoryPolicy_,maxSize_);
+     sortedIndices_ = true;
      return;
    }
 
@@ -949,14 +1868,24 @@ CoinPackedMatrix::reverseOrderedCopyOf(const CoinPackedMatrix& rhs)
 
    if (newMaxMajorDim_ > maxMajorDim_) {
       maxMajorDim_ = newMaxMajorDim_;
-      delete[] start_;
+      coinDeleteStart(start_);
       delete[] length_;
       start_ = new CoinBigIndex[maxMajorDim_ + 1];
       length_ = new int[maxMajorDim_];
    }
    // first compute how long each major-dimension vector will be
    int * COIN_RESTRICT orthoLength = length_;
-   rhs.countOrthoLength(orthoLength);
+   /* In parallel keep counts for each share of rhs so the shares can be
+      put in at the same time (a parallel counting sort) */
+   CoinThreadPool * pool = coinMatrixPool(size_);
+   const int numberPieces = pool ? pool->numberThreads() : 1;
+   CoinBigIndex * counts = NULL;
+   if (pool && static_cast<CoinBigIndex>(majorDim_) * numberPieces <= size_) {
+     counts = new CoinBigIndex [static_cast<CoinBigIndex>(numberPieces)*majorDim_];
+     coinCountOrthoPieces(pool, numberPieces, rhs, counts, orthoLength);
+   } else {
+     rhs.countOrthoLength(orthoLength);
+   }
 
    start_[0] = 0;
    if (extraGap_ == 0) {
@@ -973,10 +1902,10 @@ CoinPackedMatrix::reverseOrderedCopyOf(const CoinPackedMatrix& rhs)
 
    if (newMaxSize > maxSize_) {
       maxSize_ = newMaxSize;
-      delete[] index_;
-      delete[] element_;
-      index_ = new int[maxSize_];
-      element_ = new double[maxSize_];
+      coinDeleteMatrixArray(memoryPolicy_,index_);
+      coinDeleteMatrixArray(memoryPolicy_,element_);
+      index_ = coinNewMatrixArray<int>(memoryPolicy_,maxSize_);
+      element_ = coinNewMatrixArray<double>(memoryPolicy_,maxSize_);
 #     ifdef ZEROFAULT
       memset(index_,0,(maxSize_*sizeof(int))) ;
       memset(element_,0,(maxSize_*sizeof(double))) ;
@@ -990,6 +1919,30 @@ CoinPackedMatrix::reverseOrderedCopyOf(const CoinPackedMatrix& rhs)
    const int * COIN_RESTRICT index = rhs.index_;
    const int * COIN_RESTRICT length = rhs.length_;
    const double * COIN_RESTRICT element = rhs.element_;
+   if (counts) {
+     CoinOrthoOffsetsTask offsets;
+     offsets.counts_ = counts;
+     offsets.start_ = start_;
+     offsets.minorDim_ = majorDim_;
+     offsets.numberPieces_ = numberPieces;
+     pool->parallelFor(offsets, 0, majorDim_);
+     CoinScatterOrthoTask scatter;
+     scatter.start_ = start;
+     scatter.length_ = length;
+     scatter.index_ = index;
+     scatter.element_ = element;
+     scatter.majorDim_ = minorDim_;
+     scatter.minorDim_ = majorDim_;
+     scatter.numberPieces_ = numberPieces;
+     scatter.offsets_ = counts;
+     scatter.newIndex_ = index_;
+     scatter.newElement_ = element_;
+     pool->run(scatter, numberPieces);
+     delete [] counts;
+     // each piece of rhs goes after the one before
+     sortedIndices_ = true;
+     return;
+   }
    assert (start[0]==0);
    CoinBigIndex first = 0;
    for (i = 0; i < minorDim_; ++i) {
@@ -1033,6 +1986,7 @@ CoinPackedMatrix::reverseOrderedCopyOf(const CoinPackedMatrix& rhs)
    for (i = 0; i < majorDim_; ++i) {
      start_[i] -= length_[i];
    }
+   sortedIndices_ = true;
 }
    
 //#############################################################################
@@ -1045,6 +1999,8 @@ CoinPackedMatrix::assignMatrix(const bool colordered,
 			      CoinBigIndex *& start, int *& len,
 			      const int maxmajor, const CoinBigIndex maxsize)
 {
+   removeWide();
+   clearCaches();
    gutsOfDestructor();
    colOrdered_ = colordered;
    element_ = elem;
@@ -1055,6 +2011,13 @@ CoinPackedMatrix::assignMatrix(const bool colordered,
    size_ = numels;
    maxMajorDim_ = maxmajor != -1 ? maxmajor : major;
    maxSize_ = maxsize != -1 ? maxsize : numels;
+   if (memoryPolicy_) {
+     // arrays were allocated by new[] so copy
+     element_ = coinCopyMatrixArray(memoryPolicy_,elem,maxSize_);
+     index_ = coinCopyMatrixArray(memoryPolicy_,ind,maxSize_);
+     delete [] elem;
+     delete [] ind;
+   }
    if (len == NULL) {
      delete [] length_;
      length_ = new int[maxMajorDim_];
@@ -1078,13 +2041,31 @@ CoinPackedMatrix::operator=(const CoinPackedMatrix& rhs)
       gutsOfDestructor();
       extraGap_=rhs.extraGap_;
       extraMajor_=rhs.extraMajor_;
+      if (rhs.wideStart_) {
+	 gutsOfCopyWide(rhs);
+	 sortedIndices_ = rhs.sortedIndices_;
+	 return *this;
+      }
       gutsOfOpEqual(rhs.colOrdered_,
 		    rhs.minorDim_,  rhs.majorDim_, rhs.size_,
 		    rhs.element_, rhs.index_, rhs.start_, rhs.length_);
+      sortedIndices_ = rhs.sortedIndices_;
    }
    return *this;
 }
 
+//-----------------------------------------------------------------------------
+
+#if __cplusplus >= 201103L
+CoinPackedMatrix &
+CoinPackedMatrix::operator=(CoinPackedMatrix&& rhs) noexcept
+{
+   if (this != &rhs)
+      gutsOfMove(rhs);
+   return *this;
+}
+#endif
+
 //#############################################################################
 
 void
@@ -1093,6 +2074,7 @@ CoinPackedMatrix::reverseOrdering()
    CoinPackedMatrix m;
    m.extraGap_ = extraMajor_;
    m.extraMajor_ = extraGap_;
+   m.memoryPolicy_ = memoryPolicy_;
    m.reverseOrderedCopyOf(*this);
    swap(m);
 }
@@ -1102,6 +2084,7 @@ CoinPackedMatrix::reverseOrdering()
 void
 CoinPackedMatrix::transpose()
 {
+   clearCaches();
    colOrdered_ = ! colOrdered_;
 }
 
@@ -1122,6 +2105,51 @@ CoinPackedMatrix::swap(CoinPackedMatrix& m)
    std::swap(size_,	   m.size_);
    std::swap(maxMajorDim_, m.maxMajorDim_);
    std::swap(maxSize_,     m.maxSize_);
+   std::swap(memoryPolicy_, m.memoryPolicy_);
+   std::swap(appendMoves_, m.appendMoves_);
+   std::swap(wideStart_,   m.wideStart_);
+   const bool sorted = sortedIndices_;
+   const bool mSorted = m.sortedIndices_;
+   // settings stay but copies kept for multiplying are dropped
+   clearCaches();
+   m.clearCaches();
+   sortedIndices_ = mSorted;
+   m.sortedIndices_ = sorted;
+}
+
+//-----------------------------------------------------------------------------
+
+void
+CoinPackedMatrix::gutsOfMove(CoinPackedMatrix& m)
+{
+   std::swap(colOrdered_,  m.colOrdered_);
+   std::swap(extraGap_,	   m.extraGap_);
+   std::swap(extraMajor_,  m.extraMajor_);
+   std::swap(element_, 	   m.element_);
+   std::swap(index_,	   m.index_);
+   std::swap(start_,	   m.start_);
+   std::swap(length_,	   m.length_);
+   std::swap(majorDim_,	   m.majorDim_);
+   std::swap(minorDim_,	   m.minorDim_);
+   std::swap(size_,	   m.size_);
+   std::swap(maxMajorDim_, m.maxMajorDim_);
+   std::swap(maxSize_,     m.maxSize_);
+   std::swap(memoryPolicy_, m.memoryPolicy_);
+   std::swap(appendMoves_, m.appendMoves_);
+   std::swap(wideStart_,   m.wideStart_);
+   std::swap(sellCache_,   m.sellCache_);
+   std::swap(orthoCache_,  m.orthoCache_);
+   std::swap(orthoDelta_,  m.orthoDelta_);
+   std::swap(numberMultiplies_, m.numberMultiplies_);
+   const bool sorted = sortedIndices_;
+   const bool mSorted = m.sortedIndices_;
+   if (dualOrdered_ != m.dualOrdered_) {
+      // a change log only makes sense with the setting it was made with
+      clearCaches();
+      m.clearCaches();
+   }
+   sortedIndices_ = mSorted;
+   m.sortedIndices_ = sorted;
 }
 
 //#############################################################################
@@ -1130,6 +2158,10 @@ CoinPackedMatrix::swap(CoinPackedMatrix& m)
 void
 CoinPackedMatrix::times(const double * x, double * y) const 
 {
+   if (useSellCache()) {
+      sellCache_->times(x, y);
+      return;
+   }
    if (colOrdered_)
       timesMajor(x, y);
    else
@@ -1141,6 +2173,7 @@ CoinPackedMatrix::times(const double * x, double * y) const
 void
 CoinPackedMatrix::times(const CoinPackedVectorBase& x, double * y) const 
 {
+   checkNarrow("times");
    if (colOrdered_)
       timesMajor(x, y);
    else
@@ -1152,6 +2185,10 @@ CoinPackedMatrix::times(const CoinPackedVectorBase& x, double * y) const
 void
 CoinPackedMatrix::transposeTimes(const double * x, double * y) const 
 {
+   if (useSellCache()) {
+      sellCache_->transposeTimes(x, y);
+      return;
+   }
    if (colOrdered_)
       timesMinor(x, y);
    else
@@ -1163,12 +2200,366 @@ CoinPackedMatrix::transposeTimes(const double * x, double * y) const
 void
 CoinPackedMatrix::transposeTimes(const CoinPackedVectorBase& x, double * y) const
 {
+   checkNarrow("transposeTimes");
    if (colOrdered_)
       timesMinor(x, y);
    else
       timesMajor(x, y);
 }
 #endif
+/* x * A for sparse x.  Goes along rows (of the row copy) which x uses if
+   that is less work than going down every column.  Scattering costs
+   more than a dot product so row work is counted twice.  Nothing is
+   built or brought up to date here so several threads may multiply by
+   the same matrix - only a reverse ordered copy with no changes pending
+   is used. */
+void
+CoinPackedMatrix::transposeTimes(const CoinIndexedVector & x,
+				 CoinIndexedVector & y) const
+{
+   checkNarrow("transposeTimes");
+   const int numberRows = getNumRows();
+   const int numberColumns = getNumCols();
+   y.clear();
+   if (y.capacity() < numberColumns)
+      y.reserve(numberColumns);
+   const int number = x.getNumElements();
+   if (!number)
+      return;
+   // bitmap or pure dense x is gone through densely
+   const bool listed = x.representation() == CoinIndexedVector::indexList;
+   const int * which = listed ? x.getIndices() : NULL;
+   const int numberWhich = listed ? number : numberRows;
+   const double * value = x.denseVector();
+   const bool packed = x.packedMode();
+   const CoinPackedMatrix * ortho = orthoDelta_ ? NULL : orthoCache_;
+   const CoinPackedMatrix * byRow = colOrdered_ ? ortho : this;
+   const CoinPackedMatrix * byColumn = colOrdered_ ? this : ortho;
+   bool alongRows;
+   if (!byColumn) {
+      alongRows = true;
+   } else if (!byRow) {
+      alongRows = false;
+   } else {
+      double rowWork = listed ? 0.0 : numberRows;
+      for (int k = 0; k < numberWhich; ++k) {
+	 const int iRow = listed ? which[k] : k;
+	 if (listed || value[iRow])
+	    rowWork += byRow->length_[iRow];
+      }
+      const double columnWork = static_cast<double>(size_) + numberColumns +
+	 (packed ? numberRows : 0);
+      alongRows = 2.0 * rowWork < columnWork;
+   }
+   if (alongRows) {
+      const CoinBigIndex * start = byRow->start_;
+      const int * length = byRow->length_;
+      const int * index = byRow->index_;
+      const double * element = byRow->element_;
+      for (int k = 0; k < numberWhich; ++k) {
+	 const int iRow = listed ? which[k] : k;
+	 const double xValue = packed ? value[k] : value[iRow];
+	 if (!xValue)
+	    continue;
+	 const CoinBigIndex last = start[iRow] + length[iRow];
+	 for (CoinBigIndex j = start[iRow]; j < last; ++j)
+	    y.quickAdd(index[j], xValue * element[j]);
+      }
+   } else {
+      double * dense = NULL;
+      if (packed) {
+	 dense = new double [numberRows];
+	 CoinZeroN(dense, numberRows);
+	 for (int k = 0; k < number; ++k)
+	    dense[which[k]] = value[k];
+	 value = dense;
+      }
+      const CoinBigIndex * start = byColumn->start_;
+      const int * length = byColumn->length_;
+      const int * index = byColumn->index_;
+      const double * element = byColumn->element_;
+      for (int iColumn = 0; iColumn < numberColumns; ++iColumn) {
+	 double sum = 0.0;
+	 const CoinBigIndex last = start[iColumn] + length[iColumn];
+	 for (CoinBigIndex j = start[iColumn]; j < last; ++j)
+	    sum += value[index[j]] * element[j];
+	 if (fabs(sum) >= COIN_INDEXED_TINY_ELEMENT)
+	    y.quickInsert(iColumn, sum);
+      }
+      delete [] dense;
+   }
+}
+
+//-----------------------------------------------------------------------------
+// Changes to or from 64 bit starts
+
+void
+CoinPackedMatrix::setWideStarts(bool yesNo)
+{
+   clearCaches();
+   if (yesNo) {
+      if (wideStart_)
+	 return;
+      removeGaps();
+      wideStart_ = new CoinInt64[majorDim_ + 1];
+      for (int i = 0; i <= majorDim_; ++i)
+	 wideStart_[i] = start_[i];
+      coinDeleteStart(start_);
+      start_ = NULL;
+   } else {
+      if (!wideStart_)
+	 return;
+      const CoinInt64 numberElements = wideStart_[majorDim_];
+      if (numberElements > std::numeric_limits<CoinBigIndex>::max())
+	 throw CoinError("too many elements", "setWideStarts",
+			 "CoinPackedMatrix");
+      start_ = new CoinBigIndex[maxMajorDim_ + 1];
+      for (int i = 0; i <= majorDim_; ++i)
+	 start_[i] = static_cast<CoinBigIndex>(wideStart_[i]);
+      delete[] wideStart_;
+      wideStart_ = NULL;
+      size_ = static_cast<CoinBigIndex>(numberElements);
+      maxSize_ = CoinMax(maxSize_, size_);
+   }
+}
+
+//-----------------------------------------------------------------------------
+
+void
+CoinPackedMatrix::assignWideMatrix(const bool colordered,
+				   const int minor, const int major,
+				   CoinInt64 *& start, int *& ind,
+				   double *& elem)
+{
+   clearCaches();
+   gutsOfDestructor();
+   const CoinInt64 numberElements = start[major];
+   colOrdered_ = colordered;
+   majorDim_ = major;
+   minorDim_ = minor;
+   maxMajorDim_ = major;
+   const bool fits =
+      numberElements <= std::numeric_limits<CoinBigIndex>::max();
+   size_ = fits ? static_cast<CoinBigIndex>(numberElements) : -1;
+   maxSize_ = size_;
+   element_ = elem;
+   index_ = ind;
+   if (memoryPolicy_) {
+      // arrays were allocated by new[] so copy
+      element_ = coinCopyMatrixArray(memoryPolicy_, elem, numberElements);
+      index_ = coinCopyMatrixArray(memoryPolicy_, ind, numberElements);
+      delete [] elem;
+      delete [] ind;
+   }
+   length_ = new int[major];
+   for (int i = 0; i < major; ++i)
+      length_[i] = static_cast<int>(start[i+1] - start[i]);
+   wideStart_ = start;
+   elem = NULL;
+   ind = NULL;
+   start = NULL;
+   // only keep wide starts if needed
+   if (fits)
+      setWideStarts(false);
+}
+
+//-----------------------------------------------------------------------------
+// Makes matrix empty with normal starts if starts are wide
+
+void
+CoinPackedMatrix::removeWide()
+{
+   if (!wideStart_)
+      return;
+   gutsOfDestructor();
+   majorDim_ = 0;
+   minorDim_ = 0;
+   size_ = 0;
+   maxMajorDim_ = 0;
+   maxSize_ = 0;
+   start_ = new CoinBigIndex[1];
+   start_[0] = 0;
+}
+
+//-----------------------------------------------------------------------------
+// Copies rhs which has wide starts (arrays must be free)
+
+void
+CoinPackedMatrix::gutsOfCopyWide(const CoinPackedMatrix & rhs)
+{
+   const CoinInt64 numberElements = rhs.wideStart_[rhs.majorDim_];
+   colOrdered_ = rhs.colOrdered_;
+   majorDim_ = rhs.majorDim_;
+   minorDim_ = rhs.minorDim_;
+   size_ = rhs.size_;
+   maxMajorDim_ = majorDim_;
+   maxSize_ = size_;
+   wideStart_ = CoinCopyOfArray(rhs.wideStart_, majorDim_ + 1);
+   length_ = CoinCopyOfArray(rhs.length_, majorDim_);
+   index_ = coinNewMatrixArray<int>(memoryPolicy_, numberElements);
+   element_ = coinNewMatrixArray<double>(memoryPolicy_, numberElements);
+   memcpy(index_, rhs.index_, static_cast<size_t>(numberElements)*sizeof(int));
+   memcpy(element_, rhs.element_,
+	  static_cast<size_t>(numberElements)*sizeof(double));
+}
+
+//-----------------------------------------------------------------------------
+// True if multiplying should use sellCache_ (built when asked often enough)
+bool
+CoinPackedMatrix::useSellCache() const
+{
+   if (sellCache_)
+      return true;
+   if (sellCacheAfter_ <= 0 || wideStart_ || ++numberMultiplies_ < sellCacheAfter_)
+      return false;
+   sellCache_ = new CoinSellMatrix(*this);
+   return true;
+}
+
+//-----------------------------------------------------------------------------
+
+void
+CoinPackedMatrix::clearCaches() const
+{
+   delete sellCache_;
+   sellCache_ = NULL;
+   numberMultiplies_ = 0;
+   sortedIndices_ = false;
+   if (!orthoBusy_) {
+      delete orthoCache_;
+      orthoCache_ = NULL;
+      delete orthoDelta_;
+      orthoDelta_ = NULL;
+   }
+}
+
+//-----------------------------------------------------------------------------
+
+bool
+CoinPackedMatrix::keepOrthoCache() const
+{
+   if (orthoBusy_) {
+      // part of a change already logged
+      clearCaches();
+      return false;
+   }
+   // logging only pays if applying log is cheaper than a rebuild
+   if (!dualOrdered_ || !orthoCache_ || (orthoDelta_ &&
+	 orthoDelta_->work_ > 2 * (size_ + majorDim_ + minorDim_))) {
+      clearCaches();
+      return false;
+   }
+   delete sellCache_;
+   sellCache_ = NULL;
+   numberMultiplies_ = 0;
+   if (!orthoDelta_)
+      orthoDelta_ = new CoinOrthoDelta();
+   // appending columns to a row ordered copy goes over all rows
+   orthoDelta_->minorAppend_ = colOrdered_ ? CoinOrthoDelta::appendCols :
+      CoinOrthoDelta::appendRows;
+   orthoDelta_->passCost_ = minorDim_;
+   orthoDelta_->deleteCost_ = size_;
+   return true;
+}
+
+//-----------------------------------------------------------------------------
+
+void
+CoinPackedMatrix::updateOrthoCache() const
+{
+   if (orthoCache_ && orthoDelta_) {
+      CoinPackedMatrix & ortho = *orthoCache_;
+      const CoinOrthoDelta & delta = *orthoDelta_;
+      for (int i = 0; i < delta.numberEntries(); ++i) {
+	 const int number = delta.number_[i];
+	 const CoinBigIndex * starts = delta.starts(i);
+	 const int * index = delta.index(i);
+	 const double * element = delta.element(i);
+	 switch (delta.type_[i]) {
+	 case CoinOrthoDelta::appendCols:
+	    ortho.appendCols(number, starts, index, element);
+	    break;
+	 case CoinOrthoDelta::appendRows:
+	    ortho.appendRows(number, starts, index, element);
+	    break;
+	 case CoinOrthoDelta::deleteCols:
+	    ortho.deleteCols(starts[1], index);
+	    break;
+	 case CoinOrthoDelta::deleteRows:
+	    ortho.deleteRows(starts[1], index);
+	    break;
+	 case CoinOrthoDelta::modify:
+	    ortho.modifyCoefficient(index[0], index[1], element[0],
+				    element[1] != 0.0);
+	    break;
+	 case CoinOrthoDelta::dimensions:
+	    ortho.setDimensions(index[0], index[1]);
+	    break;
+	 }
+      }
+      delete orthoDelta_;
+      orthoDelta_ = NULL;
+      if (ortho.getNumRows() != getNumRows() ||
+	  ortho.getNumCols() != getNumCols() ||
+	  ortho.getNumElements() != getNumElements()) {
+	 // not same (bad indices) so build again
+	 delete orthoCache_;
+	 orthoCache_ = NULL;
+      }
+   }
+   if (!orthoCache_) {
+      delete orthoDelta_;
+      orthoDelta_ = NULL;
+      orthoCache_ = new CoinPackedMatrix();
+      orthoCache_->reverseOrderedCopyOf(*this);
+   }
+}
+
+//-----------------------------------------------------------------------------
+
+const CoinPackedMatrix &
+CoinPackedMatrix::getOrthoCopy() const
+{
+   checkNarrow("getOrthoCopy");
+   updateOrthoCache();
+   return *orthoCache_;
+}
+
+//-----------------------------------------------------------------------------
+
+void
+CoinPackedMatrix::setDualOrdered(bool yesNo)
+{
+   if (!yesNo && dualOrdered_)
+      clearCaches();
+   dualOrdered_ = yesNo;
+}
+
+//-----------------------------------------------------------------------------
+
+void
+CoinPackedMatrix::setSellCacheAfter(int value)
+{
+   sellCacheAfter_ = value;
+   clearCaches();
+}
+
+//-----------------------------------------------------------------------------
+
+int
+CoinPackedMatrix::defaultSellCacheAfter()
+{
+   return coinSellCacheAfter;
+}
+
+//-----------------------------------------------------------------------------
+
+void
+CoinPackedMatrix::setDefaultSellCacheAfter(int value)
+{
+   coinSellCacheAfter = value;
+}
+
 //#############################################################################
 //#############################################################################
 /* Count the number of entries in every minor-dimension vector and
@@ -1176,6 +2567,24 @@ CoinPackedMatrix::transposeTimes(const CoinPackedVectorBase& x, double * y) cons
 void
 CoinPackedMatrix::countOrthoLength(int * orthoLength) const
 {
+  if (wideStart_) {
+    CoinZeroN(orthoLength, minorDim_);
+    const CoinInt64 last = wideStart_[majorDim_];
+    for (CoinInt64 j = 0; j < last; ++j)
+      ++orthoLength[index_[j]];
+    return;
+  }
+  CoinThreadPool * pool = coinMatrixPool(size_);
+  // counts for each thread must be small compared to matrix
+  if (pool && static_cast<CoinBigIndex>(minorDim_) * pool->numberThreads()
+      <= size_) {
+    const int numberPieces = pool->numberThreads();
+    CoinBigIndex * counts =
+      new CoinBigIndex [static_cast<CoinBigIndex>(numberPieces)*minorDim_];
+    coinCountOrthoPieces(pool, numberPieces, *this, counts, orthoLength);
+    delete [] counts;
+    return;
+  }
   CoinZeroN(orthoLength, minorDim_);
   if (size_!=start_[majorDim_]) {
     // has gaps
@@ -1216,6 +2625,7 @@ CoinPackedMatrix::countOrthoLength() const
 int * 
 CoinPackedMatrix::getMajorIndices() const
 {
+   checkNarrow("getMajorIndices");
   // Check valid
   if (!majorDim_||start_[majorDim_]!=size_)
     return NULL;
@@ -1228,11 +2638,39 @@ CoinPackedMatrix::getMajorIndices() const
 }
 //#############################################################################
 
+void
+CoinPackedMatrix::memoryUsage(CoinMemoryUsage & usage) const
+{
+  if (wideStart_) {
+    const CoinInt64 n = wideStart_[majorDim_];
+    usage.addArray("elements",n,n,static_cast<int>(sizeof(double)));
+    usage.addArray("indices",n,n,static_cast<int>(sizeof(int)));
+    usage.addArray("starts",majorDim_+1,majorDim_+1,
+		   static_cast<int>(sizeof(CoinInt64)));
+    usage.addArray("lengths",majorDim_,maxMajorDim_,
+		   static_cast<int>(sizeof(int)));
+    return;
+  }
+  usage.addArray("elements",size_,element_ ? maxSize_ : 0,
+		 static_cast<int>(sizeof(double)));
+  usage.addArray("indices",size_,index_ ? maxSize_ : 0,
+		 static_cast<int>(sizeof(int)));
+  usage.addArray("starts",start_ ? majorDim_+1 : 0,
+		 start_ ? maxMajorDim_+1 : 0,
+		 static_cast<int>(sizeof(CoinBigIndex)));
+  usage.addArray("lengths",majorDim_,length_ ? maxMajorDim_ : 0,
+		 static_cast<int>(sizeof(int)));
+}
+
+//#############################################################################
+
 void
 CoinPackedMatrix::appendMajorVector(const int vecsize,
 				   const int *vecind,
 				   const double *vecelem)
 {
+   checkNarrow("appendMajorVector");
+   clearCaches();
 #ifdef COIN_DEBUG
   for (int i = 0; i < vecsize; ++i) {
     if (vecind[i] < 0 )
@@ -1283,6 +2721,8 @@ CoinPackedMatrix::appendMajorVector(const int vecsize,
 void
 CoinPackedMatrix::appendMajorVector(const CoinPackedVectorBase& vec)
 {
+   checkNarrow("appendMajorVector");
+   clearCaches();
    appendMajorVector(vec.getNumElements(),
 		     vec.getIndices(), vec.getElements());
 }
@@ -1292,6 +2732,8 @@ void
 CoinPackedMatrix::appendMajorVectors(const int numvecs,
 				    const CoinPackedVectorBase * const * vecs)
 {
+   checkNarrow("appendMajorVectors");
+   clearCaches();
   int i;
   CoinBigIndex nz = 0;
   for (i = 0; i < numvecs; ++i)
@@ -1309,6 +2751,8 @@ CoinPackedMatrix::appendMinorVector(const int vecsize,
 				   const int *vecind,
 				   const double *vecelem)
 {
+   checkNarrow("appendMinorVector");
+   clearCaches();
   if (vecsize == 0) {
     ++minorDim_; // empty row/column - still need to increase
     return;
@@ -1366,6 +2810,8 @@ CoinPackedMatrix::appendMinorVector(const int vecsize,
 void
 CoinPackedMatrix::appendMinorVector(const CoinPackedVectorBase& vec)
 {
+   checkNarrow("appendMinorVector");
+   clearCaches();
    appendMinorVector(vec.getNumElements(),
 		     vec.getIndices(), vec.getElements());
 }
@@ -1376,14 +2822,17 @@ void
 CoinPackedMatrix::appendMinorVectors(const int numvecs,
 				    const CoinPackedVectorBase * const * vecs)
 {
+   checkNarrow("appendMinorVectors");
+   clearCaches();
   if (numvecs == 0)
     return;
 
   int i;
 
-  int * addedEntries = new int[majorDim_];
-  CoinZeroN(addedEntries, majorDim_);
-  for (i = numvecs - 1; i >= 0; --i) {
+  // count by major index then group straight from the vectors
+  CoinBigIndex * addStart = new CoinBigIndex[majorDim_ + 1];
+  CoinZeroN(addStart, majorDim_ + 1);
+  for (i = 0; i < numvecs; ++i) {
     const int vecsize = vecs[i]->getNumElements();
     const int* vecind = vecs[i]->getIndices();
     for (int j = vecsize - 1; j >= 0; --j) {
@@ -1392,31 +2841,31 @@ CoinPackedMatrix::appendMinorVectors(const int numvecs,
 	throw CoinError("out of range index", "appendMinorVectors",
 		       "CoinPackedMatrix");
 #endif
-      ++addedEntries[vecind[j]];
+      ++addStart[vecind[j] + 1];
     }
   }
- 
-  for (i = majorDim_ - 1; i >= 0; --i) {
-    if (start_[i] + length_[i] + addedEntries[i] > start_[i+1])
-      break;
-  }
-  if (i >= 0)
-    resizeForAddingMinorVectors(addedEntries);
-  delete[] addedEntries;
-
-  // now insert the entries of the vectors
+  for (i = 0; i < majorDim_; ++i)
+    addStart[i+1] += addStart[i];
+  const CoinBigIndex numberAdded = addStart[majorDim_];
+  int * addIndex = new int[numberAdded];
+  double * addElement = new double[numberAdded];
   for (i = 0; i < numvecs; ++i) {
     const int vecsize = vecs[i]->getNumElements();
     const int* vecind = vecs[i]->getIndices();
     const double* vecelem = vecs[i]->getElements();
-    for (int j = vecsize - 1; j >= 0; --j) {
-      const int ind = vecind[j];
-      element_[start_[ind] + length_[ind]] = vecelem[j];
-      index_[start_[ind] + (length_[ind]++)] = minorDim_;
+    for (int j = 0; j < vecsize; ++j) {
+      const CoinBigIndex put = addStart[vecind[j]]++;
+      addIndex[put] = minorDim_ + i;
+      addElement[put] = vecelem[j];
     }
-    ++minorDim_;
-    size_ += vecsize;
   }
+  for (i = majorDim_ - 1; i >= 0; --i)
+    addStart[i+1] = addStart[i];
+  addStart[0] = 0;
+  gutsOfMergeMinor(numvecs, addStart, addIndex, addElement);
+  delete[] addStart;
+  delete[] addIndex;
+  delete[] addElement;
 }
 #endif
 
@@ -1426,6 +2875,9 @@ CoinPackedMatrix::appendMinorVectors(const int numvecs,
 void
 CoinPackedMatrix::majorAppendSameOrdered(const CoinPackedMatrix& matrix)
 {
+   checkNarrow("majorAppendSameOrdered");
+   matrix.checkNarrow("majorAppendSameOrdered");
+   clearCaches();
    if (minorDim_ != matrix.minorDim_) {
       throw CoinError("dimension mismatch", "rightAppendSameOrdered",
 		     "CoinPackedMatrix");
@@ -1473,6 +2925,9 @@ CoinPackedMatrix::majorAppendSameOrdered(const CoinPackedMatrix& matrix)
 void
 CoinPackedMatrix::minorAppendSameOrdered(const CoinPackedMatrix& matrix)
 {
+   checkNarrow("minorAppendSameOrdered");
+   matrix.checkNarrow("minorAppendSameOrdered");
+   clearCaches();
    if (majorDim_ != matrix.majorDim_) {
       throw CoinError("dimension mismatch", "bottomAppendSameOrdered",
 		      "CoinPackedMatrix");
@@ -1508,6 +2963,9 @@ CoinPackedMatrix::minorAppendSameOrdered(const CoinPackedMatrix& matrix)
 void
 CoinPackedMatrix::majorAppendOrthoOrdered(const CoinPackedMatrix& matrix)
 {
+   checkNarrow("majorAppendOrthoOrdered");
+   matrix.checkNarrow("majorAppendOrthoOrdered");
+   clearCaches();
    if (minorDim_ != matrix.majorDim_) {
       throw CoinError("dimension mismatch", "majorAppendOrthoOrdered",
 		     "CoinPackedMatrix");
@@ -1570,6 +3028,9 @@ CoinPackedMatrix::majorAppendOrthoOrdered(const CoinPackedMatrix& matrix)
 void
 CoinPackedMatrix::minorAppendOrthoOrdered(const CoinPackedMatrix& matrix)
 {
+   checkNarrow("minorAppendOrthoOrdered");
+   matrix.checkNarrow("minorAppendOrthoOrdered");
+   clearCaches();
    if (majorDim_ != matrix.minorDim_) {
       throw CoinError("dimension mismatch", "bottomAppendOrthoOrdered",
 		     "CoinPackedMatrix");
@@ -1577,32 +3038,12 @@ CoinPackedMatrix::minorAppendOrthoOrdered(const CoinPackedMatrix& matrix)
    if (matrix.majorDim_ == 0)
       return;
 
-   int i;
    // first compute how many entries will be added to each major-dimension
-   // vector, and if needed, resize the matrix to accommodate all
-   // this trickery is needed because MSVC++ is not willing to delete[] a
-   // 'const int *'
-   int * addedEntriesPtr = matrix.countOrthoLength();
-   const int * addedEntries = addedEntriesPtr;
-   for (i = majorDim_ - 1; i >= 0; --i) {
-      if (start_[i] + length_[i] + addedEntries[i] > start_[i+1])
-	 break;
-   }
-   if (i >= 0)
-      resizeForAddingMinorVectors(addedEntries);
-   delete[] addedEntriesPtr;
-
-   // now insert the entries of matrix
-   for (i = 0; i < matrix.majorDim_; ++i) {
-      const CoinBigIndex last = matrix.getVectorLast(i);
-      for (CoinBigIndex j = matrix.getVectorFirst(i); j != last; ++j) {
-	 const int ind = matrix.index_[j];
-	 element_[start_[ind] + length_[ind]] = matrix.element_[j];
-	 index_[start_[ind] + (length_[ind]++)] = minorDim_;
-      }
-      ++minorDim_;
-   }
-   size_ += matrix.size_;
+   // vector, then move (if needed) and insert in one pass
+   int * addedEntries = matrix.countOrthoLength();
+   gutsOfAppendMinor(matrix.majorDim_, matrix.start_, matrix.length_,
+		     matrix.index_, matrix.element_, addedEntries);
+   delete[] addedEntries;
 }
 
 //#############################################################################
@@ -1612,6 +3053,8 @@ void
 CoinPackedMatrix::deleteMajorVectors(const int numDel,
 				    const int * indDel)
 {
+   checkNarrow("deleteMajorVectors");
+   clearCaches();
    if (numDel == majorDim_) {
       // everything is deleted
       majorDim_ = 0;
@@ -1621,12 +3064,12 @@ CoinPackedMatrix::deleteMajorVectors(const int numDel,
       maxMajorDim_ = 0;
       delete [] length_;
       length_ = NULL;
-      delete [] start_;
+      coinDeleteStart(start_);
       start_ = new CoinBigIndex[1];
       start_[0]=0;;
-      delete [] element_;
+      coinDeleteMatrixArray(memoryPolicy_,element_);
       element_=NULL;
-      delete [] index_;
+      coinDeleteMatrixArray(memoryPolicy_,index_);
       index_=NULL;
       maxSize_ = 0;
       return;
@@ -1710,6 +3153,8 @@ void
 CoinPackedMatrix::deleteMinorVectors(const int numDel,
 				    const int * indDel)
 {
+   checkNarrow("deleteMinorVectors");
+   clearCaches();
    if (numDel == minorDim_) {
      // everything is deleted
      minorDim_ = 0;
@@ -1717,9 +3162,9 @@ CoinPackedMatrix::deleteMinorVectors(const int numDel,
      // Get rid of as much memory as possible
      memset(length_,0,majorDim_*sizeof(int));
      memset(start_,0,(majorDim_+1)*sizeof(CoinBigIndex ));
-     delete [] element_;
+     coinDeleteMatrixArray(memoryPolicy_,element_);
      element_=NULL;
-     delete [] index_;
+     coinDeleteMatrixArray(memoryPolicy_,index_);
      index_=NULL;
      maxSize_ = 0;
      return;
@@ -1818,6 +3263,11 @@ CoinPackedMatrix::deleteMinorVectors(const int numDel,
 void
 CoinPackedMatrix::timesMajor(const double * x, double * y) const 
 {
+   if (wideStart_) {
+      coinTimesMajor(wideStart_, length_, index_, element_, majorDim_,
+		     minorDim_, x, y);
+      return;
+   }
    memset(y, 0, minorDim_ * sizeof(double));
    for (int i = majorDim_ - 1; i >= 0; --i) {
       const double x_i = x[i];
@@ -1834,6 +3284,7 @@ CoinPackedMatrix::timesMajor(const double * x, double * y) const
 void
 CoinPackedMatrix::timesMajor(const CoinPackedVectorBase& x, double * y) const 
 {
+   checkNarrow("timesMajor");
    memset(y, 0, minorDim_ * sizeof(double));
    for (CoinBigIndex i = x.getNumElements() - 1; i >= 0; --i) {
       const double x_i = x.getElements()[i];
@@ -1851,6 +3302,22 @@ CoinPackedMatrix::timesMajor(const CoinPackedVectorBase& x, double * y) const
 void
 CoinPackedMatrix::timesMinor(const double * x, double * y) const 
 {
+   if (wideStart_) {
+      coinTimesMinor(wideStart_, length_, index_, element_, majorDim_, x, y);
+      return;
+   }
+   CoinThreadPool * pool = coinMatrixPool(size_);
+   if (pool) {
+      CoinTimesMinorTask task;
+      task.start_ = start_;
+      task.length_ = length_;
+      task.index_ = index_;
+      task.element_ = element_;
+      task.x_ = x;
+      task.y_ = y;
+      pool->parallelFor(task, 0, majorDim_);
+      return;
+   }
    memset(y, 0, majorDim_ * sizeof(double));
    for (int i = majorDim_ - 1; i >= 0; --i) {
       double y_i = 0;
@@ -1866,6 +3333,7 @@ CoinPackedMatrix::timesMinor(const double * x, double * y) const
 void
 CoinPackedMatrix::timesMinor(const CoinPackedVectorBase& x, double * y) const 
 {
+   checkNarrow("timesMinor");
    memset(y, 0, majorDim_ * sizeof(double));
    for (int i = majorDim_ - 1; i >= 0; --i) {
       double y_i = 0;
@@ -1890,7 +3358,18 @@ CoinPackedMatrix::CoinPackedMatrix() :
    minorDim_(0),
    size_(0),
    maxMajorDim_(0),
-   maxSize_(0) 
+   maxSize_(0),
+   memoryPolicy_(CoinMemoryPolicy::defaultPolicy()),
+   sellCache_(NULL),
+   orthoCache_(NULL),
+   orthoDelta_(NULL),
+   dualOrdered_(false),
+   orthoBusy_(false),
+   sortedIndices_(false),
+   numberMultiplies_(0),
+   sellCacheAfter_(coinSellCacheAfter),
+   appendMoves_(0),
+   wideStart_(NULL)
 {
   start_ = new CoinBigIndex[1];
   start_[0] = 0;
@@ -1911,7 +3390,18 @@ CoinPackedMatrix::CoinPackedMatrix(const bool colordered,
    minorDim_(0),
    size_(0),
    maxMajorDim_(0),
-   maxSize_(0)
+   maxSize_(0),
+   memoryPolicy_(CoinMemoryPolicy::defaultPolicy()),
+   sellCache_(NULL),
+   orthoCache_(NULL),
+   orthoDelta_(NULL),
+   dualOrdered_(false),
+   orthoBusy_(false),
+   sortedIndices_(false),
+   numberMultiplies_(0),
+   sellCacheAfter_(coinSellCacheAfter),
+   appendMoves_(0),
+   wideStart_(NULL)
 {
   start_ = new CoinBigIndex[1];
   start_[0] = 0;
@@ -1937,7 +3427,18 @@ CoinPackedMatrix::CoinPackedMatrix(const bool colordered,
    minorDim_(0),
    size_(0),
    maxMajorDim_(0),
-   maxSize_(0)
+   maxSize_(0),
+   memoryPolicy_(CoinMemoryPolicy::defaultPolicy()),
+   sellCache_(NULL),
+   orthoCache_(NULL),
+   orthoDelta_(NULL),
+   dualOrdered_(false),
+   orthoBusy_(false),
+   sortedIndices_(false),
+   numberMultiplies_(0),
+   sellCacheAfter_(coinSellCacheAfter),
+   appendMoves_(0),
+   wideStart_(NULL)
 {
    gutsOfOpEqual(colordered, minor, major, numels, elem, ind, start, len);
 }
@@ -1960,7 +3461,18 @@ CoinPackedMatrix::CoinPackedMatrix(const bool colordered,
    minorDim_(0),
    size_(0),
    maxMajorDim_(0),
-   maxSize_(0)
+   maxSize_(0),
+   memoryPolicy_(CoinMemoryPolicy::defaultPolicy()),
+   sellCache_(NULL),
+   orthoCache_(NULL),
+   orthoDelta_(NULL),
+   dualOrdered_(false),
+   orthoBusy_(false),
+   sortedIndices_(false),
+   numberMultiplies_(0),
+   sellCacheAfter_(coinSellCacheAfter),
+   appendMoves_(0),
+   wideStart_(NULL)
 {
      gutsOfOpEqual(colordered, minor, major, numels, elem, ind, start, len);
 }
@@ -2019,7 +3531,18 @@ CoinPackedMatrix::CoinPackedMatrix(
      minorDim_(0),
      size_(0),
      maxMajorDim_(0),
-     maxSize_(0)
+     maxSize_(0),
+     memoryPolicy_(CoinMemoryPolicy::defaultPolicy()),
+   sellCache_(NULL),
+   orthoCache_(NULL),
+   orthoDelta_(NULL),
+   dualOrdered_(false),
+   orthoBusy_(false),
+   sortedIndices_(false),
+   numberMultiplies_(0),
+   sellCacheAfter_(coinSellCacheAfter),
+   appendMoves_(0),
+   wideStart_(NULL)
 {
      CoinAbsFltEq eq;
        int * colIndices = new int[numberElements];
@@ -2184,8 +3707,24 @@ CoinPackedMatrix::CoinPackedMatrix (const CoinPackedMatrix & rhs) :
    minorDim_(0),
    size_(0),
    maxMajorDim_(0),
-   maxSize_(0)
+   maxSize_(0),
+   memoryPolicy_(rhs.memoryPolicy_),
+   sellCache_(NULL),
+   orthoCache_(NULL),
+   orthoDelta_(NULL),
+   dualOrdered_(rhs.dualOrdered_),
+   orthoBusy_(false),
+   sortedIndices_(false),
+   numberMultiplies_(0),
+   sellCacheAfter_(rhs.sellCacheAfter_),
+   appendMoves_(0),
+   wideStart_(NULL)
 {
+  if (rhs.wideStart_) {
+    gutsOfCopyWide(rhs);
+    sortedIndices_ = rhs.sortedIndices_;
+    return;
+  }
   bool hasGaps = rhs.size_<rhs.start_[rhs.majorDim_];
   if (!hasGaps&&!rhs.extraMajor_) {
    gutsOfCopyOfNoGaps(rhs.colOrdered_,
@@ -2197,7 +3736,43 @@ CoinPackedMatrix::CoinPackedMatrix (const CoinPackedMatrix & rhs) :
 		rhs.element_, rhs.index_, rhs.start_, rhs.length_,
 		rhs.extraMajor_, rhs.extraGap_);
   }
+  sortedIndices_ = rhs.sortedIndices_;
 }
+
+//-----------------------------------------------------------------------------
+
+#if __cplusplus >= 201103L
+/* rhs is left with the shared empty start array so nothing is allocated
+   and nothing can throw. */
+CoinPackedMatrix::CoinPackedMatrix(CoinPackedMatrix&& rhs) noexcept :
+   colOrdered_(true),
+   extraGap_(0.0),
+   extraMajor_(0.0),
+   element_(0), 
+   index_(0),
+   start_(coinEmptyStart),
+   length_(0),
+   majorDim_(0),
+   minorDim_(0),
+   size_(0),
+   maxMajorDim_(0),
+   maxSize_(0),
+   memoryPolicy_(rhs.memoryPolicy_),
+   sellCache_(NULL),
+   orthoCache_(NULL),
+   orthoDelta_(NULL),
+   dualOrdered_(rhs.dualOrdered_),
+   orthoBusy_(false),
+   sortedIndices_(false),
+   numberMultiplies_(0),
+   sellCacheAfter_(rhs.sellCacheAfter_),
+   appendMoves_(0),
+   wideStart_(NULL)
+{
+   gutsOfMove(rhs);
+}
+#endif
+
 /* Copy constructor - fine tuning - allowing extra space and/or reverse
    ordering.
 
@@ -2219,7 +3794,18 @@ CoinPackedMatrix::CoinPackedMatrix (const CoinPackedMatrix& rhs,
    minorDim_(rhs.minorDim_),
    size_(rhs.size_),
    maxMajorDim_(0),
-   maxSize_(0)
+   maxSize_(0),
+   memoryPolicy_(rhs.memoryPolicy_),
+   sellCache_(NULL),
+   orthoCache_(NULL),
+   orthoDelta_(NULL),
+   dualOrdered_(rhs.dualOrdered_),
+   orthoBusy_(false),
+   sortedIndices_(false),
+   numberMultiplies_(0),
+   sellCacheAfter_(rhs.sellCacheAfter_),
+   appendMoves_(0),
+   wideStart_(NULL)
 {
   if (!reverseOrdering) {
     if (extraForMajor>=0) {
@@ -2230,8 +3816,8 @@ CoinPackedMatrix::CoinPackedMatrix (const CoinPackedMatrix& rhs,
       length_ = new int[maxMajorDim_];
       CoinMemcpyN(rhs.length_, majorDim_, length_);
       start_ = new CoinBigIndex[maxMajorDim_+1];
-      element_ = new double[maxSize_];
-      index_ = new int[maxSize_];
+      element_ = coinNewMatrixArray<double>(memoryPolicy_,maxSize_);
+      index_ = coinNewMatrixArray<int>(memoryPolicy_,maxSize_);
       bool hasGaps = rhs.size_<rhs.start_[rhs.majorDim_];
       if (hasGaps) {
 	// we can't just simply memcpy these content over, because that can
@@ -2259,8 +3845,8 @@ CoinPackedMatrix::CoinPackedMatrix (const CoinPackedMatrix& rhs,
 	length_ = new int[maxMajorDim_];
 	start_ = new CoinBigIndex[maxMajorDim_+1];
 	if (maxSize_>0) {
-	  element_ = new double[maxSize_];
-	  index_ = new int[maxSize_];
+	  element_ = coinNewMatrixArray<double>(memoryPolicy_,maxSize_);
+	  index_ = coinNewMatrixArray<int>(memoryPolicy_,maxSize_);
 	}
 	CoinBigIndex size=0;
 	const double * oldElement = rhs.element_;
@@ -2300,8 +3886,8 @@ CoinPackedMatrix::CoinPackedMatrix (const CoinPackedMatrix& rhs,
     assert (maxMajorDim_>0);
     length_ = new int[maxMajorDim_];
     start_ = new CoinBigIndex[maxMajorDim_+1];
-    element_ = new double[maxSize_];
-    index_ = new int[maxSize_];
+    element_ = coinNewMatrixArray<double>(memoryPolicy_,maxSize_);
+    index_ = coinNewMatrixArray<int>(memoryPolicy_,maxSize_);
     bool hasGaps = rhs.size_<rhs.start_[rhs.majorDim_];
     CoinZeroN(length_, majorDim_);
     int i;
@@ -2364,7 +3950,18 @@ CoinPackedMatrix::CoinPackedMatrix (const CoinPackedMatrix & rhs,
    minorDim_(0),
    size_(0),
    maxMajorDim_(0),
-   maxSize_(0)
+   maxSize_(0),
+   memoryPolicy_(CoinMemoryPolicy::defaultPolicy()),
+   sellCache_(NULL),
+   orthoCache_(NULL),
+   orthoDelta_(NULL),
+   dualOrdered_(false),
+   orthoBusy_(false),
+   sortedIndices_(false),
+   numberMultiplies_(0),
+   sellCacheAfter_(coinSellCacheAfter),
+   appendMoves_(0),
+   wideStart_(NULL)
 {
   if (numberRows<=0||numberColumns<=0) {
     start_ = new CoinBigIndex[1];
@@ -2436,8 +4033,8 @@ CoinPackedMatrix::CoinPackedMatrix (const CoinPackedMatrix & rhs,
 	maxSize_=CoinMax(static_cast<CoinBigIndex> (1),rhs.size_);
 	start_ = new CoinBigIndex [numberColumns+1];
 	length_ = new int [numberColumns];
-	index_ = new int[maxSize_];
-	element_ = new double [maxSize_];
+	index_ = coinNewMatrixArray<int>(memoryPolicy_,maxSize_);
+	element_ = coinNewMatrixArray<double>(memoryPolicy_,maxSize_);
 	// and fill them
 	size_ = 0;
 	start_[0]=0;
@@ -2487,8 +4084,8 @@ CoinPackedMatrix::CoinPackedMatrix (const CoinPackedMatrix & rhs,
 	maxSize_=CoinMax(static_cast<CoinBigIndex> (1),size_);
 	start_ = new CoinBigIndex [numberColumns+1];
 	length_ = new int [numberColumns];
-	index_ = new int[maxSize_];
-	element_ = new double [maxSize_];
+	index_ = coinNewMatrixArray<int>(memoryPolicy_,maxSize_);
+	element_ = coinNewMatrixArray<double>(memoryPolicy_,maxSize_);
 	// and fill them
 	size_ = 0;
 	start_[0]=0;
@@ -2533,8 +4130,8 @@ CoinPackedMatrix::CoinPackedMatrix (const CoinPackedMatrix & rhs,
       maxSize_=CoinMax(static_cast<CoinBigIndex> (1),size_);
       start_ = new CoinBigIndex [numberColumns+1];
       length_ = new int [numberColumns];
-      index_ = new int[maxSize_];
-      element_ = new double [maxSize_];
+      index_ = coinNewMatrixArray<int>(memoryPolicy_,maxSize_);
+      element_ = coinNewMatrixArray<double>(memoryPolicy_,maxSize_);
       // and fill them
       size_ = 0;
       start_[0]=0;
@@ -2565,6 +4162,7 @@ CoinPackedMatrix::CoinPackedMatrix (const CoinPackedMatrix & rhs,
 
 CoinPackedMatrix::~CoinPackedMatrix ()
 {
+   orthoBusy_ = false;
    gutsOfDestructor();
 }
 
@@ -2575,14 +4173,17 @@ CoinPackedMatrix::~CoinPackedMatrix ()
 void
 CoinPackedMatrix::gutsOfDestructor()
 {
+   clearCaches();
    delete[] length_;
-   delete[] start_;
-   delete[] index_;
-   delete[] element_;
+   coinDeleteStart(start_);
+   coinDeleteMatrixArray(memoryPolicy_,index_);
+   coinDeleteMatrixArray(memoryPolicy_,element_);
+   delete[] wideStart_;
    length_ = 0;
    start_ = 0;
    index_ = 0;
    element_ = 0;
+   wideStart_ = 0;
 }
 
 //#############################################################################
@@ -2614,7 +4215,7 @@ CoinPackedMatrix::gutsOfCopyOf(const bool colordered,
      } else {
        CoinMemcpyN(len, major, length_);
      }
-     delete [] start_;
+     coinDeleteStart(start_);
      start_ = new CoinBigIndex[maxMajorDim_+1];
      start_[0]=0;
      CoinMemcpyN(start, major+1, start_);
@@ -2622,7 +4223,7 @@ CoinPackedMatrix::gutsOfCopyOf(const bool colordered,
      // empty but be safe
      delete [] length_;
      length_ = NULL;
-     delete [] start_;
+     coinDeleteStart(start_);
      start_ = new CoinBigIndex[1];
      start_[0]=0;
    }
@@ -2631,10 +4232,10 @@ CoinPackedMatrix::gutsOfCopyOf(const bool colordered,
    maxSize_ = CoinLengthWithExtra(maxSize_, extraMajor_);
 
    if (maxSize_ > 0) {
-     delete [] element_;
-     delete []index_;
-     element_ = new double[maxSize_];
-     index_ = new int[maxSize_];
+     coinDeleteMatrixArray(memoryPolicy_,element_);
+     coinDeleteMatrixArray(memoryPolicy_,index_);
+     element_ = coinNewMatrixArray<double>(memoryPolicy_,maxSize_);
+     index_ = coinNewMatrixArray<int>(memoryPolicy_,maxSize_);
      // we can't just simply memcpy these content over, because that can
      // upset memory debuggers like purify if there were gaps and those gaps
      // were uninitialized memory blocks
@@ -2665,9 +4266,9 @@ CoinPackedMatrix::gutsOfCopyOfNoGaps(const bool colordered,
 
    // delete all arrays
    delete [] length_;
-   delete [] start_;
-   delete [] element_;
-   delete [] index_;
+   coinDeleteStart(start_);
+   coinDeleteMatrixArray(memoryPolicy_,element_);
+   coinDeleteMatrixArray(memoryPolicy_,index_);
    
    if (maxMajorDim_ > 0) {
      length_ = new int[maxMajorDim_];
@@ -2691,8 +4292,8 @@ CoinPackedMatrix::gutsOfCopyOfNoGaps(const bool colordered,
    maxSize_ = start_[majorDim_];
 
    if (maxSize_ > 0) {
-     element_ = new double[maxSize_];
-     index_ = new int[maxSize_];
+     element_ = coinNewMatrixArray<double>(memoryPolicy_,maxSize_);
+     index_ = coinNewMatrixArray<int>(memoryPolicy_,maxSize_);
      CoinMemcpyN(ind , maxSize_, index_);
      CoinMemcpyN(elem , maxSize_, element_);
    } else {
@@ -2720,17 +4321,17 @@ CoinPackedMatrix::gutsOfOpEqual(const bool colordered,
        maxMajorDim_ = major;
        delete [] length_;
        length_ = new int[maxMajorDim_];
-       delete [] start_;
+       coinDeleteStart(start_);
        start_ = new CoinBigIndex[maxMajorDim_+1];
      }
      CoinMemcpyN(start,major+1,start_);
      std::adjacent_difference(start + 1, start + (major + 1), length_);
      if (numels>maxSize_||!element_) {
        maxSize_=numels;
-       delete [] element_;
-       delete [] index_;
-       element_ = new double[maxSize_];
-       index_ = new int[maxSize_];
+       coinDeleteMatrixArray(memoryPolicy_,element_);
+       coinDeleteMatrixArray(memoryPolicy_,index_);
+       element_ = coinNewMatrixArray<double>(memoryPolicy_,maxSize_);
+       index_ = coinNewMatrixArray<int>(memoryPolicy_,maxSize_);
      }
      CoinMemcpyN(ind,numels,index_);
      CoinMemcpyN(elem,numels,element_);
@@ -2748,7 +4349,7 @@ CoinPackedMatrix::gutsOfOpEqual(const bool colordered,
        } else {
 	 CoinMemcpyN(len, major, length_);
        }
-       delete [] start_;
+       coinDeleteStart(start_);
        start_ = new CoinBigIndex[maxMajorDim_+1];
        start_[0] = 0;
        if (extraGap_ == 0) {
@@ -2761,7 +4362,7 @@ CoinPackedMatrix::gutsOfOpEqual(const bool colordered,
        }
      } else {
        // empty matrix
-       delete [] start_;
+       coinDeleteStart(start_);
        start_ = new CoinBigIndex[1];
        start_[0] = 0;
      }
@@ -2770,10 +4371,10 @@ CoinPackedMatrix::gutsOfOpEqual(const bool colordered,
      maxSize_ = CoinLengthWithExtra(maxSize_, extraMajor_);
      
      if (maxSize_ > 0) {
-       delete [] element_;
-       delete [] index_;
-       element_ = new double[maxSize_];
-       index_ = new int[maxSize_];
+       coinDeleteMatrixArray(memoryPolicy_,element_);
+       coinDeleteMatrixArray(memoryPolicy_,index_);
+       element_ = coinNewMatrixArray<double>(memoryPolicy_,maxSize_);
+       index_ = coinNewMatrixArray<int>(memoryPolicy_,maxSize_);
        assert (maxSize_>=start_[majorDim_-1]+length_[majorDim_-1]);
        // we can't just simply memcpy these content over, because that can
        // upset memory debuggers like purify if there were gaps and those gaps
@@ -2829,8 +4430,8 @@ CoinPackedMatrix::resizeForAddingMajorVectors(const int numVec,
     CoinMax(maxSize_, CoinLengthWithExtra(newStart[majorDim_], extraMajor_));
   majorDim_ -= numVec;
 
-  int * newIndex = new int[maxSize_];
-  double * newElem = new double[maxSize_];
+  int * newIndex = coinNewMatrixArray<int>(memoryPolicy_,maxSize_);
+  double * newElem = coinNewMatrixArray<double>(memoryPolicy_,maxSize_);
   for (i = majorDim_ - 1; i >= 0; --i) {
     CoinMemcpyN(index_ + start_[i], length_[i], newIndex + newStart[i]);
     CoinMemcpyN(element_ + start_[i], length_[i], newElem + newStart[i]);
@@ -2846,6 +4447,123 @@ CoinPackedMatrix::resizeForAddingMajorVectors(const int numVec,
 
 //#############################################################################
 
+/* Appends number minor vectors in one pass.  Entries are grouped by
+   major vector first. */
+
+void
+CoinPackedMatrix::gutsOfAppendMinor(const int number,
+				    const CoinBigIndex * starts,
+				    const int * lengths, const int * index,
+				    const double * element,
+				    const int * addedEntries)
+{
+   int i;
+   // new entries grouped by major vector (in minor order)
+   CoinBigIndex * addStart = new CoinBigIndex[majorDim_ + 1];
+   CoinBigIndex numberAdded = 0;
+   for (i = 0; i < majorDim_; ++i) {
+      addStart[i] = numberAdded;
+      numberAdded += addedEntries[i];
+   }
+   addStart[majorDim_] = numberAdded;
+   int * addIndex = new int[numberAdded];
+   double * addElement = new double[numberAdded];
+   for (i = 0; i < number; ++i) {
+      const CoinBigIndex end = lengths ? starts[i] + lengths[i] : starts[i+1];
+      for (CoinBigIndex j = starts[i]; j < end; ++j) {
+	 const int iIndex = index[j];
+	 if (iIndex >= 0 && iIndex < majorDim_) {
+	    const CoinBigIndex put = addStart[iIndex]++;
+	    addIndex[put] = minorDim_ + i;
+	    addElement[put] = element[j];
+	 }
+      }
+   }
+   for (i = majorDim_ - 1; i >= 0; --i)
+      addStart[i+1] = addStart[i];
+   addStart[0] = 0;
+   gutsOfMergeMinor(number, addStart, addIndex, addElement);
+   delete[] addStart;
+   delete[] addIndex;
+   delete[] addElement;
+}
+
+//-----------------------------------------------------------------------------
+
+/* Merges grouped new entries into major vectors.  If any major vector has
+   no room all are moved once, with room as given by extraGap_ and
+   extraMajor_.  From the second such move on those getting entries are
+   also given room for as many again (and a quarter) so repeated rounds
+   usually go in place while a single append leaves the matrix packed. */
+
+void
+CoinPackedMatrix::gutsOfMergeMinor(const int number,
+				   const CoinBigIndex * addStart,
+				   const int * addIndex,
+				   const double * addElement)
+{
+   int i;
+   const CoinBigIndex numberAdded = addStart[majorDim_];
+   for (i = majorDim_ - 1; i >= 0; --i) {
+      if (start_[i] + length_[i] + addStart[i+1] - addStart[i] > start_[i+1])
+	 break;
+   }
+   CoinAppendMinorTask task;
+   task.start_ = start_;
+   task.index_ = index_;
+   task.element_ = element_;
+   task.newStart_ = start_;
+   task.newIndex_ = index_;
+   task.newElement_ = element_;
+   task.addStart_ = addStart;
+   task.addIndex_ = addIndex;
+   task.addElement_ = addElement;
+   CoinBigIndex * newStart = NULL;
+   if (i >= 0) {
+      // move everything once
+      maxMajorDim_ =
+	CoinMax(CoinLengthWithExtra(majorDim_, extraMajor_), maxMajorDim_);
+      newStart = new CoinBigIndex[maxMajorDim_ + 1];
+      int * newLength = new int[maxMajorDim_];
+      CoinMemcpyN(length_, majorDim_, newLength);
+      newStart[0] = 0;
+      for (i = 0; i < majorDim_; ++i) {
+	 const int added = static_cast<int>(addStart[i+1] - addStart[i]);
+	 const int newSize = length_[i] + added;
+	 CoinBigIndex room = CoinLengthWithExtra(newSize, extraGap_);
+	 if (appendMoves_ && added)
+	    room += added + newSize / 4;
+	 newStart[i+1] = newStart[i] + room;
+      }
+      ++appendMoves_;
+      maxSize_ = CoinMax(maxSize_,
+			 CoinLengthWithExtra(newStart[majorDim_], extraMajor_));
+      delete[] length_;
+      length_ = newLength;
+      task.newStart_ = newStart;
+      task.newIndex_ = coinNewMatrixArray<int>(memoryPolicy_, maxSize_);
+      task.newElement_ = coinNewMatrixArray<double>(memoryPolicy_, maxSize_);
+   }
+   task.length_ = length_;
+   CoinThreadPool * pool = coinMatrixPool(size_ + numberAdded);
+   if (pool)
+      pool->parallelFor(task, 0, majorDim_);
+   else
+      task.run(0, majorDim_);
+   if (newStart) {
+      coinDeleteStart(start_);
+      coinDeleteMatrixArray(memoryPolicy_, index_);
+      coinDeleteMatrixArray(memoryPolicy_, element_);
+      start_ = newStart;
+      index_ = task.newIndex_;
+      element_ = task.newElement_;
+   }
+   minorDim_ += number;
+   size_ += numberAdded;
+}
+
+//-----------------------------------------------------------------------------
+
 void
 CoinPackedMatrix::resizeForAddingMinorVectors(const int * addedEntries)
 {
@@ -2876,8 +4594,8 @@ CoinPackedMatrix::resizeForAddingMinorVectors(const int * addedEntries)
 
    maxSize_ =
      CoinMax(maxSize_, CoinLengthWithExtra(newStart[majorDim_], extraMajor_));
-   int * newIndex = new int[maxSize_];
-   double * newElem = new double[maxSize_];
+   int * newIndex = coinNewMatrixArray<int>(memoryPolicy_,maxSize_);
+   double * newElem = coinNewMatrixArray<double>(memoryPolicy_,maxSize_);
    for (i = majorDim_ - 1; i >= 0; --i) {
       CoinMemcpyN(index_ + start_[i], length_[i],
 			newIndex + newStart[i]);
@@ -2898,6 +4616,7 @@ CoinPackedMatrix::resizeForAddingMinorVectors(const int * addedEntries)
 void
 CoinPackedMatrix::dumpMatrix(const char* fname) const
 {
+   checkNarrow("dumpMatrix");
   if (! fname) {
     printf("Dumping matrix...\n\n");
     printf("colordered: %i\n", isColOrdered() ? 1 : 0);
@@ -2932,6 +4651,7 @@ void
 CoinPackedMatrix::printMatrixElement (const int row_val,
 				      const int col_val) const
 {
+   checkNarrow("printMatrixElement");
   int major_index, minor_index;
   if (isColOrdered()) {
     major_index = col_val;
@@ -2965,6 +4685,8 @@ CoinPackedMatrix::printMatrixElement (const int row_val,
 bool 
 CoinPackedMatrix::isEquivalent2(const CoinPackedMatrix& rhs) const
 {
+   checkNarrow("isEquivalent2");
+   rhs.checkNarrow("isEquivalent2");
   CoinRelFltEq eq;
   // Both must be column order or both row ordered and must be of same size
   if (isColOrdered() ^ rhs.isColOrdered()) {
@@ -3025,6 +4747,8 @@ CoinPackedMatrix::isEquivalent2(const CoinPackedMatrix& rhs) const
 bool 
 CoinPackedMatrix::isEquivalent(const CoinPackedMatrix& rhs, const CoinRelFltEq& eq) const
 {
+   checkNarrow("isEquivalent");
+   rhs.checkNarrow("isEquivalent");
   // Both must be column order or both row ordered and must be of same size
   if ((isColOrdered() ^ rhs.isColOrdered()) ||
       (getNumCols() != rhs.getNumCols()) ||
@@ -3073,11 +4797,14 @@ bool CoinPackedMatrix::isEquivalent(const CoinPackedMatrix& rhs) const
 void 
 CoinPackedMatrix::orderMatrix()
 {
+   checkNarrow("orderMatrix");
+   clearCaches();
   for (int i=0;i<majorDim_;i++) {
     CoinBigIndex start = start_[i];
     CoinBigIndex end = start + length_[i];
     CoinSort_2(index_+start,index_+end,element_+start);
   }
+  sortedIndices_ = true;
 }
 /* Append a set of rows/columns to the end of the matrix. Returns number of errors
    i.e. if any of the new rows/columns contain an index that's larger than the
@@ -3088,6 +4815,8 @@ CoinPackedMatrix::appendMajor(const int number,
                               const CoinBigIndex * starts, const int * index,
                               const double * element, int numberOther)
 {
+   checkNarrow("appendMajor");
+   clearCaches();
   int i;
   int numberErrors=0;
   CoinBigIndex numberElements = starts[number];
@@ -3106,18 +4835,18 @@ CoinPackedMatrix::appendMajor(const int number,
 	length_  = newLength;
 	CoinBigIndex * newStart = new CoinBigIndex[maxMajorDim_ + 1];
 	CoinMemcpyN(start_, majorDim_+1, newStart);
-	delete [] start_;
+	coinDeleteStart(start_);
 	start_   = newStart;
       }
       if (size_+numberElements>maxSize_) {
 	maxSize_ = size_+numberElements;
-	double * newElem = new double[maxSize_];
+	double * newElem = coinNewMatrixArray<double>(memoryPolicy_,maxSize_);
 	CoinMemcpyN(element_,size_,newElem);
-	delete [] element_;
+	coinDeleteMatrixArray(memoryPolicy_,element_);
 	element_ = newElem;
-	int * newIndex = new int[maxSize_];
+	int * newIndex = coinNewMatrixArray<int>(memoryPolicy_,maxSize_);
 	CoinMemcpyN(index_,size_,newIndex);
-	delete [] index_;
+	coinDeleteMatrixArray(memoryPolicy_,index_);
 	index_ = newIndex;
       }
       CoinMemcpyN(index,numberElements,index_+size_);
@@ -3298,6 +5027,8 @@ CoinPackedMatrix::appendMinor(const int number,
                               const CoinBigIndex * starts, const int * index,
                               const double * element, int numberOther)
 {
+   checkNarrow("appendMinor");
+   clearCaches();
   int i;
   int numberErrors=0;
   // first compute how many entries will be added to each major-dimension
@@ -3356,25 +5087,8 @@ CoinPackedMatrix::appendMinor(const int number,
       }
     }
   }
-  for (i = majorDim_ - 1; i >= 0; i--) {
-    if (start_[i] + length_[i] + addedEntries[i] > start_[i+1])
-      break;
-  }
-  if (i >= 0)
-    resizeForAddingMinorVectors(addedEntries);
+  gutsOfAppendMinor(number, starts, NULL, index, element, addedEntries);
   delete[] addedEntries;
-
-  // now insert the entries of matrix
-  for (i = 0; i < number; i++) {
-    CoinBigIndex j;
-    for ( j=starts[i];j<starts[i+1];j++) {
-      int iIndex = index[j];
-      element_[start_[iIndex] + length_[iIndex]] = element[j];
-      index_[start_[iIndex] + (length_[iIndex]++)] = minorDim_;
-    }
-    ++minorDim_;
-  }
-  size_ += starts[number];
 #ifndef NDEBUG
   int checkSize=0;
   for (int i=0;i<majorDim_;i++) {
@@ -3396,6 +5110,8 @@ CoinPackedMatrix::appendMinorFast(const int number,
 				  const CoinBigIndex * starts, const int * index,
 				  const double * element)
 {
+   checkNarrow("appendMinorFast");
+   clearCaches();
 #ifdef ADD_ROW_ANALYZE
   xxxxxx[0]++;
 #endif
@@ -3478,8 +5194,8 @@ CoinPackedMatrix::appendMinorFast(const int number,
   }
   if (packType) {
     maxSize_ = CoinMax(maxSize_, n);
-    int * newIndex = new int[maxSize_];
-    double * newElem = new double[maxSize_];
+    int * newIndex = coinNewMatrixArray<int>(memoryPolicy_,maxSize_);
+    double * newElem = coinNewMatrixArray<double>(memoryPolicy_,maxSize_);
     for (int i = majorDim_ - 1; i >= 0; --i) {
       CoinBigIndex start = start_[i];
 #ifdef USE_MEMCPY
@@ -3497,9 +5213,9 @@ CoinPackedMatrix::appendMinorFast(const int number,
 #endif
     }
     
-    delete [] start_;
-    delete [] index_;
-    delete [] element_;
+    coinDeleteStart(start_);
+    coinDeleteMatrixArray(memoryPolicy_,index_);
+    coinDeleteMatrixArray(memoryPolicy_,element_);
     start_   = newStart;
     index_   = newIndex;
     element_ = newElem;
@@ -3518,7 +5234,7 @@ CoinPackedMatrix::appendMinorFast(const int number,
 	element_[put]=element_[j];
       }
     }
-    delete [] start_;
+    coinDeleteStart(start_);
     start_   = newStart;
   } else {
     delete[] newStart;
@@ -3554,6 +5270,7 @@ CoinPackedMatrix::appendMinorFast(const int number,
 int CoinPackedMatrix::verifyMtx (int verbosity, bool zeroesAreError) const
 
 {
+   checkNarrow("verifyMtx");
   const double smallCoeff = 1.0e-50 ;
   const double largeCoeff = 1.0e50 ;
 
@@ -15,6 +15,11 @@
 class CoinRelFltEq;
 #endif
 
+class CoinMemoryUsage;
+class CoinSellMatrix;
+class CoinIndexedVector;
+class CoinOrthoDelta;
+
 /** Sparse Matrix Base Class
 
   This class is intended to represent sparse matrices using row-major
@@ -101,11 +106,32 @@ public:
     inline bool isColOrdered() const { return colOrdered_; }
 
     /** Whether the packed matrix has gaps or not. */
-    inline bool hasGaps() const { return (size_<start_[majorDim_]) ; } 
+    inline bool hasGaps() const
+    { return wideStart_ ? false : (size_<start_[majorDim_]) ; } 
 
-    /** Number of entries in the packed matrix. */
+    /** Number of entries in the packed matrix (-1 if there are too many
+	for a CoinBigIndex - see hasWideStarts()). */
     inline CoinBigIndex getNumElements() const { return size_; }
 
+    /*! \brief Whether vector starts are 64 bit.
+
+	Matrices with more elements than a CoinBigIndex can count keep
+	their starts in a CoinInt64 array (getWideVectorStarts()) while
+	indices stay int.  Such a matrix has no gaps and
+	getVectorStarts() is NULL.  Only copying, swapping, transpose(),
+	reverseOrderedCopyOf(), countOrthoLength() and times() and
+	transposeTimes() with dense vectors work on it; other methods
+	throw CoinError.
+    */
+    inline bool hasWideStarts() const { return wideStart_ != NULL; }
+
+    /// Number of entries, whether or not starts are wide
+    inline CoinInt64 getNumElementsWide() const
+    { return wideStart_ ? wideStart_[majorDim_] : size_; }
+
+    /// 64 bit starts (NULL unless hasWideStarts())
+    inline const CoinInt64 * getWideVectorStarts() const { return wideStart_; }
+
     /** Number of columns. */
     inline int getNumCols() const
     { return colOrdered_ ? majorDim_ : minorDim_; }
@@ -165,6 +191,7 @@ public:
 #ifndef COIN_FAST_CODE
       if (i < 0 || i >= majorDim_)
 	throw CoinError("bad index", "vectorFirst", "CoinPackedMatrix");
+      checkNarrow("vectorFirst");
 #endif
       return start_[i];
     }
@@ -174,6 +201,7 @@ public:
 #ifndef COIN_FAST_CODE
       if (i < 0 || i >= majorDim_)
 	throw CoinError("bad index", "vectorLast", "CoinPackedMatrix");
+      checkNarrow("vectorLast");
 #endif
       return start_[i] + length_[i];
     }
@@ -191,6 +219,7 @@ public:
 #ifndef COIN_FAST_CODE
       if (i < 0 || i >= majorDim_)
 	throw CoinError("bad index", "vector", "CoinPackedMatrix");
+      checkNarrow("vector");
 #endif
       return CoinShallowPackedVector(length_[i],
   				    index_ + start_[i],
@@ -209,6 +238,9 @@ public:
 	  The returned array is allocated with <code>new int[]</code>,
 	  free it with  <code>delete[]</code>. */
     int * getMajorIndices() const;
+    /** Add bytes used and allocated for each internal array to \p usage.
+        Slack is space left by extraGap and extraMajor (or by deletions). */
+    void memoryUsage(CoinMemoryUsage & usage) const;
   //@}
 
   //---------------------------------------------------------------------------
@@ -228,6 +260,16 @@ public:
     void setExtraGap(const double newGap);
     /** Set the extra major to be allocated to the specified value. */
     void setExtraMajor(const double newMajor);
+    /** Change to (or from) 64 bit starts.  Gaps are removed first;
+	throws CoinError if there are too many elements to go back. */
+    void setWideStarts(bool yesNo);
+    /** Set CoinMemoryPolicy for element and index arrays (-1 for default
+        policy).  Existing arrays are moved.  With a nonzero policy the
+        arrays must not be taken over by the caller (nullElementArray etc)
+        as they can not be freed by delete[]. */
+    void setMemoryPolicy(int policy);
+    /// CoinMemoryPolicy for element and index arrays
+    inline int memoryPolicy() const { return memoryPolicy_; }
 #ifndef CLP_NO_VECTOR
     /*! Append a column to the end of the matrix.
     
@@ -326,9 +368,18 @@ public:
 	keepZero true */
     void modifyCoefficient(int row, int column, double newElement,
 			   bool keepZero=false);
+    /** Modify many elements at once - as modifyCoefficient for each of
+	rows[k],columns[k],values[k] in turn (so if an element appears more
+	than once the last value is used).  Changes are grouped by major
+	vector and applied in one pass over the matrix, growing storage at
+	most once.  Bad indices are ignored (or throw if COIN_DEBUG). */
+    void modifyCoefficients(int number, const int * rows,
+			    const int * columns, const double * values,
+			    bool keepZero=false);
     /** Return one element of packed matrix.
         This works for either ordering
-	If it is not present will return 0.0 */
+	If it is not present will return 0.0.  Uses a binary search if
+	hasSortedIndices(). */
     double getCoefficient(int row, int column) const;
 
     /** Eliminate all elements in matrix whose 
@@ -342,8 +393,19 @@ public:
 	eliminated.  
     */
     int eliminateDuplicates(double threshold);
+    /** As eliminateDuplicates(double) but gives how many duplicates were
+	merged and how many elements (after merging) were too small.
+	Major vectors are done in parallel if the default CoinThreadPool
+	has threads. */
+    int eliminateDuplicates(double threshold, CoinBigIndex * numberDuplicates,
+			    CoinBigIndex * numberSmall);
     /** Sort all columns so indices are increasing.in each column */
     void orderMatrix();
+    /** True if indices are known to be increasing in each major vector.
+	Set by orderMatrix(), cleanMatrix() and reverseOrderedCopyOf(),
+	kept by changes which keep order (e.g. modifyCoefficient() and
+	modifyCoefficients()) and cleared by clearCaches(). */
+    inline bool hasSortedIndices() const { return sortedIndices_; }
     /** Really clean up matrix.
 	a) eliminate all duplicate AND small elements in matrix 
 	b) remove all gaps and set extraGap_ and extraMajor_ to 0.0
@@ -352,6 +414,12 @@ public:
 	returns number of elements eliminated
     */
     int cleanMatrix(double threshold=1.0e-20);
+    /** As cleanMatrix(double) but gives how many duplicates were merged
+	and how many elements (after merging) were too small (either
+	pointer may be NULL).  Major vectors are done in parallel if the
+	default CoinThreadPool has threads. */
+    int cleanMatrix(double threshold, CoinBigIndex * numberDuplicates,
+		    CoinBigIndex * numberSmall);
   //@}
 
   //---------------------------------------------------------------------------
@@ -368,7 +436,8 @@ public:
 		     const int numMajor, const int * indMajor);
     /** Extract a submatrix from matrix. Those major-dimension vectors of
 	the matrix comprise the submatrix whose indices are given in the
-	arguments. Allows duplicates and keeps order. */
+	arguments. Allows duplicates and keeps order.  CoinPackedMatrixView
+	gives the same without copying elements. */
     void submatrixOfWithDuplicates(const CoinPackedMatrix& matrix,
 		     const int numMajor, const int * indMajor);
 #if 0
@@ -402,6 +471,10 @@ public:
       vector orientation changed from row (column) to column (row).
       The extra space parameters are also copied and reversed.
       (Cf. #reverseOrdering, which does the same thing in place.)
+      Minor indices of the copy are sorted.
+
+      Large matrices are copied by a parallel counting sort if
+      CoinThreadPool::defaultPool() is set; the result is identical.
     */
     void reverseOrderedCopyOf(const CoinPackedMatrix& rhs);
 
@@ -422,15 +495,28 @@ public:
  
  
  
+    /** Assign a matrix without gaps which may have more elements than a
+	CoinBigIndex can count (start[major] of them).  Wide starts are
+	kept only if needed.  As assignMatrix(), pointers are NULL on
+	return and arrays must come from <code>new[]</code>. */
+    void assignWideMatrix(const bool colordered,
+			  const int minor, const int major,
+			  CoinInt64 *& start, int *& ind, double *& elem);
+
     /** Assignment operator. This copies out the data, but uses the current
         matrix's extra space parameters. */
     CoinPackedMatrix & operator=(const CoinPackedMatrix& rhs);
+#if __cplusplus >= 201103L
+    /** Move assignment.  Takes the arrays (and copies kept for
+	multiplying) of rhs, which is left with the old contents. */
+    CoinPackedMatrix & operator=(CoinPackedMatrix&& rhs) noexcept;
+#endif
  
     /*! \brief Reverse the ordering of the packed matrix.
 
       Change the major vector orientation of the matrix data structures from
       row (column) to column (row). (Cf. #reverseOrderedCopyOf, which does
-      the same thing but produces a new matrix.)
+      the same thing but produces a new matrix, in parallel if large.)
     */
     void reverseOrdering();
 
@@ -471,6 +557,44 @@ public:
         method, just <code>x</code> is given in the form of a packed vector. */
     void transposeTimes(const CoinPackedVectorBase& x, double * y) const;
 #endif
+    /** Return <code>x * A</code> in <code>y</code> for sparse x (packed or
+	not, in any representation).  y is cleared and made big enough;
+	entries which cancel may be left as tiny values.  If that is less
+	work, goes along the rows x uses rather than down every column.  A
+	column ordered matrix can only do that with its reverse ordered copy
+	- build it first with getOrthoCopy() (and setDualOrdered(true) to
+	keep it through changes).  Nothing in the matrix is changed, so
+	several threads may call this at once; a copy with logged changes
+	not yet applied is not used until getOrthoCopy() is called again. */
+    void transposeTimes(const CoinIndexedVector & x,
+			CoinIndexedVector & y) const;
+    /// True if a reverse ordered copy is kept for sparse transposeTimes
+    inline bool hasOrthoCache() const { return orthoCache_ != NULL; }
+    /** Reverse ordered copy of the matrix, built (or brought up to date)
+	if needed and kept until the matrix changes. */
+    const CoinPackedMatrix & getOrthoCopy() const;
+    /** Keep the reverse ordered copy through appendCol(s), appendRow(s),
+	deleteCols, deleteRows, modifyCoefficient, replaceVector and
+	setDimensions.  These are logged and the copy is patched when
+	next used.  Any other change, or a log costing more to apply than
+	a rebuild, drops the copy as usual. */
+    void setDualOrdered(bool yesNo);
+    /// True if reverse ordered copy is kept through logged changes
+    inline bool dualOrdered() const { return dualOrdered_; }
+    /** Build a CoinSellMatrix copy after this many calls of times() and
+        transposeTimes() with dense x and use it from then on (0, the
+        default, never).  Building costs several multiplies so this is
+        only worth while for matrices multiplied many times.  The copy
+        is dropped when the matrix changes (see clearCaches()). */
+    void setSellCacheAfter(int value);
+    /// Calls of times() and transposeTimes() before using a CoinSellMatrix
+    inline int sellCacheAfter() const { return sellCacheAfter_; }
+    /// sellCacheAfter for matrices created from now on
+    static int defaultSellCacheAfter();
+    /// Set sellCacheAfter for matrices created from now on
+    static void setDefaultSellCacheAfter(int value);
+    /// True if a CoinSellMatrix copy is being used
+    inline bool hasSellCache() const { return sellCache_ != NULL; }
   //@}
 
   //---------------------------------------------------------------------------
@@ -491,20 +615,22 @@ public:
 	  <code>delete[]</code>. */
       int * countOrthoLength() const;
       /** Count the number of entries in every minor-dimension vector and
-	  fill in an array containing these lengths.  */
+	  fill in an array containing these lengths.  Large matrices are
+	  counted in parallel if CoinThreadPool::defaultPool() is set (so
+	  reverseOrderedCopyOf() is partly parallel). */
       void countOrthoLength(int * counts) const;
       /** Major dimension. For row ordered matrix this would be the number of
           rows. */
       inline int getMajorDim() const { return majorDim_; }
       /** Set major dimension. For row ordered matrix this would be the number of
           rows. Use with great care.*/
-      inline void setMajorDim(int value) { majorDim_ = value; }
+      inline void setMajorDim(int value) { majorDim_ = value; clearCaches(); }
       /** Minor dimension. For row ordered matrix this would be the number of
 	  columns. */
       inline int getMinorDim() const { return minorDim_; }
       /** Set minor dimension. For row ordered matrix this would be the number of
           columns. Use with great care.*/
-      inline void setMinorDim(int value) { minorDim_ = value; }
+      inline void setMinorDim(int value) { minorDim_ = value; clearCaches(); }
       /** Current maximum for major dimension. For row ordered matrix this many
           rows can be added without reallocating the vector related to the
 	  major dimension (<code>start_</code> and <code>length_</code>). */
@@ -630,7 +756,10 @@ public:
       /** Return <code>A * x</code> (multiplied from the "right" direction) in
 	  <code>y</code>.
 	  @pre <code>x</code> must be of size <code>minorDim()</code>
-	  @pre <code>y</code> must be of size <code>majorDim()</code> */
+	  @pre <code>y</code> must be of size <code>majorDim()</code>
+
+	  Large matrices are done in parallel if
+	  CoinThreadPool::defaultPool() is set. */
       void timesMinor(const double * x, double * y) const;
 #ifndef CLP_NO_VECTOR
       /** Return <code>A * x</code> (multiplied from the "right" direction) in
@@ -705,23 +834,34 @@ public:
     /** A vector containing the elements in the packed matrix. Note that there
 	might be gaps in this list, entries that do not belong to any
 	major-dimension vector. To get the actual elements one should look at
-	this vector together with #start_ and #length_. */
-    inline double * getMutableElements() const { return element_; }
+	this vector together with #start_ and #length_.
+	Calls clearCaches() as the matrix may be changed. */
+    inline double * getMutableElements() const
+    { clearCaches(); return element_; }
     /** A vector containing the minor indices of the elements in the packed
         matrix. Note that there might be gaps in this list, entries that do not
         belong to any major-dimension vector. To get the actual elements one
         should look at this vector together with #start_ and
-        #length_. */
-    inline int * getMutableIndices() const { return index_; }
+        #length_.  Calls clearCaches() as the matrix may be changed. */
+    inline int * getMutableIndices() const
+    { clearCaches(); return index_; }
 
     /** The positions where the major-dimension vectors start in #element_ and
-        #index_. */
-    inline CoinBigIndex * getMutableVectorStarts() const { return start_; }
-    /** The lengths of the major-dimension vectors. */
-    inline int * getMutableVectorLengths() const { return length_; }
+        #index_.  Calls clearCaches() as the matrix may be changed. */
+    inline CoinBigIndex * getMutableVectorStarts() const
+    { clearCaches(); return start_; }
+    /** The lengths of the major-dimension vectors.  Calls clearCaches() as
+	the matrix may be changed. */
+    inline int * getMutableVectorLengths() const
+    { clearCaches(); return length_; }
     /// Change the size of the bulk store after modifying - be careful
     inline void setNumElements(CoinBigIndex value)
-    { size_ = value;}
+    { size_ = value; clearCaches(); }
+    /** Drop copies kept for multiplying (see setSellCacheAfter() and
+        hasOrthoCache()).  All methods changing the matrix do this (other
+        than logged changes to a dual ordered matrix), as do the getMutable
+        methods.  Also forgets that indices are sorted. */
+    void clearCaches() const;
     /*! NULLify element array
     
       Used when space is very tight. Does not free the space!
@@ -786,6 +926,11 @@ public:
 
    /// Copy constructor 
    CoinPackedMatrix(const CoinPackedMatrix& m);
+#if __cplusplus >= 201103L
+   /** Move constructor - takes arrays of m which is left empty.  Allocates
+       nothing so std::vector moves rather than copies on growth. */
+   CoinPackedMatrix(CoinPackedMatrix&& m) noexcept;
+#endif
 
   /*! \brief Copy constructor with fine tuning
   
@@ -860,6 +1005,27 @@ protected:
 		      const CoinBigIndex * start, const int * len);
    void resizeForAddingMajorVectors(const int numVec, const int * lengthVec);
    void resizeForAddingMinorVectors(const int * addedEntries);
+   /** Exchanges everything except settings (and copies kept for
+       multiplying unless both are dual ordered or neither is) */
+   void gutsOfMove(CoinPackedMatrix & rhs);
+   /** Cleans each major vector in place.  mode 0 moves small elements to
+       after end, 1 also merges duplicates and 2 also sorts. */
+   void gutsOfClean(int mode, double threshold,
+		    CoinBigIndex & numberDuplicates,
+		    CoinBigIndex & numberSmall);
+   /** Appends number minor vectors (vector i from starts[i] to starts[i+1],
+       or for lengths[i] if lengths given) whose counts by major index are
+       addedEntries.  Major vectors are moved at most once and in parallel.
+       Indices outside the major dimension are skipped. */
+   void gutsOfAppendMinor(const int number, const CoinBigIndex * starts,
+			  const int * lengths, const int * index,
+			  const double * element, const int * addedEntries);
+   /** Merges number new minor vectors whose entries are already grouped
+       by major vector (major vector i gets addIndex and addElement from
+       addStart[i] to addStart[i+1]).  Major vectors are moved at most once
+       and in parallel. */
+   void gutsOfMergeMinor(const int number, const CoinBigIndex * addStart,
+			 const int * addIndex, const double * addElement);
 
     /*! \brief Append a set of rows (columns) to the end of a row (colum)
     	       ordered matrix.
@@ -887,6 +1053,26 @@ protected:
                     const double * element, int numberOther=-1);
 
 private:
+   /// True if multiplying should use #sellCache_ (building it if time)
+   bool useSellCache() const;
+   /** Drops copies as clearCaches() but keeps #orthoCache_ and returns
+       true if the change about to be made should be logged */
+   bool keepOrthoCache() const;
+   /// Makes #orthoCache_ up to date
+   void updateOrthoCache() const;
+   /** Position of minorIndex in major vector (-1 if not there) - binary
+       search if #sortedIndices_ */
+   CoinBigIndex findMinor(int majorIndex, int minorIndex) const;
+   /// Throws CoinError if starts are wide
+   inline void checkNarrow(const char * method) const {
+      if (wideStart_)
+	 throw CoinError("not available with wide starts", method,
+			 "CoinPackedMatrix");
+   }
+   /// Makes matrix empty with normal starts if starts are wide
+   void removeWide();
+   /// Copies rhs which has wide starts
+   void gutsOfCopyWide(const CoinPackedMatrix & rhs);
    inline CoinBigIndex getLastStart() const {
       return majorDim_ == 0 ? 0 : start_[majorDim_];
    }
@@ -930,6 +1116,31 @@ protected:
    int maxMajorDim_;
    /// max space allocated for entries
    CoinBigIndex maxSize_;
+   /** CoinMemoryPolicy used for #element_ and #index_ (0 means they
+       were allocated by new[]) */
+   int memoryPolicy_;
+   /// Copy for times() and transposeTimes() (built when asked)
+   mutable CoinSellMatrix * sellCache_;
+   /// Reverse ordered copy for sparse transposeTimes (built when asked)
+   mutable CoinPackedMatrix * orthoCache_;
+   /// Changes not yet made to #orthoCache_ (if dual ordered)
+   mutable CoinOrthoDelta * orthoDelta_;
+   /// Keep orthoCache_ through logged changes
+   bool dualOrdered_;
+   /// True while a logged change is being made
+   bool orthoBusy_;
+   /// True if indices are increasing in each major vector
+   mutable bool sortedIndices_;
+   /// Calls of times() and transposeTimes() since last change
+   mutable int numberMultiplies_;
+   /// Build #sellCache_ after this many calls (0 never)
+   int sellCacheAfter_;
+   /** Times appending minor vectors has had to move the matrix (after
+       the first, vectors getting entries are given room to grow) */
+   int appendMoves_;
+   /** 64 bit starts for matrices with too many elements (#start_ is
+       then NULL) */
+   CoinInt64 * wideStart_;
    //@}
 };
 
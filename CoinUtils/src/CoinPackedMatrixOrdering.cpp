@@ -0,0 +1,502 @@
+/* $Id$ */
+// Copyright (C) 2012, International Business Machines
+// Corporation and others.  All Rights Reserved.
+// This code is licensed under the terms of the Eclipse Public License (EPL).
+
+#include <algorithm>
+
+#include "CoinPackedMatrixOrdering.hpp"
+#include "CoinPackedMatrix.hpp"
+#include "CoinHelperFunctions.hpp"
+#include "CoinSort.hpp"
+#include "CoinError.hpp"
+#include "CoinThreadPool.hpp"
+
+// Fewest elements worth permuting in parallel
+#define COIN_ORDERING_PARALLEL 100000
+
+// Start of major vector i whether or not starts are wide
+static inline CoinInt64
+coinFirst(const CoinPackedMatrix & matrix, int i)
+{
+  const CoinInt64 * wide = matrix.getWideVectorStarts();
+  return wide ? wide[i] : matrix.getVectorStarts()[i];
+}
+
+//#############################################################################
+/* Rows and columns as one bipartite graph.  Node i < numberMajor is major
+   vector i and node numberMajor+j is minor vector j (a major vector of
+   the reverse ordered copy). */
+
+class CoinOrderingGraph {
+public:
+  CoinOrderingGraph(const CoinPackedMatrix & matrix,
+		    const CoinPackedMatrix & reverse)
+    : matrix_(matrix), reverse_(reverse),
+      numberMajor_(matrix.getMajorDim())
+  {}
+  inline int numberNodes() const
+  { return numberMajor_+reverse_.getMajorDim(); }
+  inline int numberMajor() const
+  { return numberMajor_; }
+  inline int degree(int node) const
+  {
+    return node<numberMajor_ ? matrix_.getVectorLengths()[node] :
+      reverse_.getVectorLengths()[node-numberMajor_];
+  }
+  /// Neighbours of node are offset+index[0..degree-1]
+  inline const int * neighbours(int node, int & offset) const
+  {
+    if (node<numberMajor_) {
+      offset = numberMajor_;
+      return matrix_.getIndices()+coinFirst(matrix_,node);
+    } else {
+      offset = 0;
+      return reverse_.getIndices()+coinFirst(reverse_,node-numberMajor_);
+    }
+  }
+private:
+  const CoinPackedMatrix & matrix_;
+  const CoinPackedMatrix & reverse_;
+  int numberMajor_;
+};
+
+/* Breadth first level structure from root.  Nodes reached are put in
+   queue (marked with stamp), lastLevel is where the last level starts
+   and number of nodes is returned in numberReached.  Returns number of
+   levels. */
+static int
+coinLevels(const CoinOrderingGraph & graph, int root, int * queue,
+	   int * mark, int stamp, int & lastLevel, int & numberReached)
+{
+  int numberLevels = 0;
+  int head = 0;
+  int tail = 0;
+  queue[tail++] = root;
+  mark[root] = stamp;
+  while (head<tail) {
+    const int levelEnd = tail;
+    lastLevel = head;
+    numberLevels++;
+    for (;head<levelEnd;head++) {
+      const int node = queue[head];
+      int offset;
+      const int * index = graph.neighbours(node,offset);
+      const int n = graph.degree(node);
+      for (int j=0;j<n;j++) {
+	const int other = index[j]+offset;
+	if (mark[other]!=stamp) {
+	  mark[other] = stamp;
+	  queue[tail++] = other;
+	}
+      }
+    }
+  }
+  numberReached = tail;
+  return numberLevels;
+}
+
+// Sorts short vectors in place (longer ones with CoinSort_2)
+static inline void
+coinSortVector(int * index, double * element, int n)
+{
+  if (n>16) {
+    CoinSort_2(index,index+n,element);
+    return;
+  }
+  for (int j=1;j<n;j++) {
+    const int value = index[j];
+    const double el = element[j];
+    int k = j;
+    for (;k>0&&index[k-1]>value;k--) {
+      index[k] = index[k-1];
+      element[k] = element[k-1];
+    }
+    index[k] = value;
+    element[k] = el;
+  }
+}
+
+// Gathers renumbered major vectors into new arrays
+class CoinPermuteVectorsTask : public CoinThreadRangeTask {
+public:
+  const CoinPackedMatrix * matrix_;
+  const int * majorOrder_;
+  const int * minorPosition_;
+  const CoinInt64 * newStart_;
+  int * newIndex_;
+  double * newElement_;
+  virtual void run(int begin, int end)
+  {
+    const int * length = matrix_->getVectorLengths();
+    const int * index = matrix_->getIndices();
+    const double * element = matrix_->getElements();
+    for (int k = begin; k < end; ++k) {
+      const int i = majorOrder_[k];
+      const CoinInt64 first = coinFirst(*matrix_,i);
+      const int n = length[i];
+      int * putIndex = newIndex_+newStart_[k];
+      double * putElement = newElement_+newStart_[k];
+      for (int j=0;j<n;j++) {
+	putIndex[j] = minorPosition_[index[first+j]];
+	putElement[j] = element[first+j];
+      }
+      coinSortVector(putIndex,putElement,n);
+    }
+  }
+};
+
+//#############################################################################
+
+CoinPackedMatrixOrdering::CoinPackedMatrixOrdering()
+  : numberRows_(0),
+    numberColumns_(0),
+    method_(reverseCuthillMcKee),
+    rowOrder_(NULL),
+    rowPosition_(NULL),
+    columnOrder_(NULL),
+    columnPosition_(NULL)
+{
+}
+
+CoinPackedMatrixOrdering::CoinPackedMatrixOrdering(const CoinPackedMatrix & matrix,
+						   Method method)
+  : numberRows_(matrix.getNumRows()),
+    numberColumns_(matrix.getNumCols()),
+    method_(method),
+    rowOrder_(new int [numberRows_]),
+    rowPosition_(new int [numberRows_]),
+    columnOrder_(new int [numberColumns_]),
+    columnPosition_(new int [numberColumns_])
+{
+  if (method==columnClustering)
+    orderClusters(matrix);
+  else
+    orderCuthillMcKee(matrix);
+  makePositions();
+}
+
+CoinPackedMatrixOrdering::CoinPackedMatrixOrdering(const CoinPackedMatrixOrdering & rhs)
+{
+  gutsOfCopy(rhs);
+}
+
+CoinPackedMatrixOrdering &
+CoinPackedMatrixOrdering::operator=(const CoinPackedMatrixOrdering & rhs)
+{
+  if (this!=&rhs) {
+    delete [] rowOrder_;
+    delete [] rowPosition_;
+    delete [] columnOrder_;
+    delete [] columnPosition_;
+    gutsOfCopy(rhs);
+  }
+  return *this;
+}
+
+CoinPackedMatrixOrdering::~CoinPackedMatrixOrdering()
+{
+  delete [] rowOrder_;
+  delete [] rowPosition_;
+  delete [] columnOrder_;
+  delete [] columnPosition_;
+}
+
+void
+CoinPackedMatrixOrdering::gutsOfCopy(const CoinPackedMatrixOrdering & rhs)
+{
+  numberRows_ = rhs.numberRows_;
+  numberColumns_ = rhs.numberColumns_;
+  method_ = rhs.method_;
+  rowOrder_ = CoinCopyOfArray(rhs.rowOrder_,numberRows_);
+  rowPosition_ = CoinCopyOfArray(rhs.rowPosition_,numberRows_);
+  columnOrder_ = CoinCopyOfArray(rhs.columnOrder_,numberColumns_);
+  columnPosition_ = CoinCopyOfArray(rhs.columnPosition_,numberColumns_);
+}
+
+//#############################################################################
+
+void
+CoinPackedMatrixOrdering::orderCuthillMcKee(const CoinPackedMatrix & matrix)
+{
+  CoinPackedMatrix reverse;
+  reverse.reverseOrderedCopyOf(matrix);
+  const CoinOrderingGraph graph(matrix,reverse);
+  const int numberNodes = graph.numberNodes();
+  const int numberMajor = graph.numberMajor();
+  int * order = new int [numberNodes];
+  int * queue = new int [numberNodes];
+  int * mark = new int [numberNodes];
+  int * key = new int [numberNodes];
+  int * candidate = new int [numberNodes];
+  char * done = new char [numberNodes];
+  CoinZeroN(mark,numberNodes);
+  CoinZeroN(done,numberNodes);
+  // roots are tried by increasing degree
+  int numberCandidates = 0;
+  for (int i=0;i<numberNodes;i++) {
+    const int degree = graph.degree(i);
+    if (degree) {
+      key[numberCandidates] = degree;
+      candidate[numberCandidates++] = i;
+    }
+  }
+  CoinSort_2(key,key+numberCandidates,candidate);
+  int stamp = 0;
+  int numberOrdered = 0;
+  for (int iCandidate=0;iCandidate<numberCandidates;iCandidate++) {
+    int root = candidate[iCandidate];
+    if (done[root])
+      continue;
+    /* Pseudo-peripheral root (George and Liu) - move to a node of least
+       degree in last level while that gives more levels */
+    int lastLevel;
+    int numberReached;
+    int numberLevels = coinLevels(graph,root,queue,mark,++stamp,
+				  lastLevel,numberReached);
+    for (int pass=0;pass<8;pass++) {
+      int best = queue[lastLevel];
+      for (int k=lastLevel+1;k<numberReached;k++) {
+	if (graph.degree(queue[k])<graph.degree(best))
+	  best = queue[k];
+      }
+      int bestLastLevel;
+      const int bestLevels = coinLevels(graph,best,queue,mark,++stamp,
+					bestLastLevel,numberReached);
+      if (bestLevels<=numberLevels)
+	break;
+      root = best;
+      numberLevels = bestLevels;
+      lastLevel = bestLastLevel;
+    }
+    // Cuthill-McKee - neighbours in order of increasing degree
+    int head = numberOrdered;
+    order[numberOrdered++] = root;
+    done[root] = 1;
+    while (head<numberOrdered) {
+      const int node = order[head++];
+      int offset;
+      const int * index = graph.neighbours(node,offset);
+      const int n = graph.degree(node);
+      const int firstNew = numberOrdered;
+      for (int j=0;j<n;j++) {
+	const int other = index[j]+offset;
+	if (!done[other]) {
+	  done[other] = 1;
+	  key[numberOrdered] = graph.degree(other);
+	  order[numberOrdered++] = other;
+	}
+      }
+      CoinSort_2(key+firstNew,key+numberOrdered,order+firstNew);
+    }
+  }
+  // reverse and put empty vectors last
+  std::reverse(order,order+numberOrdered);
+  for (int i=0;i<numberNodes;i++) {
+    if (!done[i])
+      order[numberOrdered++] = i;
+  }
+  int * majorOrder = matrix.isColOrdered() ? columnOrder_ : rowOrder_;
+  int * minorOrder = matrix.isColOrdered() ? rowOrder_ : columnOrder_;
+  int numberMajorOrdered = 0;
+  int numberMinorOrdered = 0;
+  for (int k=0;k<numberNodes;k++) {
+    const int node = order[k];
+    if (node<numberMajor)
+      majorOrder[numberMajorOrdered++] = node;
+    else
+      minorOrder[numberMinorOrdered++] = node-numberMajor;
+  }
+  delete [] order;
+  delete [] queue;
+  delete [] mark;
+  delete [] key;
+  delete [] candidate;
+  delete [] done;
+}
+
+//-----------------------------------------------------------------------------
+
+void
+CoinPackedMatrixOrdering::orderClusters(const CoinPackedMatrix & matrix)
+{
+  CoinIotaN(rowOrder_,numberRows_,0);
+  // first and last row of each column (empty columns keep numberRows_)
+  int * first = new int [numberColumns_];
+  int * last = new int [numberColumns_];
+  CoinFillN(first,numberColumns_,numberRows_);
+  CoinFillN(last,numberColumns_,numberRows_);
+  const int * length = matrix.getVectorLengths();
+  const int * index = matrix.getIndices();
+  const int majorDim = matrix.getMajorDim();
+  if (matrix.isColOrdered()) {
+    for (int i=0;i<majorDim;i++) {
+      const CoinInt64 start = coinFirst(matrix,i);
+      const int n = length[i];
+      if (!n)
+	continue;
+      int low = index[start];
+      int high = low;
+      for (int j=1;j<n;j++) {
+	low = CoinMin(low,index[start+j]);
+	high = CoinMax(high,index[start+j]);
+      }
+      first[i] = low;
+      last[i] = high;
+    }
+  } else {
+    for (int i=0;i<majorDim;i++) {
+      const CoinInt64 start = coinFirst(matrix,i);
+      const int n = length[i];
+      for (int j=0;j<n;j++) {
+	const int iColumn = index[start+j];
+	if (first[iColumn]==numberRows_)
+	  first[iColumn] = i;
+	last[iColumn] = i;
+      }
+    }
+  }
+  CoinInt64 * key = new CoinInt64 [numberColumns_];
+  for (int i=0;i<numberColumns_;i++) {
+    key[i] = static_cast<CoinInt64>(first[i])*(numberRows_+1)+last[i];
+    columnOrder_[i] = i;
+  }
+  CoinSort_2(key,key+numberColumns_,columnOrder_);
+  delete [] key;
+  delete [] first;
+  delete [] last;
+}
+
+//-----------------------------------------------------------------------------
+
+void
+CoinPackedMatrixOrdering::makePositions()
+{
+  for (int i=0;i<numberRows_;i++)
+    rowPosition_[rowOrder_[i]] = i;
+  for (int i=0;i<numberColumns_;i++)
+    columnPosition_[columnOrder_[i]] = i;
+}
+
+//#############################################################################
+
+void
+CoinPackedMatrixOrdering::permute(CoinPackedMatrix & matrix) const
+{
+  if (matrix.getNumRows()!=numberRows_||matrix.getNumCols()!=numberColumns_)
+    throw CoinError("dimensions do not match", "permute",
+		    "CoinPackedMatrixOrdering");
+  if (matrix.isColOrdered())
+    permuteGuts(matrix,columnOrder_,rowPosition_);
+  else
+    permuteGuts(matrix,rowOrder_,columnPosition_);
+}
+
+void
+CoinPackedMatrixOrdering::unpermute(CoinPackedMatrix & matrix) const
+{
+  if (matrix.getNumRows()!=numberRows_||matrix.getNumCols()!=numberColumns_)
+    throw CoinError("dimensions do not match", "unpermute",
+		    "CoinPackedMatrixOrdering");
+  if (matrix.isColOrdered())
+    permuteGuts(matrix,columnPosition_,rowOrder_);
+  else
+    permuteGuts(matrix,rowPosition_,columnOrder_);
+}
+
+void
+CoinPackedMatrixOrdering::permuteGuts(CoinPackedMatrix & matrix,
+				      const int * majorOrder,
+				      const int * minorPosition)
+{
+  const int majorDim = matrix.getMajorDim();
+  const int * length = matrix.getVectorLengths();
+  CoinInt64 * start = new CoinInt64 [majorDim+1];
+  start[0] = 0;
+  for (int k=0;k<majorDim;k++)
+    start[k+1] = start[k]+length[majorOrder[k]];
+  const CoinInt64 numberElements = start[majorDim];
+  int * index = new int [numberElements];
+  double * element = new double [numberElements];
+  CoinPermuteVectorsTask task;
+  task.matrix_ = &matrix;
+  task.majorOrder_ = majorOrder;
+  task.minorPosition_ = minorPosition;
+  task.newStart_ = start;
+  task.newIndex_ = index;
+  task.newElement_ = element;
+  CoinThreadPool * pool =
+    CoinThreadPool::defaultPoolFor(numberElements,COIN_ORDERING_PARALLEL);
+  if (pool)
+    pool->parallelFor(task,0,majorDim);
+  else
+    task.run(0,majorDim);
+  matrix.assignWideMatrix(matrix.isColOrdered(),matrix.getMinorDim(),
+			  majorDim,start,index,element);
+}
+
+//-----------------------------------------------------------------------------
+
+void
+CoinPackedMatrixOrdering::permuteRowVector(const double * in,
+					   double * out) const
+{
+  for (int i=0;i<numberRows_;i++)
+    out[i] = in[rowOrder_[i]];
+}
+
+void
+CoinPackedMatrixOrdering::unpermuteRowVector(const double * in,
+					     double * out) const
+{
+  for (int i=0;i<numberRows_;i++)
+    out[rowOrder_[i]] = in[i];
+}
+
+void
+CoinPackedMatrixOrdering::permuteColumnVector(const double * in,
+					      double * out) const
+{
+  for (int i=0;i<numberColumns_;i++)
+    out[i] = in[columnOrder_[i]];
+}
+
+void
+CoinPackedMatrixOrdering::unpermuteColumnVector(const double * in,
+						double * out) const
+{
+  for (int i=0;i<numberColumns_;i++)
+    out[columnOrder_[i]] = in[i];
+}
+
+//#############################################################################
+
+int
+CoinPackedMatrixOrdering::bandwidth(const CoinPackedMatrix & matrix,
+				    double * average)
+{
+  const int majorDim = matrix.getMajorDim();
+  const int * length = matrix.getVectorLengths();
+  const int * index = matrix.getIndices();
+  int maximum = 0;
+  double sum = 0.0;
+  int numberNonEmpty = 0;
+  for (int i=0;i<majorDim;i++) {
+    const int n = length[i];
+    if (!n)
+      continue;
+    const CoinInt64 start = coinFirst(matrix,i);
+    int low = index[start];
+    int high = low;
+    for (int j=1;j<n;j++) {
+      low = CoinMin(low,index[start+j]);
+      high = CoinMax(high,index[start+j]);
+    }
+    maximum = CoinMax(maximum,high-low);
+    sum += high-low;
+    numberNonEmpty++;
+  }
+  if (average)
+    *average = numberNonEmpty ? sum/numberNonEmpty : 0.0;
+  return maximum;
+}
@@ -0,0 +1,121 @@
+/* $Id$ */
+// Copyright (C) 2012, International Business Machines
+// Corporation and others.  All Rights Reserved.
+// This code is licensed under the terms of the Eclipse Public License (EPL).
+
+#ifndef CoinPackedMatrixOrdering_H
+#define CoinPackedMatrixOrdering_H
+
+#include "CoinUtilsConfig.h"
+#include "CoinTypes.hpp"
+
+class CoinPackedMatrix;
+
+/** Row and column permutation of a CoinPackedMatrix for cache locality.
+
+    Multiplying gathers x[index[j]] (or scatters into y) so when the
+    indices in a vector are spread over the whole of x most loads miss
+    the cache.  An ordering renumbers rows and columns so each vector
+    touches a narrow band instead.
+
+    Two methods are available.  reverseCuthillMcKee treats the matrix as
+    a bipartite graph of rows and columns and numbers both in reverse
+    Cuthill-McKee order (breadth first from a pseudo-peripheral node,
+    neighbours by increasing degree), which reduces the bandwidth of
+    rectangular matrices without forming A*A'.  columnClustering leaves
+    rows alone and sorts columns by first and then last row, so columns
+    using the same rows are adjacent.  Empty rows and columns go last.
+
+    New row i is row rowOrder()[i] of the original matrix and original
+    row i is new row rowPosition()[i] (similarly for columns).  A solver
+    can permute its matrix and vectors, work in the new numbering and
+    map results back with the unpermute methods.
+*/
+class CoinPackedMatrixOrdering {
+public:
+  /// How to compute an ordering
+  enum Method {
+    reverseCuthillMcKee = 0,
+    columnClustering
+  };
+
+  /**@name Constructors and destructor */
+  //@{
+  /// Empty ordering
+  CoinPackedMatrixOrdering();
+  /// Ordering of matrix (row or column ordered, may have gaps)
+  CoinPackedMatrixOrdering(const CoinPackedMatrix & matrix,
+			   Method method = reverseCuthillMcKee);
+  CoinPackedMatrixOrdering(const CoinPackedMatrixOrdering & rhs);
+  CoinPackedMatrixOrdering & operator=(const CoinPackedMatrixOrdering & rhs);
+  ~CoinPackedMatrixOrdering();
+  //@}
+
+  /**@name Queries */
+  //@{
+  inline int getNumRows() const
+  { return numberRows_; }
+  inline int getNumCols() const
+  { return numberColumns_; }
+  inline Method method() const
+  { return method_; }
+  /// Original row for each new row
+  inline const int * rowOrder() const
+  { return rowOrder_; }
+  /// New row for each original row
+  inline const int * rowPosition() const
+  { return rowPosition_; }
+  /// Original column for each new column
+  inline const int * columnOrder() const
+  { return columnOrder_; }
+  /// New column for each original column
+  inline const int * columnPosition() const
+  { return columnPosition_; }
+  //@}
+
+  /**@name Applying */
+  //@{
+  /** Renumbers rows and columns of matrix (which must have the same
+      dimensions).  Gaps are removed and indices within each vector end
+      up in increasing order. */
+  void permute(CoinPackedMatrix & matrix) const;
+  /// Undoes permute()
+  void unpermute(CoinPackedMatrix & matrix) const;
+  /// Row vector to new numbering - out[i] = in[rowOrder()[i]]
+  void permuteRowVector(const double * in, double * out) const;
+  /// Row vector back to original numbering
+  void unpermuteRowVector(const double * in, double * out) const;
+  /// Column vector to new numbering - out[i] = in[columnOrder()[i]]
+  void permuteColumnVector(const double * in, double * out) const;
+  /// Column vector back to original numbering
+  void unpermuteColumnVector(const double * in, double * out) const;
+  //@}
+
+  /** Largest span (last minus first index) of a major vector of matrix.
+      If average is not NULL it is set to the average span of non empty
+      vectors. */
+  static int bandwidth(const CoinPackedMatrix & matrix,
+		       double * average = NULL);
+
+private:
+  /// Bipartite reverse Cuthill-McKee
+  void orderCuthillMcKee(const CoinPackedMatrix & matrix);
+  /// Columns by first and last row
+  void orderClusters(const CoinPackedMatrix & matrix);
+  /// Sets positions from orders
+  void makePositions();
+  /// New major k is old majorOrder[k] and minor j becomes minorPosition[j]
+  static void permuteGuts(CoinPackedMatrix & matrix, const int * majorOrder,
+			  const int * minorPosition);
+  void gutsOfCopy(const CoinPackedMatrixOrdering & rhs);
+
+  int numberRows_;
+  int numberColumns_;
+  Method method_;
+  int * rowOrder_;
+  int * rowPosition_;
+  int * columnOrder_;
+  int * columnPosition_;
+};
+
+#endif
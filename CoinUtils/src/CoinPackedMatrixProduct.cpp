@@ -0,0 +1,431 @@
+/* $Id$ */
+// Copyright (C) 2012, International Business Machines
+// Corporation and others.  All Rights Reserved.
+// This code is licensed under the terms of the Eclipse Public License (EPL).
+
+#include <algorithm>
+#include <cstring>
+
+#include "CoinPackedMatrixProduct.hpp"
+#include "CoinPackedMatrix.hpp"
+#include "CoinHelperFunctions.hpp"
+#include "CoinError.hpp"
+#include "CoinFinite.hpp"
+#include "CoinThreadPool.hpp"
+
+// Fewest input elements worth using threads for
+#define COIN_PRODUCT_PARALLEL 100000
+
+// Pool to use for inputs with size elements (NULL if serial)
+static inline CoinThreadPool *
+coinProductPool(CoinBigIndex size)
+{
+  return CoinThreadPool::defaultPoolFor(size,COIN_PRODUCT_PARALLEL);
+}
+
+/* Key of positions of elements of matrix (as elements are found by
+   position, sorting or moving elements changes it) */
+static void
+coinProductKey(const CoinPackedMatrix & matrix, unsigned int * key)
+{
+  const int majorDim = matrix.getMajorDim();
+  const CoinBigIndex * start = matrix.getVectorStarts();
+  const int * length = matrix.getVectorLengths();
+  const int * index = matrix.getIndices();
+  unsigned int h0 = 2166136261u;
+  unsigned int h1 = matrix.isColOrdered() ? 1u : 2u;
+#define COIN_PRODUCT_MIX(value) \
+  { const unsigned int v = static_cast<unsigned int>(value); \
+    h0 = (h0^v)*16777619u; h1 = (h1+v)*2654435761u; h1 ^= h1>>15; }
+  for (int i=0;i<majorDim;i++) {
+    COIN_PRODUCT_MIX(start[i]);
+    COIN_PRODUCT_MIX(length[i]);
+    for (CoinBigIndex j=start[i];j<start[i]+length[i];j++)
+      COIN_PRODUCT_MIX(index[j]);
+  }
+#undef COIN_PRODUCT_MIX
+  key[0] = h0;
+  key[1] = h1;
+}
+
+/* Columns (byColumn) or rows of matrix as index lists with the position
+   of each element in matrix, whichever way matrix is ordered */
+static void
+coinProductAccess(const CoinPackedMatrix & matrix, bool byColumn,
+		  CoinBigIndex *& start, int *& index,
+		  CoinBigIndex *& position)
+{
+  const int majorDim = matrix.getMajorDim();
+  const int minorDim = matrix.getMinorDim();
+  const CoinBigIndex * matrixStart = matrix.getVectorStarts();
+  const int * length = matrix.getVectorLengths();
+  const int * matrixIndex = matrix.getIndices();
+  const CoinBigIndex numberElements = matrix.getNumElements();
+  index = new int [numberElements];
+  position = new CoinBigIndex [numberElements];
+  if (byColumn==matrix.isColOrdered()) {
+    start = new CoinBigIndex [majorDim+1];
+    CoinBigIndex n = 0;
+    for (int i=0;i<majorDim;i++) {
+      start[i] = n;
+      for (CoinBigIndex j=matrixStart[i];j<matrixStart[i]+length[i];j++) {
+	index[n] = matrixIndex[j];
+	position[n++] = j;
+      }
+    }
+    start[majorDim] = n;
+  } else {
+    // counting sort
+    start = new CoinBigIndex [minorDim+1];
+    CoinZeroN(start,minorDim+1);
+    for (int i=0;i<majorDim;i++) {
+      for (CoinBigIndex j=matrixStart[i];j<matrixStart[i]+length[i];j++)
+	start[matrixIndex[j]+1]++;
+    }
+    for (int k=0;k<minorDim;k++)
+      start[k+1] += start[k];
+    for (int i=0;i<majorDim;i++) {
+      for (CoinBigIndex j=matrixStart[i];j<matrixStart[i]+length[i];j++) {
+	const CoinBigIndex put = start[matrixIndex[j]]++;
+	index[put] = i;
+	position[put] = j;
+      }
+    }
+    for (int k=minorDim;k>0;k--)
+      start[k] = start[k-1];
+    start[0] = 0;
+  }
+}
+
+//#############################################################################
+/* Does a share of the columns of the result.  Column j of the result is
+   the sum over its terms of coefficient times a column of a (just rows
+   >= j for the lower triangle). */
+
+class CoinProductTask : public CoinThreadTask {
+public:
+  /// 0 count, 1 indices, 2 values
+  int pass_;
+  bool lower_;
+  int numberRows_;
+  int numberColumns_;
+  int numberPieces_;
+  const CoinBigIndex * columnStart_;
+  const int * columnRow_;
+  const CoinBigIndex * columnPosition_;
+  const CoinBigIndex * termStart_;
+  const int * termColumn_;
+  const CoinBigIndex * termPosition_;
+  /// Elements of a
+  const double * aElement_;
+  /// Where term coefficients are (a or b)
+  const double * coefficient_;
+  /// Column weights (normal matrix, may be NULL)
+  const double * d_;
+  CoinBigIndex * start_;
+  int * index_;
+  double * element_;
+  double * work_;
+  virtual void run(int which)
+  {
+    const int first = static_cast<int>
+      ((static_cast<CoinInt64>(numberColumns_)*which)/numberPieces_);
+    const int last = static_cast<int>
+      ((static_cast<CoinInt64>(numberColumns_)*(which+1))/numberPieces_);
+    if (pass_==2)
+      numeric(first,last,work_+static_cast<size_t>(which)*numberRows_);
+    else
+      symbolic(first,last);
+  }
+private:
+  void symbolic(int first, int last)
+  {
+    int * mark = new int [numberRows_];
+    CoinFillN(mark,numberRows_,-1);
+    for (int j=first;j<last;j++) {
+      const int low = lower_ ? j : 0;
+      int number = 0;
+      CoinBigIndex put = pass_ ? start_[j] : 0;
+      for (CoinBigIndex t=termStart_[j];t<termStart_[j+1];t++) {
+	const int k = termColumn_[t];
+	for (CoinBigIndex p=columnStart_[k];p<columnStart_[k+1];p++) {
+	  const int i = columnRow_[p];
+	  if (i>=low&&mark[i]!=j) {
+	    mark[i] = j;
+	    number++;
+	    if (pass_)
+	      index_[put++] = i;
+	  }
+	}
+      }
+      if (pass_)
+	std::sort(index_+start_[j],index_+put);
+      else
+	start_[j+1] = number;
+    }
+    delete [] mark;
+  }
+  void numeric(int first, int last, double * work)
+  {
+    for (int j=first;j<last;j++) {
+      const int low = lower_ ? j : 0;
+      for (CoinBigIndex t=termStart_[j];t<termStart_[j+1];t++) {
+	const int k = termColumn_[t];
+	double value = coefficient_[termPosition_[t]];
+	if (d_)
+	  value *= d_[k];
+	if (!value)
+	  continue;
+	for (CoinBigIndex p=columnStart_[k];p<columnStart_[k+1];p++) {
+	  const int i = columnRow_[p];
+	  if (i>=low)
+	    work[i] += value*aElement_[columnPosition_[p]];
+	}
+      }
+      for (CoinBigIndex p=start_[j];p<start_[j+1];p++) {
+	const int i = index_[p];
+	element_[p] = work[i];
+	work[i] = 0.0;
+      }
+    }
+  }
+};
+
+//#############################################################################
+
+CoinPackedMatrixProduct::CoinPackedMatrixProduct()
+  : type_(0),
+    numberRows_(0),
+    numberColumns_(0),
+    aRows_(0),
+    aColumns_(0),
+    aElements_(0),
+    bRows_(0),
+    bColumns_(0),
+    bElements_(0),
+    columnStart_(NULL),
+    columnRow_(NULL),
+    columnPosition_(NULL),
+    termStart_(NULL),
+    termColumn_(NULL),
+    termPosition_(NULL),
+    start_(NULL),
+    index_(NULL),
+    size_(0),
+    numberPieces_(0),
+    work_(NULL)
+{
+}
+
+CoinPackedMatrixProduct::~CoinPackedMatrixProduct()
+{
+  clear();
+}
+
+void
+CoinPackedMatrixProduct::clear()
+{
+  delete [] columnStart_;
+  delete [] columnRow_;
+  delete [] columnPosition_;
+  delete [] termStart_;
+  delete [] termColumn_;
+  delete [] termPosition_;
+  delete [] start_;
+  delete [] index_;
+  delete [] work_;
+  columnStart_ = NULL;
+  columnRow_ = NULL;
+  columnPosition_ = NULL;
+  termStart_ = NULL;
+  termColumn_ = NULL;
+  termPosition_ = NULL;
+  start_ = NULL;
+  index_ = NULL;
+  work_ = NULL;
+  type_ = 0;
+  numberRows_ = 0;
+  numberColumns_ = 0;
+  size_ = 0;
+  numberPieces_ = 0;
+}
+
+//#############################################################################
+
+void
+CoinPackedMatrixProduct::normalMatrix(const CoinPackedMatrix & a,
+				      const double * d,
+				      CoinPackedMatrix & result)
+{
+  if (a.hasWideStarts())
+    throw CoinError("not available with wide starts", "normalMatrix",
+		    "CoinPackedMatrixProduct");
+  if (!samePattern(1,a,NULL))
+    symbolic(1,a,NULL);
+  numeric(a,d,NULL,result);
+}
+
+void
+CoinPackedMatrixProduct::product(const CoinPackedMatrix & a,
+				 const CoinPackedMatrix & b,
+				 CoinPackedMatrix & result)
+{
+  if (a.getNumCols()!=b.getNumRows())
+    throw CoinError("dimensions do not match", "product",
+		    "CoinPackedMatrixProduct");
+  if (a.hasWideStarts()||b.hasWideStarts())
+    throw CoinError("not available with wide starts", "product",
+		    "CoinPackedMatrixProduct");
+  if (!samePattern(2,a,&b))
+    symbolic(2,a,&b);
+  numeric(a,NULL,&b,result);
+}
+
+//-----------------------------------------------------------------------------
+
+bool
+CoinPackedMatrixProduct::samePattern(int type, const CoinPackedMatrix & a,
+				     const CoinPackedMatrix * b) const
+{
+  if (type!=type_||a.getNumRows()!=aRows_||a.getNumCols()!=aColumns_||
+      a.getNumElements()!=aElements_)
+    return false;
+  if (b&&(b->getNumRows()!=bRows_||b->getNumCols()!=bColumns_||
+	  b->getNumElements()!=bElements_))
+    return false;
+  unsigned int key[2];
+  coinProductKey(a,key);
+  if (key[0]!=aKey_[0]||key[1]!=aKey_[1])
+    return false;
+  if (b) {
+    coinProductKey(*b,key);
+    if (key[0]!=bKey_[0]||key[1]!=bKey_[1])
+      return false;
+  }
+  return true;
+}
+
+void
+CoinPackedMatrixProduct::symbolic(int type, const CoinPackedMatrix & a,
+				  const CoinPackedMatrix * b)
+{
+  clear();
+  type_ = type;
+  aRows_ = a.getNumRows();
+  aColumns_ = a.getNumCols();
+  aElements_ = a.getNumElements();
+  bRows_ = b ? b->getNumRows() : 0;
+  bColumns_ = b ? b->getNumCols() : 0;
+  bElements_ = b ? b->getNumElements() : 0;
+  coinProductKey(a,aKey_);
+  bKey_[0] = bKey_[1] = 0;
+  if (b)
+    coinProductKey(*b,bKey_);
+  numberRows_ = aRows_;
+  numberColumns_ = b ? bColumns_ : aRows_;
+  coinProductAccess(a,true,columnStart_,columnRow_,columnPosition_);
+  // terms of column j are row j of a (normal) or column j of b
+  if (b)
+    coinProductAccess(*b,true,termStart_,termColumn_,termPosition_);
+  else
+    coinProductAccess(a,false,termStart_,termColumn_,termPosition_);
+  CoinThreadPool * pool = coinProductPool(aElements_+bElements_);
+  numberPieces_ = pool ? CoinMax(1,CoinMin(4*pool->numberThreads(),
+					   numberColumns_)) : 1;
+  start_ = new CoinBigIndex [numberColumns_+1];
+  start_[0] = 0;
+  CoinProductTask task;
+  task.pass_ = 0;
+  task.lower_ = (type==1);
+  task.numberRows_ = numberRows_;
+  task.numberColumns_ = numberColumns_;
+  task.numberPieces_ = numberPieces_;
+  task.columnStart_ = columnStart_;
+  task.columnRow_ = columnRow_;
+  task.columnPosition_ = columnPosition_;
+  task.termStart_ = termStart_;
+  task.termColumn_ = termColumn_;
+  task.termPosition_ = termPosition_;
+  task.aElement_ = NULL;
+  task.coefficient_ = NULL;
+  task.d_ = NULL;
+  task.start_ = start_;
+  task.index_ = NULL;
+  task.element_ = NULL;
+  task.work_ = NULL;
+  if (pool)
+    pool->run(task,numberPieces_);
+  else
+    task.run(0);
+  CoinInt64 size = 0;
+  for (int j=0;j<numberColumns_;j++) {
+    size += start_[j+1];
+    if (size>COIN_INT_MAX) {
+      clear();
+      throw CoinError("too many elements in result", "symbolic",
+		      "CoinPackedMatrixProduct");
+    }
+    start_[j+1] = static_cast<CoinBigIndex>(size);
+  }
+  size_ = start_[numberColumns_];
+  index_ = new int [size_];
+  task.pass_ = 1;
+  task.index_ = index_;
+  if (pool)
+    pool->run(task,numberPieces_);
+  else
+    task.run(0);
+  work_ = new double [static_cast<size_t>(numberPieces_)*numberRows_];
+  CoinZeroN(work_,numberPieces_*numberRows_);
+}
+
+void
+CoinPackedMatrixProduct::numeric(const CoinPackedMatrix & a, const double * d,
+				 const CoinPackedMatrix * b,
+				 CoinPackedMatrix & result)
+{
+  // overwrite result if it has the pattern (e.g. made last time)
+  const bool reuse = result.isColOrdered()&&!result.hasWideStarts()&&
+    result.getNumRows()==numberRows_&&result.getNumCols()==numberColumns_&&
+    result.getNumElements()==size_&&!result.hasGaps()&&
+    !memcmp(result.getVectorStarts(),start_,
+	    (numberColumns_+1)*sizeof(CoinBigIndex))&&
+    !memcmp(result.getIndices(),index_,size_*sizeof(int));
+  double * element = reuse ? result.getMutableElements() :
+    new double [size_];
+  CoinProductTask task;
+  task.pass_ = 2;
+  task.lower_ = (type_==1);
+  task.numberRows_ = numberRows_;
+  task.numberColumns_ = numberColumns_;
+  task.numberPieces_ = numberPieces_;
+  task.columnStart_ = columnStart_;
+  task.columnRow_ = columnRow_;
+  task.columnPosition_ = columnPosition_;
+  task.termStart_ = termStart_;
+  task.termColumn_ = termColumn_;
+  task.termPosition_ = termPosition_;
+  task.aElement_ = a.getElements();
+  task.coefficient_ = b ? b->getElements() : a.getElements();
+  task.d_ = d;
+  task.start_ = start_;
+  task.index_ = index_;
+  task.element_ = element;
+  task.work_ = work_;
+  CoinThreadPool * pool = coinProductPool(aElements_+bElements_);
+  if (pool) {
+    pool->run(task,numberPieces_);
+  } else {
+    for (int i=0;i<numberPieces_;i++)
+      task.run(i);
+  }
+  if (reuse) {
+    result.clearCaches();
+  } else {
+    CoinBigIndex * start = CoinCopyOfArray(start_,numberColumns_+1);
+    int * index = CoinCopyOfArray(index_,size_);
+    int * length = NULL;
+    result.assignMatrix(true,numberRows_,numberColumns_,size_,
+			element,index,start,length);
+  }
+}
@@ -0,0 +1,108 @@
+/* $Id$ */
+// Copyright (C) 2012, International Business Machines
+// Corporation and others.  All Rights Reserved.
+// This code is licensed under the terms of the Eclipse Public License (EPL).
+
+#ifndef CoinPackedMatrixProduct_H
+#define CoinPackedMatrixProduct_H
+
+#include "CoinUtilsConfig.h"
+#include "CoinTypes.hpp"
+
+class CoinPackedMatrix;
+
+/** Sparse products of CoinPackedMatrix objects with a kept pattern.
+
+    Interior point and least squares methods form A*diag(d)*A' for the
+    same A with a new d every iteration.  The first call works out the
+    pattern of the result (symbolic pass) and keeps it with maps from
+    the result to the elements of A, so later calls just do arithmetic
+    (numeric pass).  If the result matrix passed in is the one made last
+    time its element array is overwritten in place, so no memory is
+    allocated.  A*B is done the same way.
+
+    The pattern is worked out again if the positions of elements of the
+    inputs change (a key of starts and indices is checked each call).
+    The result is overwritten in place if it already has the pattern.
+    Numeric passes (and the symbolic pass) run on
+    CoinThreadPool::defaultPool() if one is set and the inputs are
+    large.  Inputs may be row or column ordered but not have wide starts.
+*/
+class CoinPackedMatrixProduct {
+public:
+  /**@name Constructors and destructor */
+  //@{
+  CoinPackedMatrixProduct();
+  ~CoinPackedMatrixProduct();
+  //@}
+
+  /**@name Products */
+  //@{
+  /** Lower triangle (with diagonal) of A*diag(d)*A' as a column ordered
+      matrix with the rows in each column increasing.  d NULL means all
+      ones. */
+  void normalMatrix(const CoinPackedMatrix & a, const double * d,
+		    CoinPackedMatrix & result);
+  /** A*B as a column ordered matrix with the rows in each column
+      increasing.  Throws CoinError if dimensions do not match. */
+  void product(const CoinPackedMatrix & a, const CoinPackedMatrix & b,
+	       CoinPackedMatrix & result);
+  /// Forget pattern (next call works it out again)
+  void clear();
+  /// True if a pattern is kept
+  inline bool hasPattern() const
+  { return type_!=0; }
+  /// Number of elements in pattern of result
+  inline CoinBigIndex getNumElements() const
+  { return size_; }
+  //@}
+
+private:
+  /// Not copyable
+  CoinPackedMatrixProduct(const CoinPackedMatrixProduct &);
+  CoinPackedMatrixProduct & operator=(const CoinPackedMatrixProduct &);
+  /// True if pattern was made for these inputs
+  bool samePattern(int type, const CoinPackedMatrix & a,
+		   const CoinPackedMatrix * b) const;
+  /// Works out pattern
+  void symbolic(int type, const CoinPackedMatrix & a,
+		const CoinPackedMatrix * b);
+  /// Does arithmetic and puts values in result
+  void numeric(const CoinPackedMatrix & a, const double * d,
+	       const CoinPackedMatrix * b, CoinPackedMatrix & result);
+
+  /// 0 none, 1 normal matrix, 2 product
+  int type_;
+  /// Rows and columns of result
+  int numberRows_;
+  int numberColumns_;
+  /// Dimensions and size of inputs when pattern made
+  int aRows_;
+  int aColumns_;
+  CoinBigIndex aElements_;
+  int bRows_;
+  int bColumns_;
+  CoinBigIndex bElements_;
+  /// Keys of positions of elements of inputs when pattern made
+  unsigned int aKey_[2];
+  unsigned int bKey_[2];
+  /// Columns of a (row and position of element in a)
+  CoinBigIndex * columnStart_;
+  int * columnRow_;
+  CoinBigIndex * columnPosition_;
+  /** Terms making each column of result - column of a and position of
+      coefficient (in a for normal matrix, in b for product) */
+  CoinBigIndex * termStart_;
+  int * termColumn_;
+  CoinBigIndex * termPosition_;
+  /// Pattern of result
+  CoinBigIndex * start_;
+  int * index_;
+  CoinBigIndex size_;
+  /// Columns of result done by each piece of work
+  int numberPieces_;
+  /// Dense work array (numberRows_ for each piece)
+  double * work_;
+};
+
+#endif
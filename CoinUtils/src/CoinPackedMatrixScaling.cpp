@@ -0,0 +1,447 @@
+/* $Id$ */
+// Copyright (C) 2012, International Business Machines
+// Corporation and others.  All Rights Reserved.
+// This code is licensed under the terms of the Eclipse Public License (EPL).
+
+#include <cmath>
+
+#include "CoinPackedMatrixScaling.hpp"
+#include "CoinPackedMatrix.hpp"
+#include "CoinHelperFunctions.hpp"
+#include "CoinError.hpp"
+#include "CoinFinite.hpp"
+#include "CoinThreadPool.hpp"
+
+// Fewest elements worth using threads for
+#define COIN_SCALING_PARALLEL 100000
+
+//#############################################################################
+// One pass along a range of major vectors of a matrix
+
+class CoinScalingTask : public CoinThreadRangeTask {
+public:
+  /** 0 - out_ largest and out2_ smallest of |a|*scale_[minor]
+      1 - out_ sum of log|a| and out2_ number of nonzeros
+      2 - out_ sum of x_[minor] over nonzeros
+      3 - out_ majorScale_[major] * sum of a*scale_[minor]*x_[minor]
+      4 - element_ scaled by majorScale_[major]*scale_[minor] */
+  int mode_;
+  const CoinPackedMatrix * matrix_;
+  const double * scale_;
+  const double * majorScale_;
+  const double * x_;
+  double * out_;
+  double * out2_;
+  double * element_;
+  virtual void run(int begin, int end)
+  {
+    const CoinBigIndex * start = matrix_->getVectorStarts();
+    const int * length = matrix_->getVectorLengths();
+    const int * index = matrix_->getIndices();
+    const double * element = matrix_->getElements();
+    for (int i = begin; i < end; ++i) {
+      const CoinBigIndex first = start[i];
+      const CoinBigIndex last = first+length[i];
+      switch (mode_) {
+      case 0:
+	{
+	  double largest = 0.0;
+	  double smallest = COIN_DBL_MAX;
+	  for (CoinBigIndex j=first;j<last;j++) {
+	    const double value = fabs(element[j])*scale_[index[j]];
+	    if (value) {
+	      largest = CoinMax(largest,value);
+	      smallest = CoinMin(smallest,value);
+	    }
+	  }
+	  out_[i] = largest;
+	  out2_[i] = smallest;
+	}
+	break;
+      case 1:
+	{
+	  double sum = 0.0;
+	  int number = 0;
+	  for (CoinBigIndex j=first;j<last;j++) {
+	    const double value = fabs(element[j]);
+	    if (value) {
+	      sum += log(value);
+	      number++;
+	    }
+	  }
+	  out_[i] = sum;
+	  out2_[i] = number;
+	}
+	break;
+      case 2:
+	{
+	  double sum = 0.0;
+	  for (CoinBigIndex j=first;j<last;j++) {
+	    if (element[j])
+	      sum += x_[index[j]];
+	  }
+	  out_[i] = sum;
+	}
+	break;
+      case 3:
+	{
+	  double sum = 0.0;
+	  for (CoinBigIndex j=first;j<last;j++) {
+	    const int k = index[j];
+	    sum += element[j]*scale_[k]*x_[k];
+	  }
+	  out_[i] = majorScale_[i]*sum;
+	}
+	break;
+      case 4:
+	{
+	  const double scale = majorScale_[i];
+	  for (CoinBigIndex j=first;j<last;j++)
+	    element_[j] *= scale*scale_[index[j]];
+	}
+	break;
+      }
+    }
+  }
+};
+
+// Runs task over major vectors of its matrix (in parallel if worth it)
+static void
+coinScalingRun(CoinScalingTask & task)
+{
+  const int majorDim = task.matrix_->getMajorDim();
+  CoinThreadPool * pool =
+    CoinThreadPool::defaultPoolFor(task.matrix_->getNumElements(),
+				   COIN_SCALING_PARALLEL);
+  if (pool)
+    pool->parallelFor(task,0,majorDim);
+  else
+    task.run(0,majorDim);
+}
+
+//#############################################################################
+
+CoinPackedMatrixScaling::CoinPackedMatrixScaling()
+  : numberRows_(0),
+    numberColumns_(0),
+    method_(geometricMean),
+    rowScale_(NULL),
+    columnScale_(NULL)
+{
+}
+
+CoinPackedMatrixScaling::CoinPackedMatrixScaling(const CoinPackedMatrix & matrix,
+						 Method method,
+						 int numberPasses)
+  : numberRows_(matrix.getNumRows()),
+    numberColumns_(matrix.getNumCols()),
+    method_(method),
+    rowScale_(NULL),
+    columnScale_(NULL)
+{
+  check(matrix,"CoinPackedMatrixScaling");
+  rowScale_ = new double [numberRows_];
+  columnScale_ = new double [numberColumns_];
+  CoinFillN(rowScale_,numberRows_,1.0);
+  CoinFillN(columnScale_,numberColumns_,1.0);
+  if (!numberPasses) {
+    if (method==geometricMean)
+      numberPasses = 4;
+    else if (method==equilibration)
+      numberPasses = 1;
+    else
+      numberPasses = 20;
+  }
+  if (method==curtisReid)
+    scaleCurtisReid(matrix,numberPasses);
+  else
+    scaleByPasses(matrix,numberPasses);
+}
+
+CoinPackedMatrixScaling::CoinPackedMatrixScaling(const CoinPackedMatrixScaling & rhs)
+{
+  gutsOfCopy(rhs);
+}
+
+CoinPackedMatrixScaling &
+CoinPackedMatrixScaling::operator=(const CoinPackedMatrixScaling & rhs)
+{
+  if (this!=&rhs) {
+    delete [] rowScale_;
+    delete [] columnScale_;
+    gutsOfCopy(rhs);
+  }
+  return *this;
+}
+
+CoinPackedMatrixScaling::~CoinPackedMatrixScaling()
+{
+  delete [] rowScale_;
+  delete [] columnScale_;
+}
+
+void
+CoinPackedMatrixScaling::gutsOfCopy(const CoinPackedMatrixScaling & rhs)
+{
+  numberRows_ = rhs.numberRows_;
+  numberColumns_ = rhs.numberColumns_;
+  method_ = rhs.method_;
+  rowScale_ = CoinCopyOfArray(rhs.rowScale_,numberRows_);
+  columnScale_ = CoinCopyOfArray(rhs.columnScale_,numberColumns_);
+}
+
+void
+CoinPackedMatrixScaling::check(const CoinPackedMatrix & matrix,
+			       const char * method) const
+{
+  if (matrix.hasWideStarts())
+    throw CoinError("not available with wide starts", method,
+		    "CoinPackedMatrixScaling");
+  if (matrix.getNumRows()!=numberRows_||matrix.getNumCols()!=numberColumns_)
+    throw CoinError("dimensions do not match", method,
+		    "CoinPackedMatrixScaling");
+}
+
+//#############################################################################
+
+void
+CoinPackedMatrixScaling::scaleByPasses(const CoinPackedMatrix & matrix,
+				       int numberPasses)
+{
+  const bool geometric = (method_==geometricMean);
+  const CoinPackedMatrix & ortho = matrix.getOrthoCopy();
+  const CoinPackedMatrix & byRow = matrix.isColOrdered() ? ortho : matrix;
+  const CoinPackedMatrix & byColumn = matrix.isColOrdered() ? matrix : ortho;
+  const int size = CoinMax(numberRows_,numberColumns_);
+  double * largest = new double [size];
+  double * smallest = new double [size];
+  CoinScalingTask task;
+  task.mode_ = 0;
+  task.out_ = largest;
+  task.out2_ = smallest;
+  for (int pass=0;pass<numberPasses;pass++) {
+    // rows using current column scales
+    task.matrix_ = &byRow;
+    task.scale_ = columnScale_;
+    coinScalingRun(task);
+    for (int i=0;i<numberRows_;i++) {
+      if (largest[i])
+	rowScale_[i] = geometric ? 1.0/sqrt(largest[i]*smallest[i]) :
+	  1.0/largest[i];
+    }
+    // then columns
+    task.matrix_ = &byColumn;
+    task.scale_ = rowScale_;
+    coinScalingRun(task);
+    for (int i=0;i<numberColumns_;i++) {
+      if (largest[i])
+	columnScale_[i] = geometric ? 1.0/sqrt(largest[i]*smallest[i]) :
+	  1.0/largest[i];
+    }
+  }
+  delete [] largest;
+  delete [] smallest;
+}
+
+/* Minimizes sum over nonzeros of (log|a(i,j)| + rho(i) + gamma(j))^2.
+   Setting the gradient to zero gives
+     count(i)*rho(i) + sum over row i of gamma = -sum over row of log|a|
+     sum over column j of rho + count(j)*gamma(j) = -sum over column of log|a|
+   which is solved by conjugate gradients with the counts as
+   preconditioner.  Scales are exp(rho) and exp(gamma). */
+
+void
+CoinPackedMatrixScaling::scaleCurtisReid(const CoinPackedMatrix & matrix,
+					 int numberPasses)
+{
+  const CoinPackedMatrix & ortho = matrix.getOrthoCopy();
+  const CoinPackedMatrix & byRow = matrix.isColOrdered() ? ortho : matrix;
+  const CoinPackedMatrix & byColumn = matrix.isColOrdered() ? matrix : ortho;
+  const int number = numberRows_+numberColumns_;
+  // rows then columns in each array
+  double * count = new double [number];
+  double * residual = new double [number];
+  double * solution = new double [number];
+  double * direction = new double [number];
+  double * product = new double [number];
+  double * work = new double [number];
+  CoinScalingTask task;
+  task.mode_ = 1;
+  task.matrix_ = &byRow;
+  task.out_ = residual;
+  task.out2_ = count;
+  coinScalingRun(task);
+  task.matrix_ = &byColumn;
+  task.out_ = residual+numberRows_;
+  task.out2_ = count+numberRows_;
+  coinScalingRun(task);
+  double rz = 0.0;
+  for (int i=0;i<number;i++) {
+    residual[i] = -residual[i];
+    solution[i] = 0.0;
+    // empty rows and columns stay at zero
+    if (!count[i])
+      count[i] = 1.0;
+    direction[i] = residual[i]/count[i];
+    rz += residual[i]*direction[i];
+  }
+  const double tolerance = 1.0e-20*rz;
+  task.mode_ = 2;
+  for (int pass=0;pass<numberPasses&&rz>tolerance;pass++) {
+    // product = K * direction
+    task.matrix_ = &byRow;
+    task.x_ = direction+numberRows_;
+    task.out_ = product;
+    coinScalingRun(task);
+    task.matrix_ = &byColumn;
+    task.x_ = direction;
+    task.out_ = product+numberRows_;
+    coinScalingRun(task);
+    double pq = 0.0;
+    for (int i=0;i<number;i++) {
+      product[i] += count[i]*direction[i];
+      pq += direction[i]*product[i];
+    }
+    if (pq<=0.0)
+      break;
+    const double alpha = rz/pq;
+    double rzNew = 0.0;
+    for (int i=0;i<number;i++) {
+      solution[i] += alpha*direction[i];
+      residual[i] -= alpha*product[i];
+      work[i] = residual[i]/count[i];
+      rzNew += residual[i]*work[i];
+    }
+    const double beta = rzNew/rz;
+    for (int i=0;i<number;i++)
+      direction[i] = work[i]+beta*direction[i];
+    rz = rzNew;
+  }
+  for (int i=0;i<numberRows_;i++)
+    rowScale_[i] = exp(solution[i]);
+  for (int i=0;i<numberColumns_;i++)
+    columnScale_[i] = exp(solution[numberRows_+i]);
+  delete [] count;
+  delete [] residual;
+  delete [] solution;
+  delete [] direction;
+  delete [] product;
+  delete [] work;
+}
+
+//#############################################################################
+
+void
+CoinPackedMatrixScaling::apply(CoinPackedMatrix & matrix) const
+{
+  check(matrix,"apply");
+  CoinScalingTask task;
+  task.mode_ = 4;
+  task.matrix_ = &matrix;
+  task.majorScale_ = matrix.isColOrdered() ? columnScale_ : rowScale_;
+  task.scale_ = matrix.isColOrdered() ? rowScale_ : columnScale_;
+  task.element_ = matrix.getMutableElements();
+  coinScalingRun(task);
+  matrix.clearCaches();
+}
+
+void
+CoinPackedMatrixScaling::times(const CoinPackedMatrix & matrix,
+			       const double * x, double * y) const
+{
+  check(matrix,"times");
+  if (matrix.isColOrdered()&&!matrix.hasOrthoCache()) {
+    // scatter down columns
+    CoinZeroN(y,numberRows_);
+    const CoinBigIndex * start = matrix.getVectorStarts();
+    const int * length = matrix.getVectorLengths();
+    const int * index = matrix.getIndices();
+    const double * element = matrix.getElements();
+    for (int j=0;j<numberColumns_;j++) {
+      const double value = columnScale_[j]*x[j];
+      if (value) {
+	for (CoinBigIndex k=start[j];k<start[j]+length[j];k++)
+	  y[index[k]] += element[k]*value;
+      }
+    }
+    for (int i=0;i<numberRows_;i++)
+      y[i] *= rowScale_[i];
+  } else {
+    // gather along rows
+    CoinScalingTask task;
+    task.mode_ = 3;
+    task.matrix_ = matrix.isColOrdered() ? &matrix.getOrthoCopy() : &matrix;
+    task.majorScale_ = rowScale_;
+    task.scale_ = columnScale_;
+    task.x_ = x;
+    task.out_ = y;
+    coinScalingRun(task);
+  }
+}
+
+void
+CoinPackedMatrixScaling::transposeTimes(const CoinPackedMatrix & matrix,
+					const double * x, double * y) const
+{
+  check(matrix,"transposeTimes");
+  if (!matrix.isColOrdered()&&!matrix.hasOrthoCache()) {
+    // scatter along rows
+    CoinZeroN(y,numberColumns_);
+    const CoinBigIndex * start = matrix.getVectorStarts();
+    const int * length = matrix.getVectorLengths();
+    const int * index = matrix.getIndices();
+    const double * element = matrix.getElements();
+    for (int i=0;i<numberRows_;i++) {
+      const double value = rowScale_[i]*x[i];
+      if (value) {
+	for (CoinBigIndex k=start[i];k<start[i]+length[i];k++)
+	  y[index[k]] += element[k]*value;
+      }
+    }
+    for (int j=0;j<numberColumns_;j++)
+      y[j] *= columnScale_[j];
+  } else {
+    // gather down columns
+    CoinScalingTask task;
+    task.mode_ = 3;
+    task.matrix_ = matrix.isColOrdered() ? &matrix : &matrix.getOrthoCopy();
+    task.majorScale_ = columnScale_;
+    task.scale_ = rowScale_;
+    task.x_ = x;
+    task.out_ = y;
+    coinScalingRun(task);
+  }
+}
+
+//-----------------------------------------------------------------------------
+
+double
+CoinPackedMatrixScaling::ratio(const CoinPackedMatrix & matrix,
+			       const double * rowScale,
+			       const double * columnScale)
+{
+  if (matrix.hasWideStarts())
+    throw CoinError("not available with wide starts", "ratio",
+		    "CoinPackedMatrixScaling");
+  const double * majorScale = matrix.isColOrdered() ? columnScale : rowScale;
+  const double * minorScale = matrix.isColOrdered() ? rowScale : columnScale;
+  const CoinBigIndex * start = matrix.getVectorStarts();
+  const int * length = matrix.getVectorLengths();
+  const int * index = matrix.getIndices();
+  const double * element = matrix.getElements();
+  double largest = 0.0;
+  double smallest = COIN_DBL_MAX;
+  for (int i=0;i<matrix.getMajorDim();i++) {
+    const double scale = majorScale ? majorScale[i] : 1.0;
+    for (CoinBigIndex j=start[i];j<start[i]+length[i];j++) {
+      double value = fabs(element[j])*scale;
+      if (minorScale)
+	value *= minorScale[index[j]];
+      if (value) {
+	largest = CoinMax(largest,value);
+	smallest = CoinMin(smallest,value);
+      }
+    }
+  }
+  return largest ? largest/smallest : 1.0;
+}
@@ -0,0 +1,109 @@
+/* $Id$ */
+// Copyright (C) 2012, International Business Machines
+// Corporation and others.  All Rights Reserved.
+// This code is licensed under the terms of the Eclipse Public License (EPL).
+
+#ifndef CoinPackedMatrixScaling_H
+#define CoinPackedMatrixScaling_H
+
+#include "CoinUtilsConfig.h"
+#include "CoinTypes.hpp"
+
+class CoinPackedMatrix;
+
+/** Row and column scale factors for a CoinPackedMatrix.
+
+    The scaled matrix is diag(rowScale())*A*diag(columnScale()).  Three
+    methods are available:
+    - geometricMean - each pass sets every row scale to one over the
+      square root of the largest times the smallest scaled element in
+      the row, then does the same for columns.
+    - equilibration - as geometricMean but scales the largest element in
+      each row and then column to one.
+    - curtisReid - least squares fit of log scale factors so scaled
+      elements are as near one as possible (Curtis and Reid), solved
+      with preconditioned conjugate gradients.
+
+    Passes go along columns and along the matrix's reverse ordered copy
+    (CoinPackedMatrix::getOrthoCopy(), which is built if not kept) so
+    each is a gather.  They run on CoinThreadPool::defaultPool() if one is
+    set and the matrix is large.  Zero elements, empty rows and empty
+    columns are ignored (their scale is one).  Matrices with wide starts
+    are not allowed.
+
+    Scales can be applied to the matrix in place or used on the fly by
+    times() and transposeTimes() without making a scaled copy.
+*/
+class CoinPackedMatrixScaling {
+public:
+  /// How to compute scale factors
+  enum Method {
+    geometricMean = 0,
+    equilibration,
+    curtisReid
+  };
+
+  /**@name Constructors and destructor */
+  //@{
+  /// Empty scaling
+  CoinPackedMatrixScaling();
+  /** Scale factors for matrix.  numberPasses is passes of row and then
+      column scaling (conjugate gradient iterations for curtisReid); 0
+      gives 4, 1 and 20 for the three methods. */
+  CoinPackedMatrixScaling(const CoinPackedMatrix & matrix,
+			  Method method = geometricMean,
+			  int numberPasses = 0);
+  CoinPackedMatrixScaling(const CoinPackedMatrixScaling & rhs);
+  CoinPackedMatrixScaling & operator=(const CoinPackedMatrixScaling & rhs);
+  ~CoinPackedMatrixScaling();
+  //@}
+
+  /**@name Queries */
+  //@{
+  inline int getNumRows() const
+  { return numberRows_; }
+  inline int getNumCols() const
+  { return numberColumns_; }
+  inline Method method() const
+  { return method_; }
+  inline const double * rowScale() const
+  { return rowScale_; }
+  inline const double * columnScale() const
+  { return columnScale_; }
+  //@}
+
+  /**@name Using scale factors */
+  //@{
+  /// Scales elements of matrix (which must have the same dimensions)
+  void apply(CoinPackedMatrix & matrix) const;
+  /// y = R * A * C * x for unscaled matrix A
+  void times(const CoinPackedMatrix & matrix, const double * x,
+	     double * y) const;
+  /// y = x * R * A * C for unscaled matrix A
+  void transposeTimes(const CoinPackedMatrix & matrix, const double * x,
+		      double * y) const;
+  /** Largest over smallest absolute nonzero element of
+      diag(rowScale)*A*diag(columnScale) (NULL scales are all one).
+      1.0 if there are no nonzero elements. */
+  static double ratio(const CoinPackedMatrix & matrix,
+		      const double * rowScale = NULL,
+		      const double * columnScale = NULL);
+  //@}
+
+private:
+  /// Alternating row and column passes (geometric mean or equilibration)
+  void scaleByPasses(const CoinPackedMatrix & matrix, int numberPasses);
+  /// Curtis-Reid by conjugate gradients
+  void scaleCurtisReid(const CoinPackedMatrix & matrix, int numberPasses);
+  /// Throws CoinError if matrix does not fit
+  void check(const CoinPackedMatrix & matrix, const char * method) const;
+  void gutsOfCopy(const CoinPackedMatrixScaling & rhs);
+
+  int numberRows_;
+  int numberColumns_;
+  Method method_;
+  double * rowScale_;
+  double * columnScale_;
+};
+
+#endif
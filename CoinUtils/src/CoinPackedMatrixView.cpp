@@ -0,0 +1,211 @@
+/* $Id$ */
+// Copyright (C) 2012, International Business Machines
+// Corporation and others.  All Rights Reserved.
+// This code is licensed under the terms of the Eclipse Public License (EPL).
+
+#include "CoinPackedMatrixView.hpp"
+#include "CoinPackedMatrix.hpp"
+#include "CoinHelperFunctions.hpp"
+#include "CoinError.hpp"
+#include "CoinFinite.hpp"
+
+//#############################################################################
+
+CoinPackedMatrixView::CoinPackedMatrixView()
+  : matrix_(NULL),
+    numberMajor_(0),
+    which_(NULL),
+    numberElements_(0)
+{
+}
+
+CoinPackedMatrixView::CoinPackedMatrixView(const CoinPackedMatrix & matrix,
+					   int numberMajor,
+					   const int * which)
+  : matrix_(&matrix),
+    numberMajor_(numberMajor),
+    which_(NULL),
+    numberElements_(0)
+{
+  const int majorDim = matrix.getMajorDim();
+  const int * length = matrix.getVectorLengths();
+  CoinInt64 numberElements = 0;
+  for (int i=0;i<numberMajor;i++) {
+    if (which[i]<0||which[i]>=majorDim)
+      throw CoinError("bad index", "CoinPackedMatrixView",
+		      "CoinPackedMatrixView");
+    numberElements += length[which[i]];
+  }
+  // selection of a matrix with wide starts may still be too big
+  if (numberElements>COIN_INT_MAX)
+    throw CoinError("too many elements", "CoinPackedMatrixView",
+		    "CoinPackedMatrixView");
+  numberElements_ = static_cast<CoinBigIndex>(numberElements);
+  which_ = CoinCopyOfArray(which,numberMajor);
+}
+
+CoinPackedMatrixView::CoinPackedMatrixView(const CoinPackedMatrixView & rhs)
+  : matrix_(rhs.matrix_),
+    numberMajor_(rhs.numberMajor_),
+    numberElements_(rhs.numberElements_)
+{
+  which_ = CoinCopyOfArray(rhs.which_,numberMajor_);
+}
+
+CoinPackedMatrixView &
+CoinPackedMatrixView::operator=(const CoinPackedMatrixView & rhs)
+{
+  if (this!=&rhs) {
+    delete [] which_;
+    matrix_ = rhs.matrix_;
+    numberMajor_ = rhs.numberMajor_;
+    numberElements_ = rhs.numberElements_;
+    which_ = CoinCopyOfArray(rhs.which_,numberMajor_);
+  }
+  return *this;
+}
+
+CoinPackedMatrixView::~CoinPackedMatrixView()
+{
+  delete [] which_;
+}
+
+//#############################################################################
+
+bool
+CoinPackedMatrixView::isColOrdered() const
+{
+  return matrix_ ? matrix_->isColOrdered() : true;
+}
+
+int
+CoinPackedMatrixView::getNumRows() const
+{
+  return isColOrdered() ? getMinorDim() : numberMajor_;
+}
+
+int
+CoinPackedMatrixView::getNumCols() const
+{
+  return isColOrdered() ? numberMajor_ : getMinorDim();
+}
+
+int
+CoinPackedMatrixView::getMinorDim() const
+{
+  return matrix_ ? matrix_->getMinorDim() : 0;
+}
+
+CoinInt64
+CoinPackedMatrixView::first(int i) const
+{
+  const CoinInt64 * wideStart = matrix_->getWideVectorStarts();
+  return wideStart ? wideStart[which_[i]] :
+    matrix_->getVectorStarts()[which_[i]];
+}
+
+int
+CoinPackedMatrixView::getVectorSize(int i) const
+{
+  if (i<0||i>=numberMajor_)
+    throw CoinError("bad index", "getVectorSize", "CoinPackedMatrixView");
+  return matrix_->getVectorLengths()[which_[i]];
+}
+
+const CoinShallowPackedVector
+CoinPackedMatrixView::getVector(int i) const
+{
+  if (i<0||i>=numberMajor_)
+    throw CoinError("bad index", "getVector", "CoinPackedMatrixView");
+  const CoinInt64 start = first(i);
+  return CoinShallowPackedVector(matrix_->getVectorLengths()[which_[i]],
+				 matrix_->getIndices()+start,
+				 matrix_->getElements()+start,
+				 false);
+}
+
+void
+CoinPackedMatrixView::getPackedMatrix(CoinPackedMatrix & matrix) const
+{
+  if (!matrix_) {
+    matrix = CoinPackedMatrix();
+    return;
+  }
+  const int * length = matrix_->getVectorLengths();
+  const int * index = matrix_->getIndices();
+  const double * element = matrix_->getElements();
+  CoinBigIndex * start = new CoinBigIndex [numberMajor_+1];
+  int * newIndex = new int [numberElements_];
+  double * newElement = new double [numberElements_];
+  start[0] = 0;
+  for (int i=0;i<numberMajor_;i++) {
+    const CoinInt64 j = first(i);
+    const int n = length[which_[i]];
+    CoinMemcpyN(index+j,n,newIndex+start[i]);
+    CoinMemcpyN(element+j,n,newElement+start[i]);
+    start[i+1] = start[i]+n;
+  }
+  matrix.copyOf(isColOrdered(),getMinorDim(),numberMajor_,numberElements_,
+		newElement,newIndex,start,NULL);
+  delete [] start;
+  delete [] newIndex;
+  delete [] newElement;
+}
+
+//#############################################################################
+
+void
+CoinPackedMatrixView::times(const double * x, double * y) const
+{
+  if (isColOrdered())
+    timesMajor(x,y);
+  else
+    timesMinor(x,y);
+}
+
+void
+CoinPackedMatrixView::transposeTimes(const double * x, double * y) const
+{
+  if (isColOrdered())
+    timesMinor(x,y);
+  else
+    timesMajor(x,y);
+}
+
+void
+CoinPackedMatrixView::timesMajor(const double * x, double * y) const
+{
+  CoinZeroN(y,getMinorDim());
+  if (!numberMajor_)
+    return;
+  const int * length = matrix_->getVectorLengths();
+  const int * COIN_RESTRICT index = matrix_->getIndices();
+  const double * COIN_RESTRICT element = matrix_->getElements();
+  for (int i=0;i<numberMajor_;i++) {
+    const double value = x[i];
+    if (value) {
+      const CoinInt64 start = first(i);
+      const CoinInt64 end = start+length[which_[i]];
+      for (CoinInt64 j=start;j<end;j++)
+	y[index[j]] += value*element[j];
+    }
+  }
+}
+
+void
+CoinPackedMatrixView::timesMinor(const double * x, double * y) const
+{
+  if (!numberMajor_)
+    return;
+  const int * length = matrix_->getVectorLengths();
+  const int * COIN_RESTRICT index = matrix_->getIndices();
+  const double * COIN_RESTRICT element = matrix_->getElements();
+  for (int i=0;i<numberMajor_;i++) {
+    const CoinInt64 start = first(i);
+    const CoinInt64 end = start+length[which_[i]];
+    double value = 0.0;
+    for (CoinInt64 j=start;j<end;j++)
+      value += x[index[j]]*element[j];
+    y[i] = value;
+  }
+}
@@ -0,0 +1,92 @@
+/* $Id$ */
+// Copyright (C) 2012, International Business Machines
+// Corporation and others.  All Rights Reserved.
+// This code is licensed under the terms of the Eclipse Public License (EPL).
+
+#ifndef CoinPackedMatrixView_H
+#define CoinPackedMatrixView_H
+
+#include "CoinUtilsConfig.h"
+#include "CoinTypes.hpp"
+#include "CoinShallowPackedVector.hpp"
+
+class CoinPackedMatrix;
+
+/** Submatrix of a CoinPackedMatrix which does not copy elements.
+
+    A view selects some major vectors of a matrix (in any order and
+    possibly more than once, as submatrixOfWithDuplicates()) and keeps
+    only their indices.  Major vector i of the view is major vector
+    getIndexMap()[i] of the matrix and the minor dimension is that of the
+    matrix.  Making a view costs O(number selected) rather than O(number
+    of elements) so it suits taking many column subsets just to multiply
+    with them.
+
+    The matrix must outlive the view and must not be changed while the
+    view is used.  Matrices with wide starts (see
+    CoinPackedMatrix::hasWideStarts()) may be viewed.
+*/
+class CoinPackedMatrixView {
+public:
+  /**@name Constructors and destructor */
+  //@{
+  /// Empty view
+  CoinPackedMatrixView();
+  /** View of major vectors which[0..numberMajor-1] of matrix.  Throws
+      CoinError if an index is out of range or the selected vectors have
+      more elements than an int can count. */
+  CoinPackedMatrixView(const CoinPackedMatrix & matrix, int numberMajor,
+		       const int * which);
+  CoinPackedMatrixView(const CoinPackedMatrixView & rhs);
+  CoinPackedMatrixView & operator=(const CoinPackedMatrixView & rhs);
+  ~CoinPackedMatrixView();
+  //@}
+
+  /**@name Queries */
+  //@{
+  /// Matrix viewed (NULL if empty view)
+  inline const CoinPackedMatrix * getMatrix() const
+  { return matrix_; }
+  /// Major vector of matrix for each major vector of view
+  inline const int * getIndexMap() const
+  { return which_; }
+  bool isColOrdered() const;
+  int getNumRows() const;
+  int getNumCols() const;
+  inline int getMajorDim() const
+  { return numberMajor_; }
+  int getMinorDim() const;
+  /// Number of elements in selected vectors (counted when made)
+  inline CoinBigIndex getNumElements() const
+  { return numberElements_; }
+  /// Length of major vector i of view
+  int getVectorSize(int i) const;
+  /// Major vector i of view (pointing into matrix)
+  const CoinShallowPackedVector getVector(int i) const;
+  /// Copy of view as a matrix without gaps
+  void getPackedMatrix(CoinPackedMatrix & matrix) const;
+  //@}
+
+  /**@name Multiplying */
+  //@{
+  /// y = A * x (x has getNumCols() entries, y getNumRows())
+  void times(const double * x, double * y) const;
+  /// y = x * A (x has getNumRows() entries, y getNumCols())
+  void transposeTimes(const double * x, double * y) const;
+  //@}
+
+private:
+  /// y (minor) = sum of x[major] * major vector
+  void timesMajor(const double * x, double * y) const;
+  /// y[major] = major vector . x (x minor)
+  void timesMinor(const double * x, double * y) const;
+  /// Start in matrix of major vector i of view
+  CoinInt64 first(int i) const;
+
+  const CoinPackedMatrix * matrix_;
+  int numberMajor_;
+  int * which_;
+  CoinBigIndex numberElements_;
+};
+
+#endif
@@ -9,6 +9,7 @@
 #endif
 
 #include <cassert>
+#include <utility>
 
 #include "CoinHelperFunctions.hpp"
 #include "CoinPackedVector.hpp"
@@ -50,6 +51,30 @@ CoinPackedVector::operator=(const CoinPackedVectorBase & rhs)
    return *this;
 }
 
+//#############################################################################
+
+#if __cplusplus >= 201103L
+CoinPackedVector &
+CoinPackedVector::operator=(CoinPackedVector && rhs)
+{
+   if (this != &rhs) {
+      std::swap(indices_, rhs.indices_);
+      std::swap(elements_, rhs.elements_);
+      std::swap(nElements_, rhs.nElements_);
+      std::swap(origIndices_, rhs.origIndices_);
+      std::swap(capacity_, rhs.capacity_);
+      clearBase();
+      rhs.clearBase();
+      // rhs has been checked if it was being tested
+      if (testForDuplicateIndex() && !rhs.testForDuplicateIndex())
+	 setTestForDuplicateIndex(true);
+      else
+	 setTestForDuplicateIndexWhenTrue(testForDuplicateIndex());
+   }
+   return *this;
+}
+#endif
+
 //#############################################################################
 #if 0
 void
@@ -465,6 +490,28 @@ CoinPackedVector::CoinPackedVector(const CoinPackedVector & rhs) :
 
 //-----------------------------------------------------------------------------
 
+#if __cplusplus >= 201103L
+CoinPackedVector::CoinPackedVector(CoinPackedVector && rhs) noexcept :
+   CoinPackedVectorBase(),
+   indices_(rhs.indices_),
+   elements_(rhs.elements_),
+   nElements_(rhs.nElements_),
+   origIndices_(rhs.origIndices_),
+   capacity_(rhs.capacity_)
+{
+   // already tested if rhs was being tested
+   setTestForDuplicateIndexWhenTrue(rhs.testForDuplicateIndex());
+   rhs.indices_ = NULL;
+   rhs.elements_ = NULL;
+   rhs.nElements_ = 0;
+   rhs.origIndices_ = NULL;
+   rhs.capacity_ = 0;
+   rhs.clearBase();
+}
+#endif
+
+//-----------------------------------------------------------------------------
+
 CoinPackedVector::~CoinPackedVector ()
 {
    delete [] indices_;
@@ -165,6 +165,12 @@ public:
        <code>testForDuplicateIndex</code> setting, and affter copying the data
        it acts accordingly. */
    CoinPackedVector & operator=(const CoinPackedVectorBase & rhs);
+#if __cplusplus >= 201103L
+   /** Move assignment.  Takes the arrays of rhs (which is left with the
+       old ones) but keeps the current <code>testForDuplicateIndex</code>
+       setting. */
+   CoinPackedVector & operator=(CoinPackedVector && rhs);
+#endif
 
    /** Assign the ownership of the arguments to this vector.
        Size is the length of both the indices and elements vectors.
@@ -302,6 +308,12 @@ public:
 		   bool testForDuplicateIndex = COIN_DEFAULT_VALUE_FOR_DUPLICATE);
    /** Copy constructor. */
    CoinPackedVector(const CoinPackedVector &);
+#if __cplusplus >= 201103L
+   /** Move constructor - takes arrays of rhs which is left empty.
+       Does not throw so std::vector moves rather than copies when it
+       grows. */
+   CoinPackedVector(CoinPackedVector && rhs) noexcept;
+#endif
    /** Copy constructor <em>from a PackedVectorBase</em>. */
    CoinPackedVector(const CoinPackedVectorBase & rhs);
    /** Destructor */
@@ -0,0 +1,218 @@
+/* $Id$ */
+// Copyright (C) 2012, International Business Machines
+// Corporation and others.  All Rights Reserved.
+// This code is licensed under the terms of the Eclipse Public License (EPL).
+
+#include <cstring>
+
+#include "CoinPlusMinusOneMatrix.hpp"
+#include "CoinPackedMatrix.hpp"
+#include "CoinHelperFunctions.hpp"
+#include "CoinError.hpp"
+
+//#############################################################################
+
+CoinPlusMinusOneMatrix::CoinPlusMinusOneMatrix()
+  : colOrdered_(true),
+    numberRows_(0),
+    numberColumns_(0),
+    startNegative_(NULL),
+    indices_(NULL)
+{
+  startPositive_ = new CoinBigIndex [1];
+  startPositive_[0] = 0;
+}
+
+CoinPlusMinusOneMatrix::CoinPlusMinusOneMatrix(const CoinPackedMatrix & matrix)
+  : colOrdered_(matrix.isColOrdered()),
+    numberRows_(matrix.getNumRows()),
+    numberColumns_(matrix.getNumCols()),
+    startPositive_(NULL),
+    startNegative_(NULL),
+    indices_(NULL)
+{
+  if (matrix.hasWideStarts())
+    throw CoinError("not available with wide starts",
+		    "CoinPlusMinusOneMatrix", "CoinPlusMinusOneMatrix");
+  const int numberMajor = matrix.getMajorDim();
+  const CoinBigIndex * start = matrix.getVectorStarts();
+  const int * length = matrix.getVectorLengths();
+  const int * index = matrix.getIndices();
+  const double * element = matrix.getElements();
+  CoinBigIndex numberElements = 0;
+  for (int i=0;i<numberMajor;i++) {
+    for (CoinBigIndex j=start[i];j<start[i]+length[i];j++) {
+      double value = element[j];
+      if (value==1.0||value==-1.0)
+	numberElements++;
+      else if (value)
+	throw CoinError("Element not +1 or -1",
+			"CoinPlusMinusOneMatrix", "CoinPlusMinusOneMatrix");
+    }
+  }
+  startPositive_ = new CoinBigIndex [numberMajor+1];
+  startNegative_ = new CoinBigIndex [numberMajor];
+  indices_ = new int [numberElements];
+  CoinBigIndex put = 0;
+  for (int i=0;i<numberMajor;i++) {
+    const CoinBigIndex end = start[i]+length[i];
+    startPositive_[i] = put;
+    for (CoinBigIndex j=start[i];j<end;j++) {
+      if (element[j]==1.0)
+	indices_[put++] = index[j];
+    }
+    startNegative_[i] = put;
+    for (CoinBigIndex j=start[i];j<end;j++) {
+      if (element[j]==-1.0)
+	indices_[put++] = index[j];
+    }
+  }
+  startPositive_[numberMajor] = put;
+}
+
+CoinPlusMinusOneMatrix::CoinPlusMinusOneMatrix(bool columnOrdered,
+					       int numberRows,
+					       int numberColumns,
+					       const CoinBigIndex * startPositive,
+					       const CoinBigIndex * startNegative,
+					       const int * indices)
+  : colOrdered_(columnOrdered),
+    numberRows_(numberRows),
+    numberColumns_(numberColumns)
+{
+  const int numberMajor = getMajorDim();
+  startPositive_ = CoinCopyOfArray(startPositive,numberMajor+1);
+  startNegative_ = CoinCopyOfArray(startNegative,numberMajor);
+  indices_ = CoinCopyOfArray(indices,startPositive[numberMajor]);
+}
+
+CoinPlusMinusOneMatrix::CoinPlusMinusOneMatrix(const CoinPlusMinusOneMatrix & rhs)
+  : colOrdered_(rhs.colOrdered_),
+    numberRows_(rhs.numberRows_),
+    numberColumns_(rhs.numberColumns_)
+{
+  const int numberMajor = getMajorDim();
+  startPositive_ = CoinCopyOfArray(rhs.startPositive_,numberMajor+1);
+  startNegative_ = CoinCopyOfArray(rhs.startNegative_,numberMajor);
+  indices_ = CoinCopyOfArray(rhs.indices_,rhs.getNumElements());
+}
+
+CoinPlusMinusOneMatrix &
+CoinPlusMinusOneMatrix::operator=(const CoinPlusMinusOneMatrix & rhs)
+{
+  if (this!=&rhs) {
+    delete [] startPositive_;
+    delete [] startNegative_;
+    delete [] indices_;
+    colOrdered_ = rhs.colOrdered_;
+    numberRows_ = rhs.numberRows_;
+    numberColumns_ = rhs.numberColumns_;
+    const int numberMajor = getMajorDim();
+    startPositive_ = CoinCopyOfArray(rhs.startPositive_,numberMajor+1);
+    startNegative_ = CoinCopyOfArray(rhs.startNegative_,numberMajor);
+    indices_ = CoinCopyOfArray(rhs.indices_,rhs.getNumElements());
+  }
+  return *this;
+}
+
+CoinPlusMinusOneMatrix::~CoinPlusMinusOneMatrix()
+{
+  delete [] startPositive_;
+  delete [] startNegative_;
+  delete [] indices_;
+}
+
+//#############################################################################
+
+bool
+CoinPlusMinusOneMatrix::isPlusMinusOne(const CoinPackedMatrix & matrix)
+{
+  // too many elements to hold
+  if (matrix.hasWideStarts())
+    return false;
+  const int numberMajor = matrix.getMajorDim();
+  const CoinBigIndex * start = matrix.getVectorStarts();
+  const int * length = matrix.getVectorLengths();
+  const double * element = matrix.getElements();
+  for (int i=0;i<numberMajor;i++) {
+    for (CoinBigIndex j=start[i];j<start[i]+length[i];j++) {
+      double value = element[j];
+      if (value&&value!=1.0&&value!=-1.0)
+	return false;
+    }
+  }
+  return true;
+}
+
+// Same matrix as a CoinPackedMatrix
+void
+CoinPlusMinusOneMatrix::getPackedMatrix(CoinPackedMatrix & matrix) const
+{
+  const int numberMajor = getMajorDim();
+  const CoinBigIndex numberElements = getNumElements();
+  double * element = new double [numberElements];
+  for (int i=0;i<numberMajor;i++) {
+    CoinFillN(element+startPositive_[i],startNegative_[i]-startPositive_[i],
+	      1.0);
+    CoinFillN(element+startNegative_[i],startPositive_[i+1]-startNegative_[i],
+	      -1.0);
+  }
+  matrix.copyOf(colOrdered_,getMinorDim(),numberMajor,numberElements,
+		element,indices_,startPositive_,NULL);
+  delete [] element;
+}
+
+//#############################################################################
+
+void
+CoinPlusMinusOneMatrix::times(const double * x, double * y) const
+{
+  if (colOrdered_)
+    timesMajor(x,y);
+  else
+    timesMinor(x,y);
+}
+
+void
+CoinPlusMinusOneMatrix::transposeTimes(const double * x, double * y) const
+{
+  if (colOrdered_)
+    timesMinor(x,y);
+  else
+    timesMajor(x,y);
+}
+
+void
+CoinPlusMinusOneMatrix::timesMajor(const double * x, double * y) const
+{
+  const int numberMajor = getMajorDim();
+  CoinZeroN(y,getMinorDim());
+  const int * COIN_RESTRICT index = indices_;
+  for (int i=0;i<numberMajor;i++) {
+    const double value = x[i];
+    if (value) {
+      CoinBigIndex j;
+      for (j=startPositive_[i];j<startNegative_[i];j++)
+	y[index[j]] += value;
+      for (;j<startPositive_[i+1];j++)
+	y[index[j]] -= value;
+    }
+  }
+}
+
+void
+CoinPlusMinusOneMatrix::timesMinor(const double * x, double * y) const
+{
+  const int numberMajor = getMajorDim();
+  const int * COIN_RESTRICT index = indices_;
+  for (int i=0;i<numberMajor;i++) {
+    double positive = 0.0;
+    double negative = 0.0;
+    CoinBigIndex j;
+    for (j=startPositive_[i];j<startNegative_[i];j++)
+      positive += x[index[j]];
+    for (;j<startPositive_[i+1];j++)
+      negative += x[index[j]];
+    y[i] = positive-negative;
+  }
+}
@@ -0,0 +1,98 @@
+/* $Id$ */
+// Copyright (C) 2012, International Business Machines
+// Corporation and others.  All Rights Reserved.
+// This code is licensed under the terms of the Eclipse Public License (EPL).
+
+#ifndef CoinPlusMinusOneMatrix_H
+#define CoinPlusMinusOneMatrix_H
+
+#include "CoinUtilsConfig.h"
+#include "CoinTypes.hpp"
+
+class CoinPackedMatrix;
+
+/** Matrix whose elements are all +1 or -1.
+
+    Only indices are stored.  Major vector i has its +1 entries in
+    indices from startPositive[i] to startNegative[i] and its -1 entries
+    from startNegative[i] to startPositive[i+1] (as made by
+    CoinModel::createPlusMinusOne).  times() and transposeTimes() just
+    add and subtract so they read a third of the memory a
+    CoinPackedMatrix needs.
+
+    Network, assignment and set partitioning models are often like
+    this; CoinMpsIO checks every matrix it reads (isPlusMinusOne()) and
+    getPlusMinusOneMatrix() then gives one.
+*/
+class CoinPlusMinusOneMatrix {
+public:
+  /**@name Constructors and destructor */
+  //@{
+  /// Empty column ordered matrix
+  CoinPlusMinusOneMatrix();
+  /** From matrix with all elements +1, -1 or 0 (zeros are dropped).
+      Throws CoinError if it has other elements or wide starts. */
+  explicit CoinPlusMinusOneMatrix(const CoinPackedMatrix & matrix);
+  /** From arrays as described above (startPositive has major
+      dimension + 1 entries, startNegative major dimension). */
+  CoinPlusMinusOneMatrix(bool columnOrdered, int numberRows,
+			 int numberColumns,
+			 const CoinBigIndex * startPositive,
+			 const CoinBigIndex * startNegative,
+			 const int * indices);
+  CoinPlusMinusOneMatrix(const CoinPlusMinusOneMatrix & rhs);
+  CoinPlusMinusOneMatrix & operator=(const CoinPlusMinusOneMatrix & rhs);
+  ~CoinPlusMinusOneMatrix();
+  //@}
+
+  /**@name Queries */
+  //@{
+  /// True if every element of matrix is +1, -1 or 0 (false if wide starts)
+  static bool isPlusMinusOne(const CoinPackedMatrix & matrix);
+  inline bool isColOrdered() const
+  { return colOrdered_; }
+  inline int getNumRows() const
+  { return numberRows_; }
+  inline int getNumCols() const
+  { return numberColumns_; }
+  inline CoinBigIndex getNumElements() const
+  { return startPositive_[getMajorDim()]; }
+  inline int getMajorDim() const
+  { return colOrdered_ ? numberColumns_ : numberRows_; }
+  inline int getMinorDim() const
+  { return colOrdered_ ? numberRows_ : numberColumns_; }
+  /// Start of +1 entries of each major vector (and end of last)
+  inline const CoinBigIndex * getStartPositive() const
+  { return startPositive_; }
+  /// Start of -1 entries of each major vector
+  inline const CoinBigIndex * getStartNegative() const
+  { return startNegative_; }
+  inline const int * getIndices() const
+  { return indices_; }
+  /// Same matrix (same ordering, no gaps) as a CoinPackedMatrix
+  void getPackedMatrix(CoinPackedMatrix & matrix) const;
+  //@}
+
+  /**@name Multiplying */
+  //@{
+  /// y = A * x (x has getNumCols() entries, y getNumRows())
+  void times(const double * x, double * y) const;
+  /// y = x * A (x has getNumRows() entries, y getNumCols())
+  void transposeTimes(const double * x, double * y) const;
+  //@}
+
+private:
+  /// y (minor) = sum of x[major] * major vector
+  void timesMajor(const double * x, double * y) const;
+  /// y[major] = major vector . x (x minor)
+  void timesMinor(const double * x, double * y) const;
+
+  bool colOrdered_;
+  int numberRows_;
+  int numberColumns_;
+  CoinBigIndex * startPositive_;
+  CoinBigIndex * startNegative_;
+  int * indices_;
+};
+
+#endif
@@ -9,6 +9,7 @@
 
 #include "CoinHelperFunctions.hpp"
 #include "CoinPresolveMatrix.hpp"
+#include "CoinMemoryUsage.hpp"
 #ifndef SLIM_CLP
 #include "CoinWarmStartBasis.hpp"
 #endif
@@ -82,7 +83,8 @@ CoinPrePostsolveMatrix::CoinPrePostsolveMatrix
 
     handler_(0),
     defaultHandler_(false),
-    messages_()
+    messages_(),
+    arena_(0)
 
 { handler_ = new CoinMessageHandler() ;
   defaultHandler_ = true ;
@@ -476,6 +478,43 @@ void CoinPrePostsolveMatrix::setColumnStatusUsingValue(int iColumn)
     setColumnStatus(iColumn,superBasic);
   }
 }
+
+/*
+  Report memory usage. Arrays are allocated for the original size; the
+  current size is what is in use.
+*/
+void CoinPrePostsolveMatrix::memoryUsage (CoinMemoryUsage &usage) const
+{
+  const int sizeDouble = static_cast<int>(sizeof(double)) ;
+  const int sizeInt = static_cast<int>(sizeof(int)) ;
+  if (mcstrt_)
+    usage.addArray("colStarts",ncols_+1,ncols0_+1,
+		   static_cast<int>(sizeof(CoinBigIndex))) ;
+  if (hincol_)
+    usage.addArray("colLengths",ncols_,ncols0_+1,sizeInt) ;
+  if (hrow_)
+    usage.addArray("rowIndicesByCol",nelems_,bulk0_,sizeInt) ;
+  if (colels_)
+    usage.addArray("elementsByCol",nelems_,bulk0_,sizeDouble) ;
+  const double *colArrays[5] = { clo_, cup_, cost_, sol_, rcosts_ } ;
+  const char *colNames[5] = { "colLower", "colUpper", "cost",
+			      "colSolution", "reducedCost" } ;
+  for (int i = 0 ; i < 5 ; i++)
+  { if (colArrays[i])
+      usage.addArray(colNames[i],ncols_,ncols0_,sizeDouble) ; }
+  const double *rowArrays[4] = { rlo_, rup_, rowduals_, acts_ } ;
+  const char *rowNames[4] = { "rowLower", "rowUpper", "rowPrice",
+			      "rowActivity" } ;
+  for (int i = 0 ; i < 4 ; i++)
+  { if (rowArrays[i])
+      usage.addArray(rowNames[i],nrows_,nrows0_,sizeDouble) ; }
+  if (originalColumn_)
+    usage.addArray("originalColumn",ncols_,ncols0_,sizeInt) ;
+  if (originalRow_)
+    usage.addArray("originalRow",nrows_,nrows0_,sizeInt) ;
+  if (colstat_)
+    usage.add("status",ncols_+nrows_,ncols0_+nrows0_) ;
+}
 #ifndef SLIM_CLP
 
 
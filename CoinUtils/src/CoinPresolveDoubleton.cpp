@@ -542,11 +542,11 @@ const CoinPresolveAction
     s->ncoly = colLengths[tgtcoly] ;
     if (s->ncoly < s->ncolx) {
       s->colel	= presolve_dupmajor(colCoeffs,rowIndices,colLengths[tgtcoly],
-				    colStarts[tgtcoly],tgtrow) ;
+				    colStarts[tgtcoly],tgtrow,prob->arena_) ;
       s->ncolx = 0 ;
     } else {
       s->colel = presolve_dupmajor(colCoeffs,rowIndices,colLengths[tgtcolx],
-				   colStarts[tgtcolx],tgtrow) ;
+				   colStarts[tgtcolx],tgtrow,prob->arena_) ;
       s->ncoly = 0 ;
     }
 /*
@@ -758,7 +758,7 @@ const CoinPresolveAction
     action *actions1 = new action[nactions] ;
     CoinMemcpyN(actions, nactions, actions1) ;
 
-    next = new doubleton_action(nactions, actions1, next) ;
+    next = new doubleton_action(nactions, actions1, next, prob->arena_) ;
 
     if (nzeros)
       next = drop_zero_coefficients_action::presolve(prob, zeros, nzeros, next) ;
@@ -1472,8 +1472,10 @@ void doubleton_action::postsolve(CoinPostsolveMatrix *prob) const
 
 doubleton_action::~doubleton_action()
 {
-  for (int i=nactions_-1; i>=0; i--) {
-    delete[]actions_[i].colel ;
+  if (!arena_) {
+    for (int i=nactions_-1; i>=0; i--) {
+      delete[]actions_[i].colel ;
+    }
   }
   deleteAction(actions_,action*) ;
 }
@@ -573,7 +573,8 @@ const CoinPresolveAction
       s->ithis  = j2 ;
       s->ilast  = j1 ;
       s->nincol = hincol[j2] ;
-      s->colels = presolve_dupmajor(colels,hrow,hincol[j2],mcstrt[j2]) ;
+      s->colels = presolve_dupmajor(colels,hrow,hincol[j2],mcstrt[j2],-1,
+				    prob->arena_) ;
 /*
   Combine the columns into column j1. Upper and lower bounds and solution
   simply add, and the coefficients are unchanged.
@@ -767,7 +768,8 @@ const CoinPresolveAction
 	   nactions,nfixed_down,nfixed_up) ; }
 # endif
   if (nactions)
-  { next = new dupcol_action(nactions,CoinCopyOfArray(actions,nactions),next) ;
+  { next = new dupcol_action(nactions,CoinCopyOfArray(actions,nactions),next,
+			     prob->arena_) ;
     // we can't go round again in integer
     prob->presolveOptions_ |= 0x80000000;
 }
@@ -901,8 +903,10 @@ void dupcol_action::postsolve(CoinPostsolveMatrix *prob) const
 
 dupcol_action::~dupcol_action()
 {
-    for (int i = nactions_-1; i >= 0; --i) {
-	deleteAction(actions_[i].colels, double *);
+    if (!arena_) {
+	for (int i = nactions_-1; i >= 0; --i) {
+	    deleteAction(actions_[i].colels, double *);
+	}
     }
     deleteAction(actions_, action*);
 }
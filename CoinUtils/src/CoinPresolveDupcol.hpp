@@ -49,12 +49,14 @@ class dupcol_action : public CoinPresolveAction {
   const int nactions_;
   // actions_ is owned by the class and must be deleted at destruction
   const action *const actions_;
+  // colels are deleted at destruction unless from arena_
+  CoinArena *const arena_;
 
   dupcol_action(int nactions, const action *actions,
-		const CoinPresolveAction *next) :
+		const CoinPresolveAction *next, CoinArena *arena = NULL) :
       CoinPresolveAction(next),
       nactions_(nactions),
-      actions_(actions) {}
+      actions_(actions), arena_(arena) {}
 
  public:
   const char *name() const;
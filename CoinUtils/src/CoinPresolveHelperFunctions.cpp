@@ -16,6 +16,7 @@
 
 #include "CoinHelperFunctions.hpp"
 #include "CoinPresolveMatrix.hpp"
+#include "CoinArena.hpp"
 
 
 /*! \defgroup PMMDVX Packed Matrix Major Dimension Vector Expansion
@@ -243,7 +244,8 @@ bool presolve_expand_major (CoinBigIndex *majstrts, double *els,
 */
 
 double *presolve_dupmajor (const double *elems, const int *indices,
-			   int length, CoinBigIndex offset, int tgt)
+			   int length, CoinBigIndex offset, int tgt,
+			   CoinArena *arena)
 
 { int n ;
 
@@ -254,7 +256,11 @@ double *presolve_dupmajor (const double *elems, const int *indices,
   else
     n = 2*length ;
 
-  double *dArray = new double [n] ;
+  double *dArray ;
+  if (arena)
+    dArray = arena->allocateArray<double>(n) ;
+  else
+    dArray = new double [n] ;
   int *iArray = reinterpret_cast<int *>(dArray+length) ;
 
   if (tgt < 0)
@@ -689,7 +689,8 @@ const CoinPresolveAction *implied_free_action::presolve (
     s->rlo = rlo[tgtrow] ;
     s->rup = rup[tgtrow] ;
     s->ninrow = tgtrow_len ;
-    s->rowels = presolve_dupmajor(rowCoeffs,colIndices,tgtrow_len,krs) ;
+    s->rowels = presolve_dupmajor(rowCoeffs,colIndices,tgtrow_len,krs,-1,
+				  prob->arena_) ;
     s->costs = NULL ;
 /*
   We're processing a singleton, hence no substitutions in the matrix, but we
@@ -770,7 +771,7 @@ const CoinPresolveAction *implied_free_action::presolve (
 #   endif
     action *actions1 = new action[nactions] ;
     CoinMemcpyN(actions, nactions, actions1) ;
-    next = new implied_free_action(nactions,actions1,next) ;
+    next = new implied_free_action(nactions,actions1,next,prob->arena_) ;
   } 
   delete [] actions ;
 # if PRESOLVE_DEBUG > 0
@@ -1140,7 +1141,8 @@ implied_free_action::~implied_free_action()
 { 
   int i ;
   for (i=0;i<nactions_;i++) {
-    deleteAction(actions_[i].rowels,double *) ;
+    if (!arena_)
+      deleteAction(actions_[i].rowels,double *) ;
     deleteAction( actions_[i].costs,double *) ;
   }
   deleteAction(actions_,action *) ;
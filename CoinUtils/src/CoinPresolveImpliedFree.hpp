@@ -38,12 +38,15 @@ class implied_free_action : public CoinPresolveAction {
 
   const int nactions_;
   const action *const actions_;
+  /// Arena rowels came from (NULL if new[])
+  CoinArena *const arena_;
 
   implied_free_action(int nactions,
 		      const action *actions,
-		      const CoinPresolveAction *next) :
+		      const CoinPresolveAction *next,
+		      CoinArena *arena = NULL) :
     CoinPresolveAction(next),
-    nactions_(nactions), actions_(actions) {}
+    nactions_(nactions), actions_(actions), arena_(arena) {}
 
  public:
   const char *name() const;
@@ -10,6 +10,7 @@
 
 #include "CoinHelperFunctions.hpp"
 #include "CoinPresolveMatrix.hpp"
+#include "CoinMemoryUsage.hpp"
 #include "CoinTime.hpp"
 
 /*! \file
@@ -446,6 +447,49 @@ void CoinPresolveMatrix::deleteStuff()
   sumDown_ = NULL;
 }
 
+/*
+  Report memory usage. Adds the row-major copy, links, and work arrays to
+  what the base class reports.
+*/
+void CoinPresolveMatrix::memoryUsage (CoinMemoryUsage &usage) const
+{
+  CoinPrePostsolveMatrix::memoryUsage(usage) ;
+  const int sizeDouble = static_cast<int>(sizeof(double)) ;
+  const int sizeInt = static_cast<int>(sizeof(int)) ;
+  if (mrstrt_)
+    usage.addArray("rowStarts",nrows_+1,nrows0_+1,
+		   static_cast<int>(sizeof(CoinBigIndex))) ;
+  if (hinrow_)
+    usage.addArray("rowLengths",nrows_,nrows0_+1,sizeInt) ;
+  if (hcol_)
+    usage.addArray("colIndicesByRow",nelems_,bulk0_,sizeInt) ;
+  if (rowels_)
+    usage.addArray("elementsByRow",nelems_,bulk0_,sizeDouble) ;
+  if (clink_)
+    usage.addArray("colLinks",ncols_+1,ncols0_+1,
+		   static_cast<int>(sizeof(presolvehlink))) ;
+  if (rlink_)
+    usage.addArray("rowLinks",nrows_+1,nrows0_+1,
+		   static_cast<int>(sizeof(presolvehlink))) ;
+  if (integerType_)
+    usage.add("integerType",ncols_,ncols0_) ;
+  if (colChanged_)
+    usage.add("colChanged",ncols_,ncols0_) ;
+  if (rowChanged_)
+    usage.add("rowChanged",nrows_,nrows0_) ;
+  if (colsToDo_)
+    usage.addArray("colsToDo",2*ncols_,2*ncols0_,sizeInt) ;
+  if (rowsToDo_)
+    usage.addArray("rowsToDo",2*nrows_,2*nrows0_,sizeInt) ;
+  // Work arrays from initializeStuff
+  if (usefulRowInt_) {
+    int k = CoinMax(ncols_+1,nrows_+1) ;
+    CoinInt64 bytes = (5*nrows_+2*ncols_)*static_cast<CoinInt64>(sizeInt) +
+      (4*nrows_+ncols_+k)*static_cast<CoinInt64>(sizeDouble) ;
+    usage.add("work",bytes,bytes) ;
+  }
+}
+
 
 /*
   These functions set integer type information. The first expects an array with
@@ -102,6 +102,7 @@ const double ZTOLDP2 = 1e-10 ;
 
 
 class CoinPostsolveMatrix ;
+class CoinArena ;
 
 /*! \class CoinPresolveAction
     \brief Abstract base class of all presolve routines.
@@ -511,6 +512,13 @@ class CoinPrePostsolveMatrix
   { int empty = 0 ;
     for (int i = 0 ; i < ncols_ ; i++) if (hincol_[i] == 0) empty++ ;
     return (empty) ; }
+  /*! \brief Add bytes used and allocated for each internal array to
+	     \p usage
+
+    Used is the current size, allocated the size given by #ncols0_,
+    #nrows0_ and #bulk0_.
+  */
+  void memoryUsage(CoinMemoryUsage &usage) const ;
   //@}
 
 
@@ -534,6 +542,22 @@ class CoinPrePostsolveMatrix
   { return messages_; }
   //@}
 
+  /*! \name Arena for vectors kept by transforms */
+  //@{
+  /*! \brief Set arena
+
+    Copies of rows and columns kept for postsolve by the doubleton,
+    tripleton, dupcol and implied_free transforms are taken from the arena
+    instead of by new[].  The client retains responsibility for the arena,
+    which must outlive the transforms (i.e., until postsolve is finished).
+  */
+  inline void setArena(CoinArena *arena)
+  { arena_ = arena ; }
+  /// Return arena (NULL if none)
+  inline CoinArena *arena() const
+  { return arena_ ; }
+  //@}
+
   /*! \name Current and Allocated Size
 
     During pre- and postsolve, the matrix will change in size. During presolve
@@ -703,6 +727,9 @@ class CoinPrePostsolveMatrix
   CoinMessage messages_; 
   //@}
 
+  /// Arena for vectors kept by transforms (not owned)
+  CoinArena *arena_ ;
+
 };
 
 /*! \relates CoinPrePostsolveMatrix
@@ -983,6 +1010,13 @@ class CoinPresolveMatrix : public CoinPrePostsolveMatrix
   /// Sets any special options (see #presolveOptions_)
   inline void setPresolveOptions(int value)
   { presolveOptions_=value;}
+  /*! \brief Add bytes used and allocated for each internal array to
+	     \p usage
+
+    Includes the arrays reported by CoinPrePostsolveMatrix::memoryUsage
+    and the row-major copy, links and work arrays.
+  */
+  void memoryUsage(CoinMemoryUsage &usage) const ;
   //@}
 
   /*! \name Matrix storage management links
@@ -1829,9 +1863,13 @@ inline void presolve_delete_from_col2(int row, int col, CoinBigIndex *mcstrt,
     
     If \p tgt is specified, the entry with minor index == \p tgt is
     omitted from the copy.
+
+    If \p arena is specified the copy is taken from it, otherwise it must
+    be deleted with delete[].
 */
 double *presolve_dupmajor(const double *elems, const int *indices,
-			  int length, CoinBigIndex offset, int tgt = -1);
+			  int length, CoinBigIndex offset, int tgt = -1,
+			  CoinArena *arena = NULL);
 
 /// Initialize a vector with random numbers
 void coin_init_random_vec(double *work, int n);
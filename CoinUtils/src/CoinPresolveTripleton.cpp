@@ -530,7 +530,7 @@ const CoinPresolveAction *tripleton_action::presolve(CoinPresolveMatrix *prob,
 	  
 	  s->ncoly	= hincol[icoly];
 	  s->colel	= presolve_dupmajor(colels, hrow, hincol[icoly],
-					    mcstrt[icoly]);
+					    mcstrt[icoly], -1, prob->arena_);
 	}
 
 	// costs
@@ -638,7 +638,7 @@ const CoinPresolveAction *tripleton_action::presolve(CoinPresolveMatrix *prob,
     action *actions1 = new action[nactions];
     CoinMemcpyN(actions, nactions, actions1);
 
-    next = new tripleton_action(nactions, actions1, next);
+    next = new tripleton_action(nactions, actions1, next, prob->arena_);
 
     if (nzeros) {
       next = drop_zero_coefficients_action::presolve(prob, zeros, nzeros, next);
@@ -1067,8 +1067,10 @@ void tripleton_action::postsolve(CoinPostsolveMatrix *prob) const
 
 tripleton_action::~tripleton_action()
 {
-  for (int i=nactions_-1; i>=0; i--) {
-    delete[]actions_[i].colel;
+  if (!arena_) {
+    for (int i=nactions_-1; i>=0; i--) {
+      delete[]actions_[i].colel;
+    }
   }
   deleteAction(actions_,action*);
 }
@@ -44,11 +44,15 @@ class tripleton_action : public CoinPresolveAction {
   const action *const actions_;
 
  private:
+  /// Arena colel came from (NULL if new[])
+  CoinArena *const arena_;
+
   tripleton_action(int nactions,
 		      const action *actions,
-		      const CoinPresolveAction *next) :
+		      const CoinPresolveAction *next,
+		      CoinArena *arena = NULL) :
     CoinPresolveAction(next),
-    nactions_(nactions), actions_(actions)
+    nactions_(nactions), actions_(actions), arena_(arena)
 {}
 
  public:
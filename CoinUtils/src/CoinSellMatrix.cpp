@@ -0,0 +1,525 @@
+/* $Id$ */
+// Copyright (C) 2012, International Business Machines
+// Corporation and others.  All Rights Reserved.
+// This code is licensed under the terms of the Eclipse Public License (EPL).
+
+#include <algorithm>
+#include <cassert>
+
+#include "CoinSellMatrix.hpp"
+#include "CoinPackedMatrix.hpp"
+#include "CoinHelperFunctions.hpp"
+#include "CoinError.hpp"
+#include "CoinFinite.hpp"
+#include "CoinThreadPool.hpp"
+
+/* Where the compiler allows, AVX2 and AVX-512 kernels are compiled as
+   well as the plain loop and the best the processor supports is used.
+   Define COIN_SELL_NO_SIMD to get just the plain loop. */
+#ifndef COIN_SELL_NO_SIMD
+#if (defined(__x86_64__) || defined(__i386__)) && \
+  ((defined(__clang__) && __clang_major__ >= 4) || \
+   (!defined(__clang__) && defined(__GNUC__) && \
+    (__GNUC__ > 4 || (__GNUC__ == 4 && __GNUC_MINOR__ >= 9))))
+#define COIN_SELL_SIMD 1
+#include <immintrin.h>
+#endif
+#endif
+
+/* Every kernel must give the same answer to the last bit, so multiplies
+   and adds must not be fused.  GCC fuses across statements unless told not
+   to; clang and MSVC only fuse within an expression, and the kernels keep
+   the product in its own statement. */
+#if defined(__GNUC__) && !defined(__clang__)
+#define COIN_SELL_NO_FMA __attribute__((optimize("fp-contract=off")))
+#else
+#define COIN_SELL_NO_FMA
+#endif
+
+// Fewest stored entries worth using threads for
+#define COIN_SELL_PARALLEL 100000
+
+namespace {
+  // -1 for best processor supports, otherwise set by setInstructionSet
+  int coinSellLevel = -1;
+}
+
+//#############################################################################
+
+/// Major vectors of a packed matrix in SELL-C-sigma format
+class CoinSellSlices {
+public:
+  CoinSellSlices(const CoinPackedMatrix & matrix, int chunkSize, int sigma);
+  CoinSellSlices(const CoinSellSlices & rhs);
+  ~CoinSellSlices();
+  /// y[major] = major vector . x
+  void multiply(const double * x, double * y) const;
+
+  int numberMajor_;
+  int numberMinor_;
+  int chunkSize_;
+  int numberChunks_;
+  CoinBigIndex numberElements_;
+  /// Start of each chunk (numberChunks_+1)
+  CoinBigIndex * chunkStart_;
+  /// Longest vector in each chunk
+  int * chunkLength_;
+  /// Shortest vector in each chunk
+  int * chunkMinimum_;
+  /// Major vector in each slot (-1 if none)
+  int * permutation_;
+  /// Length of vector in each slot
+  int * length_;
+  /// Chunk c slot r entry j is at chunkStart_[c]+j*chunkSize_+r
+  int * index_;
+  double * element_;
+private:
+  CoinSellSlices & operator=(const CoinSellSlices &);
+};
+
+CoinSellSlices::CoinSellSlices(const CoinPackedMatrix & matrix,
+			       int chunkSize, int sigma)
+  : numberMajor_(matrix.getMajorDim()),
+    numberMinor_(matrix.getMinorDim()),
+    chunkSize_(chunkSize),
+    numberElements_(matrix.getNumElements())
+{
+  const int nMajor = numberMajor_;
+  const int C = chunkSize_;
+  numberChunks_ = (nMajor+C-1)/C;
+  const int numberSlots = numberChunks_*C;
+  const CoinBigIndex * start = matrix.getVectorStarts();
+  const int * length = matrix.getVectorLengths();
+  const int * index = matrix.getIndices();
+  const double * element = matrix.getElements();
+  // sort by decreasing length within windows (ties keep order)
+  permutation_ = new int [numberSlots];
+  length_ = new int [numberSlots];
+  CoinInt64 * key = new CoinInt64 [nMajor];
+  for (int i=0;i<nMajor;i++)
+    key[i] = (static_cast<CoinInt64>(COIN_INT_MAX-length[i])<<32)|i;
+  if (sigma>C) {
+    for (int i=0;i<nMajor;i+=sigma)
+      std::sort(key+i,key+CoinMin(i+sigma,nMajor));
+  }
+  for (int i=0;i<nMajor;i++) {
+    permutation_[i] = static_cast<int>(key[i]&0xffffffff);
+    length_[i] = length[permutation_[i]];
+  }
+  delete [] key;
+  for (int i=nMajor;i<numberSlots;i++) {
+    permutation_[i] = -1;
+    length_[i] = 0;
+  }
+  chunkStart_ = new CoinBigIndex [numberChunks_+1];
+  chunkLength_ = new int [numberChunks_];
+  chunkMinimum_ = new int [numberChunks_];
+  chunkStart_[0] = 0;
+  for (int c=0;c<numberChunks_;c++) {
+    int longest = 0;
+    int shortest = COIN_INT_MAX;
+    for (int r=0;r<C;r++) {
+      longest = CoinMax(longest,length_[c*C+r]);
+      shortest = CoinMin(shortest,length_[c*C+r]);
+    }
+    chunkLength_[c] = longest;
+    chunkMinimum_[c] = shortest;
+    chunkStart_[c+1] = chunkStart_[c]+static_cast<CoinBigIndex>(longest)*C;
+  }
+  const CoinBigIndex numberStored = chunkStart_[numberChunks_];
+  // padding has zero element and index (never used)
+  index_ = new int [numberStored];
+  element_ = new double [numberStored];
+  CoinZeroN(index_,numberStored);
+  CoinZeroN(element_,numberStored);
+  for (int c=0;c<numberChunks_;c++) {
+    for (int r=0;r<C;r++) {
+      const int iMajor = permutation_[c*C+r];
+      if (iMajor<0)
+	continue;
+      CoinBigIndex put = chunkStart_[c]+r;
+      const CoinBigIndex end = start[iMajor]+length[iMajor];
+      for (CoinBigIndex j=start[iMajor];j<end;j++) {
+	index_[put] = index[j];
+	element_[put] = element[j];
+	put += C;
+      }
+    }
+  }
+}
+
+CoinSellSlices::CoinSellSlices(const CoinSellSlices & rhs)
+  : numberMajor_(rhs.numberMajor_),
+    numberMinor_(rhs.numberMinor_),
+    chunkSize_(rhs.chunkSize_),
+    numberChunks_(rhs.numberChunks_),
+    numberElements_(rhs.numberElements_)
+{
+  const int numberSlots = numberChunks_*chunkSize_;
+  const CoinBigIndex numberStored = rhs.chunkStart_[numberChunks_];
+  chunkStart_ = CoinCopyOfArray(rhs.chunkStart_,numberChunks_+1);
+  chunkLength_ = CoinCopyOfArray(rhs.chunkLength_,numberChunks_);
+  chunkMinimum_ = CoinCopyOfArray(rhs.chunkMinimum_,numberChunks_);
+  permutation_ = CoinCopyOfArray(rhs.permutation_,numberSlots);
+  length_ = CoinCopyOfArray(rhs.length_,numberSlots);
+  index_ = CoinCopyOfArray(rhs.index_,numberStored);
+  element_ = CoinCopyOfArray(rhs.element_,numberStored);
+}
+
+CoinSellSlices::~CoinSellSlices()
+{
+  delete [] chunkStart_;
+  delete [] chunkLength_;
+  delete [] chunkMinimum_;
+  delete [] permutation_;
+  delete [] length_;
+  delete [] index_;
+  delete [] element_;
+}
+
+//#############################################################################
+// Kernels - do chunks first..last-1
+
+COIN_SELL_NO_FMA static void
+coinSellPlain(const CoinSellSlices & s, const double * COIN_RESTRICT x,
+	      double * COIN_RESTRICT y, int first, int last)
+{
+  const int C = s.chunkSize_;
+  double sum[16];
+  for (int c=first;c<last;c++) {
+    const int * COIN_RESTRICT index = s.index_+s.chunkStart_[c];
+    const double * COIN_RESTRICT element = s.element_+s.chunkStart_[c];
+    const int * slotLength = s.length_+c*C;
+    const int length = s.chunkLength_[c];
+    const int minimum = s.chunkMinimum_[c];
+    for (int r=0;r<C;r++)
+      sum[r] = 0.0;
+    int j;
+    for (j=0;j<minimum;j++) {
+      for (int r=0;r<C;r++) {
+	double product = element[r]*x[index[r]];
+	sum[r] += product;
+      }
+      index += C;
+      element += C;
+    }
+    for (;j<length;j++) {
+      for (int r=0;r<C;r++) {
+	if (j<slotLength[r]) {
+	  double product = element[r]*x[index[r]];
+	  sum[r] += product;
+	}
+      }
+      index += C;
+      element += C;
+    }
+    const int * permutation = s.permutation_+c*C;
+    for (int r=0;r<C;r++) {
+      if (permutation[r]>=0)
+	y[permutation[r]] = sum[r];
+    }
+  }
+}
+
+#if COIN_SELL_SIMD
+// chunkSize a multiple of 4
+__attribute__((target("avx2"))) COIN_SELL_NO_FMA static void
+coinSellAvx2(const CoinSellSlices & s, const double * COIN_RESTRICT x,
+	     double * COIN_RESTRICT y, int first, int last)
+{
+  const int C = s.chunkSize_;
+  double sum[16];
+  for (int c=first;c<last;c++) {
+    const CoinBigIndex start = s.chunkStart_[c];
+    const int * slotLength = s.length_+c*C;
+    const int length = s.chunkLength_[c];
+    const int minimum = s.chunkMinimum_[c];
+    for (int g=0;g<C;g+=4) {
+      const int * index = s.index_+start+g;
+      const double * element = s.element_+start+g;
+      __m256d total = _mm256_setzero_pd();
+      // masked gather with every lane on (plain gather has undefined source)
+      const __m256d all = _mm256_castsi256_pd(_mm256_set1_epi64x(-1));
+      int j;
+      for (j=0;j<minimum;j++) {
+	__m128i vi = _mm_loadu_si128(reinterpret_cast<const __m128i *>(index));
+	__m256d vx = _mm256_mask_i32gather_pd(_mm256_setzero_pd(),x,vi,all,8);
+	total = _mm256_add_pd(total,_mm256_mul_pd(_mm256_loadu_pd(element),vx));
+	index += C;
+	element += C;
+      }
+      if (j<length) {
+	// only gather for lanes still in their vector
+	__m128i vl = _mm_loadu_si128(reinterpret_cast<const __m128i *>(slotLength+g));
+	for (;j<length;j++) {
+	  __m128i active = _mm_cmpgt_epi32(vl,_mm_set1_epi32(j));
+	  __m256d mask = _mm256_castsi256_pd(_mm256_cvtepi32_epi64(active));
+	  __m128i vi = _mm_loadu_si128(reinterpret_cast<const __m128i *>(index));
+	  __m256d vx = _mm256_mask_i32gather_pd(_mm256_setzero_pd(),x,vi,mask,8);
+	  total = _mm256_add_pd(total,_mm256_mul_pd(_mm256_loadu_pd(element),vx));
+	  index += C;
+	  element += C;
+	}
+      }
+      _mm256_storeu_pd(sum+g,total);
+    }
+    const int * permutation = s.permutation_+c*C;
+    for (int r=0;r<C;r++) {
+      if (permutation[r]>=0)
+	y[permutation[r]] = sum[r];
+    }
+  }
+}
+
+// chunkSize a multiple of 8
+__attribute__((target("avx512f,avx512vl"))) COIN_SELL_NO_FMA static void
+coinSellAvx512(const CoinSellSlices & s, const double * COIN_RESTRICT x,
+	       double * COIN_RESTRICT y, int first, int last)
+{
+  const int C = s.chunkSize_;
+  double sum[16];
+  for (int c=first;c<last;c++) {
+    const CoinBigIndex start = s.chunkStart_[c];
+    const int * slotLength = s.length_+c*C;
+    const int length = s.chunkLength_[c];
+    const int minimum = s.chunkMinimum_[c];
+    for (int g=0;g<C;g+=8) {
+      const int * index = s.index_+start+g;
+      const double * element = s.element_+start+g;
+      __m512d total = _mm512_setzero_pd();
+      int j;
+      for (j=0;j<minimum;j++) {
+	__m256i vi = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(index));
+	__m512d vx = _mm512_mask_i32gather_pd(_mm512_setzero_pd(),0xff,vi,x,8);
+	total = _mm512_add_pd(total,_mm512_mul_pd(_mm512_loadu_pd(element),vx));
+	index += C;
+	element += C;
+      }
+      if (j<length) {
+	__m256i vl = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(slotLength+g));
+	for (;j<length;j++) {
+	  __mmask8 active = _mm256_cmpgt_epi32_mask(vl,_mm256_set1_epi32(j));
+	  __m256i vi = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(index));
+	  __m512d vx = _mm512_mask_i32gather_pd(_mm512_setzero_pd(),active,vi,x,8);
+	  total = _mm512_add_pd(total,_mm512_mul_pd(_mm512_loadu_pd(element),vx));
+	  index += C;
+	  element += C;
+	}
+      }
+      _mm512_storeu_pd(sum+g,total);
+    }
+    const int * permutation = s.permutation_+c*C;
+    for (int r=0;r<C;r++) {
+      if (permutation[r]>=0)
+	y[permutation[r]] = sum[r];
+    }
+  }
+}
+#endif
+
+// Instruction set processor supports
+static int
+coinSellDetect()
+{
+#if COIN_SELL_SIMD
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("avx512f")&&__builtin_cpu_supports("avx512vl"))
+    return 2;
+  if (__builtin_cpu_supports("avx2"))
+    return 1;
+#endif
+  return 0;
+}
+
+/* Best instruction set processor supports.  Found once - a local static
+   is initialized safely even if first use is from several threads. */
+static int
+coinSellBest()
+{
+  static const int best = coinSellDetect();
+  return best;
+}
+
+// Instruction set to use (nothing written on the way)
+static inline int
+coinSellUse()
+{
+  int level = coinSellLevel;
+  return level<0 ? coinSellBest() : level;
+}
+
+// Kernel for level and chunk size
+static void
+coinSellKernel(int level, const CoinSellSlices & s, const double * x,
+	       double * y, int first, int last)
+{
+#if COIN_SELL_SIMD
+  if (level==2&&(s.chunkSize_&7)==0) {
+    coinSellAvx512(s,x,y,first,last);
+    return;
+  } else if (level>=1&&(s.chunkSize_&3)==0) {
+    coinSellAvx2(s,x,y,first,last);
+    return;
+  }
+#endif
+  coinSellPlain(s,x,y,first,last);
+}
+
+// Does a range of chunks
+class CoinSellTask : public CoinThreadRangeTask {
+public:
+  const CoinSellSlices * slices_;
+  const double * x_;
+  double * y_;
+  int level_;
+  virtual void run(int begin, int end)
+  {
+    coinSellKernel(level_,*slices_,x_,y_,begin,end);
+  }
+};
+
+void
+CoinSellSlices::multiply(const double * x, double * y) const
+{
+  int level = coinSellUse();
+  CoinThreadPool * pool =
+    CoinThreadPool::defaultPoolFor(chunkStart_[numberChunks_],
+				   COIN_SELL_PARALLEL);
+  if (pool) {
+    CoinSellTask task;
+    task.slices_ = this;
+    task.x_ = x;
+    task.y_ = y;
+    task.level_ = level;
+    pool->parallelFor(task,0,numberChunks_);
+  } else {
+    coinSellKernel(level,*this,x,y,0,numberChunks_);
+  }
+}
+
+//#############################################################################
+
+CoinSellMatrix::CoinSellMatrix()
+  : rows_(NULL),
+    columns_(NULL),
+    chunkSize_(8),
+    sigma_(256)
+{
+}
+
+CoinSellMatrix::CoinSellMatrix(const CoinPackedMatrix & matrix,
+			       int chunkSize, int sigma)
+  : rows_(NULL),
+    columns_(NULL),
+    chunkSize_(chunkSize),
+    sigma_(sigma)
+{
+  if (chunkSize_!=1&&chunkSize_!=2&&chunkSize_!=4&&chunkSize_!=8&&
+      chunkSize_!=16)
+    throw CoinError("chunkSize must be 1, 2, 4, 8 or 16",
+		    "CoinSellMatrix", "CoinSellMatrix");
+  if (matrix.hasWideStarts())
+    throw CoinError("not available with wide starts",
+		    "CoinSellMatrix", "CoinSellMatrix");
+  if (sigma_<0)
+    sigma_ = 0;
+  sigma_ = ((sigma_+chunkSize_-1)/chunkSize_)*chunkSize_;
+  CoinPackedMatrix reversed;
+  reversed.reverseOrderedCopyOf(matrix);
+  const CoinPackedMatrix & byRow = matrix.isColOrdered() ? reversed : matrix;
+  const CoinPackedMatrix & byColumn = matrix.isColOrdered() ? matrix : reversed;
+  rows_ = new CoinSellSlices(byRow,chunkSize_,sigma_);
+  columns_ = new CoinSellSlices(byColumn,chunkSize_,sigma_);
+}
+
+CoinSellMatrix::CoinSellMatrix(const CoinSellMatrix & rhs)
+  : rows_(NULL),
+    columns_(NULL),
+    chunkSize_(rhs.chunkSize_),
+    sigma_(rhs.sigma_)
+{
+  if (rhs.rows_) {
+    rows_ = new CoinSellSlices(*rhs.rows_);
+    columns_ = new CoinSellSlices(*rhs.columns_);
+  }
+}
+
+CoinSellMatrix &
+CoinSellMatrix::operator=(const CoinSellMatrix & rhs)
+{
+  if (this!=&rhs) {
+    delete rows_;
+    delete columns_;
+    rows_ = NULL;
+    columns_ = NULL;
+    chunkSize_ = rhs.chunkSize_;
+    sigma_ = rhs.sigma_;
+    if (rhs.rows_) {
+      rows_ = new CoinSellSlices(*rhs.rows_);
+      columns_ = new CoinSellSlices(*rhs.columns_);
+    }
+  }
+  return *this;
+}
+
+CoinSellMatrix::~CoinSellMatrix()
+{
+  delete rows_;
+  delete columns_;
+}
+
+int
+CoinSellMatrix::getNumRows() const
+{
+  return rows_ ? rows_->numberMajor_ : 0;
+}
+
+int
+CoinSellMatrix::getNumCols() const
+{
+  return rows_ ? rows_->numberMinor_ : 0;
+}
+
+CoinBigIndex
+CoinSellMatrix::getNumElements() const
+{
+  return rows_ ? rows_->numberElements_ : 0;
+}
+
+// Entries stored for rows including padding
+CoinBigIndex
+CoinSellMatrix::getNumStored() const
+{
+  return rows_ ? rows_->chunkStart_[rows_->numberChunks_] : 0;
+}
+
+// y = A * x
+void
+CoinSellMatrix::times(const double * x, double * y) const
+{
+  if (rows_)
+    rows_->multiply(x,y);
+}
+
+// y = x * A
+void
+CoinSellMatrix::transposeTimes(const double * x, double * y) const
+{
+  if (columns_)
+    columns_->multiply(x,y);
+}
+
+int
+CoinSellMatrix::instructionSet()
+{
+  return coinSellUse();
+}
+
+void
+CoinSellMatrix::setInstructionSet(int value)
+{
+  if (value<0)
+    coinSellLevel = -1;
+  else
+    coinSellLevel = CoinMin(value,coinSellBest());
+}
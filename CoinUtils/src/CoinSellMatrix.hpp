@@ -0,0 +1,87 @@
+/* $Id$ */
+// Copyright (C) 2012, International Business Machines
+// Corporation and others.  All Rights Reserved.
+// This code is licensed under the terms of the Eclipse Public License (EPL).
+
+#ifndef CoinSellMatrix_H
+#define CoinSellMatrix_H
+
+#include "CoinUtilsConfig.h"
+#include "CoinTypes.hpp"
+
+class CoinPackedMatrix;
+class CoinSellSlices;
+
+/** Matrix in SELL-C-sigma format for fast matrix times vector.
+
+    Rows are put in chunks of C (chunkSize) and each chunk is stored
+    column by column, padded to its longest row, so C rows are done at
+    once with vector instructions (gathering x).  To keep padding small,
+    rows are sorted by length within windows of sigma rows.  Columns are
+    stored the same way for transposeTimes.
+
+    A CoinSellMatrix is built from a CoinPackedMatrix in one call and
+    can not be changed.  Each result is summed in the order the entries
+    are in the row (column) of the matrix so, apart from the order of
+    adding, results are those of CoinPackedMatrix.  AVX2 and AVX-512
+    kernels are used where the compiler and processor allow (define
+    COIN_SELL_NO_SIMD for just plain loops); they give the same results
+    as the plain loops.  If CoinThreadPool::defaultPool() is set large
+    matrices are multiplied in parallel.
+
+    CoinPackedMatrix can build and keep one for matrices which are
+    multiplied repeatedly - see CoinPackedMatrix::setSellCacheAfter().
+*/
+class CoinSellMatrix {
+public:
+  /**@name Constructors and destructor */
+  //@{
+  /// Empty matrix
+  CoinSellMatrix();
+  /** Build from matrix.  chunkSize (C) is 1, 2, 4, 8 or 16; sigma is
+      rounded up to a multiple of chunkSize (0 for no sorting).  Throws
+      CoinError if matrix has wide starts. */
+  CoinSellMatrix(const CoinPackedMatrix & matrix, int chunkSize = 8,
+		 int sigma = 256);
+  CoinSellMatrix(const CoinSellMatrix & rhs);
+  CoinSellMatrix & operator=(const CoinSellMatrix & rhs);
+  ~CoinSellMatrix();
+  //@}
+
+  /**@name Queries */
+  //@{
+  int getNumRows() const;
+  int getNumCols() const;
+  CoinBigIndex getNumElements() const;
+  /// Entries stored for rows including padding
+  CoinBigIndex getNumStored() const;
+  inline int chunkSize() const
+  { return chunkSize_; }
+  inline int sigma() const
+  { return sigma_; }
+  //@}
+
+  /**@name Multiplying */
+  //@{
+  /// y = A * x (x has getNumCols() entries, y getNumRows())
+  void times(const double * x, double * y) const;
+  /// y = x * A (x has getNumRows() entries, y getNumCols())
+  void transposeTimes(const double * x, double * y) const;
+  /// Instruction set used - 0 plain, 1 AVX2, 2 AVX-512
+  static int instructionSet();
+  /** Use instruction set value (or best available if it is not).
+      -1 chooses again.  Mainly for testing - not to be called while
+      other threads multiply. */
+  static void setInstructionSet(int value);
+  //@}
+
+private:
+  /// Slices of rows (for times)
+  CoinSellSlices * rows_;
+  /// Slices of columns (for transposeTimes)
+  CoinSellSlices * columns_;
+  int chunkSize_;
+  int sigma_;
+};
+
+#endif
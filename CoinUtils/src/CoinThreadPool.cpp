@@ -0,0 +1,488 @@
+/* $Id$ */
+// Copyright (C) 2012, International Business Machines
+// Corporation and others.  All Rights Reserved.
+// This code is licensed under the terms of the Eclipse Public License (EPL).
+
+#include <cstddef>
+#ifndef _MSC_VER
+#include <stdint.h>
+#endif
+
+#include "CoinThreadPool.hpp"
+#include "CoinTypes.hpp"
+
+#ifndef _MSC_VER
+#include <unistd.h>
+#endif
+#if defined(COINUTILS_PTHREADS) && (COINUTILS_PTHREADS == 1)
+#include <pthread.h>
+#define COIN_THREAD_POOL_PTHREADS 1
+#endif
+
+// Most ranges parallelSum splits into if grain not given
+#define COIN_THREAD_POOL_REDUCE_PIECES 64
+
+static int coinConcurrencyLimit = 0;
+static CoinThreadPool * coinDefaultPool = NULL;
+
+//#############################################################################
+
+#ifdef COIN_THREAD_POOL_PTHREADS
+static int coinThreadsInUse = 0;
+static pthread_mutex_t coinConcurrencyMutex = PTHREAD_MUTEX_INITIALIZER;
+
+/// Pieces still to be done by one thread
+class CoinThreadSlot {
+public:
+  pthread_mutex_t mutex_;
+  /// Next piece
+  int begin_;
+  /// One after last piece
+  int end_;
+  /// Number of times this thread stole
+  int steals_;
+  /// Keep slots on different cache lines
+  char pad_[64];
+};
+
+class CoinThreadPoolData;
+
+/// Passed to each worker thread
+class CoinThreadWorker {
+public:
+  CoinThreadPoolData * data_;
+  /// Slot of thread (1..numberWorkers)
+  int which_;
+};
+
+class CoinThreadPoolData {
+public:
+  pthread_t * threads_;
+  CoinThreadWorker * workers_;
+  /// One for each thread - caller is 0
+  CoinThreadSlot * slots_;
+  pthread_mutex_t mutex_;
+  /// Signalled when there is new work (or stop)
+  pthread_cond_t start_;
+  /// Signalled when last worker finishes
+  pthread_cond_t done_;
+  CoinThreadTask * task_;
+  /// Threads (including caller) taking part in current work
+  int participants_;
+  /// Workers still running current work
+  int active_;
+  /// Bumped for each new piece of work
+  unsigned int generation_;
+  /// True while run() is active
+  bool busy_;
+  bool stop_;
+  int numberWorkers_;
+  /// Do pieces in slot (and steal more) until none left
+  void work(int which);
+  /// Move half of largest other share to slot - false if none left
+  bool steal(int which);
+};
+
+void
+CoinThreadPoolData::work(int which)
+{
+  CoinThreadSlot & slot = slots_[which];
+  while (true) {
+    pthread_mutex_lock(&slot.mutex_);
+    int piece = -1;
+    if (slot.begin_<slot.end_)
+      piece = slot.begin_++;
+    pthread_mutex_unlock(&slot.mutex_);
+    if (piece>=0)
+      task_->runOnThread(piece,which);
+    else if (!steal(which))
+      break;
+  }
+}
+
+bool
+CoinThreadPoolData::steal(int which)
+{
+  while (true) {
+    // find largest share (may change before locked)
+    int victim = -1;
+    int most = 0;
+    for (int i=0;i<participants_;i++) {
+      if (i==which)
+	continue;
+      CoinThreadSlot & slot = slots_[i];
+      pthread_mutex_lock(&slot.mutex_);
+      int left = slot.end_-slot.begin_;
+      pthread_mutex_unlock(&slot.mutex_);
+      if (left>most) {
+	most = left;
+	victim = i;
+      }
+    }
+    if (victim<0)
+      return false;
+    CoinThreadSlot & slot = slots_[victim];
+    pthread_mutex_lock(&slot.mutex_);
+    int left = slot.end_-slot.begin_;
+    int take = (left+1)>>1;
+    int from = slot.end_-take;
+    if (take>0)
+      slot.end_ = from;
+    pthread_mutex_unlock(&slot.mutex_);
+    if (take>0) {
+      CoinThreadSlot & mine = slots_[which];
+      pthread_mutex_lock(&mine.mutex_);
+      mine.begin_ = from;
+      mine.end_ = from+take;
+      mine.steals_++;
+      pthread_mutex_unlock(&mine.mutex_);
+      return true;
+    }
+  }
+}
+
+extern "C" {
+  static void * coinThreadPoolWorker(void * arg)
+  {
+    CoinThreadWorker * worker = static_cast<CoinThreadWorker *>(arg);
+    CoinThreadPoolData * data = worker->data_;
+    unsigned int seen = 0;
+    pthread_mutex_lock(&data->mutex_);
+    while (true) {
+      while (data->generation_==seen&&!data->stop_)
+	pthread_cond_wait(&data->start_,&data->mutex_);
+      if (data->stop_)
+	break;
+      seen = data->generation_;
+      if (worker->which_>=data->participants_)
+	continue; // not needed this time
+      pthread_mutex_unlock(&data->mutex_);
+      data->work(worker->which_);
+      pthread_mutex_lock(&data->mutex_);
+      if (!--data->active_)
+	pthread_cond_signal(&data->done_);
+    }
+    pthread_mutex_unlock(&data->mutex_);
+    return NULL;
+  }
+}
+#else
+class CoinThreadPoolData {
+};
+#endif
+
+//#############################################################################
+
+int
+CoinThreadPool::numberProcessors()
+{
+#ifdef _SC_NPROCESSORS_ONLN
+  long n = sysconf(_SC_NPROCESSORS_ONLN);
+  if (n>1)
+    return static_cast<int>(n);
+#endif
+  return 1;
+}
+
+CoinThreadPool::CoinThreadPool(int numberThreads)
+  : numberThreads_(1),
+    data_(NULL)
+{
+#ifdef COIN_THREAD_POOL_PTHREADS
+  if (numberThreads<=0)
+    numberThreads = numberProcessors();
+  if (numberThreads>1) {
+    data_ = new CoinThreadPoolData;
+    data_->threads_ = new pthread_t [numberThreads-1];
+    data_->workers_ = new CoinThreadWorker [numberThreads-1];
+    data_->slots_ = new CoinThreadSlot [numberThreads];
+    for (int i=0;i<numberThreads;i++) {
+      pthread_mutex_init(&data_->slots_[i].mutex_,NULL);
+      data_->slots_[i].begin_ = 0;
+      data_->slots_[i].end_ = 0;
+      data_->slots_[i].steals_ = 0;
+    }
+    pthread_mutex_init(&data_->mutex_,NULL);
+    pthread_cond_init(&data_->start_,NULL);
+    pthread_cond_init(&data_->done_,NULL);
+    data_->task_ = NULL;
+    data_->participants_ = 0;
+    data_->active_ = 0;
+    data_->generation_ = 0;
+    data_->busy_ = false;
+    data_->stop_ = false;
+    int n = 0;
+    for (int i=0;i<numberThreads-1;i++) {
+      data_->workers_[n].data_ = data_;
+      data_->workers_[n].which_ = n+1;
+      if (pthread_create(data_->threads_+n,NULL,coinThreadPoolWorker,
+			 data_->workers_+n))
+	break;
+      n++;
+    }
+    data_->numberWorkers_ = n;
+    numberThreads_ = n+1;
+  }
+#else
+  // no threads - always serial
+  (void) numberThreads;
+#endif
+}
+
+CoinThreadPool::~CoinThreadPool()
+{
+#ifdef COIN_THREAD_POOL_PTHREADS
+  if (data_) {
+    pthread_mutex_lock(&data_->mutex_);
+    data_->stop_ = true;
+    pthread_cond_broadcast(&data_->start_);
+    pthread_mutex_unlock(&data_->mutex_);
+    for (int i=0;i<data_->numberWorkers_;i++)
+      pthread_join(data_->threads_[i],NULL);
+    pthread_cond_destroy(&data_->done_);
+    pthread_cond_destroy(&data_->start_);
+    pthread_mutex_destroy(&data_->mutex_);
+    for (int i=0;i<=data_->numberWorkers_;i++)
+      pthread_mutex_destroy(&data_->slots_[i].mutex_);
+    delete [] data_->slots_;
+    delete [] data_->workers_;
+    delete [] data_->threads_;
+  }
+#endif
+  if (coinDefaultPool==this)
+    coinDefaultPool = NULL;
+  delete data_;
+}
+
+// Call task.run(i) for i=0..number-1 and wait until all are done
+void
+CoinThreadPool::run(CoinThreadTask & task, int number)
+{
+#ifdef COIN_THREAD_POOL_PTHREADS
+  if (data_&&number>1) {
+    pthread_mutex_lock(&data_->mutex_);
+    if (!data_->busy_) {
+      data_->busy_ = true;
+      pthread_mutex_unlock(&data_->mutex_);
+      // get helpers allowed by concurrency limit
+      int helpers = data_->numberWorkers_;
+      if (helpers>number-1)
+	helpers = number-1;
+      pthread_mutex_lock(&coinConcurrencyMutex);
+      if (coinConcurrencyLimit>0) {
+	int allowed = coinConcurrencyLimit-coinThreadsInUse-1;
+	if (helpers>allowed)
+	  helpers = allowed>0 ? allowed : 0;
+      }
+      coinThreadsInUse += helpers+1;
+      pthread_mutex_unlock(&coinConcurrencyMutex);
+      if (helpers) {
+	// share out pieces evenly
+	int participants = helpers+1;
+	for (int i=0;i<participants;i++) {
+	  CoinThreadSlot & slot = data_->slots_[i];
+	  slot.begin_ = static_cast<int>
+	    ((static_cast<CoinInt64>(number)*i)/participants);
+	  slot.end_ = static_cast<int>
+	    ((static_cast<CoinInt64>(number)*(i+1))/participants);
+	}
+	pthread_mutex_lock(&data_->mutex_);
+	data_->task_ = &task;
+	data_->participants_ = participants;
+	data_->active_ = helpers;
+	data_->generation_++;
+	pthread_cond_broadcast(&data_->start_);
+	pthread_mutex_unlock(&data_->mutex_);
+	data_->work(0);
+	pthread_mutex_lock(&data_->mutex_);
+	while (data_->active_)
+	  pthread_cond_wait(&data_->done_,&data_->mutex_);
+	data_->task_ = NULL;
+	pthread_mutex_unlock(&data_->mutex_);
+      } else {
+	for (int i=0;i<number;i++)
+	  task.runOnThread(i,0);
+      }
+      pthread_mutex_lock(&coinConcurrencyMutex);
+      coinThreadsInUse -= helpers+1;
+      pthread_mutex_unlock(&coinConcurrencyMutex);
+      pthread_mutex_lock(&data_->mutex_);
+      data_->busy_ = false;
+      pthread_mutex_unlock(&data_->mutex_);
+      return;
+    }
+    // called from inside a task
+    pthread_mutex_unlock(&data_->mutex_);
+  }
+#endif
+  // serial - one at a time so all on thread 0 (even if nested)
+  for (int i=0;i<number;i++)
+    task.runOnThread(i,0);
+}
+
+//#############################################################################
+
+// Does range task a grain at a time
+class CoinThreadRangePieces : public CoinThreadTask {
+public:
+  CoinThreadRangeTask * task_;
+  int begin_;
+  int end_;
+  int grain_;
+  virtual void run(int which)
+  {
+    CoinInt64 begin = begin_+static_cast<CoinInt64>(which)*grain_;
+    CoinInt64 end = begin+grain_;
+    if (end>end_)
+      end = end_;
+    task_->run(static_cast<int>(begin),static_cast<int>(end));
+  }
+};
+
+// Does reduce task a grain at a time saving sums
+class CoinThreadReducePieces : public CoinThreadTask {
+public:
+  CoinThreadReduceTask * task_;
+  double * sum_;
+  int begin_;
+  int end_;
+  int grain_;
+  virtual void run(int which)
+  {
+    CoinInt64 begin = begin_+static_cast<CoinInt64>(which)*grain_;
+    CoinInt64 end = begin+grain_;
+    if (end>end_)
+      end = end_;
+    sum_[which] = task_->run(static_cast<int>(begin),static_cast<int>(end));
+  }
+};
+
+// Call task.run(b,e) for ranges covering begin..end-1
+void
+CoinThreadPool::parallelFor(CoinThreadRangeTask & task, int begin, int end,
+			    int grain)
+{
+  if (end<=begin)
+    return;
+  CoinInt64 n = static_cast<CoinInt64>(end)-begin;
+  if (grain<=0) {
+    if (numberThreads_==1) {
+      task.run(begin,end);
+      return;
+    }
+    CoinInt64 pieces = 4*numberThreads_;
+    grain = static_cast<int>((n+pieces-1)/pieces);
+  }
+  CoinThreadRangePieces pieces;
+  pieces.task_ = &task;
+  pieces.begin_ = begin;
+  pieces.end_ = end;
+  pieces.grain_ = grain;
+  run(pieces,static_cast<int>((n+grain-1)/grain));
+}
+
+// Sum of task.run(b,e) over ranges covering begin..end-1
+double
+CoinThreadPool::parallelSum(CoinThreadReduceTask & task, int begin, int end,
+			    int grain)
+{
+  if (end<=begin)
+    return 0.0;
+  CoinInt64 n = static_cast<CoinInt64>(end)-begin;
+  if (grain<=0)
+    grain = static_cast<int>((n+COIN_THREAD_POOL_REDUCE_PIECES-1)/
+			     COIN_THREAD_POOL_REDUCE_PIECES);
+  int number = static_cast<int>((n+grain-1)/grain);
+  double * sum = new double [number];
+  CoinThreadReducePieces pieces;
+  pieces.task_ = &task;
+  pieces.sum_ = sum;
+  pieces.begin_ = begin;
+  pieces.end_ = end;
+  pieces.grain_ = grain;
+  run(pieces,number);
+  // add in fixed order
+  double total = 0.0;
+  for (int i=0;i<number;i++)
+    total += sum[i];
+  delete [] sum;
+  return total;
+}
+
+// Number of times a thread took work from another
+int
+CoinThreadPool::numberSteals() const
+{
+  int n = 0;
+#ifdef COIN_THREAD_POOL_PTHREADS
+  if (data_) {
+    for (int i=0;i<numberThreads_;i++) {
+      pthread_mutex_lock(&data_->slots_[i].mutex_);
+      n += data_->slots_[i].steals_;
+      pthread_mutex_unlock(&data_->slots_[i].mutex_);
+    }
+  }
+#endif
+  return n;
+}
+
+//#############################################################################
+
+void
+CoinThreadPool::setConcurrencyLimit(int limit)
+{
+#ifdef COIN_THREAD_POOL_PTHREADS
+  pthread_mutex_lock(&coinConcurrencyMutex);
+#endif
+  coinConcurrencyLimit = limit>0 ? limit : 0;
+#ifdef COIN_THREAD_POOL_PTHREADS
+  pthread_mutex_unlock(&coinConcurrencyMutex);
+#endif
+}
+
+int
+CoinThreadPool::concurrencyLimit()
+{
+#ifdef COIN_THREAD_POOL_PTHREADS
+  pthread_mutex_lock(&coinConcurrencyMutex);
+  int limit = coinConcurrencyLimit;
+  pthread_mutex_unlock(&coinConcurrencyMutex);
+  return limit;
+#else
+  return coinConcurrencyLimit;
+#endif
+}
+
+int
+CoinThreadPool::threadsInUse()
+{
+#ifdef COIN_THREAD_POOL_PTHREADS
+  pthread_mutex_lock(&coinConcurrencyMutex);
+  int n = coinThreadsInUse;
+  pthread_mutex_unlock(&coinConcurrencyMutex);
+  return n;
+#else
+  return 0;
+#endif
+}
+
+void
+CoinThreadPool::setDefaultPool(CoinThreadPool * pool)
+{
+  coinDefaultPool = pool;
+}
+
+CoinThreadPool *
+CoinThreadPool::defaultPool()
+{
+  return coinDefaultPool;
+}
+
+CoinThreadPool *
+CoinThreadPool::defaultPoolFor(CoinBigIndex work, CoinBigIndex minimum)
+{
+  CoinThreadPool * pool = coinDefaultPool;
+  if (pool&&pool->numberThreads_>1&&work>=minimum)
+    return pool;
+  return NULL;
+}
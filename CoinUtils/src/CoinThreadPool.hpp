@@ -0,0 +1,157 @@
+/* $Id$ */
+// Copyright (C) 2012, International Business Machines
+// Corporation and others.  All Rights Reserved.
+// This code is licensed under the terms of the Eclipse Public License (EPL).
+
+#ifndef CoinThreadPool_H
+#define CoinThreadPool_H
+
+#include "CoinUtilsConfig.h"
+#include "CoinTypes.hpp"
+
+/* Threads in CoinUtils.
+
+   CoinThreadPool keeps worker threads waiting for work.  Work is a
+   CoinThreadTask (pieces 0..n-1), a CoinThreadRangeTask (ranges of
+   indices) or a CoinThreadReduceTask (ranges whose results are added in
+   a fixed order).  Nothing in the library starts threads of its own.
+
+   Library code finds a pool in one of two ways:
+   - CoinPartitionedVector uses the pool given by setThreadPool(), as its
+     partitions are set up by the caller for one solve.
+   - Everything else (CoinPackedMatrix, CoinSellSlices, scaling,
+     ordering, products and fingerprints) asks defaultPoolFor() with the
+     amount of work and its own threshold, and runs serially if no
+     default pool is set or the work is small.
+   Results never depend on the number of threads.
+*/
+
+/** Work given to CoinThreadPool.
+
+    run(which) is called once for each of which=0..number-1, possibly
+    at the same time from different threads.  The pool actually calls
+    runOnThread(which,thread), which a task can override to keep work
+    space for each thread instead of for each piece.
+*/
+class CoinThreadTask {
+public:
+  virtual ~CoinThreadTask() {}
+  /// Do piece \p which of the work
+  virtual void run(int which) = 0;
+  /** Do piece \p which on \p thread (0 for the caller, less than
+      CoinThreadPool::numberThreads()).  Pieces with the same thread
+      never run at the same time.  Default just calls run(which). */
+  virtual void runOnThread(int which, int /*thread*/)
+  { run(which); }
+};
+
+/** Work given to CoinThreadPool::parallelFor.
+
+    run(begin,end) is called for consecutive ranges covering the whole
+    range asked for, possibly at the same time from different threads.
+*/
+class CoinThreadRangeTask {
+public:
+  virtual ~CoinThreadRangeTask() {}
+  /// Do indices begin..end-1
+  virtual void run(int begin, int end) = 0;
+};
+
+/** Work given to CoinThreadPool::parallelSum.
+
+    run(begin,end) returns the contribution of indices begin..end-1.
+*/
+class CoinThreadReduceTask {
+public:
+  virtual ~CoinThreadReduceTask() {}
+  /// Sum over indices begin..end-1
+  virtual double run(int begin, int end) = 0;
+};
+
+class CoinThreadPoolData;
+
+/** A set of worker threads kept waiting for work.
+
+    Threads are only started if CoinUtils was configured with
+    --enable-coinutils-threads (COINUTILS_PTHREADS); otherwise, or if one
+    thread is asked for, run() just does the pieces in order.  The thread
+    calling run() takes part in the work.  run() may not be called again
+    from inside a task (it then runs serially).
+
+    The pieces of a run() are first split evenly between the threads
+    taking part; a thread which finishes its share steals half of what
+    is left of the largest other share, so uneven pieces still balance.
+
+    The number of threads working on pool tasks at once, over all pools,
+    can be limited by setConcurrencyLimit(); a run() then uses fewer
+    threads rather than waiting.  Library code which can use threads
+    (e.g. CoinPackedMatrix::timesMinor) uses defaultPool() if one is set.
+    setDefaultPool() should be called before other threads use the
+    library.
+*/
+class CoinThreadPool {
+public:
+  /**@name Constructors and destructor */
+  //@{
+  /** Constructor - numberThreads includes the calling thread.
+      0 means number of processors. */
+  CoinThreadPool(int numberThreads = 0);
+  /// Destructor - stops threads
+  ~CoinThreadPool();
+  //@}
+
+  /**@name Running work */
+  //@{
+  /// Number of threads (including caller) which may run tasks
+  inline int numberThreads() const
+  { return numberThreads_; }
+  /// Call task.run(i) for i=0..number-1 and wait until all are done
+  void run(CoinThreadTask & task, int number);
+  /** Call task.run(b,e) for ranges of at most grain indices covering
+      begin..end-1.  grain 0 gives a few ranges for each thread. */
+  void parallelFor(CoinThreadRangeTask & task, int begin, int end,
+		   int grain = 0);
+  /** Sum of task.run(b,e) over ranges of grain indices covering
+      begin..end-1.  The ranges and the order they are added in only
+      depend on begin, end and grain, so the result is the same for any
+      number of threads.  grain 0 gives at most 64 ranges. */
+  double parallelSum(CoinThreadReduceTask & task, int begin, int end,
+		     int grain = 0);
+  /// Number of times a thread took work from another (since constructed)
+  int numberSteals() const;
+  /// Number of processors (1 if not known)
+  static int numberProcessors();
+  //@}
+
+  /**@name Sharing between pools */
+  //@{
+  /** Limit threads (including callers) working on pool tasks at once
+      over all pools - 0 for no limit */
+  static void setConcurrencyLimit(int limit);
+  /// Limit on threads working on pool tasks (0 if none)
+  static int concurrencyLimit();
+  /// Number of threads working on pool tasks now
+  static int threadsInUse();
+  /** Set pool used by library code (NULL for serial).  The caller
+      keeps ownership. */
+  static void setDefaultPool(CoinThreadPool * pool);
+  /// Pool used by library code (NULL if none)
+  static CoinThreadPool * defaultPool();
+  /** Default pool if it has more than one thread and work is at least
+      minimum, otherwise NULL (do it serially) */
+  static CoinThreadPool * defaultPoolFor(CoinBigIndex work,
+					 CoinBigIndex minimum);
+  //@}
+
+private:
+  /// Not copyable
+  CoinThreadPool(const CoinThreadPool &);
+  CoinThreadPool & operator=(const CoinThreadPool &);
+
+  /// Number of threads including caller
+  int numberThreads_;
+  /// Threads, locks etc (NULL if serial)
+  CoinThreadPoolData * data_;
+};
+
+#endif
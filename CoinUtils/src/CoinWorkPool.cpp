@@ -0,0 +1,330 @@
+/* $Id$ */
+// Copyright (C) 2012, International Business Machines
+// Corporation and others.  All Rights Reserved.
+// This code is licensed under the terms of the Eclipse Public License (EPL).
+
+#include <cassert>
+#include <cstring>
+#ifndef _MSC_VER
+#include <stdint.h>
+#endif
+
+#include "CoinWorkPool.hpp"
+#include "CoinFinite.hpp"
+#include "CoinHelperFunctions.hpp"
+
+#if defined(COINUTILS_PTHREADS) && (COINUTILS_PTHREADS == 1)
+#include <pthread.h>
+#define COIN_WORK_POOL_PTHREADS 1
+#endif
+
+//#############################################################################
+
+// Smallest region is 1<<COIN_WORK_POOL_SHIFT bytes
+#define COIN_WORK_POOL_SHIFT 6
+#define COIN_WORK_POOL_CLASSES 25
+#define COIN_WORK_POOL_ALIGN 64
+
+/* Regions are aligned on 64 bytes with a header just in front giving the
+   block to delete, the size class (-1 if not pooled), how many bytes
+   at start may be nonzero and how many were asked for at checkOut. */
+namespace {
+  struct CoinWorkPoolHeader {
+    char * block;
+    int sizeClass;
+    int capacity;
+    int dirty;
+    int used;
+  };
+  inline CoinWorkPoolHeader * coinWorkPoolHeader(const char * region)
+  {
+    return reinterpret_cast<CoinWorkPoolHeader *>
+      (const_cast<char *>(region)-sizeof(CoinWorkPoolHeader));
+  }
+}
+
+static char *
+coinWorkPoolAllocate(int capacity, int sizeClass)
+{
+  char * block = new char [capacity+2*COIN_WORK_POOL_ALIGN];
+  CoinInt64 xx = reinterpret_cast<CoinInt64>(block+COIN_WORK_POOL_ALIGN);
+  int iBottom = static_cast<int>(xx & (COIN_WORK_POOL_ALIGN-1));
+  char * region = block+COIN_WORK_POOL_ALIGN;
+  if (iBottom)
+    region += COIN_WORK_POOL_ALIGN-iBottom;
+  CoinWorkPoolHeader * header = coinWorkPoolHeader(region);
+  header->block = block;
+  header->sizeClass = sizeClass;
+  header->capacity = capacity;
+  header->dirty = capacity;
+  header->used = capacity;
+  return region;
+}
+
+static inline void
+coinWorkPoolFree(char * region)
+{
+  delete [] coinWorkPoolHeader(region)->block;
+}
+
+//#############################################################################
+// Pool for each thread
+//#############################################################################
+
+#ifdef COIN_WORK_POOL_PTHREADS
+static pthread_key_t coinWorkPoolKey;
+static pthread_once_t coinWorkPoolOnce = PTHREAD_ONCE_INIT;
+extern "C" {
+  static void coinWorkPoolDelete(void * pool)
+  {
+    delete static_cast<CoinWorkPool *>(pool);
+  }
+  static void coinWorkPoolMakeKey()
+  {
+    pthread_key_create(&coinWorkPoolKey,coinWorkPoolDelete);
+  }
+}
+static inline CoinWorkPool *
+coinWorkPoolCurrent()
+{
+  pthread_once(&coinWorkPoolOnce,coinWorkPoolMakeKey);
+  return static_cast<CoinWorkPool *>(pthread_getspecific(coinWorkPoolKey));
+}
+static inline void
+coinWorkPoolSetCurrent(CoinWorkPool * pool)
+{
+  pthread_setspecific(coinWorkPoolKey,pool);
+}
+#elif __cplusplus >= 201103L
+// Pool deleted when thread ends
+namespace {
+  struct CoinWorkPoolHolder {
+    CoinWorkPool * pool;
+    ~CoinWorkPoolHolder() { delete pool; }
+  };
+}
+static thread_local CoinWorkPoolHolder coinWorkPoolHolder = { NULL };
+static inline CoinWorkPool *
+coinWorkPoolCurrent()
+{
+  return coinWorkPoolHolder.pool;
+}
+static inline void
+coinWorkPoolSetCurrent(CoinWorkPool * pool)
+{
+  coinWorkPoolHolder.pool = pool;
+}
+#else
+/* No way of having a pool per thread - one global pool would be shared
+   by all threads without locking, so pool is never made active. */
+#define COIN_WORK_POOL_DISABLED 1
+static CoinWorkPool * coinWorkPoolPointer = NULL;
+static inline CoinWorkPool *
+coinWorkPoolCurrent()
+{
+  return coinWorkPoolPointer;
+}
+static inline void
+coinWorkPoolSetCurrent(CoinWorkPool * pool)
+{
+  coinWorkPoolPointer = pool;
+}
+#endif
+
+CoinWorkPool *
+CoinWorkPool::threadPool()
+{
+  CoinWorkPool * pool = coinWorkPoolCurrent();
+  if (!pool) {
+    pool = new CoinWorkPool();
+    coinWorkPoolSetCurrent(pool);
+  }
+  return pool;
+}
+
+bool
+CoinWorkPool::active()
+{
+  CoinWorkPool * pool = coinWorkPoolCurrent();
+  return pool&&pool->active_;
+}
+
+void
+CoinWorkPool::setActive(bool yesNo)
+{
+  CoinWorkPool * pool = threadPool();
+#ifdef COIN_WORK_POOL_DISABLED
+  yesNo = false;
+#endif
+  pool->active_ = yesNo;
+  if (!yesNo)
+    pool->trim();
+}
+
+void
+CoinWorkPool::release(char * region, int dirtyBytes)
+{
+  if (region) {
+    CoinWorkPool * pool = coinWorkPoolCurrent();
+    if (pool&&pool->active_)
+      pool->checkIn(region,dirtyBytes);
+    else
+      coinWorkPoolFree(region);
+  }
+}
+
+//#############################################################################
+
+CoinWorkPool::CoinWorkPool()
+  : active_(false),
+    maximumCached_(16),
+    cached_(COIN_WORK_POOL_CLASSES),
+    checkOuts_(COIN_WORK_POOL_CLASSES+1),
+    hits_(COIN_WORK_POOL_CLASSES+1)
+{
+}
+
+CoinWorkPool::~CoinWorkPool()
+{
+  trim();
+  if (coinWorkPoolCurrent()==this)
+    coinWorkPoolSetCurrent(NULL);
+}
+
+int
+CoinWorkPool::numberClasses()
+{
+  return COIN_WORK_POOL_CLASSES;
+}
+
+int
+CoinWorkPool::sizeClass(int numberBytes)
+{
+  int k = 0;
+  int size = 1<<COIN_WORK_POOL_SHIFT;
+  while (size<numberBytes) {
+    k++;
+    if (k==COIN_WORK_POOL_CLASSES)
+      return -1;
+    size <<= 1;
+  }
+  return k;
+}
+
+// Get region with bytes from zeroFrom on zero
+char *
+CoinWorkPool::checkOut(int numberBytes, int zeroFrom)
+{
+  int k = sizeClass(numberBytes);
+  char * region;
+  if (k>=0) {
+    checkOuts_[k]++;
+    if (!cached_[k].empty()) {
+      hits_[k]++;
+      region = cached_[k].back();
+      cached_[k].pop_back();
+    } else {
+      region = coinWorkPoolAllocate(1<<(k+COIN_WORK_POOL_SHIFT),k);
+    }
+  } else {
+    checkOuts_[COIN_WORK_POOL_CLASSES]++;
+    region = coinWorkPoolAllocate(numberBytes,-1);
+  }
+  CoinWorkPoolHeader * header = coinWorkPoolHeader(region);
+  zeroFrom = CoinMax(zeroFrom,0);
+  if (header->dirty>zeroFrom)
+    memset(region+zeroFrom,0,header->dirty-zeroFrom);
+  header->dirty = CoinMin(header->dirty,zeroFrom);
+  header->used = numberBytes;
+  return region;
+}
+
+// Return region
+void
+CoinWorkPool::checkIn(char * region, int dirtyBytes)
+{
+  CoinWorkPoolHeader * header = coinWorkPoolHeader(region);
+  int k = header->sizeClass;
+  dirtyBytes = CoinMin(CoinMax(dirtyBytes,0),header->capacity);
+#ifndef NDEBUG
+  for (int i=dirtyBytes;i<header->capacity;i++)
+    assert (!region[i]);
+#endif
+  if (k>=0&&static_cast<int>(cached_[k].size())<maximumCached_) {
+    header->dirty = dirtyBytes;
+    cached_[k].push_back(region);
+  } else {
+    coinWorkPoolFree(region);
+  }
+}
+
+int
+CoinWorkPool::capacity(const char * region)
+{
+  return coinWorkPoolHeader(region)->capacity;
+}
+
+int
+CoinWorkPool::used(const char * region)
+{
+  return coinWorkPoolHeader(region)->used;
+}
+
+void
+CoinWorkPool::trim()
+{
+  for (int k=0;k<COIN_WORK_POOL_CLASSES;k++) {
+    for (size_t i=0;i<cached_[k].size();i++)
+      coinWorkPoolFree(cached_[k][i]);
+    cached_[k].clear();
+  }
+}
+
+CoinInt64
+CoinWorkPool::numberCheckOuts(int whichClass) const
+{
+  if (whichClass>=0)
+    return checkOuts_[whichClass];
+  CoinInt64 n = 0;
+  for (size_t k=0;k<checkOuts_.size();k++)
+    n += checkOuts_[k];
+  return n;
+}
+
+CoinInt64
+CoinWorkPool::numberHits(int whichClass) const
+{
+  if (whichClass>=0)
+    return hits_[whichClass];
+  CoinInt64 n = 0;
+  for (size_t k=0;k<hits_.size();k++)
+    n += hits_[k];
+  return n;
+}
+
+int
+CoinWorkPool::numberCached() const
+{
+  int n = 0;
+  for (int k=0;k<COIN_WORK_POOL_CLASSES;k++)
+    n += static_cast<int>(cached_[k].size());
+  return n;
+}
+
+CoinInt64
+CoinWorkPool::bytesCached() const
+{
+  CoinInt64 n = 0;
+  for (int k=0;k<COIN_WORK_POOL_CLASSES;k++)
+    n += static_cast<CoinInt64>(cached_[k].size())<<(k+COIN_WORK_POOL_SHIFT);
+  return n;
+}
+
+void
+CoinWorkPool::resetCounts()
+{
+  for (size_t k=0;k<checkOuts_.size();k++) {
+    checkOuts_[k] = 0;
+    hits_[k] = 0;
+  }
+}
@@ -0,0 +1,113 @@
+/* $Id$ */
+// Copyright (C) 2012, International Business Machines
+// Corporation and others.  All Rights Reserved.
+// This code is licensed under the terms of the Eclipse Public License (EPL).
+
+#ifndef CoinWorkPool_H
+#define CoinWorkPool_H
+
+#include <vector>
+#ifndef _MSC_VER
+#include <stdint.h>
+#endif
+
+#include "CoinUtilsConfig.h"
+#include "CoinTypes.hpp"
+
+/** Per thread pool of work regions.
+
+    Each thread has its own pool (so no locking) holding regions whose
+    sizes are powers of two from 64 bytes to 1Gb.  Regions are aligned on
+    64 bytes.  A region remembers how much of its start may be nonzero so
+    that on checkOut only the part the caller needs zeroed and is not
+    already zero is cleared.  Used the same way each iteration this gives
+    no allocation and no memset.
+
+    If active() is true for a thread, CoinIndexedVector::reserve and
+    CoinArrayWithLength take their arrays from the pool and give them back
+    when freed.  A CoinIndexedVector gives back its elements zeroed (and
+    checks that with checkClear() in a debug build).  Arrays from the pool
+    must not be swapped with ordinary arrays through setDenseVector or
+    setIndexVector except very temporarily.
+
+    Pools are per thread through pthreads or C++11 thread_local.  Without
+    either the pool is never active (setActive(true) is ignored).
+*/
+class CoinWorkPool {
+public:
+  /**@name Pool of calling thread */
+  //@{
+  /// Pool for calling thread (created if needed)
+  static CoinWorkPool * threadPool();
+  /// True if vectors and arrays in calling thread use pool
+  static bool active();
+  /// Switch use of pool on or off for calling thread (off also trims)
+  static void setActive(bool yesNo);
+  /** Give region back to pool of calling thread, or free it if pool not
+      active.  See checkIn. */
+  static void release(char * region, int dirtyBytes);
+  //@}
+
+  /**@name Regions */
+  //@{
+  /** Get region of at least numberBytes.  Bytes from zeroFrom to end of
+      region are zero. */
+  char * checkOut(int numberBytes, int zeroFrom = 0);
+  /** Return region.  Only first dirtyBytes may be nonzero (all of rest of
+      region must be zero - checked in debug build). */
+  void checkIn(char * region, int dirtyBytes);
+  /// Usable size of region in bytes
+  static int capacity(const char * region);
+  /** Bytes asked for when region was checked out.  A caller which does
+      not know how much it wrote can give this as dirtyBytes. */
+  static int used(const char * region);
+  /// Free all regions held
+  void trim();
+  /// Maximum number of regions held for each size
+  inline int maximumCached() const
+  { return maximumCached_; }
+  /// Set maximum number of regions held for each size
+  inline void setMaximumCached(int value)
+  { maximumCached_ = value; }
+  //@}
+
+  /**@name Statistics */
+  //@{
+  /// Number of size classes
+  static int numberClasses();
+  /// Size class of a request (-1 if too big to pool)
+  static int sizeClass(int numberBytes);
+  /// Number of checkOuts (for a class or all if -1)
+  CoinInt64 numberCheckOuts(int whichClass = -1) const;
+  /// Number of checkOuts served from pool (for a class or all if -1)
+  CoinInt64 numberHits(int whichClass = -1) const;
+  /// Number of regions held
+  int numberCached() const;
+  /// Bytes held
+  CoinInt64 bytesCached() const;
+  /// Set counts to zero
+  void resetCounts();
+  //@}
+
+  /// Destructor - frees regions (called when thread ends)
+  ~CoinWorkPool();
+
+private:
+  /// Constructor - use threadPool()
+  CoinWorkPool();
+  CoinWorkPool(const CoinWorkPool &);
+  CoinWorkPool & operator=(const CoinWorkPool &);
+
+  /// True if pool in use
+  bool active_;
+  /// Maximum number of regions held for each size
+  int maximumCached_;
+  /// Regions held for each size
+  std::vector<std::vector<char *> > cached_;
+  /// CheckOuts for each size
+  std::vector<CoinInt64> checkOuts_;
+  /// Hits for each size
+  std::vector<CoinInt64> hits_;
+};
+
+#endif
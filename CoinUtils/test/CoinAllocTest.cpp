@@ -0,0 +1,158 @@
+// Copyright (C) 2012, International Business Machines
+// Corporation and others.  All Rights Reserved.
+// This code is licensed under the terms of the Eclipse Public License (EPL).
+
+#ifdef NDEBUG
+#undef NDEBUG
+#endif
+
+#include <cassert>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#include "CoinAlloc.hpp"
+#include "CoinThreadPool.hpp"
+#include "CoinTime.hpp"
+#include "CoinTestTiming.hpp"
+
+//#############################################################################
+
+// Number of blocks each piece allocates
+#define COIN_ALLOC_TEST_BLOCKS 1000
+
+/* Each piece allocates blocks of mixed sizes and frees most of them,
+   then in a second pass (probably in another thread) frees the rest. */
+class CoinAllocTestTask : public CoinThreadTask {
+public:
+  CoinAlloc * allocator_;
+  void ** blocks_;
+  int passes_;
+  bool second_;
+  virtual void run(int which)
+  {
+    void ** block = blocks_+which*COIN_ALLOC_TEST_BLOCKS;
+    if (second_) {
+      for (int i=0;i<COIN_ALLOC_TEST_BLOCKS;i++) {
+	if (block[i]) {
+	  assert (*static_cast<int *>(block[i])==which);
+	  if (allocator_)
+	    allocator_->dealloc(block[i]);
+	  else
+	    free(block[i]);
+	  block[i] = NULL;
+	}
+      }
+      return;
+    }
+    unsigned int seed = 12345+which;
+    for (int pass=0;pass<passes_;pass++) {
+      for (int i=0;i<COIN_ALLOC_TEST_BLOCKS;i++) {
+	seed = seed*1103515245+12345;
+	size_t size = 8+((seed>>16)&511);
+	block[i] = allocator_ ? allocator_->alloc(size) : malloc(size);
+	*static_cast<int *>(block[i]) = which;
+      }
+      for (int i=COIN_ALLOC_TEST_BLOCKS-1;i>=0;i--) {
+	// keep a few for second pass
+	if (pass==passes_-1&&(i%10)==0)
+	  continue;
+	if (allocator_)
+	  allocator_->dealloc(block[i]);
+	else
+	  free(block[i]);
+	block[i] = NULL;
+      }
+    }
+  }
+};
+
+void
+CoinAllocUnitTest()
+{
+  {
+    // No pooling
+    CoinAlloc allocator(0);
+    assert( allocator.numberPools() == 0 );
+    char * p = static_cast<char *>(allocator.alloc(100));
+    memset(p,0,100);
+    allocator.dealloc(p);
+    assert( allocator.numberAllocs() == 0 );
+    assert( allocator.trim() == 0 );
+  }
+
+  {
+    // Pooling in one thread
+    CoinAlloc allocator(4096);
+    allocator.setBatchSize(8);
+    assert( allocator.numberPools() == 4096/COINUTILS_MEMPOOL_ALIGNMENT );
+    const int n = 100;
+    char * p[n];
+    for (int i=0;i<n;i++) {
+      p[i] = static_cast<char *>(allocator.alloc(i+1));
+      assert( (reinterpret_cast<CoinInt64>(p[i])&(COINUTILS_MEMPOOL_ALIGNMENT-1)) == 0 );
+      memset(p[i],i,i+1);
+    }
+    // big one is not pooled
+    char * big = static_cast<char *>(allocator.alloc(10000));
+    assert( allocator.numberAllocs() == n );
+    for (int i=0;i<n;i++) {
+      for (int j=0;j<=i;j++)
+	assert( p[i][j] == static_cast<char>(i) );
+      allocator.dealloc(p[i]);
+    }
+    allocator.dealloc(big);
+    assert( allocator.numberDeallocs() == n );
+    assert( allocator.numberFree() == allocator.numberMalloced() );
+    // same again should all come from cache
+    CoinInt64 nMalloc = allocator.numberMalloced();
+    for (int i=0;i<n;i++)
+      p[i] = static_cast<char *>(allocator.alloc(i+1));
+    for (int i=0;i<n;i++)
+      allocator.dealloc(p[i]);
+    assert( allocator.numberMalloced() == nMalloc );
+    // many of one size - some passed to shared pool
+    char * q[50];
+    for (int i=0;i<50;i++)
+      q[i] = static_cast<char *>(allocator.alloc(24));
+    for (int i=0;i<50;i++)
+      allocator.dealloc(q[i]);
+    CoinInt64 bytes = allocator.bytesFree();
+    assert( bytes > 0 );
+    assert( allocator.trim() == bytes );
+    assert( allocator.numberFree() == 0 );
+    assert( allocator.numberMalloced() == 0 );
+  }
+
+  {
+    // Many threads (compared with malloc if -timing)
+    CoinThreadPool threads(8);
+    CoinAlloc allocator(1024);
+    const int numberPieces = 64;
+    void ** blocks = new void * [numberPieces*COIN_ALLOC_TEST_BLOCKS];
+    CoinAllocTestTask task;
+    task.blocks_ = blocks;
+    task.passes_ = 20;
+    double time[2] = {0.0,0.0};
+    for (int k=coinTestTiming ? 0 : 1;k<2;k++) {
+      task.allocator_ = k ? &allocator : NULL;
+      double start = CoinGetTimeOfDay();
+      task.second_ = false;
+      threads.run(task,numberPieces);
+      task.second_ = true;
+      threads.run(task,numberPieces);
+      time[k] = CoinGetTimeOfDay()-start;
+    }
+    assert( allocator.numberAllocs() == allocator.numberDeallocs() );
+    assert( allocator.numberAllocs() ==
+	    static_cast<CoinInt64>(numberPieces)*task.passes_*COIN_ALLOC_TEST_BLOCKS );
+    if (coinTestTiming) {
+      printf("%d threads - %d allocations malloc %g, CoinAlloc %g seconds\n",
+	     threads.numberThreads(),
+	     numberPieces*task.passes_*COIN_ALLOC_TEST_BLOCKS,time[0],time[1]);
+      allocator.printStatistics();
+    }
+    allocator.trim();
+    delete [] blocks;
+  }
+}
@@ -0,0 +1,169 @@
+// Copyright (C) 2012, International Business Machines
+// Corporation and others.  All Rights Reserved.
+// This code is licensed under the terms of the Eclipse Public License (EPL).
+
+#ifdef NDEBUG
+#undef NDEBUG
+#endif
+
+#include <cassert>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#include "CoinArena.hpp"
+#include "CoinBuild.hpp"
+#include "CoinPresolveMatrix.hpp"
+#include "CoinTime.hpp"
+#include "CoinTestTiming.hpp"
+
+//#############################################################################
+
+void
+CoinArenaUnitTest()
+{
+  {
+    // Basic allocation and alignment
+    CoinArena arena(1024);
+    assert( arena.bytesUsed() == 0 );
+    assert( arena.numberBlocks() == 0 );
+    char * p = static_cast<char *>(arena.allocate(3,1));
+    memset(p,1,3);
+    double * d = arena.allocateArray<double>(10);
+    assert( (reinterpret_cast<size_t>(d)&15) == 0 );
+    for (int i=0;i<10;i++)
+      d[i] = i;
+    char * q = static_cast<char *>(arena.allocate(100,64));
+    assert( (reinterpret_cast<size_t>(q)&63) == 0 );
+    assert( arena.numberBlocks() == 1 );
+    // bigger than a block
+    double * big = arena.allocateArray<double>(1000);
+    assert( arena.numberBlocks() == 2 );
+    assert( arena.bytesReserved() >= 1024+8000 );
+    for (int i=0;i<1000;i++)
+      big[i] = -i;
+    for (int i=0;i<10;i++)
+      assert( d[i] == i );
+    assert( p[2] == 1 );
+    char * s = arena.duplicate("arena");
+    assert( !strcmp(s,"arena") );
+  }
+
+  {
+    // Marks and scopes
+    CoinArena arena(1024);
+    arena.allocate(100);
+    size_t used = arena.bytesUsed();
+    CoinArenaMark mark = arena.mark();
+    for (int i=0;i<100;i++)
+      arena.allocate(200);
+    int numberBlocks = arena.numberBlocks();
+    assert( numberBlocks > 1 );
+    arena.release(mark);
+    assert( arena.bytesUsed() == used );
+    // blocks are reused
+    for (int i=0;i<100;i++)
+      arena.allocate(200);
+    assert( arena.numberBlocks() == numberBlocks );
+    arena.release(mark);
+    {
+      CoinArenaScope scope(arena);
+      int * work = arena.allocateArray<int>(1000);
+      work[999] = 1;
+      assert( arena.bytesUsed() > used );
+    }
+    assert( arena.bytesUsed() == used );
+    arena.trim();
+    assert( arena.numberBlocks() == 1 );
+    arena.reset();
+    assert( arena.bytesUsed() == 0 );
+    arena.trim();
+    assert( arena.numberBlocks() == 0 );
+    assert( arena.bytesReserved() == 0 );
+  }
+
+  {
+    // Reallocation
+    CoinArena arena(1024);
+    int * a = arena.allocateArray<int>(10);
+    for (int i=0;i<10;i++)
+      a[i] = i;
+    // last allocation - extended in place
+    int * b = static_cast<int *>(arena.reallocate(a,10*sizeof(int),
+						  20*sizeof(int)));
+    assert( a == b );
+    arena.allocate(8);
+    // not last - copied
+    int * c = static_cast<int *>(arena.reallocate(b,20*sizeof(int),
+						  1000*sizeof(int)));
+    assert( c != b );
+    for (int i=0;i<10;i++)
+      assert( c[i] == i );
+  }
+
+  {
+    // CoinBuild taking items from arena
+    CoinArena arena;
+    CoinBuild build;
+    build.setArena(&arena);
+    assert( build.arena() == &arena );
+    int indices[3] = {0,2,4};
+    double elements[3] = {1.0,2.0,3.0};
+    for (int i=0;i<100;i++)
+      build.addColumn(3,indices,elements,0.0,10.0,static_cast<double>(i));
+    assert( build.numberColumns() == 100 );
+    assert( arena.bytesUsed() > 0 );
+    const int * ind;
+    const double * els;
+    double lo, up, obj;
+    build.column(99,lo,up,obj,ind,els);
+    assert( obj == 99.0 );
+    assert( ind[2] == 4 && els[2] == 3.0 );
+    // copy does not use arena
+    CoinBuild copy(build);
+    assert( copy.arena() == NULL );
+    copy.column(50,lo,up,obj,ind,els);
+    assert( obj == 50.0 );
+  }
+
+  {
+    // Vectors kept by presolve transforms
+    CoinArena arena;
+    double elems[5] = {1.0,2.0,3.0,4.0,5.0};
+    int indices[5] = {0,3,5,7,9};
+    size_t used = arena.bytesUsed();
+    double * copy = presolve_dupmajor(elems,indices,4,1,5,&arena);
+    assert( arena.bytesUsed() > used );
+    const int * copyIndices = reinterpret_cast<const int *>(copy+3);
+    assert( copy[0] == 2.0 && copy[1] == 4.0 && copy[2] == 5.0 );
+    assert( copyIndices[0] == 3 && copyIndices[1] == 7 &&
+	    copyIndices[2] == 9 );
+  }
+
+  if (coinTestTiming) {
+    // Many small temporaries - compare with malloc
+    const int n = 200000;
+    void ** blocks = new void * [n];
+    double time[2];
+    CoinArena arena;
+    for (int k=0;k<2;k++) {
+      double start = CoinCpuTime();
+      for (int pass=0;pass<10;pass++) {
+	if (k) {
+	  CoinArenaScope scope(arena);
+	  for (int i=0;i<n;i++)
+	    blocks[i] = arena.allocate(8+(i&127));
+	} else {
+	  for (int i=0;i<n;i++)
+	    blocks[i] = malloc(8+(i&127));
+	  for (int i=0;i<n;i++)
+	    free(blocks[i]);
+	}
+      }
+      time[k] = CoinCpuTime()-start;
+    }
+    printf("%d small temporaries - malloc %g, CoinArena %g seconds\n",
+	   10*n,time[0],time[1]);
+    delete [] blocks;
+  }
+}
@@ -0,0 +1,285 @@
+// Copyright (C) 2012, International Business Machines
+// Corporation and others.  All Rights Reserved.
+// This code is licensed under the terms of the Eclipse Public License (EPL).
+
+#ifdef NDEBUG
+#undef NDEBUG
+#endif
+
+#include <cassert>
+#include <cstdio>
+#include <cstring>
+#include <string>
+
+#include "CoinFactorization.hpp"
+#include "CoinIndexedVector.hpp"
+#include "CoinFileIO.hpp"
+#include "CoinMemoryUsage.hpp"
+#include "CoinHelperFunctions.hpp"
+
+//#############################################################################
+
+// Reads whole file into string
+static std::string
+coinFactorizationTestRead(const char * file)
+{
+  std::string contents;
+  FILE * fp = fopen(file,"rb");
+  assert (fp);
+  char buffer[4096];
+  size_t n;
+  while ((n=fread(buffer,1,sizeof(buffer),fp))>0)
+    contents.append(buffer,n);
+  fclose(fp);
+  return contents;
+}
+
+// Writes first n bytes of contents to file
+static void
+coinFactorizationTestWrite(const char * file, const std::string & contents,
+			   size_t n)
+{
+  FILE * fp = fopen(file,"wb");
+  assert (fp);
+  assert (fwrite(contents.data(),1,n,fp)==n);
+  fclose(fp);
+}
+
+// Factorizes sparse matrix with random values and dominant diagonal
+static int
+coinFactorizationTestFactor(CoinFactorization & factorization,
+			    int numberRows, int numberColumns)
+{
+  const int perColumn = 3;
+  int numberElements = 0;
+  int * row = new int [numberColumns*(perColumn+1)];
+  int * column = new int [numberColumns*(perColumn+1)];
+  double * element = new double [numberColumns*(perColumn+1)];
+  CoinSeedRandom(1234567);
+  for (int i=0;i<numberColumns;i++) {
+    if (i<numberRows) {
+      row[numberElements] = i;
+      column[numberElements] = i;
+      element[numberElements++] = 4.0;
+    }
+    // different rows (numberRows at least 50)
+    for (int j=0;j<perColumn;j++) {
+      row[numberElements] = (i+7+12*j)%numberRows;
+      column[numberElements] = i;
+      element[numberElements++] = CoinDrand48()-0.5;
+    }
+  }
+  int * permutation = new int [numberColumns];
+  int returnCode = factorization.factorize(numberRows,numberColumns,
+					   numberElements,3*numberElements,
+					   3*numberElements,row,column,
+					   element,permutation);
+  delete [] row;
+  delete [] column;
+  delete [] element;
+  delete [] permutation;
+  return returnCode;
+}
+
+// Ftran and btran of fixed right hand side
+static void
+coinFactorizationTestSolve(const CoinFactorization & factorization,
+			   double * ftran, double * btran)
+{
+  int numberRows = factorization.numberRows();
+  CoinIndexedVector region(numberRows);
+  CoinIndexedVector rhs(numberRows);
+  for (int i=0;i<numberRows;i++)
+    rhs.insert(i,1.0+(i%7));
+  factorization.updateColumn(&region,&rhs);
+  CoinMemcpyN(rhs.denseVector(),numberRows,ftran);
+  rhs.clear();
+  for (int i=0;i<numberRows;i+=3)
+    rhs.insert(i,1.0-(i%5));
+  factorization.updateColumnTranspose(&region,&rhs);
+  CoinMemcpyN(rhs.denseVector(),numberRows,btran);
+}
+
+// Bytes reserved for firstCount in memory usage report
+static CoinInt64
+coinFactorizationTestFirstCount(const CoinFactorization & factorization)
+{
+  CoinMemoryUsage usage;
+  factorization.memoryUsage(usage);
+  int which = usage.find("firstCount");
+  assert (which>=0);
+  return usage.reserved(which);
+}
+
+//#############################################################################
+
+void
+CoinFactorizationUnitTest()
+{
+  const char * file = "CoinFactorizationTest.chk";
+  const char * file2 = "CoinFactorizationTest2.chk";
+  const char * bad = "CoinFactorizationTestBad.chk";
+  {
+    // Restore into memory
+    const int numberRows = 100;
+    CoinFactorization factorization;
+    assert (!coinFactorizationTestFactor(factorization,numberRows,numberRows));
+    double ftran[numberRows];
+    double btran[numberRows];
+    coinFactorizationTestSolve(factorization,ftran,btran);
+    assert (!factorization.saveFactorization(file));
+    std::string contents = coinFactorizationTestRead(file);
+    CoinFactorization restored;
+    assert (!restored.restoreFactorization(file));
+    assert (!restored.mapped());
+    assert (restored.numberRows()==numberRows);
+    assert (restored.numberElements()==factorization.numberElements());
+    // only used part of areas is saved but space for updates is restored
+    CoinMemoryUsage usage;
+    factorization.memoryUsage(usage);
+    assert (static_cast<CoinInt64>(contents.size())<usage.totalReserved());
+    int which = usage.find("elementU");
+    const CoinInt64 sizeDouble = sizeof(CoinFactorizationDouble);
+    assert (usage.used(which)==factorization.numberElementsU()*sizeDouble);
+    assert (usage.reserved(which)==factorization.lengthAreaU()*sizeDouble);
+    int whichL = usage.find("elementL");
+    assert (usage.used(whichL)==(factorization.numberElementsL()+
+				 factorization.numberElementsR())*sizeDouble);
+    assert (usage.reserved(whichL)==factorization.lengthAreaL()*sizeDouble);
+    int whichPermute = usage.find("permute");
+    assert (usage.used(whichPermute)==usage.reserved(whichPermute));
+    assert (usage.reserved(whichPermute)==
+	    (factorization.maximumRowsExtra()+1)*CoinSizeofAsInt(int));
+    CoinMemoryUsage usage2;
+    restored.memoryUsage(usage2);
+    assert (usage2.reserved(which)==usage.reserved(which));
+    double ftran2[numberRows];
+    double btran2[numberRows];
+    coinFactorizationTestSolve(restored,ftran2,btran2);
+    assert (!memcmp(ftran,ftran2,sizeof(ftran)));
+    assert (!memcmp(btran,btran2,sizeof(btran)));
+    // saving again gives same file
+    assert (!restored.saveFactorization(file2));
+    assert (coinFactorizationTestRead(file2)==contents);
+    // compressed
+    if (CoinFileOutput::compressionSupported(CoinFileOutput::COMPRESS_GZIP)) {
+      assert (!factorization.saveFactorization(file2,1));
+      CoinFactorization unzipped;
+      assert (!unzipped.restoreFactorization(file2));
+      coinFactorizationTestSolve(unzipped,ftran2,btran2);
+      assert (!memcmp(ftran,ftran2,sizeof(ftran)));
+      assert (!memcmp(btran,btran2,sizeof(btran)));
+      // compressed files can not be mapped
+      assert (unzipped.mapFactorization(file2)==3);
+    }
+
+    // Mapped file
+    CoinFactorization mapped;
+    int returnCode = mapped.mapFactorization(file);
+#ifndef _MSC_VER
+    assert (!returnCode);
+    assert (mapped.mapped());
+    coinFactorizationTestSolve(mapped,ftran2,btran2);
+    assert (!memcmp(ftran,ftran2,sizeof(ftran)));
+    assert (!memcmp(btran,btran2,sizeof(btran)));
+    assert (!mapped.saveFactorization(file2));
+    assert (coinFactorizationTestRead(file2)==contents);
+    // copy in arrays and keep going
+    mapped.unmapFactorization(true);
+    assert (!mapped.mapped());
+    coinFactorizationTestSolve(mapped,ftran2,btran2);
+    assert (!memcmp(ftran,ftran2,sizeof(ftran)));
+    // refactorizing drops mapping
+    assert (!mapped.mapFactorization(file));
+    assert (!coinFactorizationTestFactor(mapped,numberRows,numberRows));
+    assert (!mapped.mapped());
+    coinFactorizationTestSolve(mapped,ftran2,btran2);
+    assert (!memcmp(ftran,ftran2,sizeof(ftran)));
+    // mapping is read only so an update copies arrays in first
+    assert (!mapped.mapFactorization(file));
+    {
+      CoinFactorization copy(factorization);
+      CoinIndexedVector region(numberRows);
+      CoinIndexedVector rhs(numberRows);
+      CoinIndexedVector rhs2(numberRows);
+      for (int i=0;i<numberRows;i+=2) {
+	rhs.insert(i,1.0+i);
+	rhs2.insert(i,1.0+i);
+      }
+      copy.updateColumnFT(&region,&rhs);
+      mapped.updateColumnFT(&region,&rhs2);
+      assert (!mapped.mapped());
+      assert (!memcmp(rhs.denseVector(),rhs2.denseVector(),
+		      numberRows*sizeof(double)));
+    }
+#else
+    assert (returnCode==3);
+#endif
+
+    // Wrong version
+    std::string changed = contents;
+    int version = 99;
+    memcpy(&changed[8],&version,sizeof(int));
+    coinFactorizationTestWrite(bad,changed,changed.size());
+    CoinFactorization rejected;
+    assert (rejected.restoreFactorization(bad)==2);
+#ifndef _MSC_VER
+    assert (rejected.mapFactorization(bad)==2);
+#endif
+    // Not a checkpoint
+    changed = contents;
+    changed[0] = 'X';
+    coinFactorizationTestWrite(bad,changed,changed.size());
+    assert (rejected.restoreFactorization(bad)==2);
+    assert (rejected.mapFactorization(bad)==3);
+    // Truncated in header, in table and in last section
+    size_t sizes[3] = {20,300,contents.size()-1};
+    for (int i=0;i<3;i++) {
+      coinFactorizationTestWrite(bad,contents,sizes[i]);
+      assert (rejected.restoreFactorization(bad)==1);
+#ifndef _MSC_VER
+      assert (rejected.mapFactorization(bad)==1);
+      assert (!rejected.mapped());
+#endif
+    }
+    // Scalar changed so L would not fit its area
+    changed = contents;
+    // after header (72 bytes) lengthL is 24th CoinInt64
+    CoinInt64 value = 1<<29;
+    memcpy(&changed[72+23*sizeof(CoinInt64)],&value,sizeof(CoinInt64));
+    coinFactorizationTestWrite(bad,changed,changed.size());
+    assert (rejected.restoreFactorization(bad)==1);
+#ifndef _MSC_VER
+    assert (rejected.mapFactorization(bad)==1);
+    assert (!rejected.mapped());
+#endif
+    // Missing file
+    assert (rejected.restoreFactorization("CoinFactorizationTestNone.chk")==1);
+#ifndef _MSC_VER
+    assert (rejected.mapFactorization("CoinFactorizationTestNone.chk")==1);
+#endif
+  }
+  {
+    /* firstCount is saved with as many entries as getAreas gives it
+       (maximumRowsExtra+1 for a square matrix) */
+    const int numberRows = 60;
+    CoinFactorization factorization;
+    factorization.maximumPivots(5);
+    assert (!coinFactorizationTestFactor(factorization,numberRows,numberRows));
+    CoinInt64 needed = static_cast<CoinInt64>(sizeof(int))*(numberRows+5+1);
+    assert (coinFactorizationTestFirstCount(factorization)==needed);
+    assert (!factorization.saveFactorization(file));
+    CoinFactorization restored;
+    assert (!restored.restoreFactorization(file));
+    assert (restored.maximumPivots()==5);
+    assert (coinFactorizationTestFirstCount(restored)==needed);
+#ifndef _MSC_VER
+    CoinFactorization mapped;
+    assert (!mapped.mapFactorization(file));
+    assert (coinFactorizationTestFirstCount(mapped)==needed);
+#endif
+  }
+  remove(file);
+  remove(file2);
+  remove(bad);
+}
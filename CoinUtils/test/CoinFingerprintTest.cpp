@@ -0,0 +1,222 @@
+// Copyright (C) 2012, International Business Machines
+// Corporation and others.  All Rights Reserved.
+// This code is licensed under the terms of the Eclipse Public License (EPL).
+
+#ifdef NDEBUG
+#undef NDEBUG
+#endif
+
+#include <cassert>
+#include <cmath>
+#include <cstdio>
+#include <map>
+
+#include "CoinFingerprint.hpp"
+#include "CoinPackedMatrix.hpp"
+#include "CoinMpsIO.hpp"
+#include "CoinModel.hpp"
+#include "CoinHelperFunctions.hpp"
+#include "CoinFinite.hpp"
+#include "CoinThreadPool.hpp"
+#include "CoinTime.hpp"
+#include "CoinTestTiming.hpp"
+
+//#############################################################################
+
+void
+CoinFingerprintUnitTest()
+{
+  {
+    /* Small matrix
+         1  .  2  .
+         .  3  .  .
+         4  .  5  6
+    */
+    int row[6] = {0,0,1,2,2,2};
+    int column[6] = {0,2,1,0,2,3};
+    double element[6] = {1.0,2.0,3.0,4.0,5.0,6.0};
+    CoinPackedMatrix matrix(true,row,column,element,6);
+    CoinFingerprint fingerprint(matrix);
+    assert( fingerprint.toString().size() == 32 );
+    assert( fingerprint != CoinFingerprint() );
+    assert( !fingerprint.word(0,CoinFingerprint::columnData) );
+    // order of elements, gaps and ordering do not matter
+    int row2[6] = {2,1,0,2,2,0};
+    int column2[6] = {3,1,2,2,0,0};
+    double element2[6] = {6.0,3.0,2.0,5.0,4.0,1.0};
+    CoinPackedMatrix shuffled(false,row2,column2,element2,6);
+    assert( CoinFingerprint(shuffled) == fingerprint );
+    CoinPackedMatrix byRow;
+    byRow.reverseOrderedCopyOf(matrix);
+    assert( CoinFingerprint(byRow) == fingerprint );
+    // columns in slots of three with rows out of order
+    int rowGaps[12] = {2,0,-1,1,-1,-1,0,2,-1,2,-1,-1};
+    double elementGaps[12] = {4.0,1.0,0.0,3.0,0.0,0.0,2.0,5.0,0.0,6.0,0.0,0.0};
+    CoinBigIndex startGaps[5] = {0,3,6,9,12};
+    int lengthGaps[4] = {2,1,2,1};
+    int * index = CoinCopyOfArray(rowGaps,12);
+    double * values = CoinCopyOfArray(elementGaps,12);
+    CoinBigIndex * starts = CoinCopyOfArray(startGaps,5);
+    int * lengths = CoinCopyOfArray(lengthGaps,4);
+    CoinPackedMatrix gaps;
+    gaps.assignMatrix(true,3,4,6,values,index,starts,lengths);
+    assert( gaps.getVectorStarts()[1] == 3 );
+    assert( CoinFingerprint(gaps) == fingerprint );
+    // new value - only values differ
+    CoinPackedMatrix changed(matrix);
+    changed.modifyCoefficient(2,2,5.5);
+    CoinFingerprint other(changed);
+    assert( other != fingerprint );
+    assert( other.differences(fingerprint) ==
+	    (1<<CoinFingerprint::matrixValues) );
+    // -0.0 same as 0.0 but new element changes structure
+    changed = matrix;
+    changed.modifyCoefficient(1,3,0.0,true);
+    CoinPackedMatrix negative(matrix);
+    negative.modifyCoefficient(1,3,-0.0,true);
+    other = CoinFingerprint(changed);
+    assert( CoinFingerprint(negative) == other );
+    assert( other.differences(fingerprint) ==
+	    ((1<<CoinFingerprint::matrixStructure)|
+	     (1<<CoinFingerprint::matrixValues)) );
+    // extra empty column changes structure
+    changed = matrix;
+    changed.setDimensions(-1,5);
+    assert( CoinFingerprint(changed).differences(fingerprint) ==
+	    ((1<<CoinFingerprint::matrixStructure)|
+	     (1<<CoinFingerprint::matrixValues)) );
+    // tiny changes ignored with fewer bits
+    changed = matrix;
+    changed.modifyCoefficient(2,2,5.0*(1.0+1.0e-13));
+    assert( CoinFingerprint(changed) != fingerprint );
+    assert( CoinFingerprint(changed,40) == CoinFingerprint(matrix,40) );
+    // small integers are not changed by rounding
+    assert( CoinFingerprint(matrix,40) == fingerprint );
+    assert( CoinFingerprint(matrix,40).valueBits() == 40 );
+    // usable as map key
+    std::map<CoinFingerprint,int> seen;
+    seen[fingerprint] = 1;
+    seen[other] = 2;
+    assert( seen.size() == 2 );
+    assert( seen[CoinFingerprint(byRow)] == 1 );
+  }
+
+  {
+    // Same problem as CoinMpsIO and CoinModel
+    int row[6] = {0,0,1,2,2,2};
+    int column[6] = {0,2,1,0,2,3};
+    double element[6] = {1.0,2.0,3.0,4.0,5.0,6.0};
+    CoinPackedMatrix matrix(true,row,column,element,6);
+    double columnLower[4] = {0.0,-1.0,0.0,0.0};
+    double columnUpper[4] = {COIN_DBL_MAX,1.0,10.0,COIN_DBL_MAX};
+    double objective[4] = {1.0,-2.0,0.0,3.0};
+    double rowLower[3] = {-COIN_DBL_MAX,1.0,2.0};
+    double rowUpper[3] = {4.0,1.0,COIN_DBL_MAX};
+    char integer[4] = {0,0,1,0};
+    CoinMpsIO mps;
+    mps.setMpsData(matrix,COIN_DBL_MAX,columnLower,columnUpper,objective,
+		   integer,rowLower,rowUpper,
+		   static_cast<char **>(NULL),static_cast<char **>(NULL));
+    CoinFingerprint fingerprint(mps);
+    assert( fingerprint.word(0,CoinFingerprint::columnData) );
+    // matrix parts as for matrix alone
+    CoinFingerprint matrixOnly(matrix);
+    assert( fingerprint.differences(matrixOnly) ==
+	    ((1<<CoinFingerprint::columnData)|(1<<CoinFingerprint::rowData)) );
+    // block CoinModel
+    CoinModel block;
+    block.loadBlock(matrix,columnLower,columnUpper,objective,
+		    rowLower,rowUpper);
+    block.setInteger(2);
+    assert( block.rowUpperArray()[0] == 4.0 );
+    assert( CoinFingerprint(block) == fingerprint );
+    // CoinModel built element by element (bounds of 1e30 are infinite)
+    CoinModel model;
+    for (int k=5;k>=0;k--)
+      model.setElement(row[k],column[k],element[k]);
+    for (int i=0;i<3;i++) {
+      model.setRowLower(i,rowLower[i] < -1.0e30 ? -1.0e30 : rowLower[i]);
+      model.setRowUpper(i,rowUpper[i] > 1.0e30 ? 1.0e30 : rowUpper[i]);
+    }
+    for (int j=0;j<4;j++) {
+      model.setColumnLower(j,columnLower[j]);
+      model.setColumnUpper(j,columnUpper[j]);
+      model.setObjective(j,objective[j]);
+    }
+    model.setInteger(2);
+    assert( CoinFingerprint(model) == fingerprint );
+    // near repeats - new bound, new objective, not integer
+    model.setRowUpper(0,5.0);
+    assert( CoinFingerprint(model).differences(fingerprint) ==
+	    (1<<CoinFingerprint::rowData) );
+    model.setRowUpper(0,4.0);
+    model.setObjective(1,-2.5);
+    assert( CoinFingerprint(model).differences(fingerprint) ==
+	    (1<<CoinFingerprint::columnData) );
+    model.setObjective(1,-2.0);
+    model.setContinuous(2);
+    assert( CoinFingerprint(model).differences(fingerprint) ==
+	    (1<<CoinFingerprint::columnData) );
+    model.setInteger(2);
+    model.setObjectiveOffset(1.0);
+    assert( CoinFingerprint(model).differences(fingerprint) ==
+	    (1<<CoinFingerprint::columnData) );
+    model.setObjectiveOffset(0.0);
+    // deleted element
+    model.setElement(1,3,7.0);
+    assert( CoinFingerprint(model) != fingerprint );
+    model.deleteElement(1,3);
+    assert( CoinFingerprint(model) == fingerprint );
+  }
+
+  {
+    // Large matrix - threads give same fingerprint as serial
+    const int numberColumns = 200000;
+    const int numberRows = 50000;
+    const int perColumn = 10;
+    const CoinBigIndex numberElements = numberColumns*perColumn;
+    int * row = new int [numberElements];
+    double * element = new double [numberElements];
+    CoinBigIndex * start = new CoinBigIndex [numberColumns+1];
+    unsigned int seed = 13579;
+    start[0] = 0;
+    for (int i=0;i<numberColumns;i++) {
+      for (int j=0;j<perColumn;j++) {
+	seed = seed*1103515245+12345;
+	row[i*perColumn+j] = (j*numberRows)/perColumn+
+	  (seed>>8)%(numberRows/perColumn);
+	element[i*perColumn+j] = 1.0+((seed>>4)&255);
+      }
+      start[i+1] = start[i]+perColumn;
+    }
+    CoinPackedMatrix matrix(true,numberRows,numberColumns,numberElements,
+			    element,row,start,NULL);
+    delete [] row;
+    delete [] element;
+    delete [] start;
+    CoinThreadPool * oldPool = CoinThreadPool::defaultPool();
+    CoinThreadPool::setDefaultPool(NULL);
+    double startTime = CoinGetTimeOfDay();
+    CoinFingerprint serial(matrix);
+    const double serialTime = CoinGetTimeOfDay()-startTime;
+    CoinThreadPool pool(4);
+    CoinThreadPool::setDefaultPool(&pool);
+    startTime = CoinGetTimeOfDay();
+    CoinFingerprint parallel(matrix);
+    const double parallelTime = CoinGetTimeOfDay()-startTime;
+    assert( parallel == serial );
+    CoinPackedMatrix byRow;
+    byRow.reverseOrderedCopyOf(matrix);
+    assert( CoinFingerprint(byRow) == serial );
+    // one value changed
+    matrix.getMutableElements()[numberElements/2] += 1.0;
+    matrix.clearCaches();
+    assert( CoinFingerprint(matrix).differences(serial) ==
+	    (1<<CoinFingerprint::matrixValues) );
+    CoinThreadPool::setDefaultPool(oldPool);
+    if (coinTestTiming)
+      printf("Fingerprint of %d elements %s - serial %g seconds, %g with %d threads\n",
+	     numberElements,serial.toString().c_str(),serialTime,parallelTime,
+	     pool.numberThreads());
+  }
+}
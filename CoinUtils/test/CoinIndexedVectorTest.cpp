@@ -14,10 +14,18 @@
 #endif
 
 #include <cassert>
+#include <cmath>
+#include <utility>
+#include <vector>
 
 #include "CoinFinite.hpp"
 #include "CoinIndexedVector.hpp"
 #include "CoinShallowPackedVector.hpp"
+#include "CoinMemoryUsage.hpp"
+#include "CoinTime.hpp"
+#include "CoinThreadPool.hpp"
+#include "CoinWorkPool.hpp"
+#include "CoinTestTiming.hpp"
 
 //--------------------------------------------------------------------------
 void
@@ -296,6 +304,16 @@ CoinIndexedVectorUnitTest()
     v1.setVector(ne,inx,el);
     assert( v1.capacity()==6 );
     assert( v1.getNumElements()==2 );
+    {
+      // memory usage - 6 ints + mark area and 6+9 doubles allocated
+      CoinMemoryUsage usage;
+      v1.memoryUsage(usage);
+      assert( usage.numberEntries()==2 );
+      assert( usage.used(0)==2*CoinSizeofAsInt(int) );
+      assert( usage.reserved(0)>=6*CoinSizeofAsInt(int) );
+      assert( usage.used(1)==2*CoinSizeofAsInt(double) );
+      assert( usage.reserved(1)==15*CoinSizeofAsInt(double) );
+    }
     v2=v1;
     assert( v2.capacity()==6 );
     assert( v2.getNumElements()==2 );
@@ -527,7 +545,305 @@ CoinIndexedVectorUnitTest()
     assert( add[4] == 40.+40. );
     
   }
+
+  // Test switching representation with density
+  {
+    const int n = 4000;
+    CoinIndexedVector r;
+    r.reserve(n);
+    r.setAutoRepresentation(true);
+    assert( r.representation()==CoinIndexedVector::indexList );
+    for (i=0;i<n;i+=2)
+      r.quickAdd(i,1.0+i);
+    assert( r.representation()!=CoinIndexedVector::indexList );
+    r.quickAdd(4,1.0);
+    assert( r.getNumElements()==n/2 );
+    assert( r.representation()==CoinIndexedVector::indexList );
+    const int * inds = r.getIndices();
+    for (i=0;i<n/2;i++) {
+      assert( inds[i]==2*i );
+      assert( r[2*i]==(i==2 ? 6.0 : 1.0+2*i) );
+    }
+    // last clear was dense so starts dense and stays correct
+    r.clear();
+    for (i=0;i<n;i+=3)
+      r.insert(i,2.0);
+    assert( r.representation()!=CoinIndexedVector::indexList );
+    assert( r.getNumElements()==(n+2)/3 );
+    r.clear();
+#ifndef NO_CHECK_CL
+    r.checkClear();
+#endif
+    // sparse again so drops back to list
+    r.clear();
+    r.insert(10,1.0);
+    assert( r.representation()==CoinIndexedVector::indexList );
+    assert( r.getNumElements()==1 );
+    // const access does not change representation
+    for (int representation=CoinIndexedVector::nonzeroBitmap;
+	 representation<=CoinIndexedVector::pureDense;representation++) {
+      r.clear();
+      r.setAutoRepresentation(false);
+      r.setRepresentation(representation);
+      for (i=n-1;i>=0;i-=5)
+	r.insert(i,3.0);
+      const CoinIndexedVector & constR = r;
+      assert( constR.getNumElements()==n/5 );
+      assert( constR.representation()==representation );
+      bool threw = false;
+      try {
+	constR.getIndices();
+      }
+      catch (CoinError & ) {
+	threw = true;
+      }
+      assert( threw );
+      assert( constR.getMinIndex()==4 && constR.getMaxIndex()==n-1 );
+      CoinIndexedVector copy(constR);
+      assert( copy.representation()==CoinIndexedVector::indexList );
+      assert( copy.getNumElements()==n/5 && copy.getIndices()[0]==4 );
+      assert( copy==constR && !(copy!=constR) );
+      assert( constR==copy && !(constR!=copy) );
+      CoinIndexedVector sum = copy+constR;
+      assert( sum.getNumElements()==n/5 && sum[n-1]==6.0 );
+      assert( constR.representation()==representation );
+      // non-const access goes back to list
+      assert( r.getIndices()[0]==4 );
+      assert( r.representation()==CoinIndexedVector::indexList );
+    }
+  }
+
+  // Test scans with each instruction set against plain loops
+  // (times printed with -timing)
+  {
+    const int n = 100003;
+    const int nDensity = 5;
+    const double density[nDensity] = { 0.001, 0.01, 0.1, 0.5, 1.0 };
+    const int best = CoinIndexedVector::scanInstructionSet();
+    double * values = new double[n];
+    int * count = new int [4*(best+1)];
+    CoinIndexedVector r;
+    r.reserve(n);
+    for (int iDensity=0;iDensity<nDensity;iDensity++) {
+      // values near tolerance, zeros and a -0.0
+      unsigned int seed = 12345;
+      for (i=0;i<n;i++) {
+	seed = 1664525*seed+1013904223;
+	double random = static_cast<double>(seed>>8)/16777216.0;
+	if (random<density[iDensity])
+	  values[i] = (seed&1) ? -random : 1.0e-3*(i%7);
+	else
+	  values[i] = 0.0;
+      }
+      values[n/2] = -0.0;
+      double time[3]={0.0,0.0,0.0};
+      for (int level=0;level<=best;level++) {
+	CoinIndexedVector::setScanInstructionSet(level);
+	assert( CoinIndexedVector::scanInstructionSet()==level );
+	for (int pass=0;pass<40;pass++) {
+	  int type = pass&3;
+	  double tolerance = 2.0e-3*type*density[iDensity];
+	  double * dense = r.denseVector();
+	  CoinMemcpyN(values,n,dense);
+	  double start = CoinCpuTime();
+	  int number;
+	  if (type<2)
+	    number = r.scan(tolerance);
+	  else
+	    number = r.scanAndPack(1,n-1,tolerance);
+	  time[level] += CoinCpuTime()-start;
+	  count[4*level+type] = number;
+	  const int * inds = r.getIndices();
+	  for (int j=0;j<number;j++) {
+	    int k = inds[j];
+	    assert( !j || k>inds[j-1] );
+	    double value = (type<2) ? dense[k] : dense[j];
+	    assert( value==values[k] );
+	    if (type<2)
+	      assert( values[k] && fabs(values[k])>=tolerance );
+	    else
+	      assert( fabs(values[k])>=tolerance );
+	  }
+	  if (level)
+	    assert( number==count[type] );
+	  if (type<2) {
+	    r.checkClean();
+	  } else {
+	    for (int j=number;j<n;j++)
+	      assert( !dense[j] );
+	  }
+	  r.clear();
+	}
+      }
+      if (coinTestTiming) {
+	printf("scan density %g - plain %g",density[iDensity],time[0]);
+	for (int level=1;level<=best;level++)
+	  printf(", %s %g",level==1 ? "AVX2" : "AVX-512",time[level]);
+	printf(" seconds\n");
+      }
+    }
+    CoinIndexedVector::setScanInstructionSet(best);
+    // partitioned
+    CoinPartitionedVector p;
+    p.reserve(1000);
+    int starts[4] = { 0, 7, 500, 1000 };
+    p.setPartitions(3,starts);
+    for (int level=0;level<=best;level++) {
+      CoinIndexedVector::setScanInstructionSet(level);
+      double * dense = p.denseVector();
+      for (i=0;i<1000;i++)
+	dense[i] = (i%3) ? 0.0 : 1.0e-3*(i%11);
+      int number[3];
+      for (int k=0;k<3;k++)
+	number[k] = p.scan(k,k ? 2.0e-3 : 0.0);
+      for (int k=0;k<3;k++) {
+	if (level)
+	  assert( number[k]==count[k] );
+	count[k] = number[k];
+	const int * inds = p.getIndices()+starts[k];
+	const double * elems = dense+starts[k];
+	for (int j=0;j<number[k];j++) {
+	  assert( inds[j]>=starts[k] && inds[j]<starts[k+1] );
+	  assert( elems[j]==1.0e-3*(inds[j]%11) );
+	}
+	for (int j=starts[k]+number[k];j<starts[k+1];j++)
+	  assert( !dense[j] );
+      }
+      p.computeNumberElements();
+      p.clearAndKeep();
+    }
+    CoinIndexedVector::setScanInstructionSet(best);
+    delete [] values;
+    delete [] count;
+  }
+
+  // Test partitions done by threads
+  {
+    const int n = 60000;
+    CoinThreadPool pool(4);
+    assert( pool.numberThreads()>=1 );
+    int * weight = new int [n];
+    for (i=0;i<n;i++)
+      weight[i] = (i<n/4) ? 10 : 1;
+    CoinPartitionedVector p;
+    p.reserve(n);
+    p.setBalancedPartitions(4,n,weight);
+    // first partitions are shorter
+    assert( p.getNumPartitions()==4 );
+    assert( p.startPartition(1)<n/4 && p.startPartition(4)==n );
+    CoinPartitionedVector q(p);
+    p.setThreadPool(&pool);
+    for (int pass=0;pass<2;pass++) {
+      double * dense = p.denseVector();
+      double * denseQ = q.denseVector();
+      for (i=0;i<n;i++) {
+	dense[i] = (i%(3+pass)) ? 0.0 : 1.0+i%5;
+	denseQ[i] = dense[i];
+      }
+      int number = p.scanPartitions(1.5);
+      assert( number==q.scanPartitions(1.5) );
+      assert( p.getNumElements()==number );
+      for (int k=0;k<4;k++) {
+	int start=p.startPartition(k);
+	assert( p.getNumElements(k)==q.getNumElements(k) );
+	for (int j=0;j<p.getNumElements(k);j++) {
+	  assert( p.getIndices()[start+j]==q.getIndices()[start+j] );
+	  assert( dense[start+j]==denseQ[start+j] );
+	}
+      }
+      if (!pass) {
+	p.clearAndKeep();
+	q.clearAndKeep();
+	p.checkClear();
+	// sparser so can compact in parallel
+	p.setBalancedPartitions(4,n,NULL);
+	q.setBalancedPartitions(4,n,NULL);
+	assert( p.startPartition(1)==n/4 );
+      } else {
+	// pack down
+	p.compact();
+	q.compact();
+	assert( p.getNumElements()==number );
+	for (i=0;i<number;i++) {
+	  assert( p.getIndices()[i]==q.getIndices()[i] );
+	  assert( dense[i]==denseQ[i] );
+	}
+	for (;i<n;i++)
+	  assert( !dense[i] );
+	p.clearAndReset();
+	p.checkClear();
+      }
+    }
+    delete [] weight;
+  }
+
+  // Test work regions from pool
+  {
+    CoinWorkPool * pool = CoinWorkPool::threadPool();
+    CoinWorkPool::setActive(true);
+    pool->resetCounts();
+    for (int pass=0;pass<10;pass++) {
+      CoinIndexedVector r;
+      r.reserve(1000+pass);
+      for (i=0;i<1000;i+=7)
+	r.insert(i,1.0+i);
+      r.reserve(3000);
+      assert( r.getNumElements()==143 && r[994]==995.0 );
+      r.checkClean();
+      CoinDoubleArrayWithLength array(2000,1);
+      const double * values = array.array();
+      for (i=0;i<2000;i++)
+	assert( !values[i] );
+      array.array()[10] = 1.0;
+      CoinIntArrayWithLength work;
+      work.switchOn();
+      work.conditionalNew(100+pass);
+      work.array()[0] = pass;
+    }
+    // after first pass everything comes from pool
+    assert( pool->numberCheckOuts()==60 );
+    assert( pool->numberHits()==54 );
+    assert( pool->numberCached()>0 );
+    // region given back with only what was asked for dirty
+    char * region = pool->checkOut(100,100);
+    assert( CoinWorkPool::used(region)==100 &&
+	    CoinWorkPool::capacity(region)==128 );
+    region[99] = 1;
+    CoinWorkPool::release(region,CoinWorkPool::used(region));
+    region = pool->checkOut(128,100);
+    assert( region[99]==1 && !region[100] && !region[127] );
+    CoinWorkPool::release(region,CoinWorkPool::used(region));
+    CoinWorkPool::setActive(false);
+    assert( !pool->numberCached() && !pool->bytesCached() );
+    assert( !CoinWorkPool::active() );
+  }
   
+
+#if __cplusplus >= 201103L
+  {
+    // Moves take arrays rather than copying them
+    CoinIndexedVector v;
+    v.reserve(100);
+    v.insert(3,1.0);
+    v.insert(7,2.0);
+    const double * dense = v.denseVector();
+    CoinInt64 before = CoinMemoryTracker::numberAllocations();
+    CoinIndexedVector moved(std::move(v));
+    assert( CoinMemoryTracker::numberAllocations() == before );
+    assert( moved.denseVector() == dense );
+    assert( moved.getNumElements() == 2 && moved[7] == 2.0 );
+    assert( !v.capacity() && !v.getNumElements() );
+    v = std::move(moved);
+    assert( CoinMemoryTracker::numberAllocations() == before );
+    assert( v.denseVector() == dense && v[3] == 1.0 );
+    // std::vector moves when it grows
+    std::vector<CoinIndexedVector> vectors;
+    vectors.push_back(std::move(v));
+    vectors.push_back(CoinIndexedVector(10));
+    vectors.push_back(CoinIndexedVector(10));
+    assert( vectors[0].denseVector() == dense );
+  }
+#endif
 }
     
 
@@ -12,8 +12,10 @@
 #endif
 
 #include <cassert>
+#include <cstdio>
 
 #include "CoinLpIO.hpp"
+#include "CoinArena.hpp"
 #include "CoinFloatEqual.hpp"
 #include <string.h>
 //#############################################################################
@@ -47,6 +49,52 @@ CoinLpIOUnitTest(const std::string& lpDir)
       m.newLanguage(CoinMessages::it);
       m.messageHandler()->setPrefix(false);
       m.readLp(fn.c_str());
+      // Read again with temporaries from an arena
+      {
+         CoinArena arena(4096);
+         CoinLpIO a;
+         a.setArena(&arena);
+         a.readLp(fn.c_str());
+         // all given back but blocks kept for next time
+         assert( arena.bytesUsed() == 0 );
+         assert( arena.numberBlocks() > 0 );
+         assert( a.getNumCols() == m.getNumCols() );
+         assert( a.getNumRows() == m.getNumRows() );
+         assert( a.getNumElements() == m.getNumElements() );
+         assert( !strcmp( a.objName_ , "OBJ"));
+         for (int i = 0; i < m.getNumRows(); i++) {
+            assert( eq(a.getRowLower()[i], m.getRowLower()[i]) );
+            assert( eq(a.getRowUpper()[i], m.getRowUpper()[i]) );
+            assert( !strcmp(a.rowName(i), m.rowName(i)) );
+         }
+         for (int j = 0; j < m.getNumCols(); j++) {
+            assert( eq(a.getObjCoefficients()[j], m.getObjCoefficients()[j]) );
+            assert( !strcmp(a.columnName(j), m.columnName(j)) );
+         }
+         assert( a.getMatrixByRow()->isEquivalent(*m.getMatrixByRow()) );
+         int numberBlocks = arena.numberBlocks();
+         a.readLp(fn.c_str());
+         assert( arena.numberBlocks() == numberBlocks );
+         // given back when bad file throws
+         const char * bad = "CoinLpIOTestBad.lp";
+         FILE * fp = fopen(bad, "w");
+         assert( fp );
+         fprintf(fp, "Minimize\n obj: x + y\nSubject xx\n c1: x >= 1\nEnd\n");
+         fclose(fp);
+         fp = fopen(bad, "r");
+         assert( fp );
+         bool thrown = false;
+         try {
+            a.readLp(fp);
+         }
+         catch (CoinError &) {
+            thrown = true;
+         }
+         fclose(fp);
+         remove(bad);
+         assert( thrown );
+         assert( arena.bytesUsed() == 0 );
+      }
       // Test copy constructor and assignment operator
       {
          CoinLpIO lhs;
@@ -12,11 +12,18 @@
 #endif
 
 #include <cassert>
+#include <cstring>
+#include <utility>
+#include <vector>
+#if __cplusplus >= 201103L
+#include <type_traits>
+#endif
 
 #include "CoinMpsIO.hpp"
 #include "CoinModel.hpp"
 #include "CoinHelperFunctions.hpp"
 #include "CoinTime.hpp"
+#include "CoinMemoryUsage.hpp"
 
 //#############################################################################
 
@@ -682,6 +689,88 @@ CoinModelUnitTest(const std::string & mpsDir,
 	<< time1 << " seconds\n" << std::endl ;
     }
   }
+  {
+    // First row and column of a new model keep their bounds
+    int row[4] = {0,1,1,2};
+    int column[4] = {0,0,1,2};
+    double element[4] = {1.0,2.0,3.0,4.0};
+    CoinPackedMatrix matrix(true,row,column,element,4);
+    double lower[3] = {0.5,1.0,2.0};
+    double upper[3] = {5.0,6.0,7.0};
+    double objective[3] = {-1.0,2.0,3.0};
+    CoinModel model;
+    model.loadBlock(matrix,lower,upper,objective,lower,upper);
+    assert( model.getRowLower(0) == 0.5 && model.getRowUpper(0) == 5.0 );
+    assert( model.getColumnLower(0) == 0.5 && model.getColumnUpper(0) == 5.0 );
+    assert( model.getColumnObjective(0) == -1.0 );
+    assert( model.getRowUpper(2) == 7.0 && model.getColumnUpper(2) == 7.0 );
+    CoinModel model2;
+    model2.setRowUpper(0,4.0);
+    model2.setRowUpper(1,3.0);
+    model2.setColumnUpper(0,2.0);
+    model2.setColumnUpper(1,1.0);
+    assert( model2.numberRows() == 2 && model2.numberColumns() == 2 );
+    assert( model2.getRowUpper(0) == 4.0 && model2.getRowUpper(1) == 3.0 );
+    assert( model2.getColumnUpper(0) == 2.0 && model2.getColumnUpper(1) == 1.0 );
+  }
+  {
+    // Memory usage shows room left by first sizes
+    CoinModel model(10,0,50);
+    int columns[2] = {0,3};
+    double elements[2] = {1.0,-1.0};
+    for (int i=0;i<3;i++)
+      model.addRow(2,columns,elements,0.0,1.0);
+    assert( model.numberRows() == 3 && model.numberColumns() == 4 );
+    CoinMemoryUsage usage;
+    model.memoryUsage(usage);
+    int which = usage.find("rowLower");
+    assert( usage.used(which) == 3*CoinSizeofAsInt(double) );
+    assert( usage.reserved(which) == 10*CoinSizeofAsInt(double) );
+    which = usage.find("elements");
+    assert( usage.used(which) == 6*CoinSizeofAsInt(CoinModelTriple) );
+    assert( usage.reserved(which) == 50*CoinSizeofAsInt(CoinModelTriple) );
+  }
+
+#if __cplusplus >= 201103L
+  {
+    // Moves take arrays rather than copying them
+    int row[4] = {0,1,1,2};
+    int column[4] = {0,0,1,2};
+    double element[4] = {1.0,2.0,3.0,4.0};
+    CoinPackedMatrix matrix(true,row,column,element,4);
+    const double * elements = matrix.getElements();
+    double lower[3] = {0.0,1.0,2.0};
+    double upper[3] = {5.0,6.0,7.0};
+    CoinModel model;
+    model.loadBlock(std::move(matrix),lower,upper,NULL,lower,upper);
+    assert( !matrix.getNumElements() );
+    assert( model.packedMatrix()->getElements() == elements );
+    assert( model.numberRows() == 3 && model.getRowUpper(2) == 7.0 );
+    model.setProblemName("moved");
+    CoinInt64 before = CoinMemoryTracker::numberAllocations();
+    CoinModel moved(std::move(model));
+    assert( CoinMemoryTracker::numberAllocations() == before );
+    assert( moved.packedMatrix()->getElements() == elements );
+    assert( moved.numberColumns() == 3 && moved.getColumnLower(1) == 1.0 );
+    assert( !strcmp(moved.getProblemName(),"moved") );
+    assert( !model.packedMatrix() && !model.numberRows() );
+    model = std::move(moved);
+    assert( model.packedMatrix()->getElements() == elements );
+    // vector moves rather than copies when it grows
+    assert( std::is_nothrow_move_constructible<CoinModel>::value );
+    std::vector<CoinModel> models;
+    models.push_back(std::move(model));
+    for (int i=0;i<20;i++)
+      models.push_back(CoinModel());
+    assert( models[0].packedMatrix()->getElements() == elements );
+    // sense version
+    CoinPackedMatrix matrix2(true,row,column,element,4);
+    char sense[3] = {'L','E','G'};
+    CoinModel model2;
+    model2.loadBlock(std::move(matrix2),NULL,NULL,NULL,sense,upper,NULL);
+    assert( model2.getRowLower(0) < -1.0e30 && model2.getRowUpper(1) == 6.0 );
+  }
+#endif
 }
 
 
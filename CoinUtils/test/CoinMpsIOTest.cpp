@@ -12,9 +12,17 @@
 #endif
 
 #include <cassert>
+#include <cstring>
+#include <utility>
+#include <vector>
+#if __cplusplus >= 201103L
+#include <type_traits>
+#endif
 
 #include "CoinMpsIO.hpp"
 #include "CoinFloatEqual.hpp"
+#include "CoinHelperFunctions.hpp"
+#include "CoinMemoryUsage.hpp"
 
 //#############################################################################
 
@@ -49,6 +57,27 @@ CoinMpsIOUnitTest(const std::string & mpsDir)
     int numErr = m.readMps(fn.c_str(),"mps");
     assert( numErr== 0 );
 
+    // Memory usage - arrays are exact size
+    {
+      CoinMemoryUsage usage;
+      m.memoryUsage(usage);
+      int which = usage.find("rowLower");
+      assert( usage.used(which) == 5*CoinSizeofAsInt(double) );
+      assert( usage.reserved(which) == usage.used(which) );
+      which = usage.find("integerType");
+      assert( usage.used(which) == 8 && usage.reserved(which) == 8 );
+      which = usage.find("matrixByColumn.elements");
+      assert( usage.used(which) == 14*CoinSizeofAsInt(double) );
+      // row sense made when asked for
+      assert( usage.find("rowSense") < 0 );
+      CoinMpsIO sensed(m);
+      sensed.getRowSense();
+      usage.clear();
+      sensed.memoryUsage(usage);
+      which = usage.find("rowSense");
+      assert( usage.used(which) == 5 && usage.reserved(which) == 5 );
+    }
+
     assert( !strcmp( m.problemName_ , "EXAMPLE"));
     assert( !strcmp( m.objectiveName_ , "OBJ"));
     assert( !strcmp( m.rhsName_ , "RHS1"));
@@ -646,5 +675,48 @@ CoinMpsIOUnitTest(const std::string & mpsDir)
 #endif
   }
 
+
+#if __cplusplus >= 201103L
+  {
+    // Moves take arrays rather than copying them
+    int row[4] = {0,1,1,2};
+    int column[4] = {0,0,1,2};
+    double element[4] = {1.0,2.0,3.0,4.0};
+    CoinPackedMatrix matrix(true,row,column,element,4);
+    const double * elements = matrix.getElements();
+    double lower[3] = {0.0,1.0,2.0};
+    double upper[3] = {5.0,6.0,7.0};
+    CoinMpsIO m;
+    m.setMpsData(std::move(matrix),COIN_DBL_MAX,lower,upper,upper,NULL,
+		 lower,upper,NULL,NULL);
+    assert( !matrix.getNumElements() );
+    assert( m.getMatrixByCol()->getElements() == elements );
+    assert( !strcmp(m.columnName(2),"C0000002") );
+    const double * colLower = m.getColLower();
+    // moving allocates nothing
+    CoinInt64 before = CoinMemoryTracker::numberAllocations();
+    CoinMpsIO moved(std::move(m));
+    assert( CoinMemoryTracker::numberAllocations() == before );
+    assert( moved.getMatrixByCol()->getElements() == elements );
+    assert( moved.getColLower() == colLower );
+    assert( moved.getNumRows() == 3 && !m.getNumRows() );
+    assert( !strcmp(moved.rowName(1),"R0000001") );
+    // handler goes with everything else
+    assert( moved.messageHandler() && !m.messageHandler() );
+    before = CoinMemoryTracker::numberAllocations();
+    m = std::move(moved);
+    assert( CoinMemoryTracker::numberAllocations() == before );
+    assert( m.getColLower() == colLower );
+    assert( m.getObjCoefficients()[2] == 7.0 );
+    // vector moves rather than copies when it grows
+    assert( std::is_nothrow_move_constructible<CoinMpsIO>::value );
+    std::vector<CoinMpsIO> readers;
+    readers.push_back(std::move(m));
+    for (int i=0;i<20;i++)
+      readers.push_back(CoinMpsIO());
+    assert( readers[0].getColLower() == colLower );
+    assert( !strcmp(readers[0].rowName(1),"R0000001") );
+  }
+#endif
 }
 
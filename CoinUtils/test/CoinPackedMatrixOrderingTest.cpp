@@ -0,0 +1,226 @@
+// Copyright (C) 2012, International Business Machines
+// Corporation and others.  All Rights Reserved.
+// This code is licensed under the terms of the Eclipse Public License (EPL).
+
+#ifdef NDEBUG
+#undef NDEBUG
+#endif
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <cstdio>
+
+#include "CoinPackedMatrixOrdering.hpp"
+#include "CoinPackedMatrix.hpp"
+#include "CoinHelperFunctions.hpp"
+#include "CoinTime.hpp"
+#include "CoinTestTiming.hpp"
+
+//#############################################################################
+
+// Checks ordering is a permutation and permuted matrix multiplies the same
+static void
+coinOrderingTestSame(const CoinPackedMatrixOrdering & ordering,
+		     const CoinPackedMatrix & matrix)
+{
+  const int nRow = matrix.getNumRows();
+  const int nCol = matrix.getNumCols();
+  assert( ordering.getNumRows() == nRow );
+  assert( ordering.getNumCols() == nCol );
+  for (int i=0;i<nRow;i++)
+    assert( ordering.rowPosition()[ordering.rowOrder()[i]] == i );
+  for (int i=0;i<nCol;i++)
+    assert( ordering.columnPosition()[ordering.columnOrder()[i]] == i );
+  CoinPackedMatrix permuted(matrix);
+  ordering.permute(permuted);
+  assert( permuted.getNumElements() == matrix.getNumElements() );
+  double * x = new double [nCol];
+  double * xP = new double [nCol];
+  double * y = new double [nRow];
+  double * yP = new double [nRow];
+  double * yBack = new double [nRow];
+  for (int i=0;i<nCol;i++)
+    x[i] = 1.0/(i+1.0);
+  matrix.times(x,y);
+  ordering.permuteColumnVector(x,xP);
+  permuted.times(xP,yP);
+  ordering.unpermuteRowVector(yP,yBack);
+  for (int i=0;i<nRow;i++)
+    assert( fabs(y[i]-yBack[i]) < 1.0e-12 );
+  // indices sorted within vectors
+  const CoinBigIndex * start = permuted.getVectorStarts();
+  const int * length = permuted.getVectorLengths();
+  const int * index = permuted.getIndices();
+  for (int i=0;i<permuted.getMajorDim();i++) {
+    for (CoinBigIndex j=start[i]+1;j<start[i]+length[i];j++)
+      assert( index[j-1] < index[j] );
+  }
+  ordering.unpermute(permuted);
+  assert( permuted.isEquivalent(matrix) );
+  delete [] x;
+  delete [] xP;
+  delete [] y;
+  delete [] yP;
+  delete [] yBack;
+}
+
+void
+CoinPackedMatrixOrderingUnitTest()
+{
+  {
+    /* Path graph with rows and columns scrambled
+           0  1  2  3  4
+       0   .  .  1  .  2
+       1   3  .  .  .  .
+       2   .  4  .  5  .
+       3   6  .  .  .  7
+       4   .  .  8  9  .
+    */
+    int row[9] = {0,0,1,2,2,3,3,4,4};
+    int column[9] = {2,4,0,1,3,0,4,2,3};
+    double element[9] = {1.0,2.0,3.0,4.0,5.0,6.0,7.0,8.0,9.0};
+    CoinPackedMatrix matrix(true,row,column,element,9);
+    // empty column and row
+    matrix.setDimensions(6,6);
+    double average;
+    const int before = CoinPackedMatrixOrdering::bandwidth(matrix,&average);
+    assert( before == 4 );
+    CoinPackedMatrixOrdering ordering(matrix);
+    assert( ordering.method() == CoinPackedMatrixOrdering::reverseCuthillMcKee );
+    coinOrderingTestSame(ordering,matrix);
+    // empty row and column last
+    assert( ordering.rowOrder()[5] == 5 );
+    assert( ordering.columnOrder()[5] == 5 );
+    CoinPackedMatrix permuted(matrix);
+    ordering.permute(permuted);
+    // a path so columns touch adjacent rows (column 1 just one)
+    assert( CoinPackedMatrixOrdering::bandwidth(permuted,&average) == 1 );
+    assert( fabs(average-0.8) < 1.0e-12 );
+    // same from row copy
+    CoinPackedMatrix byRow;
+    byRow.reverseOrderedCopyOf(matrix);
+    CoinPackedMatrixOrdering rowOrdering(byRow);
+    coinOrderingTestSame(rowOrdering,byRow);
+    rowOrdering.permute(byRow);
+    assert( CoinPackedMatrixOrdering::bandwidth(byRow) == 1 );
+    // clustering keeps rows
+    CoinPackedMatrixOrdering cluster(matrix,
+				     CoinPackedMatrixOrdering::columnClustering);
+    coinOrderingTestSame(cluster,matrix);
+    for (int i=0;i<6;i++)
+      assert( cluster.rowOrder()[i] == i );
+    const int * columnOrder = cluster.columnOrder();
+    // columns by first and then last row
+    assert( columnOrder[0] == 4 && columnOrder[1] == 2 );
+    assert( columnOrder[2] == 0 );
+    assert( columnOrder[3] == 1 && columnOrder[4] == 3 );
+    assert( columnOrder[5] == 5 );
+    // copies
+    CoinPackedMatrixOrdering copy(ordering);
+    CoinPackedMatrixOrdering assigned;
+    assert( !assigned.getNumRows() );
+    assigned = copy;
+    coinOrderingTestSame(assigned,matrix);
+    // wrong size
+    bool thrown = false;
+    CoinPackedMatrix small(true,row,column,element,3);
+    try {
+      assigned.permute(small);
+    }
+    catch (CoinError& e) {
+      thrown = true;
+    }
+    assert( thrown );
+    // empty matrix
+    CoinPackedMatrix empty;
+    CoinPackedMatrixOrdering emptyOrdering(empty);
+    assert( !emptyOrdering.getNumCols() );
+  }
+
+  {
+    // Scrambled band matrix - bandwidth before and after (and times
+    // with -timing)
+    const int numberRows = 200000;
+    const int numberColumns = 200000;
+    const int perColumn = 6;
+    const CoinBigIndex numberElements = numberColumns*perColumn;
+    int * rowPermutation = new int [numberRows];
+    int * columnPermutation = new int [numberColumns];
+    CoinIotaN(rowPermutation,numberRows,0);
+    CoinIotaN(columnPermutation,numberColumns,0);
+    unsigned int seed = 1234;
+    for (int i=numberRows-1;i>0;i--) {
+      seed = seed*1103515245+12345;
+      std::swap(rowPermutation[i],rowPermutation[(seed>>8)%(i+1)]);
+      seed = seed*1103515245+12345;
+      std::swap(columnPermutation[i],columnPermutation[(seed>>8)%(i+1)]);
+    }
+    int * row = new int [numberElements];
+    int * column = new int [numberElements];
+    double * element = new double [numberElements];
+    for (int i=0;i<numberColumns;i++) {
+      for (int j=0;j<perColumn;j++) {
+	const CoinBigIndex k = i*perColumn+j;
+	const int iRow = (i+3*j)%numberRows;
+	row[k] = rowPermutation[iRow];
+	column[k] = columnPermutation[i];
+	element[k] = 1.0+j;
+      }
+    }
+    CoinPackedMatrix matrix(true,row,column,element,numberElements);
+    delete [] row;
+    delete [] column;
+    delete [] element;
+    delete [] rowPermutation;
+    delete [] columnPermutation;
+    double averageBefore;
+    const int before = CoinPackedMatrixOrdering::bandwidth(matrix,
+							    &averageBefore);
+    double startTime = CoinCpuTime();
+    CoinPackedMatrixOrdering ordering(matrix);
+    CoinPackedMatrix permuted(matrix);
+    ordering.permute(permuted);
+    const double orderTime = CoinCpuTime()-startTime;
+    double averageAfter;
+    const int after = CoinPackedMatrixOrdering::bandwidth(permuted,
+							   &averageAfter);
+    assert( averageAfter*100.0 < averageBefore );
+    double * x = new double [numberColumns];
+    double * xP = new double [numberColumns];
+    double * y = new double [numberRows];
+    double * yP = new double [numberRows];
+    for (int i=0;i<numberColumns;i++)
+      x[i] = 1.0/(i+1.0);
+    ordering.permuteColumnVector(x,xP);
+    double time[2];
+    for (int k=0;k<2;k++) {
+      startTime = CoinCpuTime();
+      for (int pass=0;pass<(coinTestTiming ? 10 : 1);pass++) {
+	if (k) {
+	  permuted.times(xP,yP);
+	  permuted.transposeTimes(yP,xP);
+	} else {
+	  matrix.times(x,y);
+	  matrix.transposeTimes(y,x);
+	}
+      }
+      time[k] = CoinCpuTime()-startTime;
+    }
+    double * yBack = new double [numberRows];
+    ordering.unpermuteRowVector(yP,yBack);
+    for (int i=0;i<numberRows;i++)
+      assert( fabs(y[i]-yBack[i]) < 1.0e-8*(1.0+fabs(y[i])) );
+    if (coinTestTiming) {
+      printf("Bandwidth %d (average %g) before, %d (average %g) after ordering in %g seconds\n",
+	     before,averageBefore,after,averageAfter,orderTime);
+      printf("times and transposeTimes %g seconds before, %g after - speedup %g\n",
+	     time[0],time[1],time[1]>0.0 ? time[0]/time[1] : 0.0);
+    }
+    delete [] x;
+    delete [] xP;
+    delete [] y;
+    delete [] yP;
+    delete [] yBack;
+  }
+}
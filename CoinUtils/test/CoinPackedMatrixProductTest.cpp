@@ -0,0 +1,277 @@
+// Copyright (C) 2012, International Business Machines
+// Corporation and others.  All Rights Reserved.
+// This code is licensed under the terms of the Eclipse Public License (EPL).
+
+#ifdef NDEBUG
+#undef NDEBUG
+#endif
+
+#include <cassert>
+#include <cmath>
+#include <cstdio>
+
+#include "CoinPackedMatrixProduct.hpp"
+#include "CoinPackedMatrix.hpp"
+#include "CoinHelperFunctions.hpp"
+#include "CoinThreadPool.hpp"
+#include "CoinTime.hpp"
+#include "CoinTestTiming.hpp"
+
+//#############################################################################
+
+// Dense copy of matrix (row after row)
+static double *
+coinProductTestDense(const CoinPackedMatrix & matrix)
+{
+  const int nRow = matrix.getNumRows();
+  const int nCol = matrix.getNumCols();
+  double * dense = new double [nRow*nCol];
+  CoinZeroN(dense,nRow*nCol);
+  for (int iRow=0;iRow<nRow;iRow++) {
+    for (int iColumn=0;iColumn<nCol;iColumn++)
+      dense[iRow*nCol+iColumn] = matrix.getCoefficient(iRow,iColumn);
+  }
+  return dense;
+}
+
+// Checks result is column ordered with rows increasing and equals dense
+static void
+coinProductTestSame(const CoinPackedMatrix & result, const double * dense,
+		    bool lower)
+{
+  assert( result.isColOrdered() );
+  const int nRow = result.getNumRows();
+  const int nCol = result.getNumCols();
+  const CoinBigIndex * start = result.getVectorStarts();
+  const int * length = result.getVectorLengths();
+  const int * index = result.getIndices();
+  for (int iColumn=0;iColumn<nCol;iColumn++) {
+    for (CoinBigIndex j=start[iColumn];j<start[iColumn]+length[iColumn];j++) {
+      if (j>start[iColumn])
+	assert( index[j-1] < index[j] );
+      if (lower)
+	assert( index[j] >= iColumn );
+    }
+    for (int iRow=lower ? iColumn : 0;iRow<nRow;iRow++)
+      assert( fabs(result.getCoefficient(iRow,iColumn)-
+		   dense[iRow*nCol+iColumn]) < 1.0e-12 );
+  }
+}
+
+void
+CoinPackedMatrixProductUnitTest()
+{
+  {
+    /* Small matrices
+          A                B
+       1  .  2  .       1  .
+       .  3  .  4       .  2
+       5  .  .  6       3  .
+                        .  4
+    */
+    int row[6] = {0,0,1,1,2,2};
+    int column[6] = {0,2,1,3,0,3};
+    double element[6] = {1.0,2.0,3.0,4.0,5.0,6.0};
+    CoinPackedMatrix a(true,row,column,element,6);
+    int rowB[4] = {0,1,2,3};
+    int columnB[4] = {0,1,0,1};
+    double elementB[4] = {1.0,2.0,3.0,4.0};
+    CoinPackedMatrix b(true,rowB,columnB,elementB,4);
+    double d[4] = {1.0,2.0,3.0,4.0};
+    // dense A*diag(d)*A'
+    double adat[9];
+    double * denseA = coinProductTestDense(a);
+    for (int i=0;i<3;i++) {
+      for (int j=0;j<3;j++) {
+	double sum = 0.0;
+	for (int k=0;k<4;k++)
+	  sum += denseA[i*4+k]*d[k]*denseA[j*4+k];
+	adat[i*3+j] = sum;
+      }
+    }
+    CoinPackedMatrixProduct normal;
+    assert( !normal.hasPattern() );
+    CoinPackedMatrix result;
+    normal.normalMatrix(a,d,result);
+    assert( normal.hasPattern() );
+    // (1,0) is structurally zero
+    assert( result.getNumElements() == 5 );
+    coinProductTestSame(result,adat,true);
+    // new d - same arrays
+    const double * elements = result.getElements();
+    for (int k=0;k<4;k++)
+      d[k] = 1.0/d[k];
+    for (int i=0;i<3;i++) {
+      for (int j=0;j<3;j++) {
+	double sum = 0.0;
+	for (int k=0;k<4;k++)
+	  sum += denseA[i*4+k]*d[k]*denseA[j*4+k];
+	adat[i*3+j] = sum;
+      }
+    }
+    normal.normalMatrix(a,d,result);
+    assert( result.getElements() == elements );
+    coinProductTestSame(result,adat,true);
+    // new values in a
+    a.getMutableElements()[0] = 7.0;
+    denseA[0] = 7.0;
+    adat[0] = 49.0*d[0]+4.0*d[2];
+    adat[6] = 35.0*d[0];
+    normal.normalMatrix(a,d,result);
+    coinProductTestSame(result,adat,true);
+    // move element of column 1 to row 0 - same number of elements
+    assert( a.getVectorLengths()[1] == 1 );
+    a.getMutableIndices()[a.getVectorStarts()[1]] = 0;
+    delete [] denseA;
+    denseA = coinProductTestDense(a);
+    for (int i=0;i<3;i++) {
+      for (int j=0;j<3;j++) {
+	double sum = 0.0;
+	for (int k=0;k<4;k++)
+	  sum += denseA[i*4+k]*d[k]*denseA[j*4+k];
+	adat[i*3+j] = sum;
+      }
+    }
+    normal.normalMatrix(a,d,result);
+    coinProductTestSame(result,adat,true);
+    // a different result matrix with the pattern is overwritten correctly
+    {
+      CoinPackedMatrix fresh(result);
+      CoinZeroN(fresh.getMutableElements(),fresh.getNumElements());
+      normal.normalMatrix(a,d,fresh);
+      coinProductTestSame(fresh,adat,true);
+    }
+    // same from row copy
+    CoinPackedMatrix byRow;
+    byRow.reverseOrderedCopyOf(a);
+    CoinPackedMatrixProduct normalRow;
+    CoinPackedMatrix resultRow;
+    normalRow.normalMatrix(byRow,d,resultRow);
+    coinProductTestSame(resultRow,adat,true);
+    // NULL d
+    for (int i=0;i<3;i++) {
+      for (int j=0;j<3;j++) {
+	double sum = 0.0;
+	for (int k=0;k<4;k++)
+	  sum += denseA[i*4+k]*denseA[j*4+k];
+	adat[i*3+j] = sum;
+      }
+    }
+    normalRow.normalMatrix(byRow,NULL,resultRow);
+    coinProductTestSame(resultRow,adat,true);
+    // A*B
+    double ab[6];
+    double * denseB = coinProductTestDense(b);
+    for (int i=0;i<3;i++) {
+      for (int j=0;j<2;j++) {
+	double sum = 0.0;
+	for (int k=0;k<4;k++)
+	  sum += denseA[i*4+k]*denseB[k*2+j];
+	ab[i*2+j] = sum;
+      }
+    }
+    CoinPackedMatrix product;
+    normal.product(a,b,product);
+    assert( product.getNumRows() == 3 && product.getNumCols() == 2 );
+    coinProductTestSame(product,ab,false);
+    // and with b row ordered
+    CoinPackedMatrix bByRow;
+    bByRow.reverseOrderedCopyOf(b);
+    CoinPackedMatrixProduct productRow;
+    productRow.product(byRow,bByRow,product);
+    coinProductTestSame(product,ab,false);
+    bool thrown = false;
+    try {
+      normal.product(b,a,product);
+    }
+    catch (CoinError& e) {
+      thrown = true;
+    }
+    assert( thrown );
+    normal.clear();
+    assert( !normal.hasPattern() );
+    delete [] denseA;
+    delete [] denseB;
+  }
+
+  {
+    // Large random matrix - threads give same result as serial
+    const int numberRows = 20000;
+    const int numberColumns = 100000;
+    const int perColumn = 5;
+    const CoinBigIndex numberElements = numberColumns*perColumn;
+    int * row = new int [numberElements];
+    double * element = new double [numberElements];
+    CoinBigIndex * start = new CoinBigIndex [numberColumns+1];
+    unsigned int seed = 4321;
+    start[0] = 0;
+    for (int i=0;i<numberColumns;i++) {
+      // rows in separate bands so no duplicates
+      for (int j=0;j<perColumn;j++) {
+	seed = seed*1103515245+12345;
+	row[i*perColumn+j] = (j*numberRows)/perColumn+
+	  (seed>>8)%(numberRows/perColumn);
+	element[i*perColumn+j] = 1.0+((seed>>4)&15);
+      }
+      start[i+1] = start[i]+perColumn;
+    }
+    CoinPackedMatrix a(true,numberRows,numberColumns,numberElements,
+		       element,row,start,NULL);
+    delete [] row;
+    delete [] element;
+    delete [] start;
+    double * d = new double [numberColumns];
+    for (int i=0;i<numberColumns;i++)
+      d[i] = 1.0/(i+1.0);
+    CoinThreadPool * oldPool = CoinThreadPool::defaultPool();
+    CoinThreadPool::setDefaultPool(NULL);
+    CoinPackedMatrixProduct serial;
+    CoinPackedMatrix serialResult;
+    double startTime = CoinCpuTime();
+    serial.normalMatrix(a,d,serialResult);
+    const double serialTime = CoinCpuTime()-startTime;
+    CoinThreadPool pool(4);
+    CoinThreadPool::setDefaultPool(&pool);
+    CoinPackedMatrixProduct parallel;
+    CoinPackedMatrix result;
+    startTime = CoinGetTimeOfDay();
+    parallel.normalMatrix(a,d,result);
+    const double firstTime = CoinGetTimeOfDay()-startTime;
+    const double * elements = result.getElements();
+    startTime = CoinGetTimeOfDay();
+    const int numberPasses = coinTestTiming ? 10 : 1;
+    for (int pass=0;pass<numberPasses;pass++)
+      parallel.normalMatrix(a,d,result);
+    const double numericTime = (CoinGetTimeOfDay()-startTime)/numberPasses;
+    assert( result.getElements() == elements );
+    assert( result.getNumElements() == serialResult.getNumElements() );
+    // each column is summed in the same order whatever the threads
+    for (CoinBigIndex j=0;j<result.getNumElements();j++) {
+      assert( result.getIndices()[j] == serialResult.getIndices()[j] );
+      assert( result.getElements()[j] == serialResult.getElements()[j] );
+    }
+    if (coinTestTiming)
+      printf("A*D*A' %d by %d with %d elements - serial %g seconds, first %g then %g seconds with %d threads\n",
+	     numberRows,numberRows,result.getNumElements(),serialTime,
+	     firstTime,numericTime,pool.numberThreads());
+    // A*A' as A times transpose
+    CoinPackedMatrix transpose;
+    transpose.reverseOrderedCopyOf(a);
+    transpose.transpose();
+    parallel.product(a,transpose,result);
+    CoinPackedMatrix check;
+    serial.normalMatrix(a,NULL,check);
+    const CoinBigIndex * startCheck = check.getVectorStarts();
+    const int * lengthCheck = check.getVectorLengths();
+    for (int iColumn=0;iColumn<numberRows;iColumn+=997) {
+      for (CoinBigIndex j=startCheck[iColumn];
+	   j<startCheck[iColumn]+lengthCheck[iColumn];j++) {
+	const int iRow = check.getIndices()[j];
+	assert( fabs(result.getCoefficient(iRow,iColumn)-
+		     check.getElements()[j]) < 1.0e-8 );
+      }
+    }
+    CoinThreadPool::setDefaultPool(oldPool);
+    delete [] d;
+  }
+}
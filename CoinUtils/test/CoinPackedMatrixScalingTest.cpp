@@ -0,0 +1,225 @@
+// Copyright (C) 2012, International Business Machines
+// Corporation and others.  All Rights Reserved.
+// This code is licensed under the terms of the Eclipse Public License (EPL).
+
+#ifdef NDEBUG
+#undef NDEBUG
+#endif
+
+#include <cassert>
+#include <cmath>
+#include <cstdio>
+
+#include "CoinPackedMatrixScaling.hpp"
+#include "CoinPackedMatrix.hpp"
+#include "CoinHelperFunctions.hpp"
+#include "CoinThreadPool.hpp"
+#include "CoinTime.hpp"
+#include "CoinTestTiming.hpp"
+
+//#############################################################################
+
+// Checks fused multiplies against a scaled copy
+static void
+coinScalingTestTimes(const CoinPackedMatrixScaling & scaling,
+		     const CoinPackedMatrix & matrix)
+{
+  const int nRow = matrix.getNumRows();
+  const int nCol = matrix.getNumCols();
+  CoinPackedMatrix scaled(matrix);
+  scaling.apply(scaled);
+  double * x = new double [nCol];
+  double * xT = new double [nRow];
+  double * y = new double [CoinMax(nRow,nCol)];
+  double * y0 = new double [CoinMax(nRow,nCol)];
+  for (int i=0;i<nCol;i++)
+    x[i] = (i%3) ? 1.0/(i+1.0) : 0.0;
+  for (int i=0;i<nRow;i++)
+    xT[i] = 1.0-1.0/(i+2.0);
+  scaling.times(matrix,x,y);
+  scaled.times(x,y0);
+  for (int i=0;i<nRow;i++)
+    assert( fabs(y[i]-y0[i]) < 1.0e-10*(1.0+fabs(y0[i])) );
+  scaling.transposeTimes(matrix,xT,y);
+  scaled.transposeTimes(xT,y0);
+  for (int i=0;i<nCol;i++)
+    assert( fabs(y[i]-y0[i]) < 1.0e-10*(1.0+fabs(y0[i])) );
+  delete [] x;
+  delete [] xT;
+  delete [] y;
+  delete [] y0;
+}
+
+void
+CoinPackedMatrixScalingUnitTest()
+{
+  {
+    /* Badly scaled matrix - rows times 1e3, 1, 1e-3, 1e5 and columns
+       times 1e-2, 1, 1e4 of
+         1  2  .
+         .  1  3
+         2  .  1
+         1  1  1
+       and an empty column
+    */
+    int row[9] = {0,0,1,1,2,2,3,3,3};
+    int column[9] = {0,1,1,2,0,2,0,1,2};
+    double base[9] = {1.0,2.0,1.0,3.0,2.0,1.0,1.0,1.0,1.0};
+    double rowFactor[4] = {1.0e3,1.0,1.0e-3,1.0e5};
+    double columnFactor[3] = {1.0e-2,1.0,1.0e4};
+    double element[9];
+    for (int k=0;k<9;k++)
+      element[k] = base[k]*rowFactor[row[k]]*columnFactor[column[k]];
+    CoinPackedMatrix matrix(true,row,column,element,9);
+    matrix.setDimensions(4,4);
+    const double before = CoinPackedMatrixScaling::ratio(matrix);
+    assert( before > 1.0e10 );
+    // geometric mean
+    CoinPackedMatrixScaling geometric(matrix);
+    assert( geometric.method() == CoinPackedMatrixScaling::geometricMean );
+    assert( geometric.getNumRows() == 4 && geometric.getNumCols() == 4 );
+    double after = CoinPackedMatrixScaling::ratio(matrix,geometric.rowScale(),
+						  geometric.columnScale());
+    assert( after < 10.0 );
+    assert( geometric.columnScale()[3] == 1.0 );
+    coinScalingTestTimes(geometric,matrix);
+    // equilibration - largest in each column is one
+    CoinPackedMatrixScaling equilibrate(matrix,
+					CoinPackedMatrixScaling::equilibration);
+    CoinPackedMatrix scaled(matrix);
+    equilibrate.apply(scaled);
+    for (int j=0;j<3;j++) {
+      double largest = 0.0;
+      for (int i=0;i<4;i++)
+	largest = CoinMax(largest,fabs(scaled.getCoefficient(i,j)));
+      assert( fabs(largest-1.0) < 1.0e-12 );
+    }
+    assert( CoinPackedMatrixScaling::ratio(scaled) < 1.0e-5*before );
+    coinScalingTestTimes(equilibrate,matrix);
+    // Curtis-Reid
+    CoinPackedMatrixScaling curtisReid(matrix,
+				       CoinPackedMatrixScaling::curtisReid);
+    after = CoinPackedMatrixScaling::ratio(matrix,curtisReid.rowScale(),
+					   curtisReid.columnScale());
+    assert( after < 10.0 );
+    coinScalingTestTimes(curtisReid,matrix);
+    // row ordered gives same scales
+    CoinPackedMatrix byRow;
+    byRow.reverseOrderedCopyOf(matrix);
+    CoinPackedMatrixScaling geometricRow(byRow);
+    for (int i=0;i<4;i++) {
+      assert( geometricRow.rowScale()[i] == geometric.rowScale()[i] );
+      assert( geometricRow.columnScale()[i] == geometric.columnScale()[i] );
+    }
+    coinScalingTestTimes(geometricRow,byRow);
+    // and fused multiplies with a kept copy
+    byRow.getOrthoCopy();
+    assert( byRow.hasOrthoCache() );
+    coinScalingTestTimes(geometricRow,byRow);
+    // copies
+    CoinPackedMatrixScaling copy(curtisReid);
+    CoinPackedMatrixScaling assigned;
+    assert( !assigned.getNumRows() );
+    assigned = copy;
+    assert( assigned.method() == CoinPackedMatrixScaling::curtisReid );
+    coinScalingTestTimes(assigned,matrix);
+    // wrong size
+    bool thrown = false;
+    CoinPackedMatrix small(true,row,column,element,3);
+    try {
+      assigned.apply(small);
+    }
+    catch (CoinError& e) {
+      thrown = true;
+    }
+    assert( thrown );
+  }
+
+  {
+    // Curtis-Reid finds exact scales if all elements are one scaled
+    const int numberRows = 50;
+    const int numberColumns = 80;
+    int * row = new int [4*numberColumns];
+    int * column = new int [4*numberColumns];
+    double * element = new double [4*numberColumns];
+    int n = 0;
+    for (int j=0;j<numberColumns;j++) {
+      for (int k=0;k<4;k++) {
+	row[n] = (j+11*k)%numberRows;
+	column[n] = j;
+	element[n] = pow(10.0,(row[n]%7)-3)*pow(2.0,(j%9)-4);
+	n++;
+      }
+    }
+    CoinPackedMatrix matrix(true,row,column,element,n);
+    CoinPackedMatrixScaling scaling(matrix,CoinPackedMatrixScaling::curtisReid,
+				    100);
+    const double after =
+      CoinPackedMatrixScaling::ratio(matrix,scaling.rowScale(),
+				     scaling.columnScale());
+    assert( after < 1.0+1.0e-6 );
+    delete [] row;
+    delete [] column;
+    delete [] element;
+  }
+
+  {
+    // Large matrix - threads give same scales as serial
+    const int numberColumns = 200000;
+    const int numberRows = 50000;
+    const int perColumn = 6;
+    const CoinBigIndex numberElements = numberColumns*perColumn;
+    int * row = new int [numberElements];
+    double * element = new double [numberElements];
+    CoinBigIndex * start = new CoinBigIndex [numberColumns+1];
+    unsigned int seed = 1234;
+    start[0] = 0;
+    for (int i=0;i<numberColumns;i++) {
+      for (int j=0;j<perColumn;j++) {
+	seed = seed*1103515245+12345;
+	const int iRow = (j*numberRows)/perColumn+
+	  (seed>>8)%(numberRows/perColumn);
+	row[i*perColumn+j] = iRow;
+	// badly scaled rows and columns of values from 1 to 8
+	element[i*perColumn+j] = (1.0+((seed>>4)&7))*
+	  pow(10.0,(iRow%9)-4)*pow(10.0,(i%7)-3);
+      }
+      start[i+1] = start[i]+perColumn;
+    }
+    CoinPackedMatrix matrix(true,numberRows,numberColumns,numberElements,
+			    element,row,start,NULL);
+    delete [] row;
+    delete [] element;
+    delete [] start;
+    const double before = CoinPackedMatrixScaling::ratio(matrix);
+    CoinThreadPool * oldPool = CoinThreadPool::defaultPool();
+    CoinThreadPool pool(4);
+    for (int method=0;method<3;method++) {
+      CoinPackedMatrixScaling::Method type =
+	static_cast<CoinPackedMatrixScaling::Method>(method);
+      CoinThreadPool::setDefaultPool(NULL);
+      CoinPackedMatrix copy(matrix);
+      double startTime = CoinGetTimeOfDay();
+      CoinPackedMatrixScaling serial(copy,type);
+      const double serialTime = CoinGetTimeOfDay()-startTime;
+      CoinThreadPool::setDefaultPool(&pool);
+      copy = matrix;
+      startTime = CoinGetTimeOfDay();
+      CoinPackedMatrixScaling parallel(copy,type);
+      const double parallelTime = CoinGetTimeOfDay()-startTime;
+      for (int i=0;i<numberRows;i++)
+	assert( parallel.rowScale()[i] == serial.rowScale()[i] );
+      for (int i=0;i<numberColumns;i++)
+	assert( parallel.columnScale()[i] == serial.columnScale()[i] );
+      const double after =
+	CoinPackedMatrixScaling::ratio(matrix,parallel.rowScale(),
+				       parallel.columnScale());
+      assert( after < before );
+      if (coinTestTiming)
+	printf("Scaling method %d ratio %g to %g - serial %g seconds, %g with %d threads\n",
+	       method,before,after,serialTime,parallelTime,
+	       pool.numberThreads());
+    }
+    CoinThreadPool::setDefaultPool(oldPool);
+  }
+}
@@ -12,10 +12,25 @@
 #endif
 
 #include <cassert>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <utility>
+#if __cplusplus >= 201103L
+#include <type_traits>
+#endif
+#include <vector>
 
 #include "CoinFloatEqual.hpp"
 #include "CoinPackedVector.hpp"
 #include "CoinPackedMatrix.hpp"
+#include "CoinMemoryUsage.hpp"
+#include "CoinMemoryPolicy.hpp"
+#include "CoinIndexedVector.hpp"
+#include "CoinTime.hpp"
+#include "CoinThreadPool.hpp"
+#include "CoinTestRandom.hpp"
+#include "CoinTestTiming.hpp"
 
 //#############################################################################
 
@@ -552,6 +567,37 @@ CoinPackedMatrixUnitTest()
       assert( pm.getExtraMajor() == 0.0 );
     }
 
+    // Test memory usage report
+    {
+      CoinMemoryUsage usage;
+      globalP->memoryUsage(usage);
+      int ne = globalP->getNumElements();
+      int major = globalP->getMajorDim();
+      assert( usage.numberEntries() == 4 );
+      int iElements = usage.find("elements");
+      assert( iElements >= 0 );
+      assert( usage.used(iElements) == ne*static_cast<int>(sizeof(double)) );
+      assert( usage.used(usage.find("indices")) == ne*static_cast<int>(sizeof(int)) );
+      assert( usage.used(usage.find("lengths")) == major*static_cast<int>(sizeof(int)) );
+      // matrix was created with extra gap so there is slack
+      assert( usage.totalReserved() > usage.totalUsed() );
+
+      // exact copy has no slack
+      CoinPackedMatrix tight(*globalP,0,0);
+      CoinMemoryUsage tightUsage;
+      tight.memoryUsage(tightUsage);
+      assert( tightUsage.totalUsed() == usage.totalUsed() );
+      assert( tightUsage.totalReserved() == tightUsage.totalUsed() );
+
+      // adding with prefix merges entries
+      usage.add(tightUsage,"tight");
+      assert( usage.numberEntries() == 8 );
+      usage.add(tightUsage,"tight");
+      assert( usage.numberEntries() == 8 );
+      assert( usage.used(usage.find("tight.elements")) == 
+	      2*ne*static_cast<int>(sizeof(double)) );
+    }
+
 
     // Test ordered triples constructor
     {
@@ -628,7 +674,969 @@ CoinPackedMatrixUnitTest()
     
     delete globalP;
   }
-  
+
+  {
+    // Test memory policies
+    size_t saveThreshold = CoinMemoryPolicy::threshold();
+    int available = CoinMemoryPolicy::available();
+    CoinMemoryPolicy::setThreshold(4096);
+    int policies[4] = { CoinMemoryPolicy::standard,
+			CoinMemoryPolicy::hugePages,
+			CoinMemoryPolicy::explicitHugePages,
+			CoinMemoryPolicy::interleave|CoinMemoryPolicy::firstTouch };
+    for (int i=0;i<4;i++) {
+      double * array = static_cast<double *>
+	(CoinMemoryPolicy::allocate(100000*sizeof(double),policies[i]));
+      assert( (reinterpret_cast<CoinInt64>(array)&63) == 0 );
+      // can only get what is available
+      assert( (CoinMemoryPolicy::policyUsed(array)&~available) == 0 );
+      if (!policies[i])
+	assert( CoinMemoryPolicy::policyUsed(array) == 0 );
+      for (int j=0;j<100000;j++)
+	array[j] = j;
+      assert( array[99999] == 99999.0 );
+      CoinMemoryPolicy::release(array);
+    }
+
+    // Matrix with policy behaves as before
+    const int numberColumns = 200000;
+    const int numberRows = 100000;
+    const int perColumn = 10;
+    const CoinBigIndex numberElements = numberColumns*perColumn;
+    CoinPackedMatrix standard;
+    coinTestRandomMatrix(standard,numberRows,numberColumns,perColumn,12345);
+    const int * row = standard.getIndices();
+    const double * element = standard.getElements();
+    const CoinBigIndex * start = standard.getVectorStarts();
+    assert( standard.memoryPolicy() == CoinMemoryPolicy::defaultPolicy() );
+    CoinPackedMatrix huge(standard);
+    huge.setMemoryPolicy(CoinMemoryPolicy::hugePages|
+			 CoinMemoryPolicy::interleave);
+    assert( huge.memoryPolicy() != 0 );
+    assert( huge.isEquivalent(standard) );
+    CoinPackedMatrix hugeCopy(huge);
+    assert( hugeCopy.memoryPolicy() == huge.memoryPolicy() );
+    hugeCopy.deleteCols(1,row);
+    hugeCopy.reverseOrdering();
+    hugeCopy.removeGaps();
+    hugeCopy.swap(standard);
+    assert( standard.memoryPolicy() == huge.memoryPolicy() );
+    hugeCopy.swap(standard);
+    // assignMatrix copies to policy memory
+    CoinPackedMatrix assigned;
+    assigned.setMemoryPolicy(CoinMemoryPolicy::hugePages);
+    {
+      double * elem = new double [numberElements];
+      int * ind = new int [numberElements];
+      CoinBigIndex * starts = new CoinBigIndex [numberColumns+1];
+      CoinMemcpyN(element,numberElements,elem);
+      CoinMemcpyN(row,numberElements,ind);
+      CoinMemcpyN(start,numberColumns+1,starts);
+      int * len = NULL;
+      assigned.assignMatrix(true,numberRows,numberColumns,numberElements,
+			    elem,ind,starts,len);
+      assert( !elem && !ind );
+    }
+    assert( assigned.isEquivalent(standard) );
+
+    // y=Ax same with standard and huge page arrays (timed with -timing)
+    double * x = new double [numberColumns];
+    double * y = new double [numberRows];
+    for (int i=0;i<numberColumns;i++)
+      x[i] = 1.0/(1+i%7);
+    double time[2] = {0.0,0.0};
+    double sum[2] = {0.0,0.0};
+    for (int pass=0;pass<(coinTestTiming ? 10 : 1);pass++) {
+      for (int k=0;k<2;k++) {
+	const CoinPackedMatrix & matrix = k ? huge : standard;
+	double startTime = CoinCpuTime();
+	matrix.times(x,y);
+	time[k] += CoinCpuTime()-startTime;
+	sum[k] = 0.0;
+	for (int i=0;i<numberRows;i++)
+	  sum[k] += y[i];
+      }
+      assert( sum[0] == sum[1] );
+    }
+    if (coinTestTiming)
+      printf("times() with %d elements - standard %g, huge pages (got %d) %g seconds\n",
+	     numberElements,time[0],
+	     CoinMemoryPolicy::policyUsed(huge.getElements()),time[1]);
+
+    // Arrays
+    CoinDoubleArrayWithLength work;
+    work.setMemoryPolicy(CoinMemoryPolicy::hugePages);
+    work.switchOn();
+    double * w = work.conditionalNew(numberElements);
+    CoinMemcpyN(element,numberElements,w);
+    assert( (reinterpret_cast<CoinInt64>(w)&63) == 0 );
+    work.extend(2*numberElements*static_cast<int>(sizeof(double)));
+    assert( work.array()[numberElements-1] == element[numberElements-1] );
+
+    delete [] x;
+    delete [] y;
+    CoinMemoryPolicy::setThreshold(saveThreshold);
+  }
+
+  {
+    // transposeTimes with sparse x - both orders, packed and not
+    const int numberColumns = 20000;
+    const int numberRows = 10000;
+    const int perColumn = 5;
+    CoinPackedMatrix byColumn;
+    coinTestRandomMatrix(byColumn,numberRows,numberColumns,perColumn,54321);
+    CoinPackedMatrix byRow;
+    byRow.reverseOrderedCopyOf(byColumn);
+    double * xDense = new double [numberRows];
+    double * yDense = new double [numberColumns];
+    CoinIndexedVector x;
+    x.reserve(numberRows);
+    CoinIndexedVector y;
+    int numbers[4] = {0,5,500,numberRows};
+    for (int order=0;order<3;order++) {
+      // column ordered without and with row copy, row ordered
+      CoinPackedMatrix matrix(order==2 ? byRow : byColumn);
+      if (order==1)
+	matrix.getOrthoCopy();
+      for (int k=0;k<4;k++) {
+	// list, packed, bitmap, pure dense
+	for (int packed=0;packed<4;packed++) {
+	  x.clear();
+	  CoinZeroN(xDense,numberRows);
+	  for (int i=0;i<numbers[k];i++) {
+	    int iRow = (i*7919)%numberRows;
+	    double value = 1.0+(i%3);
+	    if (!xDense[iRow]) {
+	      xDense[iRow] = value;
+	      x.insert(iRow,value);
+	    }
+	  }
+	  if (packed>1) {
+	    x.setRepresentation(packed==2 ? CoinIndexedVector::nonzeroBitmap :
+				CoinIndexedVector::pureDense);
+	  } else if (packed) {
+	    CoinIndexedVector unpacked(x);
+	    x.clear();
+	    x.reserve(numberRows);
+	    for (int i=0;i<unpacked.getNumElements();i++) {
+	      int iRow = unpacked.getIndices()[i];
+	      x.getIndices()[i] = iRow;
+	      x.denseVector()[i] = unpacked.denseVector()[iRow];
+	    }
+	    x.setNumElements(unpacked.getNumElements());
+	    x.setPackedMode(true);
+	  }
+	  matrix.transposeTimes(xDense,yDense);
+	  const CoinIndexedVector & constX = x;
+	  matrix.transposeTimes(constX,y);
+	  assert( x.representation() == (packed>1 ? packed-1 : 0) );
+	  x.setRepresentation(CoinIndexedVector::indexList);
+	  assert( !y.packedMode() );
+	  const double * yValue = y.denseVector();
+	  int n = 0;
+	  for (int i=0;i<numberColumns;i++) {
+	    assert( fabs(yValue[i]-yDense[i]) < 1.0e-10 );
+	    if (fabs(yDense[i])>1.0e-10)
+	      n++;
+	  }
+	  assert( y.getNumElements() >= n );
+	  for (int i=0;i<y.getNumElements();i++)
+	    assert( yValue[y.getIndices()[i]] );
+	}
+	// copy only used if built first
+	assert( matrix.hasOrthoCache() == (order==1) );
+      }
+      matrix.modifyCoefficient(0,0,2.0);
+      assert( !matrix.hasOrthoCache() );
+    }
+
+    if (coinTestTiming) {
+      // Time very sparse x - along rows against down columns
+      CoinIndexedVector xSparse;
+      xSparse.reserve(numberRows);
+      for (int i=0;i<10;i++)
+	xSparse.insert(i*997,1.0);
+      double * xFull = new double [numberRows];
+      CoinZeroN(xFull,numberRows);
+      for (int i=0;i<10;i++)
+	xFull[i*997] = 1.0;
+      double time[2];
+      for (int k=0;k<2;k++) {
+	double startTime = CoinCpuTime();
+	for (int pass=0;pass<1000;pass++) {
+	  if (k)
+	    byColumn.transposeTimes(xSparse,y);
+	  else
+	    byColumn.transposeTimes(xFull,yDense);
+	}
+	time[k] = CoinCpuTime()-startTime;
+      }
+      printf("transposeTimes() with 10 nonzeros - dense %g, sparse %g seconds\n",
+	     time[0],time[1]);
+      delete [] xFull;
+    }
+    delete [] xDense;
+    delete [] yDense;
+  }
+
+  {
+    // 64 bit starts - what works must give same answers
+    //    1  .  2  .
+    //    .  3  .  .
+    //    4  .  5  6
+    int row[6] = {0,0,1,2,2,2};
+    int column[6] = {0,2,1,0,2,3};
+    double element[6] = {1.0,2.0,3.0,4.0,5.0,6.0};
+    CoinPackedMatrix narrow(true,row,column,element,6);
+    narrow.reserve(4,20);
+    CoinPackedMatrix wide(narrow);
+    assert( !wide.hasWideStarts() );
+    wide.setWideStarts(true);
+    assert( wide.hasWideStarts() );
+    assert( !wide.hasGaps() );
+    assert( wide.getNumElements() == 6 );
+    assert( wide.getNumElementsWide() == 6 );
+    assert( wide.getWideVectorStarts()[4] == 6 );
+    assert( wide.getVectorStarts() == NULL );
+    double x[4] = {1.0,2.0,3.0,4.0};
+    double y[4];
+    double y0[4];
+    wide.times(x,y);
+    narrow.times(x,y0);
+    assert( !memcmp(y,y0,3*sizeof(double)) );
+    wide.transposeTimes(x,y);
+    narrow.transposeTimes(x,y0);
+    assert( !memcmp(y,y0,4*sizeof(double)) );
+    int * count = wide.countOrthoLength();
+    assert( count[0] == 2 && count[1] == 1 && count[2] == 3 );
+    delete [] count;
+    // reverse both ways
+    CoinPackedMatrix byRow;
+    byRow.reverseOrderedCopyOf(wide);
+    assert( byRow.hasWideStarts() && !byRow.isColOrdered() );
+    byRow.times(x,y);
+    narrow.times(x,y0);
+    assert( !memcmp(y,y0,3*sizeof(double)) );
+    byRow.reverseOrdering();
+    assert( byRow.isColOrdered() );
+    byRow.setWideStarts(false);
+    assert( byRow.isEquivalent(narrow) );
+    // copies and swap
+    CoinPackedMatrix copy(wide);
+    assert( copy.hasWideStarts() );
+    CoinPackedMatrix assigned;
+    assigned = copy;
+    assigned.swap(narrow);
+    assert( narrow.hasWideStarts() && !assigned.hasWideStarts() );
+    narrow.swap(assigned);
+    CoinPackedMatrix copied;
+    copied.copyOf(wide);
+    copied.setMemoryPolicy(1);
+    copied.transposeTimes(x,y);
+    narrow.transposeTimes(x,y0);
+    assert( !memcmp(y,y0,4*sizeof(double)) );
+    copied.setWideStarts(false);
+    assert( copied.isEquivalent(narrow) );
+    // anything needing 32 bit starts throws
+    bool thrown = false;
+    try {
+      wide.modifyCoefficient(1,1,7.0);
+    }
+    catch (CoinError& e) {
+      thrown = true;
+    }
+    assert( thrown );
+    thrown = false;
+    try {
+      narrow.rightAppendPackedMatrix(wide);
+    }
+    catch (CoinError& e) {
+      thrown = true;
+    }
+    assert( thrown );
+    // starts given as 64 bit
+    CoinInt64 * start = new CoinInt64 [5];
+    int * index = new int [6];
+    double * value = new double [6];
+    for (int i=0;i<5;i++)
+      start[i] = narrow.getVectorStarts()[i];
+    CoinMemcpyN(narrow.getIndices(),6,index);
+    CoinMemcpyN(narrow.getElements(),6,value);
+    CoinPackedMatrix assignedWide;
+    assignedWide.assignWideMatrix(true,3,4,start,index,value);
+    assert( !start && !index && !value );
+    // small enough so stored with 32 bit starts
+    assert( !assignedWide.hasWideStarts() );
+    assert( assignedWide.isEquivalent(narrow) );
+    // back again and usable as before
+    wide.setWideStarts(false);
+    wide.modifyCoefficient(1,1,7.0);
+    assert( wide.getCoefficient(1,1) == 7.0 );
+  }
+
+  {
+    /* 64 bit starts on a bigger matrix with gaps - everything said to
+       work gives the same answers as 32 bit starts */
+    const int numberRows = 3000;
+    const int numberColumns = 2000;
+    CoinPackedMatrix random;
+    coinTestRandomMatrix(random,numberRows,numberColumns,10,4321);
+    // drop last element of every third column to leave gaps
+    CoinBigIndex numberElements = random.getNumElements();
+    int * length = CoinCopyOfArray(random.getVectorLengths(),numberColumns);
+    double * element = CoinCopyOfArray(random.getElements(),numberElements);
+    int * index = CoinCopyOfArray(random.getIndices(),numberElements);
+    CoinBigIndex * start = CoinCopyOfArray(random.getVectorStarts(),
+					   numberColumns+1);
+    for (int i=0;i<numberColumns;i+=3) {
+      length[i]--;
+      numberElements--;
+    }
+    CoinPackedMatrix narrow;
+    narrow.assignMatrix(true,numberRows,numberColumns,numberElements,
+			element,index,start,length);
+    assert( narrow.hasGaps() );
+    CoinPackedMatrix wide(narrow);
+    wide.setWideStarts(true);
+    assert( wide.getVectorStarts() == NULL );
+    assert( !wide.hasGaps() );
+    assert( wide.getNumElementsWide() == narrow.getNumElements() );
+    const CoinInt64 * wideStart = wide.getWideVectorStarts();
+    for (int i=0;i<numberColumns;i++)
+      assert( wideStart[i+1]-wideStart[i] == narrow.getVectorSize(i) );
+    double * x = new double [numberRows];
+    double * y = new double [numberRows];
+    double * y0 = new double [numberRows];
+    for (int i=0;i<numberRows;i++)
+      x[i] = 1.0+(i%5);
+    wide.times(x,y);
+    narrow.times(x,y0);
+    assert( !memcmp(y,y0,numberRows*sizeof(double)) );
+    wide.transposeTimes(x,y);
+    narrow.transposeTimes(x,y0);
+    assert( !memcmp(y,y0,numberColumns*sizeof(double)) );
+    int * count = wide.countOrthoLength();
+    int * count0 = narrow.countOrthoLength();
+    assert( !memcmp(count,count0,narrow.getNumRows()*sizeof(int)) );
+    delete [] count;
+    delete [] count0;
+    CoinPackedMatrix byRow;
+    byRow.reverseOrderedCopyOf(wide);
+    assert( byRow.hasWideStarts() );
+    byRow.transposeTimes(x,y);
+    narrow.transposeTimes(x,y0);
+    assert( !memcmp(y,y0,numberColumns*sizeof(double)) );
+    byRow.transpose();
+    CoinPackedMatrix back;
+    back.reverseOrderedCopyOf(byRow);
+    back.transpose();
+    back.setWideStarts(false);
+    assert( back.isEquivalent(narrow) );
+    CoinPackedMatrix copy;
+    copy = wide;
+    copy.setMemoryPolicy(1);
+    copy.setWideStarts(false);
+    assert( copy.isEquivalent(narrow) );
+    delete [] x;
+    delete [] y;
+    delete [] y0;
+  }
+
+  {
+    /* Rows added to column ordered matrix only get the room asked for
+       on a first move, then room to grow */
+    //    1  2
+    //    3  4
+    int row[4] = {0,0,1,1};
+    int column[4] = {0,1,0,1};
+    double element[4] = {1.0,2.0,3.0,4.0};
+    CoinBigIndex starts[2] = {0,2};
+    int columns[2] = {1,0};
+    double values[2] = {6.0,5.0};
+    for (int k=0;k<2;k++) {
+      CoinPackedMatrix matrix(true,row,column,element,4);
+      assert( !matrix.hasGaps() );
+      if (k)
+	matrix.setExtraGap(1.0);
+      matrix.appendRows(1,starts,columns,values);
+      assert( matrix.getNumRows() == 3 );
+      assert( matrix.getNumElements() == 6 );
+      assert( matrix.getCoefficient(2,0) == 5.0 );
+      assert( matrix.getCoefficient(2,1) == 6.0 );
+      const CoinBigIndex last = matrix.getVectorStarts()[2];
+      if (!k) {
+	assert( last == matrix.getNumElements() );
+	assert( !matrix.hasGaps() );
+	// second move leaves room so third goes in place
+	matrix.appendRows(1,starts,columns,values);
+	assert( matrix.hasGaps() );
+	const double * oldElements = matrix.getElements();
+	matrix.appendRows(1,starts,columns,values);
+	assert( matrix.getElements() == oldElements );
+	assert( matrix.getNumElements() == 10 );
+	assert( matrix.getCoefficient(4,0) == 5.0 );
+	assert( matrix.getCoefficient(4,1) == 6.0 );
+	assert( matrix.getCoefficient(1,1) == 4.0 );
+      } else {
+	assert( last == 2*matrix.getNumElements() );
+      }
+    }
+  }
+
+  {
+    // Rounds of rows added to column ordered matrix as in a cut loop
+    const int numberColumns = 20000;
+    const int numberRows = 5000;
+    const int perRow = 40;
+    const int rowsPerRound = 500;
+    const int numberRounds = 20;
+    CoinSeedRandom(1234);
+    CoinPackedMatrix byColumn;
+    {
+      int * row = new int [numberRows*perRow];
+      int * column = new int [numberRows*perRow];
+      double * element = new double [numberRows*perRow];
+      for (int i=0;i<numberRows*perRow;i++) {
+	row[i] = i/perRow;
+	// distinct columns in each row
+	column[i] = (row[i]*7)%(numberColumns/perRow)+
+	  (i%perRow)*(numberColumns/perRow);
+	element[i] = 1.0+coinTestRandomInt(8);
+      }
+      CoinPackedMatrix m(true,row,column,element,numberRows*perRow);
+      m.setDimensions(numberRows,numberColumns);
+      byColumn.swap(m);
+      delete [] row;
+      delete [] column;
+      delete [] element;
+    }
+    CoinPackedMatrix byRow;
+    byRow.reverseOrderedCopyOf(byColumn);
+    CoinBigIndex * rowStart = new CoinBigIndex [rowsPerRound+1];
+    int * column = new int [rowsPerRound*perRow];
+    double * element = new double [rowsPerRound*perRow];
+    double time = 0.0;
+    int numberMoves = 0;
+    for (int round=0;round<numberRounds;round++) {
+      rowStart[0] = 0;
+      for (int i=0;i<rowsPerRound;i++) {
+	// distinct columns in each row
+	int first = i%(numberColumns/perRow);
+	for (int j=0;j<perRow;j++) {
+	  column[i*perRow+j] = first+j*(numberColumns/perRow);
+	  element[i*perRow+j] = 1.0+coinTestRandomInt(8);
+	}
+	rowStart[i+1] = rowStart[i]+perRow;
+      }
+      const double * oldElements = byColumn.getElements();
+      double startTime = CoinCpuTime();
+      byColumn.appendRows(rowsPerRound,rowStart,column,element);
+      time += CoinCpuTime()-startTime;
+      if (byColumn.getElements()!=oldElements)
+	numberMoves++;
+      byRow.appendRows(rowsPerRound,rowStart,column,element);
+    }
+    assert( byColumn.getNumRows() == numberRows+numberRounds*rowsPerRound );
+    assert( byColumn.getNumElements() == byRow.getNumElements() );
+    // room is left when moving again so most rounds go in place
+    assert( numberMoves < numberRounds/2 );
+    CoinPackedMatrix check;
+    check.reverseOrderedCopyOf(byRow);
+    assert( check.isEquivalent(byColumn) );
+    // also as packed vectors and as a matrix
+    CoinPackedVector cut;
+    cut.insert(3,2.0);
+    cut.insert(numberColumns-1,-1.0);
+    const CoinPackedVectorBase * cuts[1] = {&cut};
+    byColumn.appendRows(1,cuts);
+    byRow.appendRows(1,cuts);
+    CoinPackedMatrix block(false,0,0);
+    block.setDimensions(0,numberColumns);
+    block.appendRow(cut);
+    byColumn.bottomAppendPackedMatrix(block);
+    byRow.bottomAppendPackedMatrix(block);
+    assert( byColumn.getCoefficient(byColumn.getNumRows()-1,3) == 2.0 );
+    check.reverseOrderedCopyOf(byRow);
+    assert( check.isEquivalent(byColumn) );
+    if (coinTestTiming)
+      printf("%d rounds of %d rows added to %d columns in %g seconds (%d moves)\n",
+	     numberRounds,rowsPerRound,numberColumns,time,numberMoves);
+    delete [] rowStart;
+    delete [] column;
+    delete [] element;
+  }
+
+  {
+    // Dual ordered - row copy kept through logged changes
+    //    1  .  2  .
+    //    .  3  .  .
+    //    4  .  5  6
+    int row[6] = {0,0,1,2,2,2};
+    int column[6] = {0,2,1,0,2,3};
+    double element[6] = {1.0,2.0,3.0,4.0,5.0,6.0};
+    CoinPackedMatrix matrix(true,row,column,element,6);
+    matrix.setDualOrdered(true);
+    assert( matrix.dualOrdered() );
+    assert( !matrix.hasOrthoCache() );
+    assert( !matrix.getOrthoCopy().isColOrdered() );
+    assert( matrix.hasOrthoCache() );
+    // a mixture of logged changes
+    int ind[3] = {0,1,2};
+    double el[3] = {7.0,8.0,9.0};
+    matrix.appendCol(3,ind,el);
+    matrix.appendRow(2,ind,el);
+    CoinPackedVector vec;
+    vec.insert(4,-1.0);
+    vec.insert(1,-2.0);
+    matrix.appendCol(vec);
+    matrix.modifyCoefficient(1,1,10.0);
+    matrix.modifyCoefficient(1,3,11.0);
+    matrix.modifyCoefficient(2,3,0.0);
+    matrix.replaceVector(0,1,el);
+    matrix.setDimensions(-1,7);
+    CoinBigIndex starts[3] = {0,2,3};
+    int columns[3] = {6,0,3};
+    matrix.appendRows(2,starts,columns,el);
+    assert( matrix.hasOrthoCache() );
+    CoinPackedMatrix check;
+    check.reverseOrderedCopyOf(matrix);
+    assert( matrix.getOrthoCopy().isEquivalent(check) );
+    // log applied so more changes can be logged
+    int del[2] = {5,1};
+    matrix.deleteCols(2,del);
+    matrix.deleteRows(1,del+1);
+    assert( matrix.hasOrthoCache() );
+    check.reverseOrderedCopyOf(matrix);
+    assert( matrix.getOrthoCopy().isEquivalent(check) );
+    assert( matrix.getOrthoCopy().getNumRows() == 6 );
+    assert( matrix.getOrthoCopy().getNumCols() == 5 );
+    // copy keeps setting, not copy
+    CoinPackedMatrix copy(matrix);
+    assert( copy.dualOrdered() && !copy.hasOrthoCache() );
+    // sparse transposeTimes does not use copy with changes pending
+    matrix.modifyCoefficient(0,0,100.0);
+    CoinIndexedVector x;
+    x.reserve(matrix.getNumRows());
+    x.insert(0,1.0);
+    CoinIndexedVector y;
+    matrix.transposeTimes(x,y);
+    assert( y[0] == 100.0 );
+    // other changes drop copy
+    matrix.compress(1.0e-3);
+    assert( !matrix.hasOrthoCache() );
+    // failed change drops copy
+    matrix.getOrthoCopy();
+    bool thrown = false;
+    try {
+      // fewer rows
+      matrix.setDimensions(1,-1);
+    }
+    catch (CoinError& e) {
+      thrown = true;
+    }
+    assert( thrown );
+    assert( !matrix.hasOrthoCache() );
+    // too many changes rebuild copy
+    matrix.getOrthoCopy();
+    for (int i=0;i<1000;i++)
+      matrix.appendCol(3,ind,el);
+    assert( !matrix.hasOrthoCache() );
+    check.reverseOrderedCopyOf(matrix);
+    assert( matrix.getOrthoCopy().isEquivalent(check) );
+    matrix.setDualOrdered(false);
+    matrix.modifyCoefficient(0,0,1.0);
+    assert( !matrix.hasOrthoCache() );
+  }
+
+  {
+    // Small changes each followed by use of row copy (timed with -timing)
+    const int numberColumns = 20000;
+    const int numberRows = 5000;
+    const int perColumn = 10;
+    int * row = new int [numberColumns*perColumn];
+    int * column = new int [numberColumns*perColumn];
+    double * element = new double [numberColumns*perColumn];
+    for (int i=0;i<numberColumns*perColumn;i++) {
+      column[i] = i/perColumn;
+      row[i] = (column[i]*7+(i%perColumn)*(numberRows/perColumn))%numberRows;
+      element[i] = 1.0+(i%5);
+    }
+    double time[2];
+    CoinPackedMatrix copies[2];
+    for (int k=0;k<2;k++) {
+      CoinPackedMatrix matrix(true,row,column,element,numberColumns*perColumn);
+      matrix.setDualOrdered(k!=0);
+      double startTime = CoinCpuTime();
+      for (int pass=0;pass<100;pass++) {
+	int ind[2] = {pass,pass+numberRows/2};
+	double el[2] = {1.0,-1.0};
+	matrix.appendCol(2,ind,el);
+	matrix.modifyCoefficient(pass,pass*3,2.0);
+	assert( matrix.getOrthoCopy().getNumCols() == matrix.getNumCols() );
+      }
+      time[k] = CoinCpuTime()-startTime;
+      copies[k].reverseOrderedCopyOf(matrix);
+      assert( !k || matrix.getOrthoCopy().isEquivalent(copies[k]) );
+    }
+    assert( copies[0].isEquivalent(copies[1]) );
+    if (coinTestTiming)
+      printf("100 changes each followed by row copy - rebuilt %g, dual ordered %g seconds\n",
+	     time[0],time[1]);
+    delete [] row;
+    delete [] column;
+    delete [] element;
+  }
+
+  {
+    // Duplicates merged and small elements dropped with counts
+    //    1+2  .   -3+7
+    //     .   4   1e-9+2e-9
+    //     3   .    .
+    int start[3] = {0,3,4};
+    int length[3] = {3,1,4};
+    int index[8] = {0,0,2,1,1,0,1,0};
+    double element[8] = {1.0,2.0,3.0,4.0,1.0e-9,-3.0,2.0e-9,7.0};
+    CoinPackedMatrix matrix(true,3,3,8,element,index,start,length);
+    CoinPackedMatrix copy(matrix);
+    CoinBigIndex numberDuplicates;
+    CoinBigIndex numberSmall;
+    int n = matrix.eliminateDuplicates(1.0e-6,&numberDuplicates,&numberSmall);
+    assert( numberDuplicates == 3 && numberSmall == 1 && n == 4 );
+    assert( matrix.getNumElements() == 4 );
+    assert( matrix.getVectorStarts()[1] == 3 );
+    assert( matrix.getCoefficient(0,0) == 3.0 );
+    assert( matrix.getCoefficient(0,2) == 4.0 );
+    assert( matrix.getVectorSize(2) == 1 );
+    n = copy.cleanMatrix(1.0e-6,&numberDuplicates,NULL);
+    assert( numberDuplicates == 3 && n == 4 );
+    assert( copy.isEquivalent(matrix) );
+    assert( copy.getVectorStarts()[1] == 2 );
+    assert( copy.getIndices()[0] == 0 && copy.getIndices()[1] == 2 );
+    // threshold 0 - duplicates go (and are counted) but a zero sum stays
+    //    1-1
+    //    2+3
+    //     4
+    CoinBigIndex startZero[2] = {0,5};
+    int indexZero[5] = {0,0,1,1,2};
+    double elementZero[5] = {1.0,-1.0,2.0,3.0,4.0};
+    CoinPackedMatrix zero(true,3,1,5,elementZero,indexZero,startZero,NULL);
+    n = zero.eliminateDuplicates(0.0);
+    assert( n == 2 );
+    assert( zero.getNumElements() == 3 && zero.getVectorSize(0) == 3 );
+    assert( zero.getIndices()[0] == 0 && zero.getElements()[0] == 0.0 );
+    assert( zero.getCoefficient(1,0) == 5.0 );
+    assert( zero.getCoefficient(2,0) == 4.0 );
+    // any positive threshold drops it
+    n = zero.eliminateDuplicates(1.0e-12,&numberDuplicates,&numberSmall);
+    assert( n == 1 && numberDuplicates == 0 && numberSmall == 1 );
+    assert( zero.getNumElements() == 2 && zero.getVectorSize(0) == 2 );
+  }
+
+  {
+    // Cleaning a large matrix with threads gives same as without
+    const int numberColumns = 50000;
+    const int numberRows = 2000;
+    const int perColumn = 12;
+    const int numberElements = numberColumns*perColumn;
+    int * row = new int [numberElements];
+    double * element = new double [numberElements];
+    CoinBigIndex * start = new CoinBigIndex [numberColumns+1];
+    CoinSeedRandom(1234);
+    start[0] = 0;
+    for (int i=0;i<numberColumns;i++) {
+      for (int j=0;j<perColumn;j++) {
+	// few rows so many duplicates
+	row[i*perColumn+j] = (i+coinTestRandomInt(8))%numberRows;
+	bool small = coinTestRandomInt(2) != 0;
+	element[i*perColumn+j] = small ? 1.0e-12 : 1.0+coinTestRandomInt(4);
+      }
+      start[i+1] = start[i]+perColumn;
+    }
+    CoinPackedMatrix clean[2];
+    CoinBigIndex counts[2][2];
+    double time[2];
+    CoinThreadPool pool(4);
+    for (int k=0;k<2;k++) {
+      CoinThreadPool::setDefaultPool(k ? &pool : NULL);
+      clean[k] = CoinPackedMatrix(true,numberRows,numberColumns,numberElements,
+				  element,row,start,NULL);
+      double startTime = CoinCpuTime();
+      clean[k].cleanMatrix(1.0e-10,counts[k],counts[k]+1);
+      time[k] = CoinCpuTime()-startTime;
+    }
+    CoinThreadPool::setDefaultPool(NULL);
+    assert( counts[0][0] == counts[1][0] && counts[0][1] == counts[1][1] );
+    assert( counts[0][0] > 0 && counts[0][1] > 0 );
+    assert( clean[0].getNumElements() ==
+	    numberElements-counts[0][0]-counts[0][1] );
+    assert( clean[0].isEquivalent(clean[1]) );
+    // sorted and no gaps
+    for (int i=0;i<numberColumns;i++) {
+      assert( clean[1].getVectorFirst(i) == (i ? clean[1].getVectorLast(i-1) : 0) );
+      for (CoinBigIndex j=clean[1].getVectorFirst(i)+1;
+	   j<clean[1].getVectorLast(i);j++)
+	assert( clean[1].getIndices()[j-1] < clean[1].getIndices()[j] );
+    }
+    if (coinTestTiming)
+      printf("cleanMatrix %d elements (%d duplicates, %d small) - serial %g, threads %g seconds\n",
+	     numberElements,counts[0][0],counts[0][1],time[0],time[1]);
+    delete [] row;
+    delete [] element;
+    delete [] start;
+  }
+
+  {
+    // Sorted indices - binary search and batched changes
+    //    1  .  2  .
+    //    .  3  .  .
+    //    4  .  5  6
+    int row[6] = {2,0,1,2,0,2};
+    int column[6] = {2,0,1,0,2,3};
+    double element[6] = {5.0,1.0,3.0,4.0,2.0,6.0};
+    CoinPackedMatrix matrix(true,row,column,element,6);
+    matrix.orderMatrix();
+    assert( matrix.hasSortedIndices() );
+    assert( matrix.getCoefficient(2,2) == 5.0 );
+    assert( matrix.getCoefficient(1,2) == 0.0 );
+    // single change goes in place
+    matrix.modifyCoefficient(1,2,7.0);
+    assert( matrix.hasSortedIndices() );
+    assert( matrix.getCoefficient(1,2) == 7.0 );
+    assert( matrix.getIndices()[matrix.getVectorStarts()[2]+1] == 1 );
+    // copies and reverse ordered copy are sorted
+    CoinPackedMatrix copy(matrix);
+    assert( copy.hasSortedIndices() );
+    CoinPackedMatrix byRow;
+    byRow.reverseOrderedCopyOf(matrix);
+    assert( byRow.hasSortedIndices() );
+    // batch - replace, add (twice so last used), delete and bad index
+    int rows[6] = {1,0,1,2,1,5};
+    int columns[6] = {3,0,3,0,0,0};
+    double values[6] = {8.0,9.0,10.0,0.0,11.0,12.0};
+    matrix.modifyCoefficients(6,rows,columns,values);
+    assert( matrix.hasSortedIndices() );
+    assert( matrix.getNumElements() == 8 );
+    assert( matrix.getCoefficient(1,3) == 10.0 );
+    assert( matrix.getCoefficient(0,0) == 9.0 );
+    assert( matrix.getCoefficient(2,0) == 0.0 );
+    assert( matrix.getCoefficient(1,0) == 11.0 );
+    byRow.modifyCoefficients(6,rows,columns,values);
+    assert( byRow.hasSortedIndices() );
+    CoinPackedMatrix check;
+    check.reverseOrderedCopyOf(byRow);
+    assert( check.isEquivalent(matrix) );
+    // so does getting mutable arrays - reverse column 2
+    CoinBigIndex first = matrix.getVectorFirst(2);
+    assert( matrix.getVectorSize(2) == 3 );
+    int * mutableIndices = matrix.getMutableIndices();
+    double * mutableElements = matrix.getMutableElements();
+    assert( !matrix.hasSortedIndices() );
+    std::swap(mutableIndices[first],mutableIndices[first+2]);
+    std::swap(mutableElements[first],mutableElements[first+2]);
+    assert( matrix.getCoefficient(2,2) == 5.0 );
+    assert( matrix.getCoefficient(0,2) == 2.0 );
+    assert( matrix.getCoefficient(1,2) == 7.0 );
+    // other changes forget order
+    matrix.orderMatrix();
+    assert( matrix.hasSortedIndices() );
+    matrix.appendCol(2,row,element);
+    assert( !matrix.hasSortedIndices() );
+  }
+
+  {
+    // Batched changes same as one at a time (sorted or not, either order)
+    const int numberRows = 300;
+    const int numberColumns = 500;
+    const int numberElements = 3000;
+    int * row = new int [numberElements];
+    int * column = new int [numberElements];
+    double * element = new double [numberElements];
+    unsigned int seed = 2468;
+    for (int k=0;k<numberElements;k++) {
+      seed = seed*1103515245+12345;
+      row[k] = (seed>>8)%numberRows;
+      seed = seed*1103515245+12345;
+      column[k] = (seed>>8)%numberColumns;
+      element[k] = 1.0+k;
+    }
+    CoinPackedMatrix base(true,row,column,element,numberElements);
+    base.eliminateDuplicates(0.0);
+    const int numberChanges = 20000;
+    int * rows = new int [numberChanges];
+    int * columns = new int [numberChanges];
+    double * values = new double [numberChanges];
+    for (int k=0;k<numberChanges;k++) {
+      seed = seed*1103515245+12345;
+      rows[k] = (seed>>8)%numberRows;
+      seed = seed*1103515245+12345;
+      columns[k] = (seed>>8)%numberColumns;
+      // some zeros to delete
+      values[k] = (k%7) ? k+0.5 : 0.0;
+    }
+    for (int type=0;type<8;type++) {
+      const bool byRow = (type&1)!=0;
+      const bool sorted = (type&2)!=0;
+      const bool keepZero = (type&4)!=0;
+      CoinPackedMatrix one;
+      if (byRow)
+	one.reverseOrderedCopyOf(base);
+      else
+	one = base;
+      if (sorted)
+	one.orderMatrix();
+      else
+	one.clearCaches();
+      assert( one.hasSortedIndices() == sorted );
+      CoinPackedMatrix batch(one);
+      // a few at a time and then the rest
+      for (int k=0;k<100;k++)
+	one.modifyCoefficient(rows[k],columns[k],values[k],keepZero);
+      batch.modifyCoefficients(100,rows,columns,values,keepZero);
+      assert( batch.isEquivalent(one) );
+      assert( batch.getNumElements() == one.getNumElements() );
+      for (int k=100;k<numberChanges;k++)
+	one.modifyCoefficient(rows[k],columns[k],values[k],keepZero);
+      batch.modifyCoefficients(numberChanges-100,rows+100,columns+100,
+			       values+100,keepZero);
+      assert( batch.isEquivalent(one) );
+      assert( batch.getNumElements() == one.getNumElements() );
+      assert( batch.hasSortedIndices() == sorted );
+      if (sorted) {
+	const CoinBigIndex * start = batch.getVectorStarts();
+	const int * length = batch.getVectorLengths();
+	const int * index = batch.getIndices();
+	for (int i=0;i<batch.getMajorDim();i++) {
+	  for (CoinBigIndex j=start[i]+1;j<start[i]+length[i];j++)
+	    assert( index[j-1] < index[j] );
+	}
+      }
+    }
+    // dual ordered - batch is logged and row copy kept
+    CoinPackedMatrix dual(base);
+    dual.setDualOrdered(true);
+    dual.getOrthoCopy();
+    dual.modifyCoefficients(50,rows,columns,values);
+    assert( dual.hasOrthoCache() );
+    CoinPackedMatrix check;
+    check.reverseOrderedCopyOf(dual);
+    assert( dual.getOrthoCopy().isEquivalent(check) );
+    delete [] row;
+    delete [] column;
+    delete [] element;
+    delete [] rows;
+    delete [] columns;
+    delete [] values;
+  }
+
+  {
+    // Many changes to a large sorted matrix - one at a time same as batched
+    // (timed with -timing)
+    const int numberColumns = 4000;
+    const int numberRows = 10000;
+    const int perColumn = 50;
+    const CoinBigIndex numberElements = numberColumns*perColumn;
+    int * row = new int [numberElements];
+    double * element = new double [numberElements];
+    CoinBigIndex * start = new CoinBigIndex [numberColumns+1];
+    start[0] = 0;
+    for (int i=0;i<numberColumns;i++) {
+      for (int j=0;j<perColumn;j++) {
+	row[i*perColumn+j] = (j*numberRows)/perColumn+(i%(numberRows/perColumn));
+	element[i*perColumn+j] = 1.0+j;
+      }
+      start[i+1] = start[i]+perColumn;
+    }
+    CoinPackedMatrix matrix(true,numberRows,numberColumns,numberElements,
+			    element,row,start,NULL);
+    delete [] row;
+    delete [] element;
+    delete [] start;
+    const int numberChanges = 200000;
+    int * rows = new int [numberChanges];
+    int * columns = new int [numberChanges];
+    double * values = new double [numberChanges];
+    unsigned int seed = 97531;
+    for (int k=0;k<numberChanges;k++) {
+      seed = seed*1103515245+12345;
+      columns[k] = (seed>>8)%numberColumns;
+      seed = seed*1103515245+12345;
+      // mostly existing elements and a few new
+      rows[k] = (k%100==0) ? static_cast<int>((seed>>8)%numberRows) :
+	matrix.getIndices()[columns[k]*perColumn+(seed>>8)%perColumn];
+      values[k] = 0.5+k;
+    }
+    CoinPackedMatrix one(matrix);
+    double startTime = CoinCpuTime();
+    for (int k=0;k<numberChanges;k++)
+      one.modifyCoefficient(rows[k],columns[k],values[k]);
+    const double oneTime = CoinCpuTime()-startTime;
+    matrix.orderMatrix();
+    CoinPackedMatrix sorted(matrix);
+    startTime = CoinCpuTime();
+    for (int k=0;k<numberChanges;k++)
+      sorted.modifyCoefficient(rows[k],columns[k],values[k]);
+    const double sortedTime = CoinCpuTime()-startTime;
+    startTime = CoinCpuTime();
+    double sum = 0.0;
+    for (int k=0;k<numberChanges;k++)
+      sum += sorted.getCoefficient(rows[k],columns[k]);
+    const double getTime = CoinCpuTime()-startTime;
+    startTime = CoinCpuTime();
+    matrix.modifyCoefficients(numberChanges,rows,columns,values);
+    const double batchTime = CoinCpuTime()-startTime;
+    assert( matrix.isEquivalent(one) );
+    assert( matrix.isEquivalent(sorted) );
+    assert( sum > 0.0 );
+    if (coinTestTiming)
+      printf("%d changes - one at a time %g seconds, %g sorted (get %g), batched %g\n",
+	     numberChanges,oneTime,sortedTime,getTime,batchTime);
+    delete [] rows;
+    delete [] columns;
+    delete [] values;
+  }
+
+#if __cplusplus >= 201103L
+  {
+    // Moves take arrays (and row copy) rather than copying them
+    int row[6] = {0,0,1,2,2,2};
+    int column[6] = {0,2,1,0,2,3};
+    double element[6] = {1.0,2.0,3.0,4.0,5.0,6.0};
+    CoinPackedMatrix matrix(true,row,column,element,6);
+    matrix.setDualOrdered(true);
+    matrix.getOrthoCopy();
+    const double * elements = matrix.getElements();
+    CoinInt64 before = CoinMemoryTracker::numberAllocations();
+    CoinPackedMatrix moved(std::move(matrix));
+    assert( CoinMemoryTracker::numberAllocations() == before );
+    assert( moved.getElements() == elements );
+    assert( moved.dualOrdered() && moved.hasOrthoCache() );
+    assert( !matrix.getNumElements() && !matrix.getMajorDim() );
+    assert( !matrix.hasOrthoCache() );
+    // matrix left behind can still be used
+    assert( !matrix.getVectorStarts()[0] );
+    CoinPackedMatrix emptyCopy(matrix);
+    assert( emptyCopy.isEquivalent(matrix) );
+    matrix.appendCol(2,row,element);
+    assert( matrix.getNumElements() == 2 && matrix.getNumCols() == 1 );
+    CoinPackedMatrix assigned;
+    before = CoinMemoryTracker::numberAllocations();
+    assigned = std::move(moved);
+    assert( CoinMemoryTracker::numberAllocations() == before );
+    assert( assigned.getElements() == elements );
+    assert( assigned.getNumElements() == 6 );
+    // copy kept as setting differs
+    assert( !assigned.dualOrdered() && !assigned.hasOrthoCache() );
+    // so vector moves rather than copies when it grows
+    assert( std::is_nothrow_move_constructible<CoinPackedMatrix>::value );
+    std::vector<CoinPackedMatrix> matrices;
+    matrices.push_back(std::move(assigned));
+    for (int i=0;i<20;i++)
+      matrices.push_back(CoinPackedMatrix());
+    assert( matrices[0].getElements() == elements );
+    assert( matrices[0].getCoefficient(2,3) == 6.0 );
+  }
+#endif
+
 #if 0
   {
     // test append
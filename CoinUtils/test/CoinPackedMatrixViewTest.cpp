@@ -0,0 +1,183 @@
+// Copyright (C) 2012, International Business Machines
+// Corporation and others.  All Rights Reserved.
+// This code is licensed under the terms of the Eclipse Public License (EPL).
+
+#ifdef NDEBUG
+#undef NDEBUG
+#endif
+
+#include <cassert>
+#include <cmath>
+#include <cstdio>
+
+#include "CoinPackedMatrixView.hpp"
+#include "CoinPackedMatrix.hpp"
+#include "CoinHelperFunctions.hpp"
+#include "CoinTime.hpp"
+#include "CoinTestTiming.hpp"
+
+//#############################################################################
+
+// Checks view against copy made by submatrixOfWithDuplicates
+static void
+coinViewTestSame(const CoinPackedMatrixView & view,
+		 const CoinPackedMatrix & matrix)
+{
+  CoinPackedMatrix sub;
+  sub.submatrixOfWithDuplicates(matrix,view.getMajorDim(),view.getIndexMap());
+  assert( view.isColOrdered() == sub.isColOrdered() );
+  int nRow = sub.getNumRows();
+  int nCol = sub.getNumCols();
+  assert( view.getNumRows() == nRow );
+  assert( view.getNumCols() == nCol );
+  assert( view.getNumElements() == sub.getNumElements() );
+  for (int i=0;i<view.getMajorDim();i++) {
+    assert( view.getVectorSize(i) == sub.getVectorSize(i) );
+    assert( view.getVector(i) == sub.getVector(i) );
+  }
+  CoinPackedMatrix copy;
+  view.getPackedMatrix(copy);
+  assert( copy.isEquivalent(sub) );
+  double * x = new double [nCol];
+  double * xT = new double [nRow];
+  double * y = new double [CoinMax(nRow,nCol)];
+  double * y0 = new double [CoinMax(nRow,nCol)];
+  for (int i=0;i<nCol;i++)
+    x[i] = (i%3) ? 1.0/(i+1.0) : 0.0;
+  for (int i=0;i<nRow;i++)
+    xT[i] = 1.0-1.0/(i+2.0);
+  view.times(x,y);
+  sub.times(x,y0);
+  for (int i=0;i<nRow;i++)
+    assert( fabs(y[i]-y0[i]) < 1.0e-12 );
+  view.transposeTimes(xT,y);
+  sub.transposeTimes(xT,y0);
+  for (int i=0;i<nCol;i++)
+    assert( fabs(y[i]-y0[i]) < 1.0e-12 );
+  delete [] x;
+  delete [] xT;
+  delete [] y;
+  delete [] y0;
+}
+
+void
+CoinPackedMatrixViewUnitTest()
+{
+  {
+    //    1  .  2  .
+    //    .  3  .  .
+    //    4  .  5  6
+    int row[6] = {0,0,1,2,2,2};
+    int column[6] = {0,2,1,0,2,3};
+    double element[6] = {1.0,2.0,3.0,4.0,5.0,6.0};
+    CoinPackedMatrix byColumn(true,row,column,element,6);
+    // columns in any order with a duplicate
+    int which[4] = {3,0,2,0};
+    CoinPackedMatrixView view(byColumn,4,which);
+    assert( view.getNumElements() == 7 );
+    assert( view.getVector(0).getElements()[0] == 6.0 );
+    // shares elements
+    assert( view.getVector(1).getElements() == byColumn.getVector(0).getElements() );
+    coinViewTestSame(view,byColumn);
+    // rows
+    CoinPackedMatrix byRow;
+    byRow.reverseOrderedCopyOf(byColumn);
+    CoinPackedMatrixView rowView(byRow,2,which+1);
+    assert( !rowView.isColOrdered() );
+    assert( rowView.getNumCols() == 4 );
+    coinViewTestSame(rowView,byRow);
+    // gaps and wide starts
+    CoinPackedMatrix gaps(byColumn);
+    gaps.setExtraGap(2.0);
+    gaps.appendCol(0,NULL,NULL);
+    gaps.setWideStarts(true);
+    CoinPackedMatrixView wideView(gaps,4,which);
+    coinViewTestSame(wideView,byColumn);
+    // copies
+    CoinPackedMatrixView copy(view);
+    CoinPackedMatrixView assigned;
+    assert( assigned.getMajorDim() == 0 && assigned.getMinorDim() == 0 );
+    assigned = copy;
+    coinViewTestSame(assigned,byColumn);
+    // bad index
+    which[2] = 4;
+    bool thrown = false;
+    try {
+      CoinPackedMatrixView bad(byColumn,4,which);
+    }
+    catch (CoinError& e) {
+      thrown = true;
+    }
+    assert( thrown );
+    thrown = false;
+    try {
+      view.getVector(4);
+    }
+    catch (CoinError& e) {
+      thrown = true;
+    }
+    assert( thrown );
+  }
+
+  {
+    // Many small column subsets each used once same as copying
+    // (timed with -timing)
+    const int numberColumns = 100000;
+    const int numberRows = 20000;
+    const int perColumn = 10;
+    const CoinBigIndex numberElements = numberColumns*perColumn;
+    int * row = new int [numberElements];
+    double * element = new double [numberElements];
+    CoinBigIndex * start = new CoinBigIndex [numberColumns+1];
+    start[0] = 0;
+    for (int i=0;i<numberColumns;i++) {
+      for (int j=0;j<perColumn;j++) {
+	row[i*perColumn+j] = (i*7+j*(numberRows/perColumn))%numberRows;
+	element[i*perColumn+j] = 1.0+((i+j)%5);
+      }
+      start[i+1] = start[i]+perColumn;
+    }
+    CoinPackedMatrix matrix(true,numberRows,numberColumns,numberElements,
+			    element,row,start,NULL);
+    const int numberWanted = 200;
+    int * which = new int [numberWanted];
+    double * x = new double [numberWanted];
+    double * y = new double [numberRows];
+    for (int i=0;i<numberWanted;i++)
+      x[i] = 1.0/(i+1.0);
+    const int numberPasses = coinTestTiming ? 200 : 10;
+    double time[2];
+    double sum[2];
+    for (int k=0;k<2;k++) {
+      sum[k] = 0.0;
+      double startTime = CoinCpuTime();
+      for (int pass=0;pass<numberPasses;pass++) {
+	CoinFillN(y,numberRows,1.0);
+	for (int i=0;i<numberWanted;i++)
+	  which[i] = (pass*numberWanted+i*37)%numberColumns;
+	if (k) {
+	  CoinPackedMatrixView view(matrix,numberWanted,which);
+	  view.transposeTimes(y,x);
+	  view.times(x,y);
+	} else {
+	  CoinPackedMatrix sub;
+	  sub.submatrixOfWithDuplicates(matrix,numberWanted,which);
+	  sub.transposeTimes(y,x);
+	  sub.times(x,y);
+	}
+	sum[k] += y[pass%numberRows];
+      }
+      time[k] = CoinCpuTime()-startTime;
+    }
+    assert( fabs(sum[0]-sum[1]) < 1.0e-8*(1.0+fabs(sum[0])) );
+    if (coinTestTiming)
+      printf("%d subsets of %d columns - copied %g, viewed %g seconds\n",
+	     numberPasses,numberWanted,time[0],time[1]);
+    delete [] which;
+    delete [] x;
+    delete [] y;
+    delete [] row;
+    delete [] element;
+    delete [] start;
+  }
+}
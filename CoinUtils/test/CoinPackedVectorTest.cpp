@@ -7,12 +7,15 @@
 #endif
 
 #include <cassert>
+#include <utility>
+#include <vector>
 
 #include "CoinPragma.hpp"
 #include "CoinFloatEqual.hpp"
 #include "CoinFinite.hpp"
 #include "CoinPackedVector.hpp"
 #include "CoinShallowPackedVector.hpp"
+#include "CoinMemoryUsage.hpp"
 
 //--------------------------------------------------------------------------
 void
@@ -1046,5 +1049,40 @@ CoinPackedVectorUnitTest()
 
   } 
 
+
+#if __cplusplus >= 201103L
+  {
+    // Moves take arrays rather than copying them
+    int inx[3] = {1,5,3};
+    double el[3] = {1.0,2.0,3.0};
+    CoinPackedVector r(3,inx,el);
+    const double * elements = r.getElements();
+    CoinInt64 before = CoinMemoryTracker::numberAllocations();
+    CoinPackedVector moved(std::move(r));
+    assert( CoinMemoryTracker::numberAllocations() == before );
+    assert( moved.getElements() == elements );
+    assert( moved.getNumElements() == 3 && moved.getMaxIndex() == 5 );
+    assert( !r.getNumElements() && !r.capacity() );
+    r = std::move(moved);
+    assert( CoinMemoryTracker::numberAllocations() == before );
+    assert( r.getElements() == elements );
+    // std::vector moves when it grows
+    std::vector<CoinPackedVector> vectors;
+    vectors.push_back(std::move(r));
+    vectors.push_back(CoinPackedVector(3,inx,el));
+    assert( vectors[0].getElements() == elements );
+    // duplicates still found if rhs was not tested
+    int dup[2] = {2,2};
+    CoinPackedVector unchecked(2,dup,el,false);
+    bool thrown = false;
+    try {
+      vectors[1] = std::move(unchecked);
+    }
+    catch (CoinError& e) {
+      thrown = true;
+    }
+    assert( thrown );
+  }
+#endif
 }
 
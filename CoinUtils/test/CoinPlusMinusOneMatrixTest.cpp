@@ -0,0 +1,209 @@
+// Copyright (C) 2012, International Business Machines
+// Corporation and others.  All Rights Reserved.
+// This code is licensed under the terms of the Eclipse Public License (EPL).
+
+#ifdef NDEBUG
+#undef NDEBUG
+#endif
+
+#include <cassert>
+#include <cmath>
+#include <cstdio>
+#include <string>
+
+#include "CoinPlusMinusOneMatrix.hpp"
+#include "CoinPackedMatrix.hpp"
+#include "CoinMpsIO.hpp"
+#include "CoinModel.hpp"
+#include "CoinMemoryUsage.hpp"
+#include "CoinHelperFunctions.hpp"
+#include "CoinTime.hpp"
+#include "CoinTestRandom.hpp"
+#include "CoinTestTiming.hpp"
+
+//#############################################################################
+
+// Checks times and transposeTimes against CoinPackedMatrix
+static void
+coinPlusMinusOneTestSame(const CoinPlusMinusOneMatrix & pm,
+			 const CoinPackedMatrix & matrix)
+{
+  int nRow = matrix.getNumRows();
+  int nCol = matrix.getNumCols();
+  assert( pm.getNumRows() == nRow );
+  assert( pm.getNumCols() == nCol );
+  double * x = new double [nCol];
+  double * xT = new double [nRow];
+  double * y = new double [CoinMax(nRow,nCol)];
+  double * y0 = new double [CoinMax(nRow,nCol)];
+  for (int i=0;i<nCol;i++)
+    x[i] = (i%3) ? 1.0/(i+1.0) : 0.0;
+  for (int i=0;i<nRow;i++)
+    xT[i] = 1.0-1.0/(i+2.0);
+  pm.times(x,y);
+  matrix.times(x,y0);
+  for (int i=0;i<nRow;i++)
+    assert( fabs(y[i]-y0[i]) < 1.0e-12 );
+  pm.transposeTimes(xT,y);
+  matrix.transposeTimes(xT,y0);
+  for (int i=0;i<nCol;i++)
+    assert( fabs(y[i]-y0[i]) < 1.0e-12 );
+  delete [] x;
+  delete [] xT;
+  delete [] y;
+  delete [] y0;
+}
+
+void
+CoinPlusMinusOneMatrixUnitTest(const std::string & mpsDir)
+{
+  {
+    // Small matrix both ways round
+    //    1 -1  .
+    //    .  1  1
+    //   -1  .  0
+    int row[7] = {0,0,1,1,2,2,0};
+    int column[7] = {0,1,1,2,0,2,2};
+    double element[7] = {1.0,-1.0,1.0,1.0,-1.0,0.0,0.0};
+    CoinPackedMatrix byColumn(true,row,column,element,7);
+    assert( CoinPlusMinusOneMatrix::isPlusMinusOne(byColumn) );
+    CoinPlusMinusOneMatrix pm(byColumn);
+    assert( pm.isColOrdered() );
+    assert( pm.getNumElements() == 5 );
+    assert( pm.getStartNegative()[0]-pm.getStartPositive()[0] == 1 );
+    coinPlusMinusOneTestSame(pm,byColumn);
+    CoinPackedMatrix byRow;
+    byRow.reverseOrderedCopyOf(byColumn);
+    CoinPlusMinusOneMatrix pmRow(byRow);
+    assert( !pmRow.isColOrdered() );
+    coinPlusMinusOneTestSame(pmRow,byColumn);
+    // back again
+    CoinPackedMatrix back;
+    pm.getPackedMatrix(back);
+    assert( back.isColOrdered() );
+    assert( back.getNumElements() == 5 );
+    assert( back.getCoefficient(2,0) == -1.0 );
+    assert( back.getCoefficient(1,2) == 1.0 );
+    // copies
+    CoinPlusMinusOneMatrix copy(pmRow);
+    CoinPlusMinusOneMatrix assigned;
+    assert( assigned.getNumElements() == 0 );
+    assigned = copy;
+    coinPlusMinusOneTestSame(assigned,byColumn);
+    // from arrays as CoinModel makes them
+    CoinModel model;
+    for (int i=0;i<7;i++) {
+      if (element[i])
+	model.setElement(row[i],column[i],element[i]);
+    }
+    CoinBigIndex startPositive[4];
+    CoinBigIndex startNegative[3];
+    model.countPlusMinusOne(startPositive,startNegative,NULL);
+    assert( startPositive[0] >= 0 );
+    int indices[5];
+    model.createPlusMinusOne(startPositive,startNegative,indices,NULL);
+    CoinPlusMinusOneMatrix fromModel(true,3,3,startPositive,startNegative,
+				     indices);
+    coinPlusMinusOneTestSame(fromModel,byColumn);
+    // not +-1
+    byColumn.modifyCoefficient(0,0,2.0);
+    assert( !CoinPlusMinusOneMatrix::isPlusMinusOne(byColumn) );
+    bool thrown = false;
+    try {
+      CoinPlusMinusOneMatrix bad(byColumn);
+    }
+    catch (CoinError& e) {
+      thrown = true;
+    }
+    assert( thrown );
+    // 64 bit starts
+    byColumn.modifyCoefficient(0,0,1.0);
+    byColumn.setWideStarts(true);
+    assert( !CoinPlusMinusOneMatrix::isPlusMinusOne(byColumn) );
+    thrown = false;
+    try {
+      CoinPlusMinusOneMatrix wide(byColumn);
+    }
+    catch (CoinError& e) {
+      thrown = true;
+    }
+    assert( thrown );
+  }
+
+  {
+    // Found by CoinMpsIO when matrix qualifies (copy made when asked for)
+    const char * names[] = {"galenet","nw460","p0033"};
+    for (int iModel=0;iModel<3;iModel++) {
+      CoinMpsIO m;
+      m.messageHandler()->setLogLevel(0);
+      std::string fn = mpsDir+names[iModel];
+      if (m.readMps(fn.c_str(),"mps")) {
+	printf("Skipping %s - could not read it\n",fn.c_str());
+	continue;
+      }
+      const CoinPackedMatrix & matrix = *m.getMatrixByCol();
+      assert( m.isPlusMinusOne() == 
+	      CoinPlusMinusOneMatrix::isPlusMinusOne(matrix) );
+      // galenet is a network
+      assert( m.isPlusMinusOne() || iModel );
+      if (!m.isPlusMinusOne()) {
+	assert( !m.getPlusMinusOneMatrix() );
+	continue;
+      }
+      // not made until asked for
+      CoinMemoryUsage usage;
+      m.memoryUsage(usage);
+      assert( usage.find("plusMinusOne") < 0 );
+      const CoinPlusMinusOneMatrix * pm = m.getPlusMinusOneMatrix();
+      assert( pm && m.getPlusMinusOneMatrix() == pm );
+      coinPlusMinusOneTestSame(*pm,matrix);
+      CoinMpsIO copy(m);
+      assert( copy.isPlusMinusOne() );
+      assert( copy.getPlusMinusOneMatrix() );
+      // dropped when problem set again with other elements
+      CoinPackedMatrix changed(matrix);
+      changed.modifyCoefficient(changed.getIndices()[0],0,2.0);
+      copy.setMpsData(changed,COIN_DBL_MAX,m.getColLower(),m.getColUpper(),
+		      m.getObjCoefficients(),NULL,m.getRowLower(),
+		      m.getRowUpper(),NULL,NULL);
+      assert( !copy.isPlusMinusOne() );
+      assert( !copy.getPlusMinusOneMatrix() );
+    }
+  }
+
+  {
+    // Large random +-1 matrix (timed against CoinPackedMatrix with -timing)
+    const int numberColumns = 200000;
+    const int numberRows = 50000;
+    const int perColumn = 8;
+    const CoinBigIndex numberElements = numberColumns*perColumn;
+    CoinPackedMatrix matrix;
+    coinTestRandomMatrix(matrix,numberRows,numberColumns,perColumn,4321,true);
+    CoinPlusMinusOneMatrix pm(matrix);
+    coinPlusMinusOneTestSame(pm,matrix);
+    if (coinTestTiming) {
+      double * x = new double [numberColumns];
+      double * y = new double [numberColumns];
+      for (int i=0;i<numberColumns;i++)
+	x[i] = 1.0/(i+1.0);
+      double time[2];
+      for (int k=0;k<2;k++) {
+	double startTime = CoinCpuTime();
+	for (int pass=0;pass<20;pass++) {
+	  if (k) {
+	    pm.times(x,y);
+	    pm.transposeTimes(x,y);
+	  } else {
+	    matrix.times(x,y);
+	    matrix.transposeTimes(x,y);
+	  }
+	}
+	time[k] = CoinCpuTime()-startTime;
+      }
+      printf("%d elements - CoinPackedMatrix %g, CoinPlusMinusOneMatrix %g seconds\n",
+	     numberElements,time[0],time[1]);
+      delete [] x;
+      delete [] y;
+    }
+  }
+}
@@ -0,0 +1,66 @@
+// Copyright (C) 2012, International Business Machines
+// Corporation and others.  All Rights Reserved.
+// This code is licensed under the terms of the Eclipse Public License (EPL).
+
+#ifdef NDEBUG
+#undef NDEBUG
+#endif
+
+#include <cassert>
+
+#include "CoinPresolveMatrix.hpp"
+#include "CoinPackedMatrix.hpp"
+#include "CoinHelperFunctions.hpp"
+#include "CoinMemoryUsage.hpp"
+
+//#############################################################################
+
+void
+CoinPresolveMatrixUnitTest()
+{
+  {
+    /* Memory usage - room for 5 columns, 4 rows and 10 elements
+          1  .  .
+          2  3  .
+          .  .  4
+    */
+    int row[4] = {0,1,1,2};
+    int column[4] = {0,0,1,2};
+    double element[4] = {1.0,2.0,3.0,4.0};
+    CoinPackedMatrix matrix(true,row,column,element,4);
+    CoinPresolveMatrix presolve(5,4,10);
+    CoinMemoryUsage usage;
+    presolve.memoryUsage(usage);
+    assert( !usage.totalReserved() );
+    presolve.setMatrix(&matrix);
+    usage.clear();
+    presolve.memoryUsage(usage);
+    const int sizeBig = CoinSizeofAsInt(CoinBigIndex);
+    const int sizeInt = CoinSizeofAsInt(int);
+    const int sizeDouble = CoinSizeofAsInt(double);
+    int which = usage.find("colStarts");
+    assert( usage.used(which) == 4*sizeBig );
+    assert( usage.reserved(which) == 6*sizeBig );
+    which = usage.find("rowLengths");
+    assert( usage.used(which) == 3*sizeInt );
+    assert( usage.reserved(which) == 5*sizeInt );
+    // bulk storage is twice number of elements
+    which = usage.find("rowIndicesByCol");
+    assert( usage.used(which) == 4*sizeInt );
+    assert( usage.reserved(which) == 20*sizeInt );
+    which = usage.find("elementsByRow");
+    assert( usage.used(which) == 4*sizeDouble );
+    assert( usage.reserved(which) == 20*sizeDouble );
+    which = usage.find("colLinks");
+    assert( usage.reserved(which) == 6*CoinSizeofAsInt(presolvehlink) );
+    // bounds appear when set
+    assert( usage.find("colLower") < 0 );
+    double lower[3] = {0.0,1.0,2.0};
+    presolve.setColLower(lower,-1);
+    usage.clear();
+    presolve.memoryUsage(usage);
+    which = usage.find("colLower");
+    assert( usage.used(which) == 3*sizeDouble );
+    assert( usage.reserved(which) == 5*sizeDouble );
+  }
+}
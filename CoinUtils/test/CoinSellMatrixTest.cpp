@@ -0,0 +1,292 @@
+// Copyright (C) 2012, International Business Machines
+// Corporation and others.  All Rights Reserved.
+// This code is licensed under the terms of the Eclipse Public License (EPL).
+
+#ifdef NDEBUG
+#undef NDEBUG
+#endif
+
+#include <cassert>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <string>
+
+#include "CoinSellMatrix.hpp"
+#include "CoinPackedMatrix.hpp"
+#include "CoinMpsIO.hpp"
+#include "CoinHelperFunctions.hpp"
+#include "CoinTime.hpp"
+#include "CoinTestTiming.hpp"
+
+//#############################################################################
+
+// Largest difference relative to size of answer
+static double
+coinSellTestDifference(const double * a, const double * b, int n)
+{
+  double largest = 0.0;
+  for (int i=0;i<n;i++) {
+    double difference = fabs(a[i]-b[i])/(1.0+fabs(a[i]));
+    if (difference>largest)
+      largest = difference;
+  }
+  return largest;
+}
+
+// Checks times and transposeTimes for all chunk sizes and instruction sets
+static void
+coinSellTestMatrix(const CoinPackedMatrix & matrix)
+{
+  int nRow = matrix.getNumRows();
+  int nCol = matrix.getNumCols();
+  double * x = new double [nCol];
+  double * xT = new double [nRow];
+  for (int i=0;i<nCol;i++)
+    x[i] = 1.0/(i+1.0);
+  for (int i=0;i<nRow;i++)
+    xT[i] = 1.0-1.0/(i+2.0);
+  double * y0 = new double [nRow];
+  double * yT0 = new double [nCol];
+  double * y = new double [nRow];
+  double * yT = new double [nCol];
+  double * yPlain = new double [nRow];
+  double * yTPlain = new double [nCol];
+  matrix.times(x,y0);
+  matrix.transposeTimes(xT,yT0);
+  int chunkSizes[5] = {1,2,4,8,16};
+  int sigmas[3] = {0,1,1000000};
+  for (int k=0;k<5;k++) {
+    for (int l=0;l<3;l++) {
+      CoinSellMatrix sell(matrix,chunkSizes[k],sigmas[l]);
+      assert( sell.getNumRows() == nRow );
+      assert( sell.getNumCols() == nCol );
+      assert( sell.getNumElements() == matrix.getNumElements() );
+      assert( sell.getNumStored() >= sell.getNumElements() );
+      assert( sell.sigma()%sell.chunkSize() == 0 );
+      // every instruction set gives exactly the same answer
+      for (int level=0;level<3;level++) {
+	CoinSellMatrix::setInstructionSet(level);
+	CoinFillN(y,nRow,-1.0);
+	CoinFillN(yT,nCol,-1.0);
+	sell.times(x,y);
+	sell.transposeTimes(xT,yT);
+	if (!level) {
+	  CoinMemcpyN(y,nRow,yPlain);
+	  CoinMemcpyN(yT,nCol,yTPlain);
+	  assert( coinSellTestDifference(y0,y,nRow) < 1.0e-12 );
+	  assert( coinSellTestDifference(yT0,yT,nCol) < 1.0e-12 );
+	} else {
+	  assert( !memcmp(y,yPlain,nRow*sizeof(double)) );
+	  assert( !memcmp(yT,yTPlain,nCol*sizeof(double)) );
+	}
+      }
+      CoinSellMatrix::setInstructionSet(-1);
+      // copies
+      CoinSellMatrix copy(sell);
+      CoinSellMatrix assigned;
+      assert( assigned.getNumRows() == 0 );
+      assigned = copy;
+      assigned.times(x,y);
+      assert( !memcmp(y,yPlain,nRow*sizeof(double)) );
+    }
+  }
+  delete [] x;
+  delete [] xT;
+  delete [] y0;
+  delete [] yT0;
+  delete [] y;
+  delete [] yT;
+  delete [] yPlain;
+  delete [] yTPlain;
+}
+
+void
+CoinSellMatrixUnitTest(const std::string & mpsDir)
+{
+  {
+    // Small matrices with empty and uneven rows and columns
+    //   1 . 2 . .
+    //   . . . . .
+    //   3 4 5 6 7
+    //   . 8 . . 9
+    int row[9] = {0,0,2,2,2,2,2,3,3};
+    int column[9] = {0,2,0,1,2,3,4,1,4};
+    double element[9] = {1.0,2.0,3.0,4.0,5.0,6.0,7.0,8.0,9.0};
+    CoinPackedMatrix byColumn(true,row,column,element,9);
+    coinSellTestMatrix(byColumn);
+    CoinPackedMatrix byRow;
+    byRow.reverseOrderedCopyOf(byColumn);
+    coinSellTestMatrix(byRow);
+    CoinSellMatrix sell(byColumn,4,0);
+    double x[5] = {1.0,1.0,1.0,1.0,1.0};
+    double y[4];
+    sell.times(x,y);
+    assert( y[0] == 3.0 && y[1] == 0.0 && y[2] == 25.0 && y[3] == 17.0 );
+    CoinPackedMatrix empty;
+    CoinSellMatrix sellEmpty(empty);
+    assert( sellEmpty.getNumStored() == 0 );
+    bool thrown = false;
+    try {
+      CoinSellMatrix bad(byColumn,3);
+    }
+    catch (CoinError& e) {
+      thrown = true;
+    }
+    assert( thrown );
+    // 64 bit starts
+    CoinPackedMatrix wide(byColumn);
+    wide.setWideStarts(true);
+    thrown = false;
+    try {
+      CoinSellMatrix bad(wide);
+    }
+    catch (CoinError& e) {
+      thrown = true;
+    }
+    assert( thrown );
+  }
+
+  {
+    // Random matrix with very different lengths
+    const int nRow = 500;
+    const int nCol = 300;
+    int * row = new int [20000];
+    int * column = new int [20000];
+    double * element = new double [20000];
+    int n = 0;
+    unsigned int seed = 12345;
+    for (int j=0;j<nCol;j++) {
+      int length = (j%7==0) ? 200 : (j%3);
+      for (int k=0;k<length;k++) {
+	seed = 1664525*seed+1013904223;
+	row[n] = (seed>>8)%nRow;
+	column[n] = j;
+	element[n++] = 1.0+static_cast<double>(seed%1000)*0.001;
+      }
+    }
+    CoinPackedMatrix matrix(true,row,column,element,n);
+    coinSellTestMatrix(matrix);
+    delete [] row;
+    delete [] column;
+    delete [] element;
+  }
+
+  {
+    // Kept by CoinPackedMatrix and dropped when matrix changes
+    CoinMpsIO m;
+    m.messageHandler()->setLogLevel(0);
+    std::string fn = mpsDir+"p0033";
+    if (m.readMps(fn.c_str(),"mps")==0) {
+      CoinPackedMatrix matrix(*m.getMatrixByCol());
+      assert( matrix.sellCacheAfter() == CoinPackedMatrix::defaultSellCacheAfter() );
+      int nRow = matrix.getNumRows();
+      int nCol = matrix.getNumCols();
+      double * x = new double [nCol];
+      double * y0 = new double [nRow];
+      double * y = new double [nRow];
+      for (int i=0;i<nCol;i++)
+	x[i] = i+1.0;
+      matrix.times(x,y0);
+      matrix.setSellCacheAfter(3);
+      matrix.times(x,y);
+      matrix.times(x,y);
+      assert( !matrix.hasSellCache() );
+      matrix.times(x,y);
+      assert( matrix.hasSellCache() );
+      assert( coinSellTestDifference(y0,y,nRow) < 1.0e-12 );
+      CoinPackedMatrix copy(matrix);
+      assert( !copy.hasSellCache() );
+      assert( copy.sellCacheAfter() == 3 );
+      matrix.modifyCoefficient(0,0,100.0);
+      assert( !matrix.hasSellCache() );
+      for (int i=0;i<3;i++)
+	matrix.times(x,y);
+      assert( matrix.hasSellCache() );
+      double * y1 = new double [nRow];
+      matrix.setSellCacheAfter(0);
+      matrix.times(x,y1);
+      assert( coinSellTestDifference(y1,y,nRow) < 1.0e-12 );
+      assert( y1[0] != y0[0] );
+      delete [] x;
+      delete [] y0;
+      delete [] y;
+      delete [] y1;
+    }
+  }
+
+  if (coinTestTiming) {
+    // How many multiplies pay for building - copies of sample matrices
+    const char * names[] = {"finnis","e226","p0548"};
+    for (int iModel=0;iModel<3;iModel++) {
+      CoinMpsIO m;
+      m.messageHandler()->setLogLevel(0);
+      std::string fn = mpsDir+names[iModel];
+      if (m.readMps(fn.c_str(),"mps")) {
+	printf("Skipping %s - could not read it\n",fn.c_str());
+	continue;
+      }
+      const CoinPackedMatrix & sample = *m.getMatrixByCol();
+      int copies = 1+300000/(sample.getNumElements()+1);
+      CoinPackedMatrix matrix;
+      {
+	// copies down the diagonal
+	int nRow = sample.getNumRows();
+	int nCol = sample.getNumCols();
+	int * row = new int [copies*sample.getNumElements()];
+	int * column = new int [copies*sample.getNumElements()];
+	double * element = new double [copies*sample.getNumElements()];
+	int n = 0;
+	for (int k=0;k<copies;k++) {
+	  for (int j=0;j<nCol;j++) {
+	    for (CoinBigIndex i=sample.getVectorFirst(j);
+		 i<sample.getVectorLast(j);i++) {
+	      row[n] = sample.getIndices()[i]+k*nRow;
+	      column[n] = j+k*nCol;
+	      element[n++] = sample.getElements()[i];
+	    }
+	  }
+	}
+	CoinPackedMatrix copy(true,row,column,element,n);
+	matrix.swap(copy);
+	delete [] row;
+	delete [] column;
+	delete [] element;
+      }
+      int nRow = matrix.getNumRows();
+      int nCol = matrix.getNumCols();
+      double * x = new double [CoinMax(nRow,nCol)];
+      double * y = new double [CoinMax(nRow,nCol)];
+      for (int i=0;i<CoinMax(nRow,nCol);i++)
+	x[i] = 1.0/(i+1.0);
+      const int passes = 20;
+      double start = CoinCpuTime();
+      for (int pass=0;pass<passes;pass++) {
+	matrix.times(x,y);
+	matrix.transposeTimes(x,y);
+      }
+      double timePacked = (CoinCpuTime()-start)/passes;
+      start = CoinCpuTime();
+      CoinSellMatrix sell(matrix);
+      double timeBuild = CoinCpuTime()-start;
+      start = CoinCpuTime();
+      for (int pass=0;pass<passes;pass++) {
+	sell.times(x,y);
+	sell.transposeTimes(x,y);
+      }
+      double timeSell = (CoinCpuTime()-start)/passes;
+      printf("%s x %d (%d elements, %.2f stored per element, instructions %d)"
+	     " - CoinPackedMatrix %g, CoinSellMatrix %g, build %g",
+	     names[iModel],copies,matrix.getNumElements(),
+	     static_cast<double>(sell.getNumStored())/matrix.getNumElements(),
+	     CoinSellMatrix::instructionSet(),timePacked,timeSell,timeBuild);
+      if (timeSell<timePacked)
+	printf(" - pays after %.1f multiplies\n",
+	       2.0*timeBuild/(timePacked-timeSell));
+      else
+	printf(" - never pays\n");
+      delete [] x;
+      delete [] y;
+    }
+  }
+}
@@ -0,0 +1,61 @@
+// Copyright (C) 2012, International Business Machines
+// Corporation and others.  All Rights Reserved.
+// This code is licensed under the terms of the Eclipse Public License (EPL).
+
+#ifndef CoinTestRandom_H
+#define CoinTestRandom_H
+
+#include "CoinHelperFunctions.hpp"
+#include "CoinPackedMatrix.hpp"
+
+/** Random numbers and matrices shared by the unit tests.
+
+    Everything is built on CoinSeedRandom and CoinDrand48 so a given seed
+    always gives the same numbers.
+*/
+
+/// Random integer in 0 to n-1 (CoinDrand48 may return 1.0 on some platforms)
+inline int coinTestRandomInt(int n)
+{
+  int value = static_cast<int>(CoinDrand48()*n);
+  return value < n ? value : n-1;
+}
+
+/** Column ordered matrix with perColumn random elements in each column.
+
+    The rows are split into perColumn bands of numberRows/perColumn rows and
+    each column has one element in each band, so there are no duplicates.
+    Elements are +1 or -1 if plusMinusOne is true, otherwise +-1 to +-8.
+    The random number generator is seeded with seed.
+*/
+inline void coinTestRandomMatrix(CoinPackedMatrix & matrix,
+				 int numberRows, int numberColumns,
+				 int perColumn, int seed,
+				 bool plusMinusOne = false)
+{
+  const CoinBigIndex numberElements =
+    static_cast<CoinBigIndex>(numberColumns)*perColumn;
+  const int band = numberRows/perColumn;
+  int * row = new int [numberElements];
+  double * element = new double [numberElements];
+  CoinBigIndex * start = new CoinBigIndex [numberColumns+1];
+  CoinSeedRandom(seed);
+  CoinBigIndex n = 0;
+  start[0] = 0;
+  for (int i=0;i<numberColumns;i++) {
+    for (int j=0;j<perColumn;j++) {
+      row[n] = j*band+coinTestRandomInt(band);
+      double value = plusMinusOne ? 1.0 : 1.0+coinTestRandomInt(8);
+      element[n++] = coinTestRandomInt(2) ? value : -value;
+    }
+    start[i+1] = n;
+  }
+  CoinPackedMatrix random(true,numberRows,numberColumns,numberElements,
+			  element,row,start,NULL);
+  matrix.swap(random);
+  delete [] row;
+  delete [] element;
+  delete [] start;
+}
+
+#endif
@@ -0,0 +1,16 @@
+// Copyright (C) 2012, International Business Machines
+// Corporation and others.  All Rights Reserved.
+// This code is licensed under the terms of the Eclipse Public License (EPL).
+
+#ifndef CoinTestTiming_H
+#define CoinTestTiming_H
+
+/** True if unitTest was run with -timing.
+
+    The unit tests only check behaviour.  Timings of one way of doing
+    something against another are just run and printed when this is set,
+    as they vary from machine to machine and run to run.
+*/
+extern bool coinTestTiming;
+
+#endif
@@ -0,0 +1,353 @@
+// Copyright (C) 2012, International Business Machines
+// Corporation and others.  All Rights Reserved.
+// This code is licensed under the terms of the Eclipse Public License (EPL).
+
+#ifdef NDEBUG
+#undef NDEBUG
+#endif
+
+#include <cassert>
+#include <cstdio>
+#include <cstring>
+#include <string>
+
+#include "CoinThreadPool.hpp"
+#include "CoinPackedMatrix.hpp"
+#include "CoinMpsIO.hpp"
+#include "CoinHelperFunctions.hpp"
+#include "CoinTime.hpp"
+#include "CoinTestTiming.hpp"
+
+//#############################################################################
+
+// Counts how often each piece is done; later pieces are slower
+class CoinThreadPoolTestTask : public CoinThreadTask {
+public:
+  int * done_;
+  int number_;
+  double * sink_;
+  virtual void run(int which)
+  {
+    done_[which]++;
+    double sum = 0.0;
+    int work = which*which;
+    for (int i=0;i<work;i++)
+      sum += 1.0/(i+1.0);
+    sink_[which] = sum;
+  }
+};
+
+// Checks pieces on same thread never overlap
+class CoinThreadPoolTestOnThread : public CoinThreadTask {
+public:
+  int * done_;
+  int * busy_;
+  double * sink_;
+  int numberThreads_;
+  virtual void run(int which)
+  { runOnThread(which,0); }
+  virtual void runOnThread(int which, int thread)
+  {
+    assert( thread >= 0 && thread < numberThreads_ );
+    assert( !busy_[thread] );
+    busy_[thread] = 1;
+    double sum = 0.0;
+    for (int i=0;i<1000*(which%7);i++)
+      sum += 1.0/(i+1.0);
+    sink_[which] = sum;
+    done_[which]++;
+    busy_[thread] = 0;
+  }
+};
+
+// Marks indices covered by each range
+class CoinThreadPoolTestRange : public CoinThreadRangeTask {
+public:
+  int * done_;
+  int grain_;
+  int maxInUse_;
+  virtual void run(int begin, int end)
+  {
+    assert( end-begin <= grain_ );
+    for (int i=begin;i<end;i++)
+      done_[i]++;
+    int inUse = CoinThreadPool::threadsInUse();
+    if (inUse>maxInUse_)
+      maxInUse_ = inUse; // not exact but never too small
+  }
+};
+
+// Sum of values which give different answers if added in other orders
+class CoinThreadPoolTestSum : public CoinThreadReduceTask {
+public:
+  const double * value_;
+  virtual double run(int begin, int end)
+  {
+    double sum = 0.0;
+    for (int i=begin;i<end;i++)
+      sum += value_[i];
+    return sum;
+  }
+};
+
+// Calls run() from inside a task (each piece with own counts)
+class CoinThreadPoolTestNested : public CoinThreadTask {
+public:
+  CoinThreadPool * pool_;
+  CoinThreadPoolTestTask * inner_;
+  virtual void run(int which)
+  {
+    CoinThreadPoolTestTask inner = *inner_;
+    inner.done_ += which*inner.number_;
+    inner.sink_ += which*inner.number_;
+    pool_->run(inner,inner.number_);
+  }
+};
+
+// Matrix made of copies of a sample matrix down the diagonal
+static CoinPackedMatrix *
+coinThreadPoolTestMatrix(const CoinPackedMatrix & sample, int copies)
+{
+  int nRow = sample.getNumRows();
+  int nCol = sample.getNumCols();
+  CoinBigIndex nEl = sample.getNumElements();
+  CoinBigIndex * start = new CoinBigIndex [copies*nCol+1];
+  int * index = new int [copies*nEl];
+  double * element = new double [copies*nEl];
+  const CoinBigIndex * sStart = sample.getVectorStarts();
+  const int * sLength = sample.getVectorLengths();
+  const int * sIndex = sample.getIndices();
+  const double * sElement = sample.getElements();
+  CoinBigIndex n = 0;
+  for (int k=0;k<copies;k++) {
+    for (int j=0;j<nCol;j++) {
+      start[k*nCol+j] = n;
+      for (CoinBigIndex i=sStart[j];i<sStart[j]+sLength[j];i++) {
+	index[n] = sIndex[i]+k*nRow;
+	element[n++] = sElement[i]*(1.0+1.0e-3*k);
+      }
+    }
+  }
+  start[copies*nCol] = n;
+  CoinPackedMatrix * matrix =
+    new CoinPackedMatrix(true,copies*nRow,copies*nCol,n,
+			 element,index,start,NULL);
+  delete [] start;
+  delete [] index;
+  delete [] element;
+  return matrix;
+}
+
+// True if same major vectors in same order (gaps may differ)
+static bool
+coinThreadPoolTestSame(const CoinPackedMatrix & a, const CoinPackedMatrix & b)
+{
+  if (a.isColOrdered()!=b.isColOrdered()||
+      a.getMajorDim()!=b.getMajorDim()||a.getMinorDim()!=b.getMinorDim())
+    return false;
+  for (int i=0;i<a.getMajorDim();i++) {
+    int n = a.getVectorSize(i);
+    if (n!=b.getVectorSize(i))
+      return false;
+    CoinBigIndex ka = a.getVectorFirst(i);
+    CoinBigIndex kb = b.getVectorFirst(i);
+    if (memcmp(a.getIndices()+ka,b.getIndices()+kb,n*sizeof(int))||
+	memcmp(a.getElements()+ka,b.getElements()+kb,n*sizeof(double)))
+      return false;
+  }
+  return true;
+}
+
+void
+CoinThreadPoolUnitTest(const std::string & mpsDir)
+{
+  const int number = 500;
+  int done[4*number];
+  double sink[4*number];
+  CoinThreadPoolTestTask task;
+  task.done_ = done;
+  task.number_ = number;
+  task.sink_ = sink;
+
+  {
+    // Every piece done once whatever the number of threads
+    for (int nThreads=1;nThreads<=8;nThreads*=2) {
+      CoinThreadPool pool(nThreads);
+      CoinZeroN(done,number);
+      pool.run(task,number);
+      for (int i=0;i<number;i++)
+	assert( done[i] == 1 );
+      if (pool.numberThreads()==1)
+	assert( pool.numberSteals() == 0 );
+      // run from inside a task is serial but still complete
+      CoinThreadPoolTestNested nested;
+      nested.pool_ = &pool;
+      nested.inner_ = &task;
+      CoinZeroN(done,4*number);
+      pool.run(nested,4);
+      for (int i=0;i<4*number;i++)
+	assert( done[i] == 1 );
+    }
+  }
+
+  {
+    // Pieces told thread they run on
+    int busy[8];
+    CoinThreadPoolTestOnThread onThread;
+    onThread.done_ = done;
+    onThread.busy_ = busy;
+    onThread.sink_ = sink;
+    for (int nThreads=1;nThreads<=8;nThreads*=2) {
+      CoinThreadPool pool(nThreads);
+      onThread.numberThreads_ = pool.numberThreads();
+      CoinZeroN(done,number);
+      CoinZeroN(busy,8);
+      pool.run(onThread,number);
+      for (int i=0;i<number;i++)
+	assert( done[i] == 1 );
+    }
+  }
+
+  {
+    // Ranges cover everything once and respect grain
+    CoinThreadPool pool(4);
+    const int n = 10007;
+    int * covered = new int [n];
+    CoinThreadPoolTestRange range;
+    range.done_ = covered;
+    int grains[4] = {1,10,1000,0};
+    for (int k=0;k<4;k++) {
+      CoinZeroN(covered,n);
+      range.grain_ = grains[k] ? grains[k] : n;
+      range.maxInUse_ = 0;
+      pool.parallelFor(range,0,n,grains[k]);
+      for (int i=0;i<n;i++)
+	assert( covered[i] == 1 );
+    }
+    // part range
+    CoinZeroN(covered,n);
+    range.grain_ = 7;
+    pool.parallelFor(range,100,200,7);
+    for (int i=0;i<n;i++)
+      assert( covered[i] == ((i>=100&&i<200) ? 1 : 0) );
+    // concurrency limit
+    CoinThreadPool::setConcurrencyLimit(2);
+    assert( CoinThreadPool::concurrencyLimit() == 2 );
+    CoinZeroN(covered,n);
+    range.grain_ = 10;
+    range.maxInUse_ = 0;
+    pool.parallelFor(range,0,n,10);
+    for (int i=0;i<n;i++)
+      assert( covered[i] == 1 );
+    assert( range.maxInUse_ <= 2 );
+    CoinThreadPool::setConcurrencyLimit(0);
+    assert( CoinThreadPool::threadsInUse() == 0 );
+    delete [] covered;
+    // library code only gets default pool for enough work
+    assert( !CoinThreadPool::defaultPoolFor(1000000,100000) );
+    CoinThreadPool::setDefaultPool(&pool);
+    assert( !CoinThreadPool::defaultPoolFor(99999,100000) );
+    assert( CoinThreadPool::defaultPoolFor(100000,100000) ==
+	    (pool.numberThreads()>1 ? &pool : NULL) );
+    {
+      CoinThreadPool temporary(2);
+      CoinThreadPool::setDefaultPool(&temporary);
+    }
+    // destructor forgets default pool
+    assert( !CoinThreadPool::defaultPool() );
+  }
+
+  {
+    // Sums are the same for any number of threads
+    const int n = 100000;
+    double * value = new double [n];
+    for (int i=0;i<n;i++)
+      value[i] = ((i&1) ? 1.0e10 : 1.0)/(i+1.0);
+    CoinThreadPoolTestSum sum;
+    sum.value_ = value;
+    double result[4];
+    for (int k=0;k<4;k++) {
+      CoinThreadPool pool(1<<k);
+      result[k] = pool.parallelSum(sum,0,n);
+      assert( !memcmp(result+k,result,sizeof(double)) );
+      // given grain
+      double result2 = pool.parallelSum(sum,0,n,1000);
+      CoinThreadPool serial(1);
+      double result3 = serial.parallelSum(sum,0,n,1000);
+      assert( !memcmp(&result2,&result3,sizeof(double)) );
+    }
+    delete [] value;
+  }
+
+  {
+    // Matrix operations on copies of sample matrices (timed with -timing)
+    const char * names[] = {"finnis","e226","p0548"};
+    for (int iModel=0;iModel<3;iModel++) {
+      CoinMpsIO m;
+      m.messageHandler()->setLogLevel(0);
+      std::string fn = mpsDir+names[iModel];
+      if (m.readMps(fn.c_str(),"mps")) {
+	printf("Skipping %s - could not read it\n",fn.c_str());
+	continue;
+      }
+      const CoinPackedMatrix & sample = *m.getMatrixByCol();
+      int copies = 1+1000000/(sample.getNumElements()+1);
+      CoinPackedMatrix * matrix = coinThreadPoolTestMatrix(sample,copies);
+      int nRow = matrix->getNumRows();
+      int nCol = matrix->getNumCols();
+      // transposeTimes of column copy is timesMinor
+      double * x = new double [nRow];
+      for (int i=0;i<nRow;i++)
+	x[i] = 1.0/(i+1.0);
+      double * y0 = new double [nCol];
+      double * y = new double [nCol];
+      int * count0 = new int [nRow];
+      int * count = new int [nRow];
+      CoinPackedMatrix byRow0;
+      if (coinTestTiming)
+	printf("%s x %d (%d elements):",names[iModel],copies,
+	       matrix->getNumElements());
+      for (int nThreads=1;nThreads<=8;nThreads*=2) {
+	CoinThreadPool pool(nThreads);
+	CoinThreadPool::setDefaultPool(&pool);
+	double start = CoinCpuTime();
+	double startWall = CoinGetTimeOfDay();
+	for (int pass=0;pass<(coinTestTiming ? 10 : 1);pass++)
+	  matrix->transposeTimes(x,nThreads==1 ? y0 : y);
+	double timeTimes = CoinGetTimeOfDay()-startWall;
+	startWall = CoinGetTimeOfDay();
+	matrix->countOrthoLength(nThreads==1 ? count0 : count);
+	CoinPackedMatrix byRow;
+	byRow.reverseOrderedCopyOf(*matrix);
+	double timeCopy = CoinGetTimeOfDay()-startWall;
+	double timeCpu = CoinCpuTime()-start;
+	if (nThreads==1) {
+	  byRow0 = byRow;
+	} else {
+	  assert( !memcmp(y0,y,nCol*sizeof(double)) );
+	  assert( !memcmp(count0,count,nRow*sizeof(int)) );
+	  assert( coinThreadPoolTestSame(byRow,byRow0) );
+	}
+	// in place with gaps
+	CoinPackedMatrix gappy;
+	gappy.setExtraGap(0.5);
+	gappy = *matrix;
+	gappy.reverseOrdering();
+	assert( coinThreadPoolTestSame(gappy,byRow0) );
+	if (coinTestTiming)
+	  printf(" %d threads times %.3f copy %.3f (cpu %.3f)",nThreads,
+		 timeTimes,timeCopy,timeCpu);
+	CoinThreadPool::setDefaultPool(NULL);
+      }
+      if (coinTestTiming)
+	printf("\n");
+      delete [] x;
+      delete [] y0;
+      delete [] y;
+      delete [] count0;
+      delete [] count;
+      delete matrix;
+    }
+    assert( CoinThreadPool::defaultPool() == NULL );
+  }
+}
@@ -24,13 +24,29 @@
 #include "CoinMpsIO.hpp"
 #include "CoinLpIO.hpp"
 #include "CoinMessageHandler.hpp"
+#include "CoinTestTiming.hpp"
 void CoinModelUnitTest(const std::string & mpsDir,
                        const std::string & netlibDir, const std::string & testModel);
+void CoinAllocUnitTest();
+void CoinArenaUnitTest();
+void CoinThreadPoolUnitTest(const std::string & mpsDir);
+void CoinSellMatrixUnitTest(const std::string & mpsDir);
+void CoinPlusMinusOneMatrixUnitTest(const std::string & mpsDir);
+void CoinPackedMatrixViewUnitTest();
+void CoinPackedMatrixOrderingUnitTest();
+void CoinPackedMatrixProductUnitTest();
+void CoinPackedMatrixScalingUnitTest();
+void CoinFingerprintUnitTest();
+void CoinFactorizationUnitTest();
+void CoinPresolveMatrixUnitTest();
 // Function Prototypes. Function definitions is in this file.
 void testingMessage( const char * const msg );
 
+// Set by -timing
+bool coinTestTiming = false;
+
 //----------------------------------------------------------------
-// unitTest [-mpsDir=V1] [-netlibDir=V2] [-testModel=V3]
+// unitTest [-mpsDir=V1] [-netlibDir=V2] [-testModel=V3] [-timing]
 // 
 // where (unix defaults):
 //   -mpsDir: directory containing mps test files
@@ -39,6 +55,7 @@ void testingMessage( const char * const msg );
 //       Default value V2="../../Data/Netlib"
 //   -testModel: name of model in netlibdir for testing CoinModel
 //       Default value V3="25fv47.mps"
+//   -timing: also time alternatives and print times
 //
 // All parameters are optional.
 //----------------------------------------------------------------
@@ -67,6 +84,8 @@ int main (int argc, const char *argv[])
   definedKeyWords.insert("-netlibDir");
   // Allow for large named model for CoinModel
   definedKeyWords.insert("-testModel");
+  // Print timings as well as checking
+  definedKeyWords.insert("-timing");
   /*
     Set parameter defaults.
   */
@@ -97,14 +116,15 @@ int main (int argc, const char *argv[])
       std::cerr
 	  << "Undefined parameter \"" << key << "\".\n"
 	  << "Correct usage: \n"
-	  << "  unitTest [-mpsDir=V1] [-netlibDir=V2] [-testModel=V3]\n"
+	  << "  unitTest [-mpsDir=V1] [-netlibDir=V2] [-testModel=V3] [-timing]\n"
 	  << "where:\n"
 	  << "  -mpsDir: directory containing mps test files\n"
 	  << "        Default value V1=\"" << mpsDir << "\"\n"
 	  << "  -netlibDir: directory containing netlib files\n"
 	  << "        Default value V2=\"" << netlibDir << "\"\n"
 	  << "  -testModel: name of model testing CoinModel\n"
-	  << "        Default value V3=\"" << testModel << "\"\n";
+	  << "        Default value V3=\"" << testModel << "\"\n"
+	  << "  -timing: also time alternatives and print times\n";
       return 1 ;
     }
     parms[key] = value ;
@@ -116,6 +136,8 @@ int main (int argc, const char *argv[])
     netlibDir = parms["-netlibDir"] + dirsep;
   if (parms.find("-testModel") != parms.end())
     testModel = parms["-testModel"] ;
+  if (parms.find("-timing") != parms.end())
+    coinTestTiming = true;
 
   bool allOK = true ;
 
@@ -190,6 +212,42 @@ int main (int argc, const char *argv[])
   testingMessage( "Testing CoinPackedMatrix\n" );
   CoinPackedMatrixUnitTest();
 
+  testingMessage( "Testing CoinAlloc\n" );
+  CoinAllocUnitTest();
+
+  testingMessage( "Testing CoinArena\n" );
+  CoinArenaUnitTest();
+
+  testingMessage( "Testing CoinThreadPool\n" );
+  CoinThreadPoolUnitTest(mpsDir);
+
+  testingMessage( "Testing CoinSellMatrix\n" );
+  CoinSellMatrixUnitTest(mpsDir);
+
+  testingMessage( "Testing CoinPlusMinusOneMatrix\n" );
+  CoinPlusMinusOneMatrixUnitTest(mpsDir);
+
+  testingMessage( "Testing CoinPackedMatrixView\n" );
+  CoinPackedMatrixViewUnitTest();
+
+  testingMessage( "Testing CoinPackedMatrixOrdering\n" );
+  CoinPackedMatrixOrderingUnitTest();
+
+  testingMessage( "Testing CoinPackedMatrixProduct\n" );
+  CoinPackedMatrixProductUnitTest();
+
+  testingMessage( "Testing CoinPackedMatrixScaling\n" );
+  CoinPackedMatrixScalingUnitTest();
+
+  testingMessage( "Testing CoinFingerprint\n" );
+  CoinFingerprintUnitTest();
+
+  testingMessage( "Testing CoinFactorization\n" );
+  CoinFactorizationUnitTest();
+
+  testingMessage( "Testing CoinPresolveMatrix\n" );
+  CoinPresolveMatrixUnitTest();
+
 // At moment CoinDenseVector is not compiling with MS V C++ V6
 #if 1
   testingMessage( "Testing CoinDenseVector\n" );